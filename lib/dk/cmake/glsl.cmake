@@ -0,0 +1,58 @@
+# Typed C++ interfaces of shader programs, generated from their GLSL sources
+#
+# dk_glsl_interface(<target>
+#     NAME <struct name>
+#     [HEADER <header name>]
+#     [VERTEX <shader>] [FRAGMENT <shader>] [GEOMETRY <shader>]
+#     [TESS_CONTROL <shader>] [TESS_EVALUATION <shader>] [COMPUTE <shader>]
+#     [INCLUDE_DIRECTORIES <directory>...]
+# )
+#
+# Generates "glsl/<header name>" (by default "<target>_interface.hpp") in the
+# build directory with the struct dk::glsl::<struct name>, which has typed
+# setters of the uniforms, locations of the attributes and bindings of the
+# blocks. Header is generated again whenever a shader changes, so a uniform
+# renamed in GLSL breaks the build of the C++ code still using it, files
+# pulled in by #include are tracked as well. Shader paths are relative to the
+# source directory, as the programs load them. The command runs whenever its
+# stamp is older than the shaders or the tool, but an unchanged header keeps
+# its timestamp, so the code including it is not compiled again.
+function(dk_glsl_interface target)
+    set(stages VERTEX FRAGMENT GEOMETRY TESS_CONTROL TESS_EVALUATION COMPUTE)
+    cmake_parse_arguments(ARG "" "NAME;HEADER;${stages}" "INCLUDE_DIRECTORIES" ${ARGN})
+    if (NOT ARG_NAME)
+        message(FATAL_ERROR "dk_glsl_interface: NAME is required")
+    endif()
+    if (NOT ARG_HEADER)
+        set(ARG_HEADER "${target}_interface.hpp")
+    endif()
+
+    set(output "${CMAKE_BINARY_DIR}/generated/glsl/${ARG_HEADER}")
+    set(stamp "${output}.stamp")
+    set(arguments "")
+    set(dependencies "")
+    foreach(stage ${stages})
+        if (ARG_${stage})
+            string(TOLOWER "${stage}" option)
+            string(REPLACE "_" "-" option "${option}")
+            list(APPEND arguments "--${option}" "${ARG_${stage}}")
+            list(APPEND dependencies "${CMAKE_SOURCE_DIR}/${ARG_${stage}}")
+        endif()
+    endforeach()
+    foreach(directory ${ARG_INCLUDE_DIRECTORIES})
+        list(APPEND arguments "--include" "${directory}")
+    endforeach()
+
+    add_custom_command(
+        OUTPUT ${stamp}
+        BYPRODUCTS ${output}
+        COMMAND dk_glsl_interface ${ARG_NAME} ${output} --stamp ${stamp} ${arguments}
+        DEPENDS dk_glsl_interface ${dependencies}
+        DEPFILE ${stamp}.d
+        WORKING_DIRECTORY ${CMAKE_SOURCE_DIR}
+        COMMENT "Generating GLSL interface ${ARG_HEADER}"
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE ${stamp} ${output})
+    target_include_directories(${target} PRIVATE "${CMAKE_BINARY_DIR}/generated")
+endfunction()
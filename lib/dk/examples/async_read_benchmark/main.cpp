@@ -0,0 +1,110 @@
+/// @file main.cpp
+///
+/// Startup loading of many asset files, read one after another with blocking
+/// std::ifstream and all at once through file::AsyncReader with both of its
+/// backends. Files are evicted from the page cache before every run, so the
+/// numbers show how well the disk queue is kept busy.
+///
+/// Usage: async_read_benchmark [count of files] [size of a file in KiB]
+/// [queue depth]
+
+#include <dklib/file/async_reader.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+/// Evicts the file from the page cache, so that the next read is cold.
+void drop_page_cache(const std::filesystem::path &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+}
+
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+std::vector<std::filesystem::path> make_files(std::size_t count, std::size_t size) {
+    const auto directory = std::filesystem::temp_directory_path() / "dk_async_read_benchmark";
+    std::filesystem::create_directories(directory);
+    std::vector<std::filesystem::path> paths;
+    const std::string contents(size, 'x');
+    for (std::size_t i = 0; i < count; ++i) {
+        auto path = directory / ("asset_" + std::to_string(i) + ".bin");
+        if (not std::filesystem::exists(path) or std::filesystem::file_size(path) != size) {
+            std::ofstream(path, std::ios::binary) << contents;
+        }
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
+
+double read_async(const std::vector<std::filesystem::path> &paths, dk::file::AsyncReader &reader) {
+    std::atomic<std::size_t> total = 0;
+    const double time = measure_seconds([&] {
+        reader.read_all(paths, [&](dk::file::ReadResult &&result) { total += result.bytes.size(); });
+        reader.wait();
+    });
+    spdlog::debug("read {} bytes", total.load());
+    return time;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 256;
+    const std::size_t size = (argc > 2 ? std::stoul(argv[2]) : 1024) * 1024;
+    const std::size_t depth = argc > 3 ? std::stoul(argv[3]) : 64;
+
+    const auto paths = make_files(count, size);
+    const double megabytes = static_cast<double>(count * size) / (1024.0 * 1024.0);
+    const auto drop_all = [&paths] {
+        for (const auto &path : paths) {
+            drop_page_cache(path);
+        }
+    };
+
+    drop_all();
+    const double blocking_time = measure_seconds([&] {
+        for (const auto &path : paths) {
+            std::ifstream fin(path, std::ios::binary);
+            std::ostringstream ss;
+            ss << fin.rdbuf();
+        }
+    });
+
+    dk::file::AsyncReader pool_reader(depth, dk::file::AsyncReader::Backend::THREAD_POOL);
+    drop_all();
+    const double pool_time = read_async(paths, pool_reader);
+
+    dk::file::AsyncReader ring_reader(depth, dk::file::AsyncReader::Backend::IO_URING);
+    drop_all();
+    const double ring_time = read_async(paths, ring_reader);
+
+    spdlog::info("{} files of {} KiB ({:.1f} MiB), queue depth {}", count, size / 1024, megabytes, depth);
+    spdlog::info("blocking ifstream: {:8.3f} s {:8.1f} MiB/s", blocking_time, megabytes / blocking_time);
+    spdlog::info("pread thread pool: {:8.3f} s {:8.1f} MiB/s", pool_time, megabytes / pool_time);
+    if (ring_reader.get_backend() == dk::file::AsyncReader::Backend::IO_URING) {
+        spdlog::info("io_uring:          {:8.3f} s {:8.1f} MiB/s", ring_time, megabytes / ring_time);
+    } else {
+        spdlog::warn("io_uring is not available, it fell back to the thread pool");
+    }
+    return 0;
+}
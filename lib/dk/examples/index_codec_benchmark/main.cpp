@@ -0,0 +1,76 @@
+/// @file main.cpp
+///
+/// Size and decoding throughput of the compressed index blob, on the indices
+/// of an OBJ mesh repeated with shifted indices, as if it were a larger mesh.
+/// The width Mesh would choose for the vertex count is printed alongside.
+///
+/// Usage: index_codec_benchmark [path to obj file] [repeat count]
+
+#include <dklib/file/index_codec.hpp>
+#include <dklib/file/obj_file.hpp>
+#include <dklib/gl/index_format.hpp>
+#include <dklib/gl/vertex.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::filesystem::path source = argc > 1 ? argv[1] : "assets/obj_files/monkey.obj";
+    const int repeat_count = argc > 2 ? std::stoi(argv[2]) : 500;
+
+    using dk::gl::experimental::Vertex;
+    const auto data = dk::file::obj::experimental::read_data<Vertex>(source);
+    const auto vertex_count = data.vertices.size();
+
+    std::vector<dk::gl::u32> indices;
+    indices.reserve(data.indices.size() * static_cast<std::size_t>(repeat_count));
+    for (int copy = 0; copy < repeat_count; ++copy) {
+        for (const auto index : data.indices) {
+            indices.push_back(index + static_cast<dk::gl::u32>(copy * vertex_count));
+        }
+    }
+
+    const auto raw_bytes = static_cast<double>(indices.size() * sizeof(dk::gl::u32));
+    std::vector<std::byte> encoded;
+    const double encode_seconds =
+        measure_seconds([&] { encoded = dk::file::index_codec::encode(std::span<const dk::gl::u32> { indices }); });
+    std::vector<dk::gl::u32> decoded(indices.size());
+    constexpr int decode_runs = 20;
+    const double decode_seconds = measure_seconds([&] {
+        for (int run = 0; run < decode_runs; ++run) {
+            dk::file::index_codec::decode(encoded, decoded);
+        }
+    }) / decode_runs;
+    if (decoded != indices) {
+        spdlog::error("decoded indices differ from the source");
+        return 1;
+    }
+
+    const auto index_size = [](std::size_t count) {
+        return dk::gl::index_size_of(dk::gl::narrowest_index_type(count));
+    };
+    spdlog::info("{}: {} vertices, {} indices, x{}", source.string(), vertex_count, data.indices.size(), repeat_count);
+    spdlog::info("GPU index size: {} B for the mesh, {} B for the repeated mesh", index_size(vertex_count),
+                 index_size(vertex_count * static_cast<std::size_t>(repeat_count)));
+    spdlog::info("encoded: {:.2f} B per index ({:.1f} MiB -> {:.1f} MiB)",
+                 static_cast<double>(encoded.size()) / static_cast<double>(indices.size()), raw_bytes / (1 << 20),
+                 static_cast<double>(encoded.size()) / (1 << 20));
+    spdlog::info("encode: {:.2f} ms", encode_seconds * 1e3);
+    spdlog::info("decode ({}): {:.2f} ms, {:.0f} M indices/s", dk::file::index_codec::instruction_set(),
+                 decode_seconds * 1e3, static_cast<double>(indices.size()) / decode_seconds / 1e6);
+    return 0;
+}
@@ -0,0 +1,94 @@
+/// @file main.cpp
+///
+/// Cache statistics of an OBJ mesh before and after each pass of the mesh
+/// optimizer, through the simulated post-transform and vertex fetch caches.
+/// OBJ faces often have vertices of their own, for their normals, so the
+/// vertices are welded by position first, otherwise there is nothing to
+/// cache. The triangles are then shuffled by default, as if the mesh came
+/// from a file without any locality.
+///
+/// Usage: mesh_optimizer_benchmark [path to obj file] [--keep-order]
+
+#include <dklib/file/obj_file.hpp>
+#include <dklib/gl/mesh_optimizer.hpp>
+#include <dklib/gl/vertex.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/// Keeps the first vertex at each position, the others use its normal and
+/// texture coordinates.
+void weld_by_position(dk::gl::MeshData<dk::gl::experimental::Vertex> &data) {
+    std::map<std::tuple<float, float, float>, dk::gl::u32> welded;
+    std::vector<dk::gl::experimental::Vertex> vertices;
+    std::vector<dk::gl::u32> remap(data.vertices.size());
+    for (std::size_t vertex = 0; vertex < data.vertices.size(); ++vertex) {
+        const auto &position = data.vertices[vertex].position;
+        const auto [it, inserted] = welded.try_emplace({ position.x, position.y, position.z },
+                                                       static_cast<dk::gl::u32>(vertices.size()));
+        if (inserted) {
+            vertices.push_back(data.vertices[vertex]);
+        }
+        remap[vertex] = it->second;
+    }
+    for (auto &index : data.indices) {
+        index = remap[index];
+    }
+    data.vertices = std::move(vertices);
+}
+
+void shuffle_triangles(std::vector<dk::gl::u32> &indices) {
+    std::vector<std::array<dk::gl::u32, 3>> triangles(indices.size() / 3);
+    for (std::size_t triangle = 0; triangle < triangles.size(); ++triangle) {
+        std::copy_n(indices.begin() + static_cast<std::ptrdiff_t>(triangle * 3), 3, triangles[triangle].begin());
+    }
+    std::mt19937 generator(7);
+    std::ranges::shuffle(triangles, generator);
+    for (std::size_t triangle = 0; triangle < triangles.size(); ++triangle) {
+        std::ranges::copy(triangles[triangle], indices.begin() + static_cast<std::ptrdiff_t>(triangle * 3));
+    }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::filesystem::path source = argc > 1 ? argv[1] : "assets/obj_files/monkey.obj";
+    const bool keep_order = argc > 2 and std::string_view { argv[2] } == "--keep-order";
+
+    using dk::gl::experimental::Vertex;
+    auto data = dk::file::obj::experimental::read_data<Vertex>(source);
+    weld_by_position(data);
+    if (not keep_order) {
+        shuffle_triangles(data.indices);
+    }
+    spdlog::info("{}: {} vertices, {} triangles{}", source.string(), data.vertices.size(), data.indices.size() / 3,
+                 keep_order ? "" : ", shuffled");
+
+    std::vector<dk::gl::MeshOptimizationPass> passes;
+    const double seconds = measure_seconds([&] { passes = dk::gl::optimize(data); });
+    for (const auto &pass : passes) {
+        spdlog::info("{:>12}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, overfetch {:.2f} -> {:.2f}", pass.name,
+                     pass.before.acmr, pass.after.acmr, pass.before.atvr, pass.after.atvr, pass.before.overfetch,
+                     pass.after.overfetch);
+    }
+    spdlog::info("optimized in {:.2f} ms, {} vertices left", seconds * 1e3, data.vertices.size());
+    return 0;
+}
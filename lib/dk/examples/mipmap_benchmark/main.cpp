@@ -0,0 +1,102 @@
+/// @file main.cpp
+///
+/// Throughput of the CPU mip chain generation in megapixels of the base level
+/// per second. Every format and filter is measured with pools of increasing
+/// size. As a baseline, the box filtered chain is also computed with
+/// a straightforward single threaded loop calling std::pow for every sample.
+///
+/// Usage: mipmap_benchmark [size of the square base level]
+
+#include <dklib/gl/mipmap.hpp>
+#include <dklib/util/thread_pool.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+dk::gl::Image make_image(dk::gl::u32 size, dk::gl::u32 channels) {
+    dk::gl::Image image(size, size, channels);
+    for (dk::gl::u32 y = 0; y < size; ++y) {
+        auto row = image.row(y);
+        for (std::size_t i = 0; i < row.size(); ++i) {
+            row[i] = static_cast<dk::gl::u8>((i * 31 + y * 17 + (i * y) % 97) & 0xff);
+        }
+    }
+    return image;
+}
+
+/// Gamma correct box filtered chain without any tables nor threads
+std::size_t naive_box_chain(const dk::gl::Image &image) {
+    const auto to_linear = [](dk::gl::u8 value) {
+        const float v = value / 255.0f;
+        return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+    };
+    const auto to_srgb = [](float v) {
+        v = v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+        return static_cast<dk::gl::u8>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+    };
+    std::size_t checksum = 0;
+    dk::gl::Image source = image;
+    while (source.width > 1 or source.height > 1) {
+        dk::gl::Image target(std::max(source.width / 2, 1u), std::max(source.height / 2, 1u), source.channels);
+        for (dk::gl::u32 y = 0; y < target.height; ++y) {
+            const auto top = source.row(std::min(2 * y, source.height - 1));
+            const auto bottom = source.row(std::min(2 * y + 1, source.height - 1));
+            auto row = target.row(y);
+            for (dk::gl::u32 x = 0; x < target.width; ++x) {
+                for (dk::gl::u32 c = 0; c < source.channels; ++c) {
+                    const std::size_t left = std::min(2 * x, source.width - 1) * source.channels + c;
+                    const std::size_t right = std::min(2 * x + 1, source.width - 1) * source.channels + c;
+                    const float sum = to_linear(top[left]) + to_linear(top[right]) + to_linear(bottom[left])
+                        + to_linear(bottom[right]);
+                    row[x * source.channels + c] = to_srgb(sum / 4.0f);
+                }
+            }
+        }
+        checksum += target.pixels[0];
+        source = std::move(target);
+    }
+    return checksum;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const dk::gl::u32 size = argc > 1 ? static_cast<dk::gl::u32>(std::stoul(argv[1])) : 4096;
+    const double megapixels = static_cast<double>(size) * size / 1e6;
+    const std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    spdlog::info("base level: {}x{} ({:.1f} MP), instruction set: {}", size, size, megapixels,
+                 dk::gl::mipmap_instruction_set());
+    for (const dk::gl::u32 channels : { 1u, 3u, 4u }) {
+        const auto image = make_image(size, channels);
+        const double naive_time = measure_seconds([&] { naive_box_chain(image); });
+        spdlog::info("{} channel(s), naive box: {:8.1f} MP/s", channels, megapixels / naive_time);
+
+        for (const auto filter : { dk::gl::MipFilter::BOX, dk::gl::MipFilter::KAISER }) {
+            const char *filter_name = filter == dk::gl::MipFilter::BOX ? "box" : "kaiser";
+            for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+                dk::util::ThreadPool pool(threads);
+                const double time = measure_seconds([&] { dk::gl::generate_mipmaps(image, { filter, true }, pool); });
+                spdlog::info(
+                    "{} channel(s), {:6}, {:2} thread(s): {:8.1f} MP/s", channels, filter_name, threads,
+                    megapixels / time
+                );
+            }
+        }
+    }
+    return 0;
+}
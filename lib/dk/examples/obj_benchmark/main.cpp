@@ -0,0 +1,283 @@
+/// @file main.cpp
+///
+/// Throughput comparison of the OBJ reading modes. The source file is scaled
+/// up by repeating all of its records (with shifted face indices), so that
+/// the measurement is not dominated by the file opening.
+///
+/// Speedups are given against the baseline, a copy of the stream reader as
+/// it was before the mapped mode, deduplicating the vertices with std::map.
+/// The stream mode itself uses util::FlatHashMap since.
+///
+/// Parallel parsing is measured with pools of increasing size, to show how it
+/// scales with the count of cores. Vertex deduplication is compared between
+/// std::map and util::FlatHashMap. Cold start of the OBJ reader is compared
+/// with the .dkmesh cache of the same mesh (scale factor of ~11000 gives
+/// a 1 GiB cache).
+///
+/// Usage: obj_benchmark [path to obj file] [scale factor]
+
+#include <dklib/file/mesh_file.hpp>
+#include <dklib/file/obj_file.hpp>
+#include <dklib/gl/vertex.hpp>
+#include <dklib/util/string_util.hpp>
+#include <dklib/util/thread_pool.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+std::filesystem::path scale_obj_file(const std::filesystem::path &source, int factor) {
+    std::ifstream fin(source);
+    if (not fin.is_open()) {
+        throw std::runtime_error("could not open the file");
+    }
+
+    std::vector<std::string> lines;
+    std::size_t positions = 0;
+    std::size_t textures = 0;
+    std::size_t normals = 0;
+    for (std::string line; std::getline(fin, line);) {
+        positions += line.starts_with("v ");
+        textures += line.starts_with("vt ");
+        normals += line.starts_with("vn ");
+        lines.push_back(std::move(line));
+    }
+
+    auto target = std::filesystem::temp_directory_path() / ("dk_obj_benchmark_" + std::to_string(factor) + ".obj");
+    std::ofstream fout(target);
+    for (int copy = 0; copy < factor; ++copy) {
+        for (const auto &line : lines) {
+            if (not line.starts_with("f ")) {
+                fout << line << '\n';
+                continue;
+            }
+            std::istringstream ss(line.substr(2));
+            fout << 'f';
+            for (std::string corner; ss >> corner;) {
+                const auto indices = dk::util::strs_to_ints(dk::util::split_by_delimeter(corner, "/"));
+                fout << ' ' << indices[0] + copy * positions << '/' << indices[1] + copy * textures << '/'
+                     << indices[2] + copy * normals;
+            }
+            fout << '\n';
+        }
+    }
+    return target;
+}
+
+using namespace dk::file::obj::experimental;
+
+/// Stream reader as it was before the mapped mode, kept as the baseline.
+template <typename VertexType>
+dk::gl::MeshData<VertexType> read_baseline(const std::filesystem::path &filepath) {
+    std::ifstream fin(filepath);
+    if (not fin.is_open()) {
+        throw std::runtime_error("could not open the file");
+    }
+
+    std::vector<dk::math::Vector3D> positions;
+    std::vector<dk::math::Vector3D> normals;
+    std::vector<dk::TextureCoordinates> textures;
+    std::vector<dk::gl::u32> indices;
+    std::vector<VertexType> vertices;
+    std::map<std::tuple<dk::gl::u32, dk::gl::u32, dk::gl::u32>, dk::gl::u32> map;
+
+    for (std::string line; std::getline(fin, line);) {
+        std::stringstream ss(line);
+        std::string prefix;
+        ss >> prefix;
+        switch (match_data_type(prefix)) {
+        case DataType::VERTEX:
+            positions.emplace_back(coordinates_from_stream_v2(ss));
+            break;
+        case DataType::NORMAL:
+            normals.emplace_back(coordinates_from_stream_v2(ss));
+            break;
+        case DataType::TEXTURE:
+            textures.emplace_back(tex_coordinates_from_stream(ss));
+            break;
+        case DataType::FACE:
+            while (not ss.eof()) {
+                std::string face_str;
+                ss >> face_str;
+                const auto [pos, tex, norm] = get_indices_from_face(face_str);
+                if (const auto it = map.find(std::make_tuple(pos, tex, norm)); it != map.end()) {
+                    indices.push_back(it->second);
+                    continue;
+                }
+                VertexType vertex;
+                vertex.position = positions[pos];
+                vertex.normal = normals[norm];
+                vertex.u = textures[tex].u;
+                vertex.v = textures[tex].v;
+                vertices.push_back(vertex);
+                map.insert({ std::make_tuple(pos, tex, norm), vertices.size() - 1 });
+                indices.push_back(vertices.size() - 1);
+            }
+            break;
+        case DataType::UNKNOWN:
+            break;
+        }
+    }
+    return { std::move(vertices), std::move(indices) };
+}
+
+struct DedupResult {
+    double seconds;
+    std::size_t unique_vertices;
+    std::size_t bytes;
+};
+
+DedupResult dedup_with_tree(const ObjData &data) {
+    const auto start = std::chrono::steady_clock::now();
+    std::map<std::tuple<dk::gl::u32, dk::gl::u32, dk::gl::u32>, dk::gl::u32> map;
+    std::vector<dk::gl::u32> indices;
+    indices.reserve(data.corners.size());
+    for (const auto &[pos, tex, norm] : data.corners) {
+        const auto [it, is_inserted] = map.try_emplace(std::make_tuple(pos, tex, norm), map.size());
+        indices.push_back(it->second);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    // Red-black tree node has three pointers and a color besides the value,
+    // allocator overhead is not included.
+    constexpr std::size_t node_size = 4 * sizeof(void *) + sizeof(decltype(map)::value_type);
+    return { std::chrono::duration<double>(end - start).count(), map.size(), map.size() * node_size };
+}
+
+DedupResult dedup_with_flat_map(const ObjData &data) {
+    const auto start = std::chrono::steady_clock::now();
+    VertexIndexMap map(std::max({ data.positions.size(), data.textures.size(), data.normals.size() }));
+    std::vector<dk::gl::u32> indices;
+    indices.reserve(data.corners.size());
+    for (const auto &corner : data.corners) {
+        indices.push_back(*map.try_emplace(corner, static_cast<dk::gl::u32>(map.size())).first);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return { std::chrono::duration<double>(end - start).count(), map.size(), map.memory_usage() };
+}
+
+/// Evicts the file from the page cache, so that the next read is cold.
+void drop_page_cache(const std::filesystem::path &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+}
+
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    using Vertex = dk::gl::experimental::Vertex;
+
+    const std::filesystem::path source = argc > 1 ? argv[1] : "assets/obj_files/monkey.obj";
+    const int factor = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    spdlog::set_level(spdlog::level::warn);
+    const auto path = scale_obj_file(source, factor);
+    const double megabytes = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+
+    dk::gl::MeshData<Vertex> baseline;
+    dk::gl::MeshData<Vertex> streamed;
+    dk::gl::MeshData<Vertex> mapped;
+    dk::gl::MeshData<Vertex> parallel;
+    const double baseline_time = measure_seconds([&] { baseline = read_baseline<Vertex>(path); });
+    const double stream_time = measure_seconds([&] { streamed = read_data<Vertex>(path, ReadMode::STREAM); });
+    const double mapped_time = measure_seconds([&] { mapped = read_data<Vertex>(path, ReadMode::MAPPED); });
+    // Parsing alone, the rest of the mapped time is spent in the vertex
+    // deduplication.
+    const double parse_time = measure_seconds([&] { parse_mapped(path); });
+
+    const double parallel_read_time = measure_seconds([&] { parallel = read_data<Vertex>(path, ReadMode::PARALLEL); });
+
+    std::vector<std::pair<std::size_t, double>> parallel_times;
+    for (std::size_t threads = 1; threads <= std::max(16U, std::thread::hardware_concurrency()); threads *= 2) {
+        dk::util::ThreadPool pool(threads);
+        parallel_times.emplace_back(threads, measure_seconds([&] { parse_mapped(path, pool); }));
+    }
+
+    const auto data = parse_mapped(path);
+    const auto tree = dedup_with_tree(data);
+    const auto flat = dedup_with_flat_map(data);
+
+    // Without a context the upload cannot be measured, touching every byte of
+    // the mapping stands in for glBufferData reading it.
+    const auto cache_path = std::filesystem::path(path).replace_extension(".dkmesh");
+    dk::file::dkmesh::write(cache_path, mapped);
+    drop_page_cache(path);
+    drop_page_cache(cache_path);
+    const double cold_obj_time = measure_seconds([&] { read_data<Vertex>(path, ReadMode::MAPPED); });
+    std::size_t checksum = 0;
+    const double cold_cache_time = measure_seconds([&] {
+        const dk::file::dkmesh::MappedMesh cache(cache_path);
+        for (const auto byte : cache.get_vertices()) {
+            checksum += static_cast<std::size_t>(byte);
+        }
+        for (const auto byte : cache.get_indices()) {
+            checksum += static_cast<std::size_t>(byte);
+        }
+    });
+    const double cache_megabytes = static_cast<double>(std::filesystem::file_size(cache_path)) / (1024.0 * 1024.0);
+    std::filesystem::remove(cache_path);
+    std::filesystem::remove(path);
+
+    spdlog::set_level(spdlog::level::info);
+    spdlog::info("file: {} x{} ({:.1f} MiB)", source.string(), factor, megabytes);
+    spdlog::info("vertices: {} indices: {}", mapped.vertices.size(), mapped.indices.size());
+    spdlog::info("baseline: {:8.3f} s {:8.1f} MiB/s", baseline_time, megabytes / baseline_time);
+    spdlog::info("stream:   {:8.3f} s {:8.1f} MiB/s", stream_time, megabytes / stream_time);
+    spdlog::info("mapped:   {:8.3f} s {:8.1f} MiB/s", mapped_time, megabytes / mapped_time);
+    spdlog::info("parallel: {:8.3f} s {:8.1f} MiB/s", parallel_read_time, megabytes / parallel_read_time);
+    spdlog::info("parse:    {:8.3f} s {:8.1f} MiB/s", parse_time, megabytes / parse_time);
+    spdlog::info(
+        "speedup over the baseline: mapped {:.1f}x, parallel {:.1f}x (parsing only {:.1f}x)",
+        baseline_time / mapped_time, baseline_time / parallel_read_time, baseline_time / parse_time
+    );
+
+    for (const auto &[threads, time] : parallel_times) {
+        spdlog::info(
+            "parallel parse ({:2} threads): {:8.3f} s {:8.1f} MiB/s scaling {:.2f}x", threads, time,
+            megabytes / time, parallel_times.front().second / time
+        );
+    }
+
+    const auto corners = static_cast<double>(data.corners.size());
+    spdlog::info(
+        "dedup std::map:      {:6.1f} M corners/s {:5.1f} B per unique vertex", corners / tree.seconds / 1e6,
+        static_cast<double>(tree.bytes) / static_cast<double>(tree.unique_vertices)
+    );
+    spdlog::info(
+        "dedup FlatHashMap:   {:6.1f} M corners/s {:5.1f} B per unique vertex", corners / flat.seconds / 1e6,
+        static_cast<double>(flat.bytes) / static_cast<double>(flat.unique_vertices)
+    );
+
+    spdlog::info("cold start OBJ:     {:8.3f} s", cold_obj_time);
+    spdlog::info(
+        "cold start .dkmesh: {:8.3f} s ({:.1f} MiB, checksum {})", cold_cache_time, cache_megabytes, checksum
+    );
+
+    if (baseline.indices != mapped.indices or streamed.indices != mapped.indices
+        or streamed.vertices.size() != mapped.vertices.size()
+        or parallel.indices != mapped.indices) {
+        spdlog::error("reading modes produced different meshes");
+        return 1;
+    }
+    return 0;
+}
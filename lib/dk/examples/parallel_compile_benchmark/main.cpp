@@ -0,0 +1,122 @@
+/// @file main.cpp
+///
+/// Startup with many shader programs, each one linked right away with
+/// Program::link versus all of them submitted first and waited for
+/// afterwards, which lets drivers with GL_KHR_parallel_shader_compile overlap
+/// the compilation. Binary cache is not used. Runs in a headless context, so
+/// it works on Mesa llvmpipe without any display.
+///
+/// Usage: parallel_compile_benchmark [count of programs]
+
+#include <dklib/gl/headless_context.hpp>
+#include <dklib/gl/program.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/// Writes pairs of shaders, `salt` makes their sources differ between the
+/// runs, so that the driver can not reuse its own cache.
+std::vector<std::pair<std::string, std::string>> make_shaders(const std::filesystem::path &directory,
+                                                             const std::string &salt, std::size_t count) {
+    std::vector<std::pair<std::string, std::string>> shaders;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto name = salt + "_" + std::to_string(i);
+        const auto vertex = directory / (name + ".vert");
+        const auto fragment = directory / (name + ".frag");
+        std::ofstream(vertex) << "#version 330 core\n// " << name
+                              << "\n"
+                                 "layout (location = 0) in vec3 position;\n"
+                                 "layout (location = 1) in vec3 normal;\n"
+                                 "uniform mat4 model;\n"
+                                 "uniform mat4 view_projection;\n"
+                                 "out vec3 world_normal;\n"
+                                 "void main() {\n"
+                                 "    world_normal = mat3(model) * normal;\n"
+                                 "    gl_Position = view_projection * model * vec4(position, 1.0);\n"
+                                 "}\n";
+        std::ofstream(fragment) << "#version 330 core\n// " << name
+                                << "\n"
+                                   "in vec3 world_normal;\n"
+                                   "uniform vec3 light_directions[8];\n"
+                                   "out vec4 color;\n"
+                                   "void main() {\n"
+                                   "    vec3 n = normalize(world_normal);\n"
+                                   "    float light = 0.0;\n"
+                                   "    for (int i = 0; i < 8; ++i) {\n"
+                                   "        float diffuse = max(dot(n, light_directions[i]), 0.0);\n"
+                                   "        light += diffuse + pow(diffuse, "
+                                << i % 16 + 2 << ".0);\n"
+                                   "    }\n"
+                                   "    color = vec4(vec3(light), 1.0);\n"
+                                   "}\n";
+        shaders.emplace_back(vertex.string(), fragment.string());
+    }
+    return shaders;
+}
+
+std::unique_ptr<dk::gl::Program> make_program(const std::pair<std::string, std::string> &shaders) {
+    auto program = std::make_unique<dk::gl::Program>(nullptr);
+    program->attach_shader(std::string(shaders.first), dk::gl::ShaderType::VERTEX)
+        .attach_shader(std::string(shaders.second), dk::gl::ShaderType::FRAGMENT);
+    return program;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 64;
+
+    // Mesa's own cache of compiled shaders would hide the compilation
+    ::setenv("MESA_SHADER_CACHE_DISABLE", "true", 1);
+    dk::gl::HeadlessContext context;
+    spdlog::info("{} | {}", reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+                 reinterpret_cast<const char *>(glGetString(GL_VERSION)));
+    spdlog::info("GL_KHR_parallel_shader_compile: {}", dk::util::has_extension("GL_KHR_parallel_shader_compile"));
+
+    const auto directory = std::filesystem::temp_directory_path() / "dk_parallel_compile_benchmark";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto serial_shaders = make_shaders(directory, "serial", count);
+    const auto deferred_shaders = make_shaders(directory, "deferred", count);
+
+    std::vector<std::unique_ptr<dk::gl::Program>> programs;
+    const auto serial = measure_seconds([&] {
+        for (const auto &shaders : serial_shaders) {
+            programs.push_back(make_program(shaders));
+            programs.back()->link();
+        }
+    });
+    programs.clear();
+
+    const auto deferred = measure_seconds([&] {
+        for (const auto &shaders : deferred_shaders) {
+            programs.push_back(make_program(shaders));
+            programs.back()->submit();
+        }
+        for (auto &program : programs) {
+            program->wait();
+        }
+    });
+    programs.clear();
+
+    spdlog::info("{} programs", count);
+    spdlog::info("link           : {:8.2f} ms", serial * 1000.0);
+    spdlog::info("submit + wait  : {:8.2f} ms, {:.2f}x faster", deferred * 1000.0, serial / deferred);
+
+    std::filesystem::remove_all(directory);
+}
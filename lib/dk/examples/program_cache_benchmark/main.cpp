@@ -0,0 +1,106 @@
+/// @file main.cpp
+///
+/// Startup cost of the shader programs, cold (every shader compiled and the
+/// program linked, then stored in the binary cache) versus warm (program
+/// restored from the binary cache). Runs in a headless context, so it works
+/// on Mesa llvmpipe without any display.
+///
+/// Usage: program_cache_benchmark [count of programs]
+
+#include <dklib/gl/headless_context.hpp>
+#include <dklib/gl/program.hpp>
+#include <dklib/gl/program_cache.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/// Writes pairs of shaders which differ, so that every program gets its own
+/// cache entry.
+std::vector<std::pair<std::string, std::string>> make_shaders(const std::filesystem::path &directory,
+                                                             std::size_t count) {
+    std::vector<std::pair<std::string, std::string>> shaders;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto vertex = directory / ("program_" + std::to_string(i) + ".vert");
+        const auto fragment = directory / ("program_" + std::to_string(i) + ".frag");
+        std::ofstream(vertex) << "#version 330 core\n"
+                                 "layout (location = 0) in vec3 position;\n"
+                                 "layout (location = 1) in vec3 normal;\n"
+                                 "uniform mat4 model;\n"
+                                 "uniform mat4 view_projection;\n"
+                                 "out vec3 world_normal;\n"
+                                 "void main() {\n"
+                                 "    world_normal = mat3(model) * normal;\n"
+                                 "    gl_Position = view_projection * model * vec4(position, 1.0);\n"
+                                 "}\n";
+        std::ofstream(fragment) << "#version 330 core\n"
+                                   "in vec3 world_normal;\n"
+                                   "uniform vec3 light_direction;\n"
+                                   "out vec4 color;\n"
+                                   "void main() {\n"
+                                   "    float diffuse = max(dot(normalize(world_normal), light_direction), 0.0);\n"
+                                   "    float specular = pow(diffuse, "
+                                << i + 2 << ".0);\n"
+                                   "    color = vec4(vec3(diffuse + specular), 1.0);\n"
+                                   "}\n";
+        shaders.emplace_back(vertex.string(), fragment.string());
+    }
+    return shaders;
+}
+
+std::size_t link_all(const std::vector<std::pair<std::string, std::string>> &shaders,
+                     dk::gl::ProgramBinaryCache *cache) {
+    std::size_t from_cache = 0;
+    for (const auto &[vertex, fragment] : shaders) {
+        dk::gl::Program program(cache);
+        program.attach_shader(std::string(vertex), dk::gl::ShaderType::VERTEX)
+            .attach_shader(std::string(fragment), dk::gl::ShaderType::FRAGMENT)
+            .link();
+        from_cache += program.is_from_binary_cache() ? 1 : 0;
+    }
+    return from_cache;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 32;
+
+    const auto directory = std::filesystem::temp_directory_path() / "dk_program_cache_benchmark";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    // Mesa keeps its own cache of compiled shaders (its program binaries
+    // depend on it), it starts empty too so that the cold run is really cold
+    ::setenv("MESA_SHADER_CACHE_DIR", (directory / "mesa").c_str(), 1);
+    dk::gl::HeadlessContext context;
+    spdlog::info("{} | {}", reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+                 reinterpret_cast<const char *>(glGetString(GL_VERSION)));
+
+    const auto shaders = make_shaders(directory, count);
+    dk::gl::ProgramBinaryCache cache(directory / "programs");
+
+    std::size_t cold_hits = 0;
+    std::size_t warm_hits = 0;
+    const auto cold = measure_seconds([&] { cold_hits = link_all(shaders, &cache); });
+    const auto warm = measure_seconds([&] { warm_hits = link_all(shaders, &cache); });
+
+    spdlog::info("{} programs", count);
+    spdlog::info("cold     : {:8.2f} ms ({} from cache)", cold * 1000.0, cold_hits);
+    spdlog::info("warm     : {:8.2f} ms ({} from cache), {:.1f}x faster", warm * 1000.0, warm_hits, cold / warm);
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,128 @@
+/// @file main.cpp
+///
+/// Material with feature flags, every combination of them needs its own
+/// fragment stage, while the vertex stage is the same for all of them. Full
+/// programs compile and link the vertex stage once per combination, the
+/// PipelineCache once in total. Binary cache is not used. Runs in a headless
+/// context, so it works on Mesa llvmpipe without any display.
+///
+/// Usage: separable_pipeline_benchmark [count of feature flags]
+
+#include <dklib/gl/headless_context.hpp>
+#include <dklib/gl/program_pipeline.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/// Writes the stages, `salt` makes their sources differ between the runs, so
+/// that the driver can not reuse its own cache.
+std::pair<std::filesystem::path, std::filesystem::path> make_shaders(const std::filesystem::path &directory,
+                                                                     const std::string &salt, std::size_t flag_count) {
+    const auto vertex = directory / (salt + ".vert");
+    const auto fragment = directory / (salt + ".frag");
+    std::ofstream(vertex) << "#version 450 core\n// " << salt
+                          << "\n"
+                             "layout (location = 0) in vec3 position;\n"
+                             "layout (location = 1) in vec3 normal;\n"
+                             "uniform mat4 model;\n"
+                             "uniform mat4 view_projection;\n"
+                             "layout (location = 0) out vec3 world_normal;\n"
+                             "void main() {\n"
+                             "    world_normal = mat3(model) * normal;\n"
+                             "    gl_Position = view_projection * model * vec4(position, 1.0);\n"
+                             "}\n";
+    std::ofstream out(fragment);
+    out << "#version 450 core\n// " << salt
+        << "\n"
+           "layout (location = 0) in vec3 world_normal;\n"
+           "uniform vec3 light_directions[8];\n"
+           "layout (location = 0) out vec4 color;\n"
+           "void main() {\n"
+           "    vec3 n = normalize(world_normal);\n"
+           "    float light = 0.0;\n"
+           "    for (int i = 0; i < 8; ++i) {\n"
+           "        light += max(dot(n, light_directions[i]), 0.0);\n"
+           "    }\n";
+    for (std::size_t flag = 0; flag < flag_count; ++flag) {
+        out << "#ifdef FEATURE_" << flag << "\n    light = pow(light, " << flag + 2 << ".0);\n#endif\n";
+    }
+    out << "    color = vec4(vec3(light), 1.0);\n}\n";
+    return { vertex, fragment };
+}
+
+std::vector<dk::gl::ShaderDefine> make_defines(std::size_t combination, std::size_t flag_count) {
+    std::vector<dk::gl::ShaderDefine> defines;
+    for (std::size_t flag = 0; flag < flag_count; ++flag) {
+        if ((combination >> flag & 1U) != 0) {
+            defines.push_back({ "FEATURE_" + std::to_string(flag) });
+        }
+    }
+    return defines;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t flag_count = argc > 1 ? std::stoul(argv[1]) : 4;
+    const std::size_t combinations = std::size_t { 1 } << flag_count;
+
+    // Mesa's own cache of compiled shaders would hide the compilation
+    ::setenv("MESA_SHADER_CACHE_DISABLE", "true", 1);
+    dk::gl::HeadlessContext context;
+    spdlog::info("{} | {}", reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+                 reinterpret_cast<const char *>(glGetString(GL_VERSION)));
+
+    const auto directory = std::filesystem::temp_directory_path() / "dk_separable_pipeline_benchmark";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto [full_vertex, full_fragment] = make_shaders(directory, "full", flag_count);
+    const auto [stage_vertex, stage_fragment] = make_shaders(directory, "stage", flag_count);
+
+    dk::gl::ShaderVariantCache variants;
+    std::vector<std::unique_ptr<dk::gl::Program>> programs;
+    const auto full = measure_seconds([&] {
+        for (std::size_t i = 0; i < combinations; ++i) {
+            const auto defines = make_defines(i, flag_count);
+            auto &program = programs.emplace_back(std::make_unique<dk::gl::Program>(nullptr));
+            // the variant cache already shares the compiled vertex shader,
+            // only the links are repeated
+            program->attach_shader(full_vertex.string(), dk::gl::ShaderType::VERTEX,
+                                   std::span<const dk::gl::ShaderDefine> {}, variants)
+                .attach_shader(full_fragment.string(), dk::gl::ShaderType::FRAGMENT,
+                               std::span<const dk::gl::ShaderDefine> { defines }, variants)
+                .link();
+        }
+    });
+
+    dk::gl::PipelineCache pipelines(nullptr);
+    const auto separable = measure_seconds([&] {
+        for (std::size_t i = 0; i < combinations; ++i) {
+            pipelines
+                .get({ { dk::gl::ShaderType::VERTEX, stage_vertex },
+                       { dk::gl::ShaderType::FRAGMENT, stage_fragment, make_defines(i, flag_count) } })
+                .bind();
+        }
+    });
+
+    spdlog::info("{} feature flags, {} combinations", flag_count, combinations);
+    spdlog::info("full programs      : {:8.2f} ms, {} programs", full * 1000.0, programs.size());
+    spdlog::info("separable pipeline : {:8.2f} ms, {} stage programs, {:.2f}x faster", separable * 1000.0,
+                 pipelines.get_stage_count(), full / separable);
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,124 @@
+/// @file main.cpp
+///
+/// The render loop of rgb_normals, the same mesh drawn many times with only
+/// a uniform changing between the draws. Frames are drawn once through the
+/// StateCache, and once with the cache invalidated before every draw, which
+/// issues every bind the way the wrappers did before it. Runs in a headless
+/// context, so it works on Mesa llvmpipe without any display.
+///
+/// Usage: state_cache_benchmark [draws per frame] [frame count]
+
+#include <dklib/gl/buffer_object.hpp>
+#include <dklib/gl/headless_context.hpp>
+#include <dklib/gl/mesh.hpp>
+#include <dklib/gl/program.hpp>
+#include <dklib/gl/state_cache.hpp>
+
+#include <GLES3/gl3.h>
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/// Small triangle, so that the draws cost less than the calls around them.
+dk::gl::MeshData<dk::gl::experimental::Vertex> make_triangle() {
+    return {
+        {
+            { { -0.1f, -0.1f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f },
+            { { 0.1f, -0.1f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 1.0f, 0.0f },
+            { { 0.0f, 0.1f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 0.5f, 1.0f },
+        },
+        { 0, 1, 2 },
+    };
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const int draw_count = argc > 1 ? std::stoi(argv[1]) : 255;
+    const int frame_count = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    dk::gl::HeadlessContext context;
+    spdlog::info("{} | {}", reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+                 reinterpret_cast<const char *>(glGetString(GL_VERSION)));
+
+    const auto directory = std::filesystem::temp_directory_path() / "dk_state_cache_benchmark";
+    std::filesystem::create_directories(directory);
+    std::ofstream(directory / "main.vert") << "#version 450 core\n"
+                                              "layout (location = 0) in vec3 position;\n"
+                                              "uniform vec2 offset;\n"
+                                              "void main() { gl_Position = vec4(position.xy + offset, 0.0, 1.0); }\n";
+    std::ofstream(directory / "main.frag") << "#version 450 core\n"
+                                              "out vec4 color;\n"
+                                              "void main() { color = vec4(1.0); }\n";
+
+    dk::gl::Program program(nullptr);
+    program.attach_shader((directory / "main.vert").string(), dk::gl::ShaderType::VERTEX)
+        .attach_shader((directory / "main.frag").string(), dk::gl::ShaderType::FRAGMENT)
+        .link();
+    auto offset = program.make_uniform("offset");
+    const dk::gl::Mesh<dk::gl::experimental::Vertex> mesh(make_triangle());
+
+    dk::gl::u32 framebuffer = 0;
+    dk::gl::u32 renderbuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 64, 64);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    glViewport(0, 0, 64, 64);
+
+    auto &state = dk::gl::StateCache::get_instance();
+    const auto run = [&](bool is_cached) {
+        state.end_frame();
+        dk::gl::StateStats frame {};
+        const auto seconds = measure_seconds([&] {
+            for (int f = 0; f < frame_count; ++f) {
+                glClear(GL_COLOR_BUFFER_BIT);
+                state.enable(GL_CULL_FACE);
+                state.enable(GL_DEPTH_TEST);
+                program.use();
+                for (int i = 0; i < draw_count; ++i) {
+                    if (not is_cached) {
+                        state.invalidate();
+                    }
+                    const auto x = static_cast<float>(i % 16) / 8.0f - 1.0f;
+                    const auto y = static_cast<float>(i / 16) / 8.0f - 1.0f;
+                    offset.set(x, y);
+                    mesh.draw();
+                }
+                frame = state.end_frame();
+            }
+            glFinish();
+        });
+        return std::pair { seconds, frame };
+    };
+
+    // warm up, the first frames compile the draw state
+    static_cast<void>(run(true));
+    const auto [uncached, uncached_frame] = run(false);
+    const auto [cached, cached_frame] = run(true);
+
+    spdlog::info("{} draws per frame, {} frames", draw_count, frame_count);
+    spdlog::info("every bind issued : {:8.3f} ms per frame, {} issued, {} elided", uncached * 1000.0 / frame_count,
+                 uncached_frame.issued, uncached_frame.elided);
+    spdlog::info("state cache       : {:8.3f} ms per frame, {} issued, {} elided, {:.2f}x faster",
+                 cached * 1000.0 / frame_count, cached_frame.issued, cached_frame.elided, uncached / cached);
+
+    glDeleteRenderbuffers(1, &renderbuffer);
+    glDeleteFramebuffers(1, &framebuffer);
+    std::filesystem::remove_all(directory);
+}
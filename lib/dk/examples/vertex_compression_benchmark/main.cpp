@@ -0,0 +1,65 @@
+/// @file main.cpp
+///
+/// Compresses the vertices of an OBJ mesh, prints their memory before and
+/// after, the error of the decoded vertices against the fp32 source and the
+/// throughput of the conversion. The vertices are repeated to get a working
+/// set larger than the caches.
+///
+/// Usage: vertex_compression_benchmark [path to obj file] [repeat count]
+
+#include <dklib/file/obj_file.hpp>
+#include <dklib/gl/vertex.hpp>
+#include <dklib/gl/vertex_compression.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+template <typename Function>
+double measure_seconds(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::filesystem::path source = argc > 1 ? argv[1] : "assets/obj_files/monkey.obj";
+    const int repeat_count = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    using dk::gl::experimental::Vertex;
+    const auto data = dk::file::obj::experimental::read_data<Vertex>(source);
+    spdlog::info("{}: {} vertices, {} indices", source.string(), data.vertices.size(), data.indices.size());
+
+    std::vector<Vertex> vertices;
+    vertices.reserve(data.vertices.size() * static_cast<std::size_t>(repeat_count));
+    for (int i = 0; i < repeat_count; ++i) {
+        vertices.insert(vertices.end(), data.vertices.begin(), data.vertices.end());
+    }
+
+    dk::gl::CompressedVertices compressed;
+    const double seconds = measure_seconds([&] { compressed = dk::gl::compress(vertices); });
+    const double source_bytes = static_cast<double>(vertices.size() * sizeof(Vertex));
+    const double compressed_bytes = static_cast<double>(compressed.vertices.size() * sizeof(dk::gl::CompressedVertex));
+    spdlog::info("instruction set: {}", dk::gl::vertex_compression_instruction_set());
+    spdlog::info("{} vertices: {:.1f} MiB -> {:.1f} MiB ({:.2f}x)", vertices.size(), source_bytes / (1 << 20),
+                 compressed_bytes / (1 << 20), source_bytes / compressed_bytes);
+    spdlog::info("compression: {:.2f} ms, {:.0f} MiB/s of fp32 vertices", seconds * 1e3,
+                 source_bytes / (1 << 20) / seconds);
+
+    std::vector<Vertex> decoded;
+    const double decode_seconds =
+        measure_seconds([&] { decoded = dk::gl::decompress(compressed.vertices, compressed.quantization); });
+    spdlog::info("decompression: {:.2f} ms", decode_seconds * 1e3);
+
+    const auto error = dk::gl::measure_error(data.vertices, dk::gl::compress(data.vertices));
+    spdlog::info("position error: max {:.3g}, mean {:.3g}", error.max_position, error.mean_position);
+    spdlog::info("normal error: max {:.3g}°, mean {:.3g}°", error.max_normal_degrees, error.mean_normal_degrees);
+    spdlog::info("uv error: max {:.3g}, mean {:.3g}", error.max_uv, error.mean_uv);
+    return 0;
+}
@@ -1,7 +1,13 @@
 #ifndef DK_FILE_H
 #define DK_FILE_H
 
+#include "file/async_reader.hpp"
 #include "file/file_base.hpp"
+#include "file/file_watcher.hpp"
+#include "file/index_codec.hpp"
+#include "file/ktx_file.hpp"
+#include "file/mesh_file.hpp"
 #include "file/obj_file.hpp"
+#include "file/ply_file.hpp"
 
 #endif // DK_FILE_H
@@ -0,0 +1,90 @@
+#ifndef DK_ASYNC_READER_HPP
+#define DK_ASYNC_READER_HPP
+
+#include <dklib/util/thread_pool.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace dk::file {
+
+/// @brief Contents of a file read by the AsyncReader.
+struct ReadResult {
+    std::filesystem::path path;
+    std::vector<std::byte> bytes;
+    /// Set when the file could not be opened or read, bytes are empty then
+    std::error_code error;
+};
+
+using ReadCallback = std::function<void(ReadResult &&result)>;
+
+/// @brief Reads whole files asynchronously, many of them at once.
+///
+/// On Linux the reads are submitted to an io_uring, so that a single thread
+/// keeps up to `queue_depth` of them in flight and the disk queue stays deep.
+/// When io_uring is not available (old kernel, seccomp filters of
+/// containers), the reads are done with pread on a pool of `queue_depth`
+/// threads instead.
+///
+/// Callbacks are called from the thread completing the reads, they should
+/// only hand the result over. Destructor waits for all of the pending reads.
+class AsyncReader {
+public:
+    enum class Backend {
+        IO_URING,
+        THREAD_POOL,
+    };
+
+    explicit AsyncReader(std::size_t queue_depth = 64, Backend preferred = Backend::IO_URING);
+    ~AsyncReader();
+
+    AsyncReader(const AsyncReader &other) = delete;
+    AsyncReader &operator=(const AsyncReader &other) = delete;
+
+    /// @brief Queues the read, callback receives the contents or the error.
+    void read(const std::filesystem::path &filepath, ReadCallback callback);
+    /// @brief Queues the read, future throws std::system_error on failure.
+    [[nodiscard]] std::future<std::vector<std::byte>> read(const std::filesystem::path &filepath);
+
+    /// @brief Queues all of the reads with as few system calls as possible.
+    void read_all(std::span<const std::filesystem::path> filepaths, const ReadCallback &callback);
+
+    /// @brief Blocks until there are no pending reads.
+    void wait();
+
+    [[nodiscard]] Backend get_backend() const noexcept { return backend_; }
+
+private:
+    struct Request;
+    class Ring;
+
+    void submit(std::span<const std::filesystem::path> filepaths, const ReadCallback &callback);
+    void complete(std::unique_ptr<Request> request);
+    void completion_loop();
+    void read_with_pread(Request &request);
+
+    Backend backend_;
+    std::size_t queue_depth_;
+    std::unique_ptr<Ring> ring_;
+    std::unique_ptr<util::ThreadPool> pool_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::size_t pending_ { 0 };
+    std::atomic<bool> is_stopping_ { false };
+    std::thread completion_thread_;
+};
+
+} // namespace dk::file
+
+#endif // DK_ASYNC_READER_HPP
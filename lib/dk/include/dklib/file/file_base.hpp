@@ -1,9 +1,13 @@
 #ifndef DK_FILE_BASE_HPP
 #define DK_FILE_BASE_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <dklib/gl/model.hpp>
@@ -57,6 +61,73 @@ private:
     std::fstream file_;
 }; */
 
+namespace file {
+    /// @brief Expected way of accessing the file, passed to madvise.
+    enum class AccessPattern {
+        NORMAL,
+        /// Read from the beginning to the end, makes the kernel read ahead
+        /// aggressively and drop the pages behind
+        SEQUENTIAL,
+        /// Read in no particular order, disables the read ahead
+        RANDOM,
+    };
+
+    struct MappingOptions {
+        AccessPattern access { AccessPattern::NORMAL };
+        /// Asks for transparent huge pages, which lowers the TLB pressure of
+        /// big files. Needs a kernel with huge pages for the page cache,
+        /// otherwise it is silently ignored.
+        bool is_huge_page_allowed { false };
+    };
+
+    /// @brief Read only memory mapping of a whole file.
+    ///
+    /// Contents of the file are accessed in place, they are never copied into
+    /// a userland buffer. Mapping is released when the object is destroyed.
+    ///
+    /// Files that can not be mapped (pipes, character devices and the like)
+    /// are read into a buffer instead, so the callers do not have to care.
+    /// So are the files that report no size, like the /proc and sysfs ones.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path &filepath, const MappingOptions &options = {});
+        ~MappedFile();
+
+        // This is a move only type
+        MappedFile(const MappedFile &other) = delete;
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        /// @brief Changes the access pattern of a part of the file.
+        ///
+        /// It is only a hint, failures are ignored and it does nothing for
+        /// the buffered files.
+        void advise(AccessPattern access, std::size_t offset = 0, std::size_t length = SIZE_MAX) const noexcept;
+
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+            return { static_cast<const std::byte *>(data_), size_ };
+        }
+        [[nodiscard]] std::string_view text() const noexcept {
+            return { static_cast<const char *>(data_), size_ };
+        }
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+        /// @brief Whether the contents are mapped, false when they had to be
+        /// read into a buffer.
+        [[nodiscard]] bool is_mapped() const noexcept { return is_mapped_; }
+
+    private:
+        void read_into_buffer(int fd, const std::filesystem::path &filepath);
+        void unmap() noexcept;
+
+        const void *data_ { nullptr };
+        std::size_t size_ { 0 };
+        std::vector<std::byte> buffer_;
+        bool is_mapped_ { false };
+    };
+} // namespace file
+
 } // namespace dk
 
 #endif // DK_FILE_BASE_HPP
@@ -0,0 +1,78 @@
+#ifndef DK_FILE_WATCHER_HPP
+#define DK_FILE_WATCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dk::file {
+
+/// @brief Change of a watched file reported by the FileWatcher.
+struct FileChange {
+    std::filesystem::path path;
+    /// Modification time of the file when the change was read
+    std::filesystem::file_time_type written;
+};
+
+using ChangeCallback = std::function<void(const FileChange &change)>;
+
+/// @brief Watches files for changes with Linux inotify, without any thread.
+///
+/// Directories of the files are watched instead of the files themselves, as
+/// editors usually save by writing a new file and renaming it over the old
+/// one, which would end a watch of the file. A file is reported once it is
+/// closed after writing or moved in place. Changes are read by poll(), which
+/// never blocks, so it can be called every frame.
+class FileWatcher {
+public:
+    using WatchId = std::uint64_t;
+
+    /// @brief Throws when inotify is not available.
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher &other) = delete;
+    FileWatcher &operator=(const FileWatcher &other) = delete;
+
+    /// @brief Calls the callback from poll() whenever the file changes, the
+    /// file does not have to exist yet. Throws when its directory can not be
+    /// watched.
+    WatchId watch(const std::filesystem::path &filepath, ChangeCallback callback);
+    void unwatch(WatchId id);
+
+    /// @brief Reads the pending changes and calls the callbacks of the
+    /// changed files, every file at most once, even when it was written
+    /// several times since the last poll. When the kernel queue overflowed
+    /// and events were lost, every watched file is reported.
+    /// @return count of the changed files
+    std::size_t poll();
+
+    /// @brief Count of the watched files.
+    [[nodiscard]] std::size_t size() const noexcept { return watches_.size(); }
+
+private:
+    struct Watch {
+        std::filesystem::path path;
+        int directory;
+        ChangeCallback callback;
+    };
+
+    struct Directory {
+        std::filesystem::path path;
+        std::size_t watch_count { 0 };
+    };
+
+    int fd_ { -1 };
+    WatchId next_id_ { 0 };
+    std::unordered_map<WatchId, Watch> watches_;
+    /// Keyed by the inotify watch descriptors
+    std::unordered_map<int, Directory> directories_;
+};
+
+} // namespace dk::file
+
+#endif // DK_FILE_WATCHER_HPP
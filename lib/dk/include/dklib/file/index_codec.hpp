@@ -0,0 +1,68 @@
+#ifndef DK_INDEX_CODEC_HPP
+#define DK_INDEX_CODEC_HPP
+
+#include <dklib/gl/gltypes.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/// Compressed index blob, used by the binary mesh files
+///
+/// Each index is stored as the zigzag encoded difference to the previous one
+/// (the first one to 0), which is small for meshes with vertex locality.
+/// Differences are byte aligned varints whose lengths are kept apart from
+/// them, the stream VByte layout:
+///
+///     control bytes (ceil(count / 4), 2 bits per index: its length - 1)
+///     data bytes (1 to 4 little endian bytes per index)
+///
+/// With the lengths known upfront, the decoder expands four indices at once
+/// with a single shuffle, then undoes the differences with a prefix sum.
+namespace dk::file::index_codec {
+
+/// @brief Largest size of count encoded indices.
+[[nodiscard]] constexpr std::size_t max_encoded_size(std::size_t count) noexcept {
+    return (count + 3) / 4 + count * sizeof(gl::u32);
+}
+
+/// @brief Smallest size of count encoded indices, each one takes at least
+/// a data byte.
+[[nodiscard]] constexpr std::size_t min_encoded_size(std::size_t count) noexcept { return (count + 3) / 4 + count; }
+
+std::vector<std::byte> encode(std::span<const gl::u32> indices);
+
+template <typename IndexType>
+std::vector<std::byte> encode(std::span<const IndexType> indices) {
+    const std::vector<gl::u32> widened(indices.begin(), indices.end());
+    return encode(std::span<const gl::u32> { widened });
+}
+
+/// @brief Decodes as many indices as the target holds.
+///
+/// Throws when the encoded blob is too short for them.
+void decode(std::span<const std::byte> encoded, std::span<gl::u32> indices);
+
+template <typename IndexType>
+std::vector<IndexType> decode(std::span<const std::byte> encoded, std::size_t count) {
+    std::vector<gl::u32> indices(count);
+    decode(encoded, indices);
+    if constexpr (std::is_same_v<IndexType, gl::u32>) {
+        return indices;
+    } else {
+        std::vector<IndexType> narrowed(count);
+        std::ranges::transform(indices, narrowed.begin(), [](gl::u32 index) { return static_cast<IndexType>(index); });
+        return narrowed;
+    }
+}
+
+/// @brief Name of the instruction set used by the decoder (ssse3 or
+/// scalar).
+std::string_view instruction_set();
+
+} // namespace dk::file::index_codec
+
+#endif // DK_INDEX_CODEC_HPP
@@ -1,10 +1,30 @@
 #ifndef DK_KTX_FILE_HPP
 #define DK_KTX_FILE_HPP
 
+#include "file_base.hpp"
 #include <dklib/gl/gltypes.hpp>
+#include <dklib/gl/mipmap.hpp>
+#include <dklib/gl/texture.hpp>
 
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+/// KTX 1.1 texture container
+///
+/// File is memory mapped and the image data of every mip level and face are
+/// exposed as spans into the mapping, nothing is copied before the upload.
 namespace dk::file::ktx {
 
+inline constexpr std::array<gl::u8, 12> IDENTIFIER = {
+    0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n',
+};
+inline constexpr gl::u32 KTX_LITTLE_ENDIAN = 0x04030201;
+inline constexpr gl::u32 KTX_BIG_ENDIAN = 0x01020304;
+
 struct Header {
     char identifier[12];
     gl::u32 endianness;
@@ -21,9 +41,121 @@ struct Header {
     gl::u32 miplevels;
     gl::u32 keypairbytes;
 };
+static_assert(sizeof(Header) == 64);
 
+/// @brief Location of a single image in the file.
+///
+/// Image is a single face of a non-array cube map, otherwise it holds the
+/// whole mip level (all of the array elements, faces and depth slices).
+struct ImageRange {
+    gl::u32 level;
+    gl::u32 face;
+    gl::u32 width;
+    gl::u32 height;
+    gl::u32 depth;
+    std::size_t offset;
+    std::size_t size;
+};
+
+/// @brief Validated header together with the position of every image.
+struct Layout {
+    /// Header with the values in the native byte order
+    Header header;
+    /// Images sorted by level and then by face
+    std::vector<ImageRange> images;
+
+    [[nodiscard]] gl::u32 level_count() const noexcept;
+    [[nodiscard]] gl::u32 face_count() const noexcept;
+    [[nodiscard]] bool is_compressed() const noexcept { return header.gltype == 0; }
+    [[nodiscard]] gl::TextureType texture_type() const;
+    [[nodiscard]] const ImageRange &image(gl::u32 level, gl::u32 face = 0) const;
+};
+
+/// @brief Validates the header and locates every image of the file.
+///
+/// Throws when the file is truncated, has unknown endianness or when its
+/// texel data would need byte swapping.
+Layout parse_layout(std::span<const std::byte> bytes);
+
+/// @brief Memory mapped KTX file.
+class MappedTexture {
+public:
+    explicit MappedTexture(const std::filesystem::path &filepath);
+
+    [[nodiscard]] const Header &get_header() const noexcept { return layout_.header; }
+    [[nodiscard]] const Layout &get_layout() const noexcept { return layout_; }
+    [[nodiscard]] gl::u32 get_level_count() const noexcept { return layout_.level_count(); }
+    [[nodiscard]] gl::u32 get_face_count() const noexcept { return layout_.face_count(); }
+
+    /// @brief Texel data of the image, pointing into the mapping.
+    [[nodiscard]] std::span<const std::byte> get_image(gl::u32 level, gl::u32 face = 0) const;
+
+private:
+    MappedFile file_;
+    Layout layout_;
+};
+
+/// @brief Texture whose mip levels are uploaded progressively.
+///
+/// Storage for the whole chain is allocated up front, then the smallest
+/// levels are uploaded first and the base level of the texture is lowered as
+/// the larger ones arrive, so the texture is complete and can be sampled
+/// after the constructor returns.
+class StreamedTexture {
+public:
+    /// @brief Uploads the smallest levels until `initial_budget` bytes are
+    /// used, always at least one level.
+    explicit StreamedTexture(MappedTexture &&source, std::size_t initial_budget = 0);
+    ~StreamedTexture();
+
+    // This is a move only type
+    StreamedTexture(const StreamedTexture &other) = delete;
+    StreamedTexture &operator=(const StreamedTexture &other) = delete;
+
+    StreamedTexture(StreamedTexture &&other) noexcept;
+    StreamedTexture &operator=(StreamedTexture &&other) noexcept;
+
+    /// @brief Uploads next larger levels, meant to be called once per frame.
+    ///
+    /// At least one level is uploaded, more of them while the total stays
+    /// within `byte_budget`.
+    /// @return true when all of the levels are resident
+    bool stream(std::size_t byte_budget);
+
+    [[nodiscard]] bool is_complete() const noexcept { return resident_level_ == 0; }
+    /// @brief Largest level that is already uploaded.
+    [[nodiscard]] gl::u32 get_resident_level() const noexcept { return resident_level_; }
+    [[nodiscard]] gl::u32 get_id() const noexcept { return id_; }
+    [[nodiscard]] gl::TextureType get_type() const noexcept { return type_; }
+
+    /// @brief Hands the texture over to the caller, which then owns it.
+    [[nodiscard]] gl::u32 release() noexcept;
+
+private:
+    void upload_level(gl::u32 level);
+
+    MappedTexture source_;
+    gl::TextureType type_;
+    gl::u32 id_ { 0 };
+    gl::u32 resident_level_ { 0 };
+};
+
+/// @brief Loads the whole texture at once.
+/// @return name of the created OpenGL texture
 gl::u32 load(const std::string &filename);
-bool save(const std::string &filename);
+
+/// @brief Writes the images in the order of Layout::images (by level, then
+/// by face).
+///
+/// Identifier and endianness of the header are filled in, key/value data are
+/// not written. Padding between the faces and the levels is added here, rows
+/// of the images have to be padded already.
+void save(const std::filesystem::path &filepath, const Header &header,
+          std::span<const std::span<const std::byte>> images);
+
+/// @brief Writes the mip chain (as made by gl::generate_mipmaps) as an
+/// uncompressed 2D texture.
+void save(const std::filesystem::path &filepath, std::span<const gl::Image> mip_chain, bool is_srgb = true);
 
 } // namespace dk::file::ktx
 
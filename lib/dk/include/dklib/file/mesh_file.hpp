@@ -0,0 +1,244 @@
+#ifndef DK_MESH_FILE_HPP
+#define DK_MESH_FILE_HPP
+
+#include "file_base.hpp"
+#include "index_codec.hpp"
+#include <dklib/gl/gltypes.hpp>
+#include <dklib/gl/mesh.hpp>
+#include <dklib/gl/vertex.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+/// Binary mesh cache format (.dkmesh)
+///
+/// File is laid out so that it can be memory mapped and its blobs passed
+/// straight to glBufferData:
+///
+///     Header
+///     VertexAttribute[attribute_count]
+///     padding up to BLOB_ALIGNMENT
+///     vertex blob (vertex_count * vertex_stride bytes)
+///     padding up to BLOB_ALIGNMENT
+///     index blob (index_bytes bytes)
+///
+/// The index blob holds index_count * index_size bytes of raw indices (the
+/// default), or the indices compressed by index_codec, see IndexEncoding.
+///
+/// All values are stored in the native byte order, which is recorded in the
+/// header, so that files from a machine with different endianness are
+/// rejected instead of being misread.
+namespace dk::file::dkmesh {
+
+inline constexpr char IDENTIFIER[8] = { 'D', 'K', 'M', 'E', 'S', 'H', '\r', '\n' };
+/// Version 2 added the stream binding and the integer flag to the attributes,
+/// version 3 the index encoding
+inline constexpr gl::u32 VERSION = 3;
+inline constexpr gl::u32 ENDIANNESS = 0x04030201;
+inline constexpr std::size_t BLOB_ALIGNMENT = 64;
+
+enum class IndexEncoding : gl::u32 {
+    /// Indices as they are uploaded, the blob may go straight to the GPU
+    RAW = 0,
+    /// index_codec, 1 to 2 bytes per index of a mesh with vertex locality.
+    /// Smaller files, but the indices are decoded into memory before the
+    /// upload, so they give up the zero-copy read.
+    DELTA_VARINT = 1,
+};
+
+struct Header {
+    char identifier[8];
+    gl::u32 endianness;
+    gl::u32 version;
+    gl::u32 header_size;
+    gl::u32 attribute_count;
+    gl::u32 vertex_stride;
+    gl::u32 index_type;
+    gl::u32 index_size;
+    IndexEncoding index_encoding;
+    gl::u64 vertex_count;
+    gl::u64 index_count;
+    gl::u64 vertex_offset;
+    gl::u64 index_offset;
+    gl::u64 index_bytes;
+    gl::f32 bounds_min[3];
+    gl::f32 bounds_max[3];
+};
+static_assert(std::is_trivially_copyable_v<Header>);
+static_assert(sizeof(Header) % alignof(gl::VertexAttribute) == 0);
+
+/// @brief Axis aligned bounding box of the vertex positions.
+struct Bounds {
+    math::Vector3D min;
+    math::Vector3D max;
+};
+
+/// @brief Type independent description of mesh data that is to be written.
+struct MeshBlobs {
+    std::span<const gl::VertexAttribute> attributes;
+    gl::u32 vertex_stride;
+    std::span<const std::byte> vertices;
+    gl::u32 index_size;
+    std::span<const std::byte> indices;
+    Bounds bounds;
+    IndexEncoding index_encoding { IndexEncoding::RAW };
+};
+
+/// @brief OpenGL type of an index with the provided size in bytes.
+gl::enum32 index_type_of(gl::u32 index_size);
+
+void write(const std::filesystem::path &filepath, const MeshBlobs &blobs);
+
+/// @brief Memory mapped .dkmesh file.
+///
+/// Vertex and index blobs are views into the mapping, they are valid as long
+/// as this object lives. Throws when the header does not match the blobs or
+/// the raw indices point past the vertices.
+class MappedMesh {
+public:
+    explicit MappedMesh(const std::filesystem::path &filepath);
+
+    [[nodiscard]] const Header &get_header() const noexcept { return *header_; }
+    [[nodiscard]] std::span<const gl::VertexAttribute> get_attributes() const noexcept { return attributes_; }
+    [[nodiscard]] std::span<const std::byte> get_vertices() const noexcept { return vertices_; }
+    /// @brief Index blob as it is stored, compressed unless the encoding
+    /// is IndexEncoding::RAW.
+    [[nodiscard]] std::span<const std::byte> get_indices() const noexcept { return indices_; }
+    [[nodiscard]] IndexEncoding get_index_encoding() const noexcept { return header_->index_encoding; }
+    [[nodiscard]] Bounds get_bounds() const noexcept;
+
+    /// @brief Checks whether the stored vertices have the layout of
+    /// VertexType and indices the size of IndexType.
+    template <gl::DescribedVertex VertexType, typename IndexType>
+    [[nodiscard]] bool holds() const noexcept {
+        constexpr auto &layout = gl::VertexLayout<VertexType>::attributes;
+        return header_->vertex_stride == sizeof(VertexType) and header_->index_size == sizeof(IndexType)
+            and std::ranges::equal(attributes_, layout);
+    }
+
+    template <typename T>
+    [[nodiscard]] std::span<const T> get_vertices_as() const noexcept {
+        return { reinterpret_cast<const T *>(vertices_.data()), vertices_.size() / sizeof(T) };
+    }
+    /// @brief View of raw indices, see read_indices for any encoding.
+    template <typename T>
+    [[nodiscard]] std::span<const T> get_indices_as() const noexcept {
+        return { reinterpret_cast<const T *>(indices_.data()), indices_.size() / sizeof(T) };
+    }
+
+    /// @brief Indices of the file, decoded when they are compressed.
+    ///
+    /// Throws when a decoded index points past the vertices, the raw ones
+    /// are checked when the file is opened.
+    template <typename IndexType>
+    [[nodiscard]] std::vector<IndexType> read_indices() const {
+        if (header_->index_encoding == IndexEncoding::RAW) {
+            const auto indices = get_indices_as<IndexType>();
+            return { indices.begin(), indices.end() };
+        }
+        auto indices = index_codec::decode<gl::u32>(indices_, header_->index_count);
+        check_decoded_indices(indices);
+        if constexpr (std::is_same_v<IndexType, gl::u32>) {
+            return indices;
+        } else {
+            return { indices.begin(), indices.end() };
+        }
+    }
+
+private:
+    void check_decoded_indices(std::span<const gl::u32> indices) const;
+
+    MappedFile file_;
+    const Header *header_ { nullptr };
+    std::span<const gl::VertexAttribute> attributes_;
+    std::span<const std::byte> vertices_;
+    std::span<const std::byte> indices_;
+};
+
+template <gl::DescribedVertex VertexType>
+Bounds compute_bounds(std::span<const VertexType> vertices) {
+    constexpr auto lowest = std::numeric_limits<gl::f32>::lowest();
+    constexpr auto highest = std::numeric_limits<gl::f32>::max();
+    Bounds bounds { { highest, highest, highest }, { lowest, lowest, lowest } };
+    if constexpr (requires(const VertexType &vertex) { vertex.position.x; }) {
+        for (const auto &vertex : vertices) {
+            bounds.min = { std::min(bounds.min.x, vertex.position.x), std::min(bounds.min.y, vertex.position.y),
+                           std::min(bounds.min.z, vertex.position.z) };
+            bounds.max = { std::max(bounds.max.x, vertex.position.x), std::max(bounds.max.y, vertex.position.y),
+                           std::max(bounds.max.z, vertex.position.z) };
+        }
+    } else {
+        for (const auto &vertex : vertices) {
+            bounds.min = { std::min(bounds.min.x, vertex.position[0]), std::min(bounds.min.y, vertex.position[1]),
+                           std::min(bounds.min.z, vertex.position[2]) };
+            bounds.max = { std::max(bounds.max.x, vertex.position[0]), std::max(bounds.max.y, vertex.position[1]),
+                           std::max(bounds.max.z, vertex.position[2]) };
+        }
+    }
+    return bounds;
+}
+
+template <gl::DescribedVertex VertexType, typename IndexType>
+void write(
+    const std::filesystem::path &filepath, std::span<const VertexType> vertices, std::span<const IndexType> indices,
+    IndexEncoding index_encoding = IndexEncoding::RAW
+) {
+    write(
+        filepath,
+        { gl::VertexLayout<VertexType>::attributes, sizeof(VertexType), std::as_bytes(vertices), sizeof(IndexType),
+          std::as_bytes(indices), compute_bounds(vertices), index_encoding }
+    );
+}
+
+template <gl::DescribedVertex VertexType, typename IndexType>
+void write(
+    const std::filesystem::path &filepath, const gl::MeshData<VertexType, IndexType> &mesh,
+    IndexEncoding index_encoding = IndexEncoding::RAW
+) {
+    write<VertexType, IndexType>(filepath, mesh.vertices, mesh.indices, index_encoding);
+}
+
+/// @brief Writes the CPU side copy of the mesh.
+///
+/// Throws for a mesh made from spans, which has no such copy.
+template <gl::DescribedVertex VertexType, typename IndexType>
+void write(
+    const std::filesystem::path &filepath, const gl::Mesh<VertexType, IndexType> &mesh,
+    IndexEncoding index_encoding = IndexEncoding::RAW
+) {
+    if (mesh.get_indices().size() != mesh.get_index_count()) {
+        spdlog::error("file: {} cannot be written from a mesh without a CPU side copy", filepath.string());
+        throw std::runtime_error("mesh has no CPU side geometry");
+    }
+    write<VertexType, IndexType>(filepath, mesh.get_vertices(), mesh.get_indices(), index_encoding);
+}
+
+/// @brief Maps the file and uploads its blobs straight from the mapping.
+///
+/// Compressed indices are decoded first. Mapping is released once the data
+/// are on the GPU.
+template <gl::DescribedVertex VertexType = gl::experimental::Vertex, typename IndexType = gl::u32>
+gl::Mesh<VertexType, IndexType> read(const std::filesystem::path &filepath) {
+    const MappedMesh mapped(filepath);
+    if (not mapped.holds<VertexType, IndexType>()) {
+        spdlog::error("file: {} does not match the requested vertex layout", filepath.string());
+        throw std::runtime_error("mesh file has a different vertex layout");
+    }
+    if (mapped.get_index_encoding() == IndexEncoding::RAW) {
+        return { mapped.get_vertices_as<VertexType>(), mapped.get_indices_as<IndexType>() };
+    }
+    const auto indices = mapped.read_indices<IndexType>();
+    return { mapped.get_vertices_as<VertexType>(), std::span<const IndexType> { indices } };
+}
+
+} // namespace dk::file::dkmesh
+
+#endif // DK_MESH_FILE_HPP
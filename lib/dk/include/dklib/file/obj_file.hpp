@@ -6,12 +6,17 @@
 #include <dklib/gl/mesh.hpp>
 #include <dklib/gl/model.hpp>
 #include <dklib/gl/vertex.hpp>
+#include <dklib/util/flat_hash_map.hpp>
+#include <dklib/util/thread_pool.hpp>
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <map>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
@@ -49,8 +54,122 @@ namespace file::obj::experimental {
     std::tuple<gl::u32, gl::u32, gl::u32>
     get_indices_from_face(const std::string &face_str);
 
+    /// @brief Strategy used for reading of the OBJ file.
+    enum class ReadMode {
+        /// Line by line reading through std::ifstream and std::stringstream.
+        STREAM,
+        /// The file is memory mapped and scanned in place with std::from_chars.
+        MAPPED,
+        /// Same as MAPPED, but the file is split at line boundaries into
+        /// chunks that are parsed on the shared thread pool.
+        PARALLEL,
+    };
+
+    /// Value of face corner component which was omitted in the file, e.g.
+    /// the texture index in `f 1//1 2//2 3//3`.
+    inline constexpr gl::u32 MISSING_INDEX = std::numeric_limits<gl::u32>::max();
+
+    /// @brief Single corner of a face with zero based indices.
+    struct FaceCorner {
+        gl::u32 position { MISSING_INDEX };
+        gl::u32 texture { MISSING_INDEX };
+        gl::u32 normal { MISSING_INDEX };
+
+        friend bool operator==(const FaceCorner &lhs, const FaceCorner &rhs) = default;
+    };
+
+    /// @brief Hash of the whole (position, texture, normal) triple, used for
+    /// vertex deduplication.
+    struct FaceCornerHash {
+        std::size_t operator()(const FaceCorner &corner) const noexcept {
+            const gl::u64 packed = (static_cast<gl::u64>(corner.position) << 32U) | corner.texture;
+            return util::mix_hash(packed ^ (static_cast<gl::u64>(corner.normal) * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
+    /// Map from a face corner to the index of its vertex.
+    using VertexIndexMap = util::FlatHashMap<FaceCorner, gl::u32, FaceCornerHash>;
+
+    /// @brief Raw records of an OBJ file, before the vertices are assembled.
+    ///
+    /// Faces are already triangulated, thus every three consecutive corners
+    /// form a single triangle.
+    struct ObjData {
+        std::vector<math::Vector3D> positions;
+        std::vector<math::Vector3D> normals;
+        std::vector<TextureCoordinates> textures;
+        std::vector<FaceCorner> corners;
+    };
+
+    /// @brief Parses OBJ records from text that is already in memory.
+    ///
+    /// Whole buffer is scanned in place, no per line or per token strings are
+    /// allocated. Polygons with more than three corners are triangulated as
+    /// a fan.
+    ObjData parse(std::string_view text);
+
+    /// @brief Parses OBJ records in parallel on the provided pool.
+    ///
+    /// Text is split at line boundaries into chunks of at least
+    /// min_chunk_size bytes. Chunks are merged by prefix sums of their record
+    /// counts, thus the result is identical to the serial parse().
+    ObjData parse(std::string_view text, util::ThreadPool &pool, std::size_t min_chunk_size = 1 << 20);
+
+    /// @brief Memory maps the file and parses it with parse().
+    ObjData parse_mapped(const std::filesystem::path &filepath);
+    ObjData parse_mapped(const std::filesystem::path &filepath, util::ThreadPool &pool);
+
+    /// @brief Creates vertices and indices from parsed records.
+    ///
+    /// Corners that share the same position, texture and normal indices are
+    /// deduplicated into a single vertex.
+    template <typename VertexType = gl::Vertex, typename IndexType = gl::u32>
+    gl::MeshData<VertexType, IndexType> assemble(const ObjData &data) {
+        gl::MeshData<VertexType, IndexType> mesh;
+        mesh.indices.reserve(data.corners.size());
+
+        // Every record is usually referenced at least once, which makes the
+        // largest record count a good estimate of the unique vertex count.
+        const std::size_t expected_vertices = std::min(
+            data.corners.size(), std::max({ data.positions.size(), data.textures.size(), data.normals.size() })
+        );
+        mesh.vertices.reserve(expected_vertices);
+        VertexIndexMap vertex_indices(expected_vertices);
+
+        for (const auto &corner : data.corners) {
+            const auto [slot, is_inserted] = vertex_indices.try_emplace(corner, static_cast<gl::u32>(mesh.vertices.size()));
+            if (not is_inserted) {
+                mesh.indices.push_back(static_cast<IndexType>(*slot));
+                continue;
+            }
+            const auto &[pos, tex, norm] = corner;
+            if (pos >= data.positions.size()
+                or (tex != MISSING_INDEX and tex >= data.textures.size())
+                or (norm != MISSING_INDEX and norm >= data.normals.size())) {
+                spdlog::error("Face corner {}/{}/{} references undefined data", pos, tex, norm);
+                throw std::runtime_error("face references undefined vertex data");
+            }
+            VertexType vertex {};
+            vertex.position = data.positions[pos];
+            if constexpr (requires { vertex.normal; }) {
+                if (norm != MISSING_INDEX) {
+                    vertex.normal = data.normals[norm];
+                }
+            }
+            if constexpr (requires { vertex.u; vertex.v; }) {
+                if (tex != MISSING_INDEX) {
+                    vertex.u = data.textures[tex].u;
+                    vertex.v = data.textures[tex].v;
+                }
+            }
+            mesh.indices.push_back(static_cast<IndexType>(mesh.vertices.size()));
+            mesh.vertices.push_back(vertex);
+        }
+        return mesh;
+    }
+
     template <typename VertexType = gl::Vertex, typename IndexType = gl::u32>
-    gl::Mesh<VertexType, IndexType> read(const std::filesystem::path &filepath) {
+    gl::MeshData<VertexType, IndexType> read_stream(const std::filesystem::path &filepath) {
 
         std::ifstream fin;
         fin.open(filepath);
@@ -66,7 +185,7 @@ namespace file::obj::experimental {
 
         std::vector<VertexType> vertices;
 
-        std::map<std::tuple<gl::u32, gl::u32, gl::u32>, gl::u32> mmap;
+        VertexIndexMap mmap;
 
         std::string line;
         while (std::getline(fin, line)) {
@@ -88,9 +207,8 @@ namespace file::obj::experimental {
                     std::string face_str;
                     ss >> face_str;
                     const auto [pos, tex, norm] = get_indices_from_face(face_str);
-                    if (auto it = mmap.find(std::make_tuple(pos, tex, norm));
-                        it != mmap.end()) {
-                        indices.push_back(it->second);
+                    if (auto *it = mmap.find({ pos, tex, norm }); it != nullptr) {
+                        indices.push_back(*it);
                         // spdlog::info("forced to not do this");
                         continue;
                     }
@@ -102,7 +220,7 @@ namespace file::obj::experimental {
                     // vertices.emplace_back(positions[pos], normals[norm], textures[tex].u,
                     // textures[tex].v);
                     vertices.push_back(vertex);
-                    mmap.insert({ std::make_tuple(pos, tex, norm), vertices.size() - 1 });
+                    mmap.try_emplace({ pos, tex, norm }, vertices.size() - 1);
                     indices.push_back(vertices.size() - 1);
                 }
             case DataType::UNKNOWN:
@@ -120,6 +238,28 @@ namespace file::obj::experimental {
         // }
         return { vertices, indices };
     }
+
+    /// @brief Reads the OBJ file into CPU side geometry, without touching
+    /// OpenGL.
+    template <typename VertexType = gl::Vertex, typename IndexType = gl::u32>
+    gl::MeshData<VertexType, IndexType>
+    read_data(const std::filesystem::path &filepath, ReadMode mode = ReadMode::STREAM) {
+        switch (mode) {
+        case ReadMode::MAPPED:
+            return assemble<VertexType, IndexType>(parse_mapped(filepath));
+        case ReadMode::PARALLEL:
+            return assemble<VertexType, IndexType>(parse_mapped(filepath, util::ThreadPool::get_instance()));
+        case ReadMode::STREAM:
+            break;
+        }
+        return read_stream<VertexType, IndexType>(filepath);
+    }
+
+    template <typename VertexType = gl::Vertex, typename IndexType = gl::u32>
+    gl::Mesh<VertexType, IndexType>
+    read(const std::filesystem::path &filepath, ReadMode mode = ReadMode::STREAM) {
+        return gl::Mesh<VertexType, IndexType> { read_data<VertexType, IndexType>(filepath, mode) };
+    }
 } // namespace file::obj::experimental
 
 gl::Model load_obj_file(const std::string &file_path);
@@ -0,0 +1,124 @@
+#ifndef DK_PLY_FILE_HPP
+#define DK_PLY_FILE_HPP
+
+#include "file_base.hpp"
+#include <dklib/gl/gltypes.hpp>
+#include <dklib/gl/mesh.hpp>
+#include <dklib/gl/vertex.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dk::file::ply {
+
+enum class Format {
+    ASCII,
+    BINARY_LITTLE_ENDIAN,
+    BINARY_BIG_ENDIAN,
+};
+
+enum class ScalarType : gl::u8 {
+    INT8,
+    UINT8,
+    INT16,
+    UINT16,
+    INT32,
+    UINT32,
+    FLOAT32,
+    FLOAT64,
+};
+
+std::size_t size_of(ScalarType type);
+
+struct Property {
+    std::string name;
+    ScalarType type;
+    /// List properties store count of type count_type followed by the items
+    bool is_list { false };
+    ScalarType count_type { ScalarType::UINT8 };
+};
+
+struct Element {
+    std::string name;
+    std::size_t count { 0 };
+    std::vector<Property> properties;
+
+    /// @brief Size of a single record, zero if the record contains a list.
+    [[nodiscard]] std::size_t stride() const;
+};
+
+struct Header {
+    Format format { Format::ASCII };
+    std::vector<Element> elements;
+    /// Offset of the first byte after `end_header`
+    std::size_t body_offset { 0 };
+};
+
+/// @brief Parses the header, up to the `end_header` line.
+///
+/// Throws when the element counts cannot fit in the rest of the file.
+Header parse_header(std::span<const std::byte> bytes);
+
+/// @brief Target of the vertex decoding, an array of vertices with the
+/// provided layout.
+///
+/// Attributes are matched with PLY properties by their location: 0 is the
+/// position (x, y, z), 1 is the normal (nx, ny, nz) and 2 are texture
+/// coordinates (s, t or u, v). Attributes without a matching property are
+/// left untouched.
+struct VertexTarget {
+    std::span<const gl::VertexAttribute> attributes;
+    std::size_t stride;
+    std::span<std::byte> vertices;
+};
+
+/// @brief Decodes the vertex element into the target and triangulates the
+/// face element (as a fan) into indices.
+///
+/// Target has to have room for all of the vertices of the file.
+void decode(
+    const Header &header, std::span<const std::byte> bytes, const VertexTarget &target, std::vector<gl::u32> &indices
+);
+
+/// @brief Count of records of the element with the provided name, zero if
+/// there is none.
+std::size_t count_of(const Header &header, std::string_view element_name);
+
+template <gl::DescribedVertex VertexType = gl::experimental::Vertex, typename IndexType = gl::u32>
+gl::MeshData<VertexType, IndexType> read_data(std::span<const std::byte> bytes) {
+    const auto header = parse_header(bytes);
+
+    gl::MeshData<VertexType, IndexType> mesh;
+    mesh.vertices.resize(count_of(header, "vertex"));
+    std::vector<gl::u32> indices;
+    decode(
+        header, bytes,
+        { gl::VertexLayout<VertexType>::attributes, sizeof(VertexType), std::as_writable_bytes(std::span { mesh.vertices }) },
+        indices
+    );
+    if constexpr (std::is_same_v<IndexType, gl::u32>) {
+        mesh.indices = std::move(indices);
+    } else {
+        mesh.indices.assign(indices.begin(), indices.end());
+    }
+    return mesh;
+}
+
+template <gl::DescribedVertex VertexType = gl::experimental::Vertex, typename IndexType = gl::u32>
+gl::MeshData<VertexType, IndexType> read_data(const std::filesystem::path &filepath) {
+    const MappedFile file(filepath, { AccessPattern::SEQUENTIAL });
+    return read_data<VertexType, IndexType>(file.bytes());
+}
+
+template <gl::DescribedVertex VertexType = gl::experimental::Vertex, typename IndexType = gl::u32>
+gl::Mesh<VertexType, IndexType> read(const std::filesystem::path &filepath) {
+    return gl::Mesh<VertexType, IndexType> { read_data<VertexType, IndexType>(filepath) };
+}
+
+} // namespace dk::file::ply
+
+#endif // DK_PLY_FILE_HPP
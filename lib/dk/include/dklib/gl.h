@@ -2,12 +2,28 @@
 #define DK_GRAPHICAL_LIBRARY_H
 
 #include "gl/app.hpp"
+#include "gl/block_layout.hpp"
 #include "gl/buffer.hpp"
 #include "gl/buffer_object.hpp"
 #include "gl/draw.hpp"
+#include "gl/glsl_interface.hpp"
 #include "gl/gltypes.hpp"
+#include "gl/headless_context.hpp"
+#include "gl/hot_reload.hpp"
+#include "gl/index_format.hpp"
+#include "gl/mesh_optimizer.hpp"
+#include "gl/mipmap.hpp"
 #include "gl/model.hpp"
 #include "gl/program.hpp"
+#include "gl/program_cache.hpp"
+#include "gl/program_pipeline.hpp"
+#include "gl/reflection.hpp"
 #include "gl/shader.hpp"
+#include "gl/shader_preprocessor.hpp"
+#include "gl/shader_source.hpp"
+#include "gl/state_cache.hpp"
+#include "gl/vertex_array_cache.hpp"
+#include "gl/vertex_compression.hpp"
+#include "gl/vertex_format.hpp"
 
 #endif // DK_GRAPHICAL_LIBRARY_H
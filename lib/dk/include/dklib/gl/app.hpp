@@ -15,6 +15,8 @@
 #include <string>
 
 #include "gltypes.hpp"
+#include "hot_reload.hpp"
+#include "state_cache.hpp"
 
 // TODO: move somewhere else
 namespace dk {
@@ -160,6 +162,11 @@ public:
     /// @param callback callback function
     virtual void register_callback(SDL_EventType type, const EventCallback &callback);
 
+    /// @brief Reloader of the programs and assets watched for changes, it is
+    /// updated before every frame. Created on the first call, applications
+    /// that never ask for it do not watch any files.
+    gl::HotReloader &get_hot_reloader();
+
 private:
     /// Function object for the SDL window deleter
     using WindowDeleter = std::function<void(SDL_Window *)>;
@@ -171,6 +178,9 @@ private:
     std::map<SDL_EventType, std::vector<EventCallback>> registered_callbacks_;
     /// Identifies whether application is still running
     bool running_ { true };
+    /// Reloads the watched files, destroyed after the objects of the derived
+    /// applications
+    std::unique_ptr<gl::HotReloader> hot_reloader_;
 };
 } // namespace dk::sdl
 
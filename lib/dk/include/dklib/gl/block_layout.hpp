@@ -0,0 +1,276 @@
+#ifndef DK_OPENGL_BLOCK_LAYOUT_HPP
+#define DK_OPENGL_BLOCK_LAYOUT_HPP
+
+#include "buffer_object.hpp"
+#include "gltypes.hpp"
+
+#include <dklib/math/vmath.h>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dk::gl {
+
+/// @brief Memory layout of an interface block, std140 for uniform blocks and
+/// std430 for the shader storage ones.
+enum class LayoutStandard {
+    STD140,
+    STD430,
+};
+
+/// @brief Fields of a C++ struct in the order of the members of the GLSL
+/// block, specialize it for every struct that is packed:
+///
+///     template <>
+///     struct gl::BlockFields<ObjectData> {
+///         static constexpr auto value = std::tuple { &ObjectData::mv_matrix, &ObjectData::tint };
+///     };
+///
+/// Fields can be f32, i32, u32 and f64 scalars, vmath vectors and matrices,
+/// C arrays or std::arrays of those and other described structs.
+template <typename T>
+struct BlockFields;
+
+namespace detail {
+    template <typename T>
+    concept BlockScalar = std::same_as<T, f32> or std::same_as<T, i32> or std::same_as<T, u32> or std::same_as<T, f64>;
+
+    template <typename T, int N>
+    std::pair<T, std::integral_constant<std::size_t, N>> as_vector(const vmath::vecN<T, N> &);
+    template <typename T, int W, int H>
+    std::tuple<vmath::vecN<T, H>, std::integral_constant<std::size_t, W>> as_matrix(const vmath::matNM<T, W, H> &);
+
+    template <typename T>
+    concept BlockVector = requires(const T &value) { as_vector(value); };
+    template <typename T>
+    concept BlockMatrix = requires(const T &value) { as_matrix(value); };
+    template <typename T>
+    concept BlockStruct = requires { BlockFields<T>::value; };
+
+    template <typename T>
+    struct ArrayTraits : std::false_type { };
+    template <typename E, std::size_t N>
+    struct ArrayTraits<E[N]> : std::true_type {
+        using element_type = E;
+        static constexpr std::size_t extent = N;
+    };
+    template <typename E, std::size_t N>
+    struct ArrayTraits<std::array<E, N>> : std::true_type {
+        using element_type = E;
+        static constexpr std::size_t extent = N;
+    };
+
+    struct TypeLayout {
+        std::size_t alignment;
+        std::size_t size;
+        /// Distance of the elements, 0 for types that are not arrays
+        std::size_t stride { 0 };
+    };
+
+    constexpr std::size_t round_up(std::size_t value, std::size_t alignment) noexcept {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    template <typename T>
+    consteval TypeLayout vector_layout() {
+        using Vector = decltype(as_vector(std::declval<const T &>()));
+        using Element = typename Vector::first_type;
+        constexpr std::size_t count = Vector::second_type::value;
+        // vec3 is aligned as vec4
+        return { sizeof(Element) * (count == 3 ? 4 : count), sizeof(Element) * count };
+    }
+
+    template <LayoutStandard S>
+    consteval TypeLayout array_layout(TypeLayout element, std::size_t count) {
+        // std140 rounds the elements of arrays (and matrix columns) to vec4
+        const auto alignment = S == LayoutStandard::STD140 ? round_up(element.alignment, 16) : element.alignment;
+        const auto stride = round_up(element.size, alignment);
+        return { alignment, stride * count, stride };
+    }
+
+    template <typename T, LayoutStandard S>
+    consteval TypeLayout layout_of();
+
+    template <typename T>
+    using FieldsOf = std::remove_cvref_t<decltype(BlockFields<T>::value)>;
+
+    template <typename T, std::size_t I>
+    using FieldType = std::remove_cvref_t<decltype(std::declval<const T &>().*std::get<I>(BlockFields<T>::value))>;
+
+    template <typename T, LayoutStandard S>
+    consteval auto struct_offsets() {
+        return []<std::size_t... I>(std::index_sequence<I...>) {
+            std::array<std::size_t, sizeof...(I)> offsets {};
+            std::size_t offset = 0;
+            std::size_t i = 0;
+            (
+                [&] {
+                    constexpr auto field = layout_of<FieldType<T, I>, S>();
+                    offset = round_up(offset, field.alignment);
+                    offsets[i++] = offset;
+                    offset += field.size;
+                }(),
+                ...);
+            return std::pair { offsets, offset };
+        }(std::make_index_sequence<std::tuple_size_v<FieldsOf<T>>> {});
+    }
+
+    template <typename T, LayoutStandard S>
+    consteval TypeLayout struct_layout() {
+        const auto alignment = []<std::size_t... I>(std::index_sequence<I...>) {
+            std::size_t max = 1;
+            ((max = std::max(max, layout_of<FieldType<T, I>, S>().alignment)), ...);
+            // std140 aligns structures as vec4
+            return S == LayoutStandard::STD140 ? round_up(max, 16) : max;
+        }(std::make_index_sequence<std::tuple_size_v<FieldsOf<T>>> {});
+        return { alignment, round_up(struct_offsets<T, S>().second, alignment) };
+    }
+
+    template <typename T, LayoutStandard S>
+    consteval TypeLayout layout_of() {
+        if constexpr (BlockScalar<T>) {
+            return { sizeof(T), sizeof(T) };
+        } else if constexpr (BlockVector<T>) {
+            return vector_layout<T>();
+        } else if constexpr (BlockMatrix<T>) {
+            // column major, so laid out as an array of the columns
+            using Matrix = decltype(as_matrix(std::declval<const T &>()));
+            using Column = std::tuple_element_t<0, Matrix>;
+            return array_layout<S>(vector_layout<Column>(), std::tuple_element_t<1, Matrix>::value);
+        } else if constexpr (ArrayTraits<T>::value) {
+            return array_layout<S>(layout_of<typename ArrayTraits<T>::element_type, S>(), ArrayTraits<T>::extent);
+        } else if constexpr (BlockStruct<T>) {
+            return struct_layout<T, S>();
+        } else {
+            static_assert(sizeof(T) == 0, "type has no GLSL block layout, describe it with gl::BlockFields");
+        }
+    }
+
+    template <LayoutStandard S, typename T>
+    void write(const T &value, std::byte *out) noexcept;
+
+    template <LayoutStandard S, typename T>
+    void write_fields(const T &value, std::byte *out) noexcept {
+        constexpr auto offsets = struct_offsets<T, S>().first;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (write<S>(value.*std::get<I>(BlockFields<T>::value), out + offsets[I]), ...);
+        }(std::make_index_sequence<offsets.size()> {});
+    }
+
+    template <LayoutStandard S, typename T>
+    void write(const T &value, std::byte *out) noexcept {
+        if constexpr (BlockScalar<T>) {
+            std::memcpy(out, &value, sizeof(T));
+        } else if constexpr (BlockVector<T>) {
+            std::memcpy(out, &value[0], vector_layout<T>().size);
+        } else if constexpr (BlockMatrix<T>) {
+            constexpr auto layout = layout_of<T, S>();
+            for (std::size_t column = 0; column < layout.size / layout.stride; ++column) {
+                write<S>(value[static_cast<int>(column)], out + column * layout.stride);
+            }
+        } else if constexpr (ArrayTraits<T>::value) {
+            constexpr auto layout = layout_of<T, S>();
+            for (std::size_t i = 0; i < ArrayTraits<T>::extent; ++i) {
+                write<S>(value[i], out + i * layout.stride);
+            }
+        } else {
+            write_fields<S>(value, out);
+        }
+    }
+} // namespace detail
+
+/// @brief Offsets, alignment and size of a described struct in a GLSL block
+/// of the given layout, all of them computed at compile time.
+///
+/// Check them against the shader where the struct is declared:
+///
+///     static_assert(gl::BlockLayout<ObjectData>::offsets[1] == 64);
+///     static_assert(gl::BlockLayout<ObjectData>::size == 80);
+template <typename T, LayoutStandard S = LayoutStandard::STD140>
+    requires detail::BlockStruct<T>
+struct BlockLayout {
+    /// Offsets of the fields, in the order of BlockFields<T>::value
+    static constexpr auto offsets = detail::struct_offsets<T, S>().first;
+    static constexpr std::size_t alignment = detail::layout_of<T, S>().alignment;
+    /// Size including the padding at the end, also the stride of arrays of T
+    static constexpr std::size_t size = detail::layout_of<T, S>().size;
+
+    static_assert(size % alignment == 0);
+
+    /// @brief Writes the value in the layout, the output has to have at least
+    /// `size` bytes. Padding bytes are left untouched.
+    static void pack(const T &value, std::span<std::byte> out) noexcept { detail::write<S>(value, out.data()); }
+};
+
+/// @brief CPU copy of an array of structs packed for a uniform or shader
+/// storage buffer.
+///
+/// Changed elements are tracked, so upload() sends all of them with a single
+/// glBufferSubData call, instead of a uniform call per field and object.
+template <typename T, LayoutStandard S = LayoutStandard::STD140>
+class BlockArray {
+public:
+    using Layout = BlockLayout<T, S>;
+
+    /// @param element_alignment alignment of every element, e.g.
+    /// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT when single elements are bound
+    /// with Buffer::bind_range
+    explicit BlockArray(std::size_t count = 0, std::size_t element_alignment = 1)
+        : stride_(detail::round_up(Layout::size, std::max(element_alignment, Layout::alignment))) {
+        resize(count);
+    }
+
+    void resize(std::size_t count) {
+        bytes_.resize(count * stride_);
+        // all of it is uploaded again, changes past the end of a shrunk array
+        // are dropped with it
+        dirty_begin_ = 0;
+        dirty_end_ = bytes_.size();
+    }
+
+    void set(std::size_t index, const T &value) noexcept {
+        const auto offset = get_offset(index);
+        Layout::pack(value, std::span { bytes_ }.subspan(offset, Layout::size));
+        mark_dirty(offset, offset + Layout::size);
+    }
+
+    /// @brief Uploads the changed elements, the buffer has to be allocated
+    /// with at least size_bytes().
+    template <BufferObjectType B>
+    void upload(const Buffer<B> &buffer) {
+        if (dirty_begin_ < dirty_end_) {
+            buffer.update(dirty_begin_, std::span { bytes_ }.subspan(dirty_begin_, dirty_end_ - dirty_begin_));
+        }
+        dirty_begin_ = bytes_.size();
+        dirty_end_ = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return bytes_.size() / stride_; }
+    [[nodiscard]] std::size_t size_bytes() const noexcept { return bytes_.size(); }
+    [[nodiscard]] std::size_t get_stride() const noexcept { return stride_; }
+    [[nodiscard]] std::size_t get_offset(std::size_t index) const noexcept { return index * stride_; }
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return bytes_; }
+
+private:
+    void mark_dirty(std::size_t begin, std::size_t end) noexcept {
+        dirty_begin_ = std::min(dirty_begin_, begin);
+        dirty_end_ = std::max(dirty_end_, end);
+    }
+
+    std::size_t stride_;
+    std::vector<std::byte> bytes_;
+    std::size_t dirty_begin_ { 0 };
+    std::size_t dirty_end_ { 0 };
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_BLOCK_LAYOUT_HPP
@@ -1,16 +1,24 @@
 #ifndef DK_GL_BUFFER_HPP
 #define DK_GL_BUFFER_HPP
 
+// gltypes.hpp brings GL/gl.h, which has to precede GL/glext.h
+#include <dklib/gl/gltypes.hpp>
+#include <dklib/gl/state_cache.hpp>
+
 #include <GL/glext.h>
 #include <GLES3/gl3.h>
-#include <dklib/gl/gltypes.hpp>
 #include <spdlog/spdlog.h>
+#include <cstddef>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace dk::gl {
 
 enum class BufferUsage : gl::enum32 {
     STATIC_DRAW = GL_STATIC_DRAW,
+    DYNAMIC_DRAW = GL_DYNAMIC_DRAW,
+    STREAM_DRAW = GL_STREAM_DRAW,
 };
 
 class IBufferObject {
@@ -27,11 +35,31 @@ private:
 class VertexArray {
 public:
     VertexArray() { glGenVertexArrays(1, &vao_); }
-    // TODO: add move ctor and then set &vao_ to nullptr
-    // NOTE: this is going to need some more work
-    ~VertexArray() { glDeleteVertexArrays(1, &vao_); }
+    ~VertexArray() {
+        if (vao_ != 0) {
+            StateCache::get_instance().forget_vertex_array(vao_);
+            glDeleteVertexArrays(1, &vao_);
+        }
+    }
+
+    // This is a move only type, copies would delete the vertex array twice
+    VertexArray(const VertexArray &other) = delete;
+    VertexArray &operator=(const VertexArray &other) = delete;
+
+    VertexArray(VertexArray &&other) noexcept
+        : vao_(std::exchange(other.vao_, 0)) { }
+    VertexArray &operator=(VertexArray &&other) noexcept {
+        if (this != &other) {
+            if (vao_ != 0) {
+                StateCache::get_instance().forget_vertex_array(vao_);
+                glDeleteVertexArrays(1, &vao_);
+            }
+            vao_ = std::exchange(other.vao_, 0);
+        }
+        return *this;
+    }
 
-    inline void bind() const noexcept { glBindVertexArray(vao_); }
+    inline void bind() const noexcept { StateCache::get_instance().bind_vertex_array(vao_); }
 
     [[nodiscard]] u32 get_id() const noexcept { return vao_; }
 
@@ -73,6 +101,7 @@ public:
     virtual ~Buffer() {
         if (id_ != 0) {
             spdlog::info("Deleting Buffer ID: {}", id_);
+            StateCache::get_instance().forget_buffer(id_);
             glDeleteBuffers(1, &id_);
         }
     }
@@ -85,6 +114,7 @@ public:
     Buffer &operator=(Buffer &&other) noexcept {
         if (this != &other) {
             if (id_ != 0) {
+                StateCache::get_instance().forget_buffer(id_);
                 glDeleteBuffers(1, &id_);
             }
             id_ = std::exchange(other.id_, 0);
@@ -92,22 +122,61 @@ public:
         return *this;
     }
 
-    virtual void bind() const { glBindBuffer(static_cast<u32>(buf_type), id_); }
-    virtual void unbind() const { glBindBuffer(static_cast<u32>(buf_type), 0); }
+    virtual void bind() const { StateCache::get_instance().bind_buffer(enum_cast(buf_type), id_); }
+    virtual void unbind() const { StateCache::get_instance().bind_buffer(enum_cast(buf_type), 0); }
 
     template <typename T>
     void setup(const std::vector<T> &objs, BufferUsage usage = BufferUsage::STATIC_DRAW) const {
-        glBindBuffer(enum_cast(buf_type), id_);
-        glBufferData(enum_cast(buf_type), objs.size() * sizeof(T), objs.data(), enum_cast(usage));
+        setup(std::span<const T> { objs }, usage);
     }
 
+    /// @brief Uploads data straight from the provided memory, e.g. from
+    /// a memory mapped file, without any intermediate copy.
+    template <typename T>
+    void setup(std::span<const T> objs, BufferUsage usage = BufferUsage::STATIC_DRAW) const {
+        StateCache::get_instance().bind_buffer(UPLOAD_TARGET, id_);
+        glBufferData(UPLOAD_TARGET, static_cast<sptr>(objs.size_bytes()), objs.data(), enum_cast(usage));
+    }
+
+    /// @brief Allocates uninitialized storage, filled in later by update().
+    void allocate(std::size_t size, BufferUsage usage = BufferUsage::DYNAMIC_DRAW) const {
+        StateCache::get_instance().bind_buffer(UPLOAD_TARGET, id_);
+        glBufferData(UPLOAD_TARGET, static_cast<sptr>(size), nullptr, enum_cast(usage));
+    }
+
+    /// @brief Replaces the bytes starting at the offset.
+    void update(std::size_t offset, std::span<const std::byte> bytes) const {
+        StateCache::get_instance().bind_buffer(UPLOAD_TARGET, id_);
+        glBufferSubData(UPLOAD_TARGET, static_cast<iptr>(offset), static_cast<sptr>(bytes.size()), bytes.data());
+    }
+
+    /// @brief Binds the buffer to the indexed binding point (uniform, shader
+    /// storage, ... buffers), which is the `binding` of the GLSL block.
+    void bind_base(u32 index) const { StateCache::get_instance().bind_buffer_base(enum_cast(buf_type), index, id_); }
+    /// @brief Binds a part of the buffer to the indexed binding point, the
+    /// offset has to respect e.g. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+    void bind_range(u32 index, std::size_t offset, std::size_t size) const {
+        StateCache::get_instance().bind_buffer_range(enum_cast(buf_type), index, id_, static_cast<iptr>(offset),
+                                                     static_cast<sptr>(size));
+    }
+
+    [[nodiscard]] u32 get_id() const noexcept { return id_; }
+
 private:
+    /// The element array binding is a state of the bound vertex array, so
+    /// element buffers are uploaded through the copy target instead, which
+    /// leaves the vertex array untouched.
+    static constexpr enum32 UPLOAD_TARGET
+        = buf_type == BufferObjectType::ELEMENT_ARRAY ? GL_COPY_WRITE_BUFFER : enum_cast(buf_type);
+
     u32 id_ { 0 };
 };
 
 using ElementBuffer = Buffer<BufferObjectType::ELEMENT_ARRAY>;
 using VertexBuffer = Buffer<BufferObjectType::ARRAY>;
 using TextureBuffer = Buffer<BufferObjectType::TEXTURE>;
+using UniformBuffer = Buffer<BufferObjectType::UNIFORM>;
+using ShaderStorageBuffer = Buffer<BufferObjectType::SHADER_STORAGE>;
 
 } // namespace dk::gl
 
@@ -0,0 +1,71 @@
+#ifndef DK_OPENGL_GLSL_INTERFACE_HPP
+#define DK_OPENGL_GLSL_INTERFACE_HPP
+
+#include "gltypes.hpp"
+#include "shader.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Declarations of the uniforms, blocks and vertex attributes of GLSL shaders,
+/// read from the sources without any OpenGL context. Used at build time by
+/// the dk_glsl_interface tool, which generates typed C++ interfaces of the
+/// programs (see cmake/glsl.cmake).
+namespace dk::gl::glsl {
+
+struct Variable {
+    std::string type;
+    std::string name;
+    /// Set for arrays, 0 when the size is not a literal
+    std::optional<u32> array_size;
+    /// From layout(location = N)
+    std::optional<i32> location;
+    /// From layout(binding = N), samplers and images
+    std::optional<i32> binding;
+};
+
+/// @brief Uniform or shader storage block.
+struct Block {
+    std::string name;
+    /// Empty when the members are in the global scope
+    std::string instance;
+    bool is_storage { false };
+    std::optional<i32> binding;
+    std::vector<Variable> members;
+};
+
+struct Interface {
+    std::vector<Variable> uniforms;
+    std::vector<Block> blocks;
+    /// Inputs of the vertex stage
+    std::vector<Variable> attributes;
+
+    /// @brief Adds the declarations of another stage, the ones declared by
+    /// both of them are kept once.
+    void merge(const Interface &other);
+};
+
+/// @brief Reads the global declarations of the shader.
+///
+/// Comments and preprocessor directives are skipped, so the declarations
+/// inside of #if branches are all reported. Throws on unbalanced braces.
+Interface parse_interface(std::string_view source, ShaderType type);
+
+/// @brief Shader of the generated program, path is what the Program loads.
+struct ShaderFile {
+    ShaderType type;
+    std::filesystem::path path;
+};
+
+/// @brief C++ header with a struct of the given name, which has typed
+/// setters of every uniform, locations of the attributes and bindings of the
+/// blocks.
+std::string generate_header(std::string_view name, std::span<const ShaderFile> shaders, const Interface &interface);
+
+} // namespace dk::gl::glsl
+
+#endif // DK_OPENGL_GLSL_INTERFACE_HPP
@@ -121,7 +121,7 @@ concept ScopedEnumType = std::is_scoped_enum_v<T>;
 
 // @brief Simple conversion function for opengl enumeration types.
 template <ScopedEnumType T>
-enum32 enum_cast(T enum_value) {
+constexpr enum32 enum_cast(T enum_value) {
     return static_cast<enum32>(enum_value);
 }
 
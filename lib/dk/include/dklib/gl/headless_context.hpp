@@ -0,0 +1,33 @@
+#ifndef DK_OPENGL_HEADLESS_CONTEXT_HPP
+#define DK_OPENGL_HEADLESS_CONTEXT_HPP
+
+#include "gltypes.hpp"
+
+namespace dk::gl {
+
+/// @brief OpenGL context without any window, made current on construction.
+///
+/// Created through EGL on the surfaceless Mesa platform, so it works on
+/// machines without a display (CI, Mesa llvmpipe). Used by the tests and
+/// benchmarks, which need a context but nothing to draw into.
+class HeadlessContext {
+public:
+    /// @brief Creates a core profile context of the given version.
+    ///
+    /// Throws when EGL or the requested version are not available.
+    explicit HeadlessContext(gl::i32 major = 4, gl::i32 minor = 5);
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext &other) = delete;
+    HeadlessContext &operator=(const HeadlessContext &other) = delete;
+
+    void make_current() const;
+
+private:
+    void *display_ { nullptr };
+    void *context_ { nullptr };
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_HEADLESS_CONTEXT_HPP
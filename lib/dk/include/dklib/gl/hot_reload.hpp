@@ -0,0 +1,114 @@
+#ifndef DK_OPENGL_HOT_RELOAD_HPP
+#define DK_OPENGL_HOT_RELOAD_HPP
+
+#include "gltypes.hpp"
+#include "mesh.hpp"
+#include "program.hpp"
+
+#include <dklib/file/file_watcher.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dk::gl {
+
+struct ReloadStats {
+    std::size_t reload_count { 0 };
+    /// Reloads that failed and left the previous state in place
+    std::size_t failure_count { 0 };
+    /// From the write of a file to the end of the first frame rendered after
+    /// its reload
+    std::chrono::duration<f64, std::milli> last_latency { 0 };
+    std::chrono::duration<f64, std::milli> max_latency { 0 };
+};
+
+/// @brief Reloads programs and assets whose files change, while the
+/// application keeps running.
+///
+/// Changes are read by update(), which never blocks and does the reloads on
+/// the calling thread, so it has to be called with the OpenGL context
+/// current, once per frame before rendering. Watched objects have to stay in
+/// place until they are unwatched or the reloader is destroyed.
+class HotReloader {
+public:
+    using ProgramCallback = std::function<void(Program &program)>;
+    using ReloadFunction = std::function<void(const std::filesystem::path &filepath)>;
+
+    HotReloader() = default;
+
+    HotReloader(const HotReloader &other) = delete;
+    HotReloader &operator=(const HotReloader &other) = delete;
+
+    /// @brief Relinks the program whenever a file of its shaders (includes as
+    /// well) changes, only the affected stages are compiled again.
+    ///
+    /// The callback is called after every successful relink, e.g. to make the
+    /// Uniforms of the program again.
+    void watch(Program &program, ProgramCallback on_reload = {});
+    void unwatch(const Program &program);
+
+    /// @brief Loads the mesh again whenever the file changes and uploads only
+    /// the changed parts of its buffers, other GPU state is left alone.
+    ///
+    ///     reloader.watch(mesh, "bunny.obj", [](const auto &path) {
+    ///         return file::obj::experimental::read_data<gl::experimental::Vertex>(path);
+    ///     });
+    template <typename VertexType, typename IndexType, typename Loader>
+    void watch(Mesh<VertexType, IndexType> &mesh, const std::filesystem::path &filepath, Loader loader) {
+        watch(filepath, [&mesh, loader = std::move(loader)](const std::filesystem::path &path) {
+            const auto update = mesh.update(loader(path));
+            spdlog::info("Mesh {} reloaded, vertices uploaded: {}, indices uploaded: {}", path.string(),
+                         update.vertices, update.indices);
+        });
+    }
+
+    /// @brief Calls the function whenever the file changes, thrown exceptions
+    /// are logged and counted as failed reloads.
+    void watch(const std::filesystem::path &filepath, ReloadFunction reload);
+    void unwatch(const std::filesystem::path &filepath);
+
+    /// @brief Reads the changes of the files and reloads what they affect.
+    /// @return count of the reloads done
+    std::size_t update();
+
+    /// @brief Marks the end of a frame, e.g. after the buffers are swapped,
+    /// which gives the latency of the reloads done by the last update().
+    void frame_presented();
+
+    [[nodiscard]] const ReloadStats &get_stats() const noexcept { return stats_; }
+
+private:
+    struct ProgramWatch {
+        Program *program;
+        ProgramCallback on_reload;
+        std::vector<file::FileWatcher::WatchId> ids;
+    };
+
+    /// @brief Watches the current files of the program, which may change by
+    /// a reload, e.g. by a new include.
+    void watch_files(ProgramWatch &watch);
+    void reloaded(const file::FileChange &change, bool is_success);
+
+    file::FileWatcher watcher_;
+    /// A list, so that the callbacks of the watcher can point to the items
+    std::list<ProgramWatch> programs_;
+    std::unordered_map<std::string, file::FileWatcher::WatchId> assets_;
+    /// Write time of the oldest change reloaded since the last frame
+    std::optional<std::filesystem::file_time_type> pending_written_;
+    std::size_t update_reload_count_ { 0 };
+    ReloadStats stats_;
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_HOT_RELOAD_HPP
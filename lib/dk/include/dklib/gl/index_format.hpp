@@ -0,0 +1,86 @@
+#ifndef DK_OPENGL_INDEX_FORMAT_HPP
+#define DK_OPENGL_INDEX_FORMAT_HPP
+
+#include "gltypes.hpp"
+
+#include <GLES3/gl3.h>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace dk::gl {
+
+template <typename T>
+concept IndexFormat = std::same_as<T, u8> or std::same_as<T, u16> or std::same_as<T, u32>;
+
+/// @brief OpenGL type of the index type, e.g. GL_UNSIGNED_SHORT for u16.
+template <IndexFormat IndexType>
+constexpr enum32 index_type_of() noexcept {
+    if constexpr (std::same_as<IndexType, u8>) {
+        return GL_UNSIGNED_BYTE;
+    } else if constexpr (std::same_as<IndexType, u16>) {
+        return GL_UNSIGNED_SHORT;
+    } else {
+        return GL_UNSIGNED_INT;
+    }
+}
+
+/// @brief Size in bytes of an index of the OpenGL type.
+constexpr std::size_t index_size_of(enum32 index_type) noexcept {
+    switch (index_type) {
+    case GL_UNSIGNED_BYTE:
+        return sizeof(u8);
+    case GL_UNSIGNED_SHORT:
+        return sizeof(u16);
+    default:
+        return sizeof(u32);
+    }
+}
+
+/// @brief Narrowest index type that addresses all of the vertices, but not
+/// wider than IndexType.
+///
+/// Indices are at most vertex_count - 1, so up to 256 vertices fit in u8 and
+/// up to 65536 vertices in u16.
+template <IndexFormat IndexType = u32>
+constexpr enum32 narrowest_index_type(std::size_t vertex_count) noexcept {
+    enum32 type = GL_UNSIGNED_INT;
+    if (vertex_count <= std::size_t { std::numeric_limits<u8>::max() } + 1) {
+        type = GL_UNSIGNED_BYTE;
+    } else if (vertex_count <= std::size_t { std::numeric_limits<u16>::max() } + 1) {
+        type = GL_UNSIGNED_SHORT;
+    }
+    return index_size_of(type) < sizeof(IndexType) ? type : index_type_of<IndexType>();
+}
+
+/// @brief Bytes of an index buffer with the indices converted to the type.
+///
+/// The type has to address every index, see narrowest_index_type.
+template <IndexFormat IndexType>
+std::vector<std::byte> narrow_indices(std::span<const IndexType> indices, enum32 index_type) {
+    std::vector<std::byte> bytes(indices.size() * index_size_of(index_type));
+    const auto convert = [&]<typename Target>() {
+        auto *target = reinterpret_cast<Target *>(bytes.data());
+        std::ranges::transform(indices, target, [](IndexType index) { return static_cast<Target>(index); });
+    };
+    switch (index_type) {
+    case GL_UNSIGNED_BYTE:
+        convert.template operator()<u8>();
+        break;
+    case GL_UNSIGNED_SHORT:
+        convert.template operator()<u16>();
+        break;
+    default:
+        convert.template operator()<u32>();
+        break;
+    }
+    return bytes;
+}
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_INDEX_FORMAT_HPP
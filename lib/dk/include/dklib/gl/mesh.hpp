@@ -1,54 +1,198 @@
 #ifndef DK_MESH_HPP
 #define DK_MESH_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include <dklib/gl/buffer_object.hpp>
+#include <dklib/gl/index_format.hpp>
+#include <dklib/gl/state_cache.hpp>
 #include <dklib/gl/texture.hpp>
 #include <dklib/gl/vertex.hpp>
+#include <dklib/gl/vertex_array_cache.hpp>
 
 namespace dk::gl {
 
+/// @brief CPU side geometry of a mesh, that is not yet uploaded to the GPU.
+///
+/// Loaders produce this first, so that the parsing may be done (and measured)
+/// without an OpenGL context.
+template <typename VertexType = Vertex, typename IndexType = u32>
+struct MeshData {
+    std::vector<VertexType> vertices;
+    std::vector<IndexType> indices;
+};
+
+namespace detail {
+    /// @brief Uploads the bytes that differ from the previous contents of
+    /// the buffer, or all of them when the size changed.
+    ///
+    /// The buffer is bound to GL_COPY_WRITE_BUFFER, which is used only for
+    /// copies, so neither the bound vertex array nor other bindings change.
+    /// @return whether anything was uploaded
+    template <BufferObjectType B>
+    bool upload_changes(const Buffer<B> &buffer, std::span<const std::byte> previous,
+                        std::span<const std::byte> current) {
+        StateCache::get_instance().bind_buffer(GL_COPY_WRITE_BUFFER, buffer.get_id());
+        if (previous.size() != current.size()) {
+            glBufferData(GL_COPY_WRITE_BUFFER, static_cast<sptr>(current.size()), current.data(), GL_STATIC_DRAW);
+            return true;
+        }
+        const auto first = std::ranges::mismatch(previous, current).in2;
+        if (first == current.end()) {
+            return false;
+        }
+        const auto last = std::ranges::mismatch(previous | std::views::reverse, current | std::views::reverse).in2.base();
+        const auto offset = static_cast<std::size_t>(first - current.begin());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<iptr>(offset), static_cast<sptr>(last - first), &*first);
+        return true;
+    }
+} // namespace detail
+
+/// @brief Buffers uploaded by Mesh::update.
+struct MeshUpdate {
+    bool vertices { false };
+    bool indices { false };
+};
+
+/// @brief Geometry uploaded to the GPU, with the vertex array reading it.
+///
+/// Meshes of a vertex type with a VertexLayout get their vertex array from
+/// the VertexArrayCache when their geometry is uploaded, so a draw only binds
+/// it. A default constructed mesh gets it by its first update or draw.
+///
+/// Indices are uploaded in the narrowest type that addresses the vertices,
+/// e.g. a mesh of 200 vertices has a u8 index buffer even when IndexType is
+/// u32. The CPU side copy keeps IndexType.
 template <typename VertexType = Vertex, typename IndexType = u32>
 class Mesh {
 public:
     Mesh() = default;
     Mesh(const std::vector<VertexType> &vertices, const std::vector<IndexType> &indeces);
+    explicit Mesh(MeshData<VertexType, IndexType> &&data);
+    /// @brief Uploads the data straight to the GPU, the mesh does not keep
+    /// a CPU side copy of it.
+    Mesh(std::span<const VertexType> vertices, std::span<const IndexType> indices);
 
     void draw() const;
 
+    /// @brief Replaces the geometry, e.g. when its file changed, and uploads
+    /// only the changed parts of the buffers.
+    ///
+    /// A mesh made from spans has no CPU side copy to compare with, so both
+    /// of its buffers are uploaded whole.
+    MeshUpdate update(MeshData<VertexType, IndexType> &&data);
+
     const std::vector<VertexType> &get_vertices() const { return vertices_; }
+    const std::vector<IndexType> &get_indices() const { return indices_; }
+    /// @brief Count of the drawn indices, also for meshes without a CPU side
+    /// copy.
+    std::size_t get_index_count() const noexcept { return index_count_; }
+    const VertexBuffer &get_vertex_buffer() const noexcept { return vbo; }
+    const ElementBuffer &get_element_buffer() const noexcept { return ebo; }
+    /// @brief OpenGL type of the uploaded indices.
+    enum32 get_index_type() const noexcept { return index_type_; }
+    /// @brief Vertex array of the mesh, nullptr for vertex types without
+    /// a VertexLayout and before the geometry is uploaded.
+    const VertexArray *get_vertex_array() const noexcept { return vao_.get(); }
 
 private:
     void setup_mesh(std::vector<VertexType> vertices, std::vector<IndexType> indeces);
+    void make_vertex_array() const;
+    void upload_indices(std::span<const IndexType> indices, std::size_t vertex_count);
 
     VertexBuffer vbo;
     ElementBuffer ebo;
+    /// Shared with the meshes of the same layout and buffers, made lazily
+    /// by make_vertex_array()
+    mutable std::shared_ptr<const VertexArray> vao_;
 
     std::vector<VertexType> vertices_;
     std::vector<IndexType> indices_;
+    std::size_t index_count_ { 0 };
+    enum32 index_type_ { index_type_of<IndexType>() };
     std::vector<Texture> textures;
 };
 
 template <typename VertexType, typename IndexType>
 void Mesh<VertexType, IndexType>::setup_mesh(std::vector<VertexType> vertices, std::vector<IndexType> indices) { }
 
+template <typename VertexType, typename IndexType>
+void Mesh<VertexType, IndexType>::make_vertex_array() const {
+    if constexpr (DescribedVertex<VertexType>) {
+        if (vao_ == nullptr) {
+            vao_ = VertexArrayCache::get_instance().get<VertexType>(vbo, ebo);
+        }
+    }
+}
+
+template <typename VertexType, typename IndexType>
+void Mesh<VertexType, IndexType>::upload_indices(std::span<const IndexType> indices, std::size_t vertex_count) {
+    index_type_ = narrowest_index_type<IndexType>(vertex_count);
+    if (index_type_ == index_type_of<IndexType>()) {
+        ebo.setup(indices);
+    } else {
+        ebo.setup(narrow_indices(indices, index_type_));
+    }
+}
+
 template <typename VertexType, typename IndexType>
 Mesh<VertexType, IndexType>::Mesh(const std::vector<VertexType> &vertices, const std::vector<IndexType> &indices)
     : vertices_(vertices)
-    , indices_(indices) {
+    , indices_(indices)
+    , index_count_(indices_.size()) {
+    vbo.setup(vertices_);
+    upload_indices(indices_, vertices_.size());
+    make_vertex_array();
+}
+
+template <typename VertexType, typename IndexType>
+Mesh<VertexType, IndexType>::Mesh(MeshData<VertexType, IndexType> &&data)
+    : vertices_(std::move(data.vertices))
+    , indices_(std::move(data.indices))
+    , index_count_(indices_.size()) {
     vbo.setup(vertices_);
-    ebo.setup(indices_);
+    upload_indices(indices_, vertices_.size());
+    make_vertex_array();
+}
+
+template <typename VertexType, typename IndexType>
+Mesh<VertexType, IndexType>::Mesh(std::span<const VertexType> vertices, std::span<const IndexType> indices)
+    : index_count_(indices.size()) {
+    vbo.setup(vertices);
+    upload_indices(indices, vertices.size());
+    make_vertex_array();
+}
+
+template <typename VertexType, typename IndexType>
+MeshUpdate Mesh<VertexType, IndexType>::update(MeshData<VertexType, IndexType> &&data) {
+    // the previous indices are compared in the type they were uploaded in
+    const enum32 index_type = narrowest_index_type<IndexType>(data.vertices.size());
+    const auto previous_indices = narrow_indices(std::span<const IndexType> { indices_ }, index_type_);
+    const auto current_indices = narrow_indices(std::span<const IndexType> { data.indices }, index_type);
+    const MeshUpdate update {
+        detail::upload_changes(vbo, std::as_bytes(std::span { vertices_ }), std::as_bytes(std::span { data.vertices })),
+        detail::upload_changes(ebo, previous_indices, current_indices),
+    };
+    index_type_ = index_type;
+    vertices_ = std::move(data.vertices);
+    indices_ = std::move(data.indices);
+    index_count_ = indices_.size();
+    make_vertex_array();
+    return update;
 }
 
 template <typename VertexType, typename IndexType>
 void Mesh<VertexType, IndexType>::draw() const {
-    glEnableVertexAttribArray(0);
-    vbo.bind();
-    experimental::bind_attributes_v2<VertexType>(0);
-    ebo.bind();
-    glDrawElements(GL_TRIANGLES, indices_.size(), GL_UNSIGNED_INT, nullptr);
-    glDisableVertexAttribArray(0);
+    static_assert(DescribedVertex<VertexType>, "Drawn vertex type needs a VertexLayout");
+    make_vertex_array();
+    vao_->bind();
+    glDrawElements(GL_TRIANGLES, static_cast<size>(index_count_), index_type_, nullptr);
 }
 
 using TriangularMesh = Mesh<Vertex, u32>;
@@ -0,0 +1,180 @@
+#ifndef DK_OPENGL_MESH_OPTIMIZER_HPP
+#define DK_OPENGL_MESH_OPTIMIZER_HPP
+
+#include <dklib/gl/gltypes.hpp>
+#include <dklib/gl/mesh.hpp>
+#include <dklib/math/vector3d.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/// Reordering of mesh indices and vertices for the GPU caches
+///
+/// The passes run on the CPU, offline or at load, in this order:
+///
+/// 1. vertex cache: triangles are reordered so that their vertices are still
+///    in the post-transform cache (Forsyth's linear-speed algorithm),
+/// 2. overdraw: the result is split into clusters wherever the cache would
+///    be flushed anyway, or where a split costs less than the threshold, and
+///    the clusters are sorted to draw the outward facing ones first,
+/// 3. vertex fetch: vertices are stored in the order of their first use, the
+///    unused ones are dropped.
+///
+/// Each pass reports the cache statistics of a simulated GPU before and
+/// after it.
+namespace dk::gl {
+
+/// Entries of the simulated post-transform cache, a FIFO as on most GPUs.
+inline constexpr u32 DEFAULT_VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats {
+    /// Average cache miss ratio, transformed vertices per triangle, 3 at
+    /// worst and about 0.5 at best for large regular meshes
+    f32 acmr { 0.0f };
+    /// Average transform to vertex ratio, transformed vertices per vertex, 1
+    /// at best
+    f32 atvr { 0.0f };
+    /// Fetched bytes per vertex byte, through a 16 KiB cache of 64 byte
+    /// lines, 1 at best, 0 without the vertex size
+    f32 overfetch { 0.0f };
+};
+
+/// @brief Statistics of drawing the indices through the simulated caches.
+///
+/// The vertex size is used for the overfetch only.
+VertexCacheStats analyze_vertex_cache(std::span<const u32> indices, std::size_t vertex_count,
+                                      std::size_t vertex_size = 0, u32 cache_size = DEFAULT_VERTEX_CACHE_SIZE);
+
+/// @brief Triangles reordered for the post-transform cache, each triangle
+/// keeps its winding.
+std::vector<u32> optimize_vertex_cache(std::span<const u32> indices, std::size_t vertex_count);
+
+/// @brief Clusters of triangles sorted to reduce overdraw, the indices
+/// should be optimized for the vertex cache first.
+///
+/// @param threshold how much the ACMR of a cluster may grow by its splits,
+/// 1.05 allows 5 percent
+std::vector<u32> optimize_overdraw(std::span<const u32> indices, std::span<const math::Vector3D> positions,
+                                   f32 threshold = 1.05f);
+
+inline constexpr u32 INVALID_REMAP = ~u32 { 0 };
+
+/// @brief New index of each vertex, in the order of their first use by the
+/// indices, unused vertices get INVALID_REMAP.
+/// @return the remap and the count of the used vertices
+std::pair<std::vector<u32>, std::size_t> make_vertex_fetch_remap(std::span<const u32> indices,
+                                                                 std::size_t vertex_count);
+
+struct MeshOptimizationPass {
+    std::string_view name;
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+struct MeshOptimizerOptions {
+    bool vertex_cache { true };
+    /// Skipped for vertices without a position
+    bool overdraw { true };
+    f32 overdraw_threshold { 1.05f };
+    bool vertex_fetch { true };
+};
+
+namespace detail {
+    template <typename VertexType>
+    concept PositionedVertex = requires(const VertexType &vertex) {
+        { vertex.position.x } -> std::convertible_to<f32>;
+    } or requires(const VertexType &vertex) {
+        { vertex.position[2] } -> std::convertible_to<f32>;
+    };
+
+    template <PositionedVertex VertexType>
+    std::vector<math::Vector3D> positions_of(std::span<const VertexType> vertices) {
+        std::vector<math::Vector3D> positions;
+        positions.reserve(vertices.size());
+        for (const auto &vertex : vertices) {
+            if constexpr (requires { vertex.position.x; }) {
+                positions.emplace_back(vertex.position.x, vertex.position.y, vertex.position.z);
+            } else {
+                positions.emplace_back(vertex.position[0], vertex.position[1], vertex.position[2]);
+            }
+        }
+        return positions;
+    }
+} // namespace detail
+
+/// @brief Runs the enabled passes on the geometry.
+/// @return statistics of each pass that ran
+template <typename VertexType, typename IndexType>
+std::vector<MeshOptimizationPass> optimize(MeshData<VertexType, IndexType> &data,
+                                           const MeshOptimizerOptions &options = {}) {
+    std::vector<u32> indices(data.indices.begin(), data.indices.end());
+    std::size_t vertex_count = data.vertices.size();
+    const auto analyze = [&] { return analyze_vertex_cache(indices, vertex_count, sizeof(VertexType)); };
+
+    std::vector<MeshOptimizationPass> passes;
+    const auto run = [&](std::string_view name, auto &&pass) {
+        MeshOptimizationPass report { name, analyze(), {} };
+        pass();
+        report.after = analyze();
+        passes.push_back(report);
+    };
+
+    if (options.vertex_cache) {
+        run("vertex cache", [&] { indices = optimize_vertex_cache(indices, vertex_count); });
+    }
+    if constexpr (detail::PositionedVertex<VertexType>) {
+        if (options.overdraw) {
+            run("overdraw", [&] {
+                const auto positions = detail::positions_of(std::span<const VertexType> { data.vertices });
+                indices = optimize_overdraw(indices, positions, options.overdraw_threshold);
+            });
+        }
+    }
+    if (options.vertex_fetch) {
+        run("vertex fetch", [&] {
+            const auto [remap, used_count] = make_vertex_fetch_remap(indices, vertex_count);
+            std::vector<VertexType> vertices(used_count);
+            for (std::size_t vertex = 0; vertex < remap.size(); ++vertex) {
+                if (remap[vertex] != INVALID_REMAP) {
+                    vertices[remap[vertex]] = std::move(data.vertices[vertex]);
+                }
+            }
+            for (auto &index : indices) {
+                index = remap[index];
+            }
+            data.vertices = std::move(vertices);
+            vertex_count = used_count;
+        });
+    }
+
+    data.indices.assign(indices.begin(), indices.end());
+    return passes;
+}
+
+/// @brief Optimizes the CPU side copy of the mesh and uploads the result.
+///
+/// A mesh made from spans has no CPU side copy, its geometry has to be
+/// optimized before it is made.
+template <typename VertexType, typename IndexType>
+std::vector<MeshOptimizationPass> optimize(Mesh<VertexType, IndexType> &mesh,
+                                           const MeshOptimizerOptions &options = {}) {
+    if (mesh.get_indices().size() != mesh.get_index_count()) {
+        spdlog::error("Mesh without a CPU side copy of its geometry cannot be optimized");
+        throw std::runtime_error("mesh has no CPU side geometry");
+    }
+    MeshData<VertexType, IndexType> data { mesh.get_vertices(), mesh.get_indices() };
+    auto passes = optimize(data, options);
+    mesh.update(std::move(data));
+    return passes;
+}
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_MESH_OPTIMIZER_HPP
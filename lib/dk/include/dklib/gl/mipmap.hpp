@@ -0,0 +1,67 @@
+#ifndef DK_MIPMAP_HPP
+#define DK_MIPMAP_HPP
+
+#include <dklib/gl/gltypes.hpp>
+#include <dklib/util/thread_pool.hpp>
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace dk::gl {
+
+/// @brief 8 bit image with one (R8), three (RGB8) or four (RGBA8) channels.
+///
+/// Rows are padded to four bytes, which matches both the default
+/// GL_UNPACK_ALIGNMENT and the layout of the KTX images.
+struct Image {
+    u32 width { 0 };
+    u32 height { 0 };
+    u32 channels { 0 };
+    std::vector<u8> pixels;
+
+    Image() = default;
+    Image(u32 width, u32 height, u32 channels);
+
+    [[nodiscard]] std::size_t stride() const noexcept { return (std::size_t { width } * channels + 3) & ~std::size_t { 3 }; }
+    [[nodiscard]] std::span<u8> row(u32 y) noexcept { return { pixels.data() + y * stride(), std::size_t { width } * channels }; }
+    [[nodiscard]] std::span<const u8> row(u32 y) const noexcept {
+        return { pixels.data() + y * stride(), std::size_t { width } * channels };
+    }
+};
+
+enum class MipFilter {
+    /// Average of 2x2 pixels
+    BOX,
+    /// Kaiser windowed sinc with 8 taps in each direction, sharper than the
+    /// box filter without much ringing
+    KAISER,
+};
+
+struct MipmapOptions {
+    MipFilter filter { MipFilter::BOX };
+    /// Color channels are sRGB encoded and are filtered in the linear space,
+    /// alpha is always linear
+    bool is_srgb { true };
+};
+
+/// @brief Generates the whole mip chain of the image, down to 1x1.
+///
+/// Every level is filtered from the previous one kept in linear floating
+/// point, so the error does not accumulate with the quantization. Rows of
+/// each level are split between the threads of the pool. Result does not
+/// depend on the count of threads nor on the instruction set used.
+/// @return levels of the chain, the first one is a copy of the image
+std::vector<Image> generate_mipmaps(
+    const Image &image, const MipmapOptions &options = {},
+    util::ThreadPool &pool = util::ThreadPool::get_instance()
+);
+
+/// @brief Name of the instruction set used by the filters (avx, sse2 or
+/// scalar).
+std::string_view mipmap_instruction_set();
+
+} // namespace dk::gl
+
+#endif // DK_MIPMAP_HPP
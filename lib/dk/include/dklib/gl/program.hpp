@@ -2,6 +2,8 @@
 #define DK_OPENGL_PROGRAM_HPP
 
 #include "gltypes.hpp"
+#include "program_cache.hpp"
+#include "reflection.hpp"
 #include "shader.hpp"
 #include "uniform.hpp"
 
@@ -10,54 +12,184 @@
 #include <GLES3/gl3.h>
 #include <spdlog/spdlog.h>
 
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <optional>
 #include <string_view>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace dk::gl {
+enum class ReloadResult {
+    /// None of the shaders changed their text
+    UNCHANGED,
+    RELOADED,
+    /// Errors were logged, the previous program is still in use
+    FAILED,
+};
+
 class Program {
 public:
+    /// @brief Program using the global binary cache.
     Program();
+    /// @brief Program using the provided binary cache, nullptr disables it.
+    explicit Program(ProgramBinaryCache *binary_cache);
     virtual ~Program();
 
+    /// Uniforms made by the program point to its shadows, a copy would
+    /// share them and delete the GL program twice
+    Program(const Program &other) = delete;
+    Program &operator=(const Program &other) = delete;
+    /// @brief Takes over the GL program, Uniforms made by the other program
+    /// upload to this one then. The other program can only be destroyed or
+    /// assigned to.
+    Program(Program &&other) noexcept;
+    Program &operator=(Program &&other) noexcept;
+
+    /// @brief Adds a shader, arguments are passed to the Shader constructor.
+    ///
+    /// Shaders are compiled by link() or submit(), and only when the program
+    /// is not found in the binary cache.
     template <typename... Args>
     Program &attach_shader(Args &&...args) {
         shaders_.emplace_back(std::forward<Args>(args)...);
-        auto owned = shaders_.back().get();
-        glAttachShader(program_descriptor_, owned);
-
-        gl::i32 is_compilation_success = -1;
-        glGetShaderiv(owned, GL_COMPILE_STATUS, &is_compilation_success);
-        if (not static_cast<bool>(is_compilation_success)) {
-            spdlog::error("Compilation of shader was not succesful");
-            auto msg = util::get_shader_error_msg(owned);
-            spdlog::error("shader log contents:\n {}", msg);
-            throw std::runtime_error("compilation of shader was not successful");
-        }
         return *this;
     }
 
+    /// @brief Links the program as a single stage (or a few) of
+    /// a ProgramPipeline, which can be combined with stage programs of the
+    /// other stages without linking them together. Has to be set before
+    /// link().
+    Program &set_separable(bool is_separable = true) noexcept {
+        is_separable_ = is_separable;
+        return *this;
+    }
+    [[nodiscard]] bool is_separable() const noexcept { return is_separable_; }
+
+    /// @brief Location of the active uniform, throws when there is none.
     [[nodiscard]] gl::i32 get_uniform(const std::string &name) const;
+    /// @brief Location of the active vertex attribute, throws when there is
+    /// none.
     [[nodiscard]] gl::i32 get_attribute(const std::string &name) const;
 
+    /// @brief Location of the active uniform, throws when there is none.
+    ///
+    /// Names given as string literals are hashed at compile time, so this
+    /// can be called every frame.
+    [[nodiscard]] gl::i32 get_uniform_location(const ResourceName &name) const;
+    /// @brief Handle of the uniform in get_reflection().get_uniforms().
+    [[nodiscard]] std::optional<ResourceHandle> find_uniform(const ResourceName &name) const noexcept {
+        return reflection_.find_uniform(name);
+    }
+    /// @brief Setter of the active uniform, throws when there is none.
+    ///
+    /// Uploads of values equal to the last ones set through any Uniform of
+    /// this program are skipped, the program has to outlive the Uniform.
+    [[nodiscard]] gl::Uniform make_uniform(const ResourceName &name);
+    /// @brief Uploads done and skipped through the Uniforms of this program.
+    [[nodiscard]] const UniformStats &get_uniform_stats() const noexcept { return *uniform_stats_; }
+    /// @brief Active resources of the program, filled in by wait().
+    [[nodiscard]] const ProgramReflection &get_reflection() const noexcept { return reflection_; }
+
+    /// @brief Uniform sharing the shadow copy of this program, see
+    /// make_uniform().
     [[nodiscard]] gl::Uniform get_uniform(bool t, const std::string &name);
     [[nodiscard]] gl::i32 get_attribute(bool t, const std::string &name) const;
 
+    /// @brief Restores the program from the binary cache, or compiles all of
+    /// the shaders, links them and stores the result in the cache.
+    ///
+    /// Same as submit().wait(). Throws when a shader does not compile or the
+    /// program does not link.
     Program &link();
-    void use() const;
 
-    void populate_attributes();
-    void populate_uniforms();
+    /// @brief Starts the compilation and the linking, but does not wait for
+    /// them to finish.
+    ///
+    /// No status is queried here, so with GL_KHR_parallel_shader_compile the
+    /// driver keeps compiling on its own threads. Submitting every program
+    /// first and waiting for them afterwards overlaps their compilation.
+    Program &submit();
+
+    /// @brief Whether wait() would return without blocking.
+    ///
+    /// Always true after submit() when the driver lacks
+    /// GL_KHR_parallel_shader_compile, the driver can not be asked then.
+    [[nodiscard]] bool is_ready() const;
+
+    /// @brief Finishes the submitted program and checks its status, submits
+    /// it first when needed.
+    ///
+    /// Throws when a shader does not compile or the program does not link.
+    Program &wait();
+
+    [[nodiscard]] bool is_linked() const noexcept { return state_ == LinkState::LINKED; }
+
+    /// @brief Rebuilds the shaders made of the changed file and links the
+    /// program again, the other shaders keep their compiled stages.
+    ///
+    /// The new program is linked aside, so when anything fails the errors are
+    /// logged and the program keeps working as it was. The program id and the
+    /// reflection change, Uniforms made before are matched with the new
+    /// uniforms by name and upload to their new locations, those the new
+    /// program lacks do nothing. A submitted program that was not waited for
+    /// yet is submitted again instead.
+    ReloadResult reload(const std::filesystem::path &changed_file);
+
+    [[nodiscard]] const std::vector<gl::Shader> &get_shaders() const noexcept { return shaders_; }
+    /// @brief Files the shaders were made of, includes as well.
+    [[nodiscard]] std::vector<std::filesystem::path> get_files() const;
+
+    /// @brief Binds the program, waits for it on the first use.
+    void use();
 
     [[nodiscard]] gl::u32 get_id() const noexcept { return program_descriptor_; }
+    /// @brief Whether the program was restored from the binary cache.
+    [[nodiscard]] bool is_from_binary_cache() const noexcept { return is_from_binary_cache_; }
+    /// @brief Key of the program in the binary cache, it covers the sources
+    /// and stages of the shaders and the identity of the driver.
+    [[nodiscard]] std::uint64_t get_binary_key() const;
 
 private:
+    enum class LinkState {
+        NONE,
+        SUBMITTED,
+        LINKED,
+    };
+
+    bool load_binary(std::uint64_t key);
+    void submit_compile_and_link();
+    void check_link();
+    /// @brief Logs why the program did not link.
+    /// @return description of the failure
+    [[nodiscard]] const char *report_link_failure(gl::u32 program);
+    void store_binary(std::uint64_t key) const;
+    /// @brief Takes the reflection of the relinked program, the shadows
+    /// follow their uniforms by name.
+    void remap_uniform_shadows(ProgramReflection &&reflection);
+
     std::vector<gl::Shader> shaders_;
+    ProgramBinaryCache *binary_cache_;
+    bool is_separable_ { false };
+    bool is_from_binary_cache_ { false };
+    bool is_binary_retrievable_ { false };
+    /// Whether the driver reports GL_COMPLETION_STATUS_KHR, set by submit()
+    /// from the extensions cached by the StateCache
+    bool is_completion_queryable_ { false };
+    std::uint64_t binary_key_ { 0 };
+    LinkState state_ { LinkState::NONE };
     gl::u32 program_descriptor_;
-    gl::u32 vertex_array_id_;
-    gl::i32 uniforms_;
-    std::unordered_map<std::string, gl::Uniform> uniform_cache_;
+    ProgramReflection reflection_;
+    /// Shadows of the uniforms of every link so far, a deque so that growing
+    /// it on a reload keeps the shadows of the existing Uniforms in place
+    std::deque<UniformShadow> uniform_shadows_;
+    /// Index into uniform_shadows_ for every handle of reflection_, a reload
+    /// keeps the shadow of each uniform whose name stays
+    std::vector<std::size_t> shadow_of_uniform_;
+    /// On the heap, so that the Uniforms keep counting when the program moves
+    std::unique_ptr<UniformStats> uniform_stats_;
 };
 } // namespace dk::gl
 #endif // DK_OPENGL_PROGRAM_HPP
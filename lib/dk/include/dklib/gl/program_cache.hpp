@@ -0,0 +1,55 @@
+#ifndef DK_OPENGL_PROGRAM_CACHE_HPP
+#define DK_OPENGL_PROGRAM_CACHE_HPP
+
+#include "gltypes.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace dk::gl {
+
+/// @brief Program binary as returned by glGetProgramBinary.
+struct ProgramBinary {
+    enum32 format { 0 };
+    std::vector<std::byte> bytes;
+};
+
+/// @brief On-disk cache of linked program binaries.
+///
+/// Every binary is stored in its own file named by the key, which is
+/// a hash of the shader sources, their stages and of the driver identity (see
+/// Program::link). Each file has a header with a checksum, so truncated or
+/// corrupted entries are detected and removed. Files are written to
+/// a temporary name first and renamed, so concurrently starting processes
+/// never see half written entries.
+class ProgramBinaryCache {
+public:
+    /// @brief Cache with the entries in the directory, which is created when
+    /// it does not exist.
+    explicit ProgramBinaryCache(std::filesystem::path directory);
+
+    /// @brief Cache in $DK_PROGRAM_CACHE_DIR, $XDG_CACHE_HOME/dklib/programs
+    /// or ~/.cache/dklib/programs, whichever is set first.
+    static ProgramBinaryCache &get_instance();
+
+    [[nodiscard]] std::optional<ProgramBinary> load(std::uint64_t key) const;
+    /// @brief Stores the binary, failures are logged and ignored.
+    void store(std::uint64_t key, enum32 format, std::span<const std::byte> bytes) const;
+    /// @brief Removes the entry, used when the driver refuses the binary.
+    void invalidate(std::uint64_t key) const;
+
+    [[nodiscard]] const std::filesystem::path &get_directory() const noexcept { return directory_; }
+
+private:
+    [[nodiscard]] std::filesystem::path path_of(std::uint64_t key) const;
+
+    std::filesystem::path directory_;
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_PROGRAM_CACHE_HPP
@@ -0,0 +1,122 @@
+#ifndef DK_OPENGL_PROGRAM_PIPELINE_HPP
+#define DK_OPENGL_PROGRAM_PIPELINE_HPP
+
+#include "gltypes.hpp"
+#include "program.hpp"
+#include "program_cache.hpp"
+#include "shader.hpp"
+#include "shader_preprocessor.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace dk::gl {
+
+/// @brief Program pipeline object, combining separable stage programs (see
+/// Program::set_separable) without linking them together.
+///
+/// Outputs of a stage are matched to the inputs of the next one when the
+/// pipeline is bound, so they should be declared with layout(location).
+/// Uniforms made by a stage program upload to it directly, plain glUniform
+/// calls go to the active program of the bound pipeline, see set_active(). A
+/// program bound by Program::use takes precedence over any pipeline, bind()
+/// unbinds it.
+class ProgramPipeline {
+public:
+    ProgramPipeline();
+    ~ProgramPipeline();
+
+    // This is a move only type, copies would delete the pipeline twice
+    ProgramPipeline(const ProgramPipeline &other) = delete;
+    ProgramPipeline &operator=(const ProgramPipeline &other) = delete;
+
+    ProgramPipeline(ProgramPipeline &&other) noexcept;
+    ProgramPipeline &operator=(ProgramPipeline &&other) noexcept;
+
+    /// @brief Uses the stages of the separable program, the programs used for
+    /// those stages before are replaced. Throws when the program is not
+    /// separable.
+    ///
+    /// The program has to outlive the pipeline, it is waited for by bind().
+    ProgramPipeline &use_stages(Program &program);
+
+    /// @brief Binds the pipeline, waits for its programs on the first use.
+    ///
+    /// Programs relinked since the last bind, e.g. by the HotReloader, are
+    /// used again, as their ids changed.
+    void bind();
+
+    /// @brief Makes the program the target of the glUniform calls, it has to
+    /// be one of the stages.
+    void set_active(const Program &program) const;
+
+    /// @brief Whether the stages can run together, the reason is logged
+    /// when they can not. The pipeline has to be bound before.
+    [[nodiscard]] bool validate() const;
+
+    [[nodiscard]] gl::u32 get_id() const noexcept { return id_; }
+
+private:
+    struct Stage {
+        Program *program;
+        /// GL_VERTEX_SHADER_BIT, ... of the stages of the program
+        gl::enum32 bits;
+        /// Id of the program when it was last used for the stages
+        gl::u32 used_id { 0 };
+    };
+
+    gl::u32 id_ { 0 };
+    std::vector<Stage> stages_;
+};
+
+/// @brief Separable stage programs and the pipelines combining them.
+///
+/// Stages are preprocessed first and their programs are keyed by the stage
+/// type and the hash of the preprocessed text, so a vertex stage shared by
+/// many fragment variants is compiled and linked once, instead of once per
+/// full program. Pipelines are keyed by the tuple of their stage programs.
+class PipelineCache {
+public:
+    struct Stage {
+        gl::ShaderType type;
+        std::filesystem::path path;
+        std::vector<ShaderDefine> defines {};
+    };
+
+    /// @param binary_cache cache of the linked stage programs, nullptr
+    /// disables it
+    explicit PipelineCache(ProgramBinaryCache *binary_cache = &ProgramBinaryCache::get_instance(),
+                           ShaderPreprocessor &preprocessor = ShaderPreprocessor::get_instance());
+
+    PipelineCache(const PipelineCache &other) = delete;
+    PipelineCache &operator=(const PipelineCache &other) = delete;
+
+    /// @brief Separable program of the stage, its linking is submitted, but
+    /// not waited for.
+    Program &get_stage(const Stage &stage);
+
+    /// @brief Pipeline of the stages, the order of them does not matter.
+    ProgramPipeline &get(std::span<const Stage> stages);
+    ProgramPipeline &get(std::initializer_list<Stage> stages) { return get(std::span { stages.begin(), stages.size() }); }
+
+    [[nodiscard]] std::size_t get_stage_count() const noexcept { return stages_.size(); }
+    [[nodiscard]] std::size_t get_pipeline_count() const noexcept { return pipelines_.size(); }
+
+private:
+    ProgramBinaryCache *binary_cache_;
+    ShaderPreprocessor &preprocessor_;
+    /// Keyed by the hash of the stage type and the preprocessed text
+    std::unordered_map<std::uint64_t, std::unique_ptr<Program>> stages_;
+    /// Keyed by the hash of the keys of the stages, in the order of the types
+    std::unordered_map<std::uint64_t, std::unique_ptr<ProgramPipeline>> pipelines_;
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_PROGRAM_PIPELINE_HPP
@@ -0,0 +1,137 @@
+#ifndef DK_OPENGL_REFLECTION_HPP
+#define DK_OPENGL_REFLECTION_HPP
+
+#include "gltypes.hpp"
+
+#include <dklib/util/hash.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dk::gl {
+
+/// @brief Name of a program resource together with its hash.
+///
+/// Made from a string literal the hash is computed by the compiler, so
+/// looking up `program.get_uniform_location("mv_matrix")` every frame does not
+/// hash anything at run time.
+struct ResourceName {
+    template <std::size_t N>
+    consteval ResourceName(const char (&literal)[N]) // NOLINT: implicit on purpose
+        : text(literal, N - 1)
+        , hash(util::fnv1a(text)) { }
+
+    /// @brief Name known only at run time, hashed here.
+    explicit constexpr ResourceName(std::string_view name)
+        : text(name)
+        , hash(util::fnv1a(text)) { }
+
+    std::string_view text;
+    std::uint64_t hash;
+};
+
+/// @brief Index of a resource in the ProgramReflection tables, stays valid
+/// for the lifetime of the linked program.
+using ResourceHandle = u32;
+
+struct UniformInfo {
+    /// Array uniforms are named without the "[0]" suffix
+    std::string name;
+    std::uint64_t hash;
+    enum32 type;
+    /// -1 for the members of uniform blocks
+    i32 location;
+    i32 array_size;
+    /// Index into ProgramReflection::get_blocks(), -1 for the default block
+    i32 block_index;
+    /// Byte offset inside of the block, -1 for the default block
+    i32 offset;
+};
+
+struct UniformBlockInfo {
+    std::string name;
+    std::uint64_t hash;
+    u32 index;
+    i32 binding;
+    i32 data_size;
+};
+
+struct AttributeInfo {
+    std::string name;
+    std::uint64_t hash;
+    enum32 type;
+    i32 location;
+    i32 array_size;
+};
+
+/// @brief Active uniforms, uniform blocks and vertex attributes of a linked
+/// program, queried once with glGetProgramResourceiv.
+///
+/// Every kind of resource is kept in a contiguous table sorted by the hash
+/// of its name, lookups are binary searches over the hashes, confirmed by
+/// the name, and handles are plain indices into the tables.
+class ProgramReflection {
+public:
+    ProgramReflection() = default;
+
+    /// @brief Queries the resources of the linked program.
+    ///
+    /// Throws when two names of the same kind share a hash.
+    explicit ProgramReflection(u32 program);
+
+    [[nodiscard]] std::span<const UniformInfo> get_uniforms() const noexcept { return uniforms_; }
+    [[nodiscard]] std::span<const UniformBlockInfo> get_blocks() const noexcept { return blocks_; }
+    [[nodiscard]] std::span<const AttributeInfo> get_attributes() const noexcept { return attributes_; }
+
+    [[nodiscard]] std::optional<ResourceHandle> find_uniform(const ResourceName &name) const noexcept {
+        return find(uniforms_, name);
+    }
+    [[nodiscard]] std::optional<ResourceHandle> find_block(const ResourceName &name) const noexcept {
+        return find(blocks_, name);
+    }
+    [[nodiscard]] std::optional<ResourceHandle> find_attribute(const ResourceName &name) const noexcept {
+        return find(attributes_, name);
+    }
+
+    [[nodiscard]] const UniformInfo &get_uniform(ResourceHandle handle) const { return uniforms_.at(handle); }
+    [[nodiscard]] const UniformBlockInfo &get_block(ResourceHandle handle) const { return blocks_.at(handle); }
+    [[nodiscard]] const AttributeInfo &get_attribute(ResourceHandle handle) const {
+        return attributes_.at(handle);
+    }
+
+private:
+    template <typename Info>
+    static std::optional<ResourceHandle> find(const std::vector<Info> &table, const ResourceName &name) noexcept {
+        const auto hash = name.hash;
+        std::size_t first = 0;
+        std::size_t count = table.size();
+        while (count > 0) {
+            const auto half = count / 2;
+            if (table[first + half].hash < hash) {
+                first += half + 1;
+                count -= half + 1;
+            } else {
+                count = half;
+            }
+        }
+        // a name the program does not have may still share the hash of one
+        if (first < table.size() and table[first].hash == hash and table[first].name == name.text) {
+            return static_cast<ResourceHandle>(first);
+        }
+        return std::nullopt;
+    }
+
+    std::vector<UniformInfo> uniforms_;
+    std::vector<UniformBlockInfo> blocks_;
+    std::vector<AttributeInfo> attributes_;
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_REFLECTION_HPP
@@ -2,17 +2,18 @@
 #define DK_OPENGL_SHADER_HPP
 
 #include "gltypes.hpp"
+#include "shader_preprocessor.hpp"
+#include "shader_source.hpp"
 
 #include <GLES3/gl3.h>
 #include <spdlog/spdlog.h>
 
-#include <cstring>
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
-#include <iostream>
 #include <span>
-#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace dk::gl {
 enum class ShaderType : gl::enum32 {
@@ -24,32 +25,102 @@ enum class ShaderType : gl::enum32 {
     COMPUTE = GL_COMPUTE_SHADER,
 };
 
+/// @brief Compiled shaders shared by every Shader made through the cache
+/// with the same stage and preprocessed text.
+///
+/// Materials with N feature flags have up to 2^N permutations, but most of
+/// them usually preprocess to a few distinct texts, each of those is compiled
+/// once. The shaders are deleted with the cache, so it has to outlive the
+/// Programs linked from them.
+class ShaderVariantCache {
+public:
+    explicit ShaderVariantCache(std::vector<std::filesystem::path> include_directories = {});
+    ~ShaderVariantCache();
+
+    ShaderVariantCache(const ShaderVariantCache &other) = delete;
+    ShaderVariantCache &operator=(const ShaderVariantCache &other) = delete;
+
+    /// @brief Compiled shader of the text, the compilation is submitted on
+    /// the first request and not waited for.
+    [[nodiscard]] gl::u32 get(gl::ShaderType type, const ShaderSource &source);
+
+    [[nodiscard]] ShaderPreprocessor &get_preprocessor() noexcept { return preprocessor_; }
+    /// @brief Count of compiled shaders.
+    [[nodiscard]] std::size_t size() const noexcept { return shaders_.size(); }
+    /// @brief Count of requests served by an already compiled shader.
+    [[nodiscard]] std::size_t get_hit_count() const noexcept { return hit_count_; }
+
+private:
+    ShaderPreprocessor preprocessor_;
+    /// Keyed by the hash of the stage and the text
+    std::unordered_map<std::uint64_t, gl::u32> shaders_;
+    std::size_t hit_count_ { 0 };
+};
+
+/// @brief Shader stage loaded from a file.
+///
+/// Source is loaded and preprocessed right away (see ShaderPreprocessor), but
+/// it is compiled only when the shader is first needed, so a Program restored
+/// from the binary cache never compiles its shaders.
 class Shader {
 public:
     // TODO: add third default arugment "use_base_shader_path" or something
     // like that, it is going to define common prefix
     Shader(std::string &&filepath, gl::ShaderType type);
+    /// @brief Preprocesses the source with the provided preprocessor instead
+    /// of the global one, the defines are injected into it.
+    Shader(std::string &&filepath, gl::ShaderType type, ShaderPreprocessor &preprocessor,
+           std::span<const ShaderDefine> defines = {});
+    /// @brief Permutation of the shader with the defines, the compiled shader
+    /// is shared with the other permutations of the same text.
+    Shader(std::string &&filepath, gl::ShaderType type, std::span<const ShaderDefine> defines,
+           ShaderVariantCache &variants);
     virtual ~Shader();
 
+    // This is a move only type, copies would delete the shader twice
+    Shader(const Shader &other) = delete;
+    Shader &operator=(const Shader &other) = delete;
+
+    Shader(Shader &&other) noexcept;
+    Shader &operator=(Shader &&other) noexcept;
+
+    /// @brief Starts the compilation unless it was already started, does not
+    /// wait for it.
+    void submit();
+
+    /// @brief Compiles the shader unless it is already compiled.
+    /// @return whether the compilation succeeded, waits for the driver
+    bool compile();
+
+    /// @brief Descriptor of the shader, submits the compilation when needed.
     // TODO: try these new types on more places
-    [[nodiscard]] inline gl::u32 get() const { return descriptor_; }
+    [[nodiscard]] gl::u32 get();
+
+    /// @brief Preprocesses the source again, when the text changed the shader
+    /// is compiled again once it is needed.
+    ///
+    /// Throws when the preprocessing fails, the shader is left as it was then.
+    /// @return whether the text changed
+    bool reload();
+
+    [[nodiscard]] bool is_submitted() const noexcept { return descriptor_ != 0; }
+    [[nodiscard]] gl::ShaderType get_type() const noexcept { return type_; }
+    [[nodiscard]] const ShaderSource &get_source() const noexcept { return source_; }
+    [[nodiscard]] const std::string &get_filepath() const noexcept { return filepath_; }
+    /// @brief Files the source was made of, indexed by the source string
+    /// numbers in the compile errors.
+    [[nodiscard]] const std::vector<std::filesystem::path> &get_files() const noexcept { return files_; }
 
 private:
-    void get_source_from_file(std::string &&filepath) {
-        spdlog::info("attaching shader with filepath: {}", filepath);
-        std::ifstream file(filepath);
-        if (not file.is_open()) {
-            spdlog::error("file: {} could not be opened", filepath);
-            throw std::runtime_error("could not open file");
-        }
-
-        std::ostringstream ss;
-        ss << file.rdbuf();
-        str_source = ss.str();
-        std::cout << str_source << std::endl;
-    }
-    std::string str_source;
-    gl::u32 descriptor_;
+    std::string filepath_;
+    gl::ShaderType type_;
+    ShaderSource source_;
+    std::vector<std::filesystem::path> files_;
+    ShaderPreprocessor *preprocessor_;
+    std::vector<ShaderDefine> defines_;
+    /// Owner of the descriptor, when it is shared
+    ShaderVariantCache *variants_ { nullptr };
+    gl::u32 descriptor_ { 0 };
 };
 } // namespace dk::gl
 #endif // DK_OPENGL_SHADER_HPP
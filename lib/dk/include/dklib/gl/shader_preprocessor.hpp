@@ -0,0 +1,85 @@
+#ifndef DK_OPENGL_SHADER_PREPROCESSOR_HPP
+#define DK_OPENGL_SHADER_PREPROCESSOR_HPP
+
+#include "shader_source.hpp"
+
+#include <dklib/util/arena.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dk::gl {
+
+/// @brief Macro defined for a permutation of a shader, e.g. a feature flag
+/// of a material.
+struct ShaderDefine {
+    std::string name;
+    std::string value { "1" };
+};
+
+/// @brief Shader source with the includes resolved and the defines injected.
+struct PreprocessedSource {
+    ShaderSource source;
+    /// Files the text was made of, indexed by the source string numbers of
+    /// its #line directives (and so of the compile errors), the shader
+    /// itself is the first one
+    std::vector<std::filesystem::path> files;
+};
+
+/// @brief GLSL preprocessing done before the shaders reach the driver.
+///
+/// `#include "file"` is looked up next to the including file first and then
+/// in the include directories, `#include <file>` only in those. Files with
+/// `#pragma once` are included once. Defines are injected right after the
+/// `#version` line, sorted by their names, so the order they are given in
+/// does not matter. Every other directive is left to the driver.
+///
+/// Preprocessed texts are kept in an arena and identical ones are stored
+/// once, so permutations ending up with the same text share it and its hash.
+/// A shader without includes and defines is returned as it is in the
+/// ShaderSourceCache.
+class ShaderPreprocessor {
+public:
+    explicit ShaderPreprocessor(std::vector<std::filesystem::path> include_directories = {});
+    ShaderPreprocessor(std::vector<std::filesystem::path> include_directories, ShaderSourceCache &sources);
+
+    ShaderPreprocessor(const ShaderPreprocessor &other) = delete;
+    ShaderPreprocessor &operator=(const ShaderPreprocessor &other) = delete;
+
+    /// @brief Preprocessor of the global ShaderSourceCache without any
+    /// include directories.
+    static ShaderPreprocessor &get_instance();
+
+    /// @brief Throws when a file can not be found or includes itself.
+    PreprocessedSource preprocess(const std::filesystem::path &filepath, std::span<const ShaderDefine> defines = {});
+
+    [[nodiscard]] const std::vector<std::filesystem::path> &get_include_directories() const noexcept {
+        return include_directories_;
+    }
+    /// @brief Count of distinct preprocessed texts that are stored.
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    struct Expansion;
+
+    void expand(const std::filesystem::path &filepath, Expansion &expansion);
+    [[nodiscard]] std::filesystem::path resolve(std::string_view name, bool is_quoted,
+                                                const std::filesystem::path &including_file) const;
+    ShaderSource store(std::string_view text);
+
+    std::vector<std::filesystem::path> include_directories_;
+    ShaderSourceCache &sources_;
+    mutable std::mutex mutex_;
+    util::Arena arena_;
+    /// Keyed by the hash of the text
+    std::unordered_map<std::uint64_t, std::string_view> texts_;
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_SHADER_PREPROCESSOR_HPP
@@ -0,0 +1,67 @@
+#ifndef DK_OPENGL_SHADER_SOURCE_HPP
+#define DK_OPENGL_SHADER_SOURCE_HPP
+
+#include <dklib/util/arena.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace dk::gl {
+
+/// @brief Source of a shader as held by the ShaderSourceCache.
+struct ShaderSource {
+    /// Null terminated text, valid until the cache is cleared
+    std::string_view text;
+    /// FNV-1a hash of the text
+    std::uint64_t hash { 0 };
+};
+
+/// @brief Shader sources loaded from files, shared by every shader using
+/// the same file.
+///
+/// Entries are keyed by the path and validated by the modification time and
+/// size of the file, so a file is read again only when it changes. Texts are
+/// kept in a single arena, an outdated text stays there (and views of it stay
+/// valid) until clear() is called.
+class ShaderSourceCache {
+public:
+    ShaderSourceCache() = default;
+
+    ShaderSourceCache(const ShaderSourceCache &other) = delete;
+    ShaderSourceCache &operator=(const ShaderSourceCache &other) = delete;
+
+    static ShaderSourceCache &get_instance();
+
+    /// @brief Source of the file, read only when it is not cached or when
+    /// the file changed since.
+    ShaderSource get(const std::filesystem::path &filepath);
+
+    /// @brief Drops all of the entries and invalidates all of the texts.
+    void clear();
+
+    [[nodiscard]] std::size_t size() const;
+    /// @brief Count of reads of files that were served from the cache.
+    [[nodiscard]] std::size_t get_hit_count() const;
+    /// @brief Count of bytes taken by the texts, including outdated ones.
+    [[nodiscard]] std::size_t memory_usage() const;
+
+private:
+    struct Entry {
+        std::filesystem::file_time_type modified;
+        std::uintmax_t size;
+        ShaderSource source;
+    };
+
+    mutable std::mutex mutex_;
+    util::Arena arena_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::size_t hit_count_ { 0 };
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_SHADER_SOURCE_HPP
@@ -0,0 +1,166 @@
+#ifndef DK_OPENGL_STATE_CACHE_HPP
+#define DK_OPENGL_STATE_CACHE_HPP
+
+#include "gltypes.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dk::gl {
+
+/// @brief Counts of the state changes that reached the driver and of those
+/// that were skipped, as the state was already set.
+struct StateStats {
+    std::uint64_t issued { 0 };
+    std::uint64_t elided { 0 };
+};
+
+/// @brief Shadow copy of the binding and capability state of the current
+/// context, the wrappers (Buffer, VertexArray, Program, ...) change the state
+/// through it, so a bind of what is already bound never reaches the driver.
+///
+/// The cache is per thread, as is the current context. Code changing the
+/// state behind its back, e.g. a raw glBindBuffer or another library, has to
+/// call invalidate() afterwards, making the cache issue the next change of
+/// every state again. The contexts of dklib invalidate it when they become
+/// current.
+class StateCache {
+public:
+    /// @brief Cache of the context current on the calling thread.
+    static StateCache &get_instance();
+
+    StateCache();
+
+    StateCache(const StateCache &other) = delete;
+    StateCache &operator=(const StateCache &other) = delete;
+
+    void use_program(u32 program) {
+        if (set(program_, program)) {
+            issue_use_program(program);
+        }
+    }
+
+    void bind_program_pipeline(u32 pipeline) {
+        if (set(pipeline_, pipeline)) {
+            issue_bind_program_pipeline(pipeline);
+        }
+    }
+
+    /// @brief Binds the vertex array, together with the element array buffer
+    /// it references.
+    void bind_vertex_array(u32 vertex_array) {
+        if (set(vertex_array_, vertex_array)) {
+            issue_bind_vertex_array(vertex_array);
+            buffers_[ELEMENT_ARRAY_SLOT] = UNKNOWN;
+        }
+    }
+
+    void bind_buffer(enum32 target, u32 buffer) {
+        const auto slot = buffer_slot(target);
+        if (slot == UNTRACKED or set(buffers_[slot], buffer)) {
+            issue_bind_buffer(target, buffer);
+        }
+    }
+
+    /// @brief Indexed binds are always issued, there are too many binding
+    /// points to be worth tracking, but they change the generic binding of
+    /// the target too.
+    void bind_buffer_base(enum32 target, u32 index, u32 buffer);
+    void bind_buffer_range(enum32 target, u32 index, u32 buffer, iptr offset, sptr size);
+
+    /// @brief Binds the texture to the unit, the unit becomes the active one.
+    void bind_texture(u32 unit, enum32 target, u32 texture);
+    /// @brief Binds the texture to the active unit, e.g. to upload it.
+    void bind_texture(enum32 target, u32 texture);
+
+    /// @brief glEnable / glDisable of the capability (GL_DEPTH_TEST, ...).
+    void set_capability(enum32 capability, bool is_enabled);
+    void enable(enum32 capability) { set_capability(capability, true); }
+    void disable(enum32 capability) { set_capability(capability, false); }
+
+    /// @brief Called before the object is deleted, as its name may be
+    /// reused by the next object of the kind. Deleting a bound object unbinds
+    /// it, which the cache records too.
+    void forget_program(u32 program);
+    void forget_program_pipeline(u32 pipeline);
+    void forget_vertex_array(u32 vertex_array);
+    void forget_buffer(u32 buffer);
+    void forget_texture(u32 texture);
+
+    /// @brief Forgets the whole state, every next change is issued.
+    ///
+    /// The extensions of the context are forgotten too, as another context
+    /// may have become current.
+    void invalidate();
+
+    /// @brief Whether the current context has the extension.
+    ///
+    /// The extensions are queried by the first call only, walking the whole
+    /// list is too slow to be done for every program.
+    [[nodiscard]] bool has_extension(std::string_view name);
+
+    /// @brief Counts since the last end_frame().
+    [[nodiscard]] const StateStats &get_frame_stats() const noexcept { return frame_; }
+    /// @brief Counts of the last finished frame.
+    [[nodiscard]] const StateStats &get_last_frame_stats() const noexcept { return last_frame_; }
+    /// @brief Finishes the counts of the frame, they are returned.
+    StateStats end_frame();
+
+private:
+    /// Binding in an unknown state
+    static constexpr u32 UNKNOWN = ~0U;
+    static constexpr std::size_t UNTRACKED = ~std::size_t { 0 };
+    static constexpr std::size_t BUFFER_TARGET_COUNT = 14;
+    /// The element array binding is a state of the bound vertex array
+    static constexpr std::size_t ELEMENT_ARRAY_SLOT = 0;
+    static constexpr std::size_t TEXTURE_TARGET_COUNT = 11;
+    static constexpr std::size_t TEXTURE_UNIT_COUNT = 32;
+
+    /// @brief Stores the value, counting the change as issued or elided.
+    /// @return whether the change has to be issued
+    bool set(u32 &current, u32 value) {
+        if (current == value) {
+            ++frame_.elided;
+            return false;
+        }
+        current = value;
+        ++frame_.issued;
+        return true;
+    }
+
+    static std::size_t buffer_slot(enum32 target) noexcept;
+    static std::size_t texture_slot(enum32 target) noexcept;
+
+    // the GL calls live in the translation unit, so that this header does not
+    // bring the GL headers of every version
+    static void issue_use_program(u32 program);
+    static void issue_bind_program_pipeline(u32 pipeline);
+    static void issue_bind_vertex_array(u32 vertex_array);
+    static void issue_bind_buffer(enum32 target, u32 buffer);
+
+    u32 program_ { UNKNOWN };
+    u32 pipeline_ { UNKNOWN };
+    u32 vertex_array_ { UNKNOWN };
+    std::array<u32, BUFFER_TARGET_COUNT> buffers_ {};
+    u32 active_texture_ { UNKNOWN };
+    /// Indexed by unit * TEXTURE_TARGET_COUNT + target slot
+    std::array<u32, TEXTURE_UNIT_COUNT * TEXTURE_TARGET_COUNT> textures_ {};
+    /// Capability and whether it is enabled, few of them are ever changed
+    std::vector<std::pair<enum32, bool>> capabilities_;
+    /// Sorted names of the extensions of the context, valid when
+    /// are_extensions_known_
+    std::vector<std::string> extensions_;
+    bool are_extensions_known_ { false };
+
+    StateStats frame_;
+    StateStats last_frame_;
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_STATE_CACHE_HPP
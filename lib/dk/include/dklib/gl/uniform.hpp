@@ -1,9 +1,13 @@
 #ifndef DK_GL_UNIFORM_HPP
 #define DK_GL_UNIFORM_HPP
 
-#include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
 #include <spdlog/spdlog.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <span>
 #include <string>
 #include <utility>
@@ -13,12 +17,49 @@
 
 namespace dk::gl {
 
+/// @brief Last value uploaded to a uniform, kept by its Program.
+struct UniformShadow {
+    /// Largest value that is shadowed, a mat4
+    static constexpr std::size_t CAPACITY = 64;
+
+    std::array<std::byte, CAPACITY> value {};
+    /// Size of the value in bytes, 0 before the first upload
+    std::size_t size { 0 };
+    /// Whether the matrix value was uploaded transposed
+    bool transposed { false };
+    /// Program the uniform belongs to and its location there, updated by the
+    /// Program when it is linked again. The location is -1 when the program
+    /// lost the uniform, uploads to it are ignored then.
+    u32 program { 0 };
+    i32 location { -1 };
+};
+
+/// @brief Counts of the uniform uploads done through the Uniforms of
+/// a Program.
+struct UniformStats {
+    std::uint64_t upload_count { 0 };
+    /// Calls that did not reach OpenGL, because the value did not change
+    std::uint64_t skipped_count { 0 };
+};
+
+/// @brief Setter of a single uniform.
+///
+/// Uniforms made by a Program upload to it with glProgramUniform, whether it
+/// is current or not. They share its shadow copy of the last uploaded values
+/// and values equal to them are not uploaded again, so the Program has to
+/// outlive them. Without a shadow every call goes to the current program.
 class Uniform {
 public:
     Uniform(i32 location, std::string &&name)
         : location_(location)
         , name_(std::move(name)) {};
 
+    Uniform(i32 location, std::string &&name, UniformShadow &shadow, UniformStats &stats)
+        : location_(location)
+        , name_(std::move(name))
+        , shadow_(&shadow)
+        , stats_(&stats) {};
+
     Uniform(i32 location, const std::string &name)
         : location_(location)
         , name_(name) {
@@ -26,11 +67,16 @@ public:
     };
 
     Uniform(const Uniform &other)
-        : Uniform(other.location_, other.name_) {};
+        : location_(other.location_)
+        , name_(other.name_)
+        , shadow_(other.shadow_)
+        , stats_(other.stats_) {};
 
     Uniform(Uniform &&other) noexcept
         : location_(std::move(other.location_))
-        , name_(std::move(other.name_)) { }
+        , name_(std::move(other.name_))
+        , shadow_(other.shadow_)
+        , stats_(other.stats_) { }
 
     Uniform &operator=(const Uniform &other) {
         Uniform tmp(other);
@@ -41,89 +87,232 @@ public:
     Uniform &operator=(Uniform &&other) noexcept {
         std::swap(location_, other.location_);
         std::swap(name_, other.name_);
+        std::swap(shadow_, other.shadow_);
+        std::swap(stats_, other.stats_);
         return *this;
     }
 
-    [[nodiscard]] gl::i32 get_location() const noexcept { return location_; }
+    /// @brief Location in the program, Uniforms made by a Program follow it
+    /// when the program is linked again.
+    [[nodiscard]] gl::i32 get_location() const noexcept { return shadow_ == nullptr ? location_ : shadow_->location; }
+    [[nodiscard]] const std::string &get_name() const noexcept { return name_; }
 
     template <typename T, std::size_t H, std::size_t W>
     using mat = std::span<T, H * W>;
 
-    inline void set(std::span<i32, 1> vec) const noexcept {
-        glUniform1iv(location_, sizeof(i32), vec.data());
+    inline void set(std::span<const i32, 1> vec) const noexcept {
+        set_values<i32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform1iv(program, location, 1, vec.data()); },
+            [&] { glUniform1iv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<u32, 1> vec) const noexcept {
-        glUniform1uiv(location_, sizeof(u32), vec.data());
+    inline void set(std::span<const u32, 1> vec) const noexcept {
+        set_values<u32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform1uiv(program, location, 1, vec.data()); },
+            [&] { glUniform1uiv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<f32, 1> vec) const noexcept {
-        glUniform1fv(location_, sizeof(f32), vec.data());
+    inline void set(std::span<const f32, 1> vec) const noexcept {
+        set_values<f32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform1fv(program, location, 1, vec.data()); },
+            [&] { glUniform1fv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<i32, 2> vec) const noexcept {
-        glUniform2iv(location_, sizeof(i32) * 2, vec.data());
+    inline void set(std::span<const i32, 2> vec) const noexcept {
+        set_values<i32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform2iv(program, location, 1, vec.data()); },
+            [&] { glUniform2iv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<u32, 2> vec) const noexcept {
-        glUniform2uiv(location_, sizeof(u32) * 2, vec.data());
+    inline void set(std::span<const u32, 2> vec) const noexcept {
+        set_values<u32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform2uiv(program, location, 1, vec.data()); },
+            [&] { glUniform2uiv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<f32, 2> vec) const noexcept {
-        glUniform2fv(location_, sizeof(f32) * 2, vec.data());
+    inline void set(std::span<const f32, 2> vec) const noexcept {
+        set_values<f32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform2fv(program, location, 1, vec.data()); },
+            [&] { glUniform2fv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<i32, 3> vec) const noexcept {
-        glUniform3iv(location_, sizeof(i32) * 3, vec.data());
+    inline void set(std::span<const i32, 3> vec) const noexcept {
+        set_values<i32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform3iv(program, location, 1, vec.data()); },
+            [&] { glUniform3iv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<u32, 3> vec) const noexcept {
-        glUniform3uiv(location_, sizeof(u32) * 3, vec.data());
+    inline void set(std::span<const u32, 3> vec) const noexcept {
+        set_values<u32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform3uiv(program, location, 1, vec.data()); },
+            [&] { glUniform3uiv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<f32, 3> vec) const noexcept {
-        glUniform3fv(location_, sizeof(f32) * 3, vec.data());
+    inline void set(std::span<const f32, 3> vec) const noexcept {
+        set_values<f32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform3fv(program, location, 1, vec.data()); },
+            [&] { glUniform3fv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<i32, 4> vec) const noexcept {
-        glUniform4iv(location_, sizeof(i32) * 4, vec.data());
+    inline void set(std::span<const i32, 4> vec) const noexcept {
+        set_values<i32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform4iv(program, location, 1, vec.data()); },
+            [&] { glUniform4iv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<u32, 4> vec) const noexcept {
-        glUniform4uiv(location_, sizeof(u32) * 4, vec.data());
+    inline void set(std::span<const u32, 4> vec) const noexcept {
+        set_values<u32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform4uiv(program, location, 1, vec.data()); },
+            [&] { glUniform4uiv(location_, 1, vec.data()); }
+        );
     };
-    inline void set(std::span<f32, 4> vec) const noexcept {
-        glUniform4fv(location_, sizeof(f32) * 4, vec.data());
+    inline void set(std::span<const f32, 4> vec) const noexcept {
+        set_values<f32>(
+            vec, [&](u32 program, i32 location) { glProgramUniform4fv(program, location, 1, vec.data()); },
+            [&] { glUniform4fv(location_, 1, vec.data()); }
+        );
     };
 
-    inline void set(mat<f32, 4, 4> mat, bool transpose = false) const noexcept {
-        glUniformMatrix4fv(location_, 1, static_cast<GLboolean>(transpose), mat.data());
+    inline void set(mat<const f32, 4, 4> mat, bool transpose = false) const noexcept {
+        const auto flag = static_cast<GLboolean>(transpose);
+        set_values<f32>(
+            mat, [&](u32 program, i32 location) { glProgramUniformMatrix4fv(program, location, 1, flag, mat.data()); },
+            [&] { glUniformMatrix4fv(location_, 1, flag, mat.data()); }, transpose
+        );
+    };
+    /// @brief Sets a column major mat4, e.g. vmath::mat4 converts to the
+    /// pointer.
+    inline void set_matrix4(const f32 *values) const noexcept { set(mat<const f32, 4, 4> { values, 16 }); };
+    inline void set_matrix3(const f32 *values) const noexcept {
+        set_values<f32>(
+            mat<const f32, 3, 3> { values, 9 },
+            [&](u32 program, i32 location) { glProgramUniformMatrix3fv(program, location, 1, GL_FALSE, values); },
+            [&] { glUniformMatrix3fv(location_, 1, GL_FALSE, values); }
+        );
+    };
+    inline void set_matrix2(const f32 *values) const noexcept {
+        set_values<f32>(
+            mat<const f32, 2, 2> { values, 4 },
+            [&](u32 program, i32 location) { glProgramUniformMatrix2fv(program, location, 1, GL_FALSE, values); },
+            [&] { glUniformMatrix2fv(location_, 1, GL_FALSE, values); }
+        );
     };
 
-    inline void set(u32 x) const noexcept { glUniform1ui(location_, x); };
-    inline void set(i32 x) const noexcept { glUniform1i(location_, x); };
-    inline void set(f32 x) const noexcept { glUniform1f(location_, x); };
+    inline void set(u32 x) const noexcept {
+        set_values<u32>(
+            std::array { x }, [&](u32 program, i32 location) { glProgramUniform1ui(program, location, x); },
+            [&] { glUniform1ui(location_, x); }
+        );
+    };
+    inline void set(i32 x) const noexcept {
+        set_values<i32>(
+            std::array { x }, [&](u32 program, i32 location) { glProgramUniform1i(program, location, x); },
+            [&] { glUniform1i(location_, x); }
+        );
+    };
+    inline void set(f32 x) const noexcept {
+        set_values<f32>(
+            std::array { x }, [&](u32 program, i32 location) { glProgramUniform1f(program, location, x); },
+            [&] { glUniform1f(location_, x); }
+        );
+    };
     inline void set(u32 x, u32 y) const noexcept {
-        glUniform2ui(location_, x, y);
+        set_values<u32>(
+            std::array { x, y }, [&](u32 program, i32 location) { glProgramUniform2ui(program, location, x, y); },
+            [&] { glUniform2ui(location_, x, y); }
+        );
     };
     inline void set(i32 x, i32 y) const noexcept {
-        glUniform2i(location_, x, y);
+        set_values<i32>(
+            std::array { x, y }, [&](u32 program, i32 location) { glProgramUniform2i(program, location, x, y); },
+            [&] { glUniform2i(location_, x, y); }
+        );
     };
     inline void set(f32 x, f32 y) const noexcept {
-        glUniform2f(location_, x, y);
+        set_values<f32>(
+            std::array { x, y }, [&](u32 program, i32 location) { glProgramUniform2f(program, location, x, y); },
+            [&] { glUniform2f(location_, x, y); }
+        );
     };
     inline void set(u32 x, u32 y, u32 z) const noexcept {
-        glUniform3ui(location_, x, y, z);
+        set_values<u32>(
+            std::array { x, y, z }, [&](u32 program, i32 location) { glProgramUniform3ui(program, location, x, y, z); },
+            [&] { glUniform3ui(location_, x, y, z); }
+        );
     };
     inline void set(i32 x, i32 y, i32 z) const noexcept {
-        glUniform3i(location_, x, y, z);
+        set_values<i32>(
+            std::array { x, y, z }, [&](u32 program, i32 location) { glProgramUniform3i(program, location, x, y, z); },
+            [&] { glUniform3i(location_, x, y, z); }
+        );
     };
     inline void set(f32 x, f32 y, f32 z) const noexcept {
-        glUniform3f(location_, x, y, z);
+        set_values<f32>(
+            std::array { x, y, z }, [&](u32 program, i32 location) { glProgramUniform3f(program, location, x, y, z); },
+            [&] { glUniform3f(location_, x, y, z); }
+        );
     };
     inline void set(u32 x, u32 y, u32 z, u32 w) const noexcept {
-        glUniform4ui(location_, x, y, z, w);
+        set_values<u32>(
+            std::array { x, y, z, w },
+            [&](u32 program, i32 location) { glProgramUniform4ui(program, location, x, y, z, w); },
+            [&] { glUniform4ui(location_, x, y, z, w); }
+        );
     };
     inline void set(i32 x, i32 y, i32 z, i32 w) const noexcept {
-        glUniform4i(location_, x, y, z, w);
+        set_values<i32>(
+            std::array { x, y, z, w },
+            [&](u32 program, i32 location) { glProgramUniform4i(program, location, x, y, z, w); },
+            [&] { glUniform4i(location_, x, y, z, w); }
+        );
     };
     inline void set(f32 x, f32 y, f32 z, f32 w) const noexcept {
-        glUniform4f(location_, x, y, z, w);
+        set_values<f32>(
+            std::array { x, y, z, w },
+            [&](u32 program, i32 location) { glProgramUniform4f(program, location, x, y, z, w); },
+            [&] { glUniform4f(location_, x, y, z, w); }
+        );
     };
 
 private:
+    /// @return whether the value differs from the shadow and has to be
+    /// uploaded, the shadow holds the value then
+    template <typename T>
+    [[nodiscard]] bool update_shadow(std::span<const T> values, bool transposed) const noexcept {
+        const auto bytes = std::as_bytes(values);
+        if (bytes.size() > UniformShadow::CAPACITY) {
+            shadow_->size = 0;
+            ++stats_->upload_count;
+            return true;
+        }
+        if (shadow_->size == bytes.size() and shadow_->transposed == transposed
+            and std::memcmp(shadow_->value.data(), bytes.data(), bytes.size()) == 0) {
+            ++stats_->skipped_count;
+            return false;
+        }
+        std::memcpy(shadow_->value.data(), bytes.data(), bytes.size());
+        shadow_->size = bytes.size();
+        shadow_->transposed = transposed;
+        ++stats_->upload_count;
+        return true;
+    }
+
+    /// Uniforms of a Program upload to it, whichever program is current,
+    /// the others to the current program.
+    template <typename T, typename ProgramUpload, typename Upload>
+    inline void set_values(std::span<const T> values, ProgramUpload &&program_upload, Upload &&upload,
+                           bool transposed = false) const noexcept {
+        if (shadow_ == nullptr) {
+            upload();
+        } else if (update_shadow<T>(values, transposed)) {
+            program_upload(shadow_->program, shadow_->location);
+        }
+    }
+
     i32 location_;
     std::string name_;
+    UniformShadow *shadow_ { nullptr };
+    UniformStats *stats_ { nullptr };
 };
 } // namespace dk::gl
 
@@ -1,11 +1,15 @@
 #ifndef DK_GL_VERTEX_HPP
 #define DK_GL_VERTEX_HPP
 
+#include <array>
+#include <cstddef>
+#include <span>
 #include <type_traits>
 
 #include <GLES3/gl3.h>
 
 #include <dklib/gl/gltypes.hpp>
+#include <dklib/gl/vertex_format.hpp>
 #include <dklib/math/vector3d.hpp>
 
 namespace dk::gl {
@@ -35,18 +39,6 @@ namespace experimental {
         f32 v;
     };
 
-    template <typename T>
-    inline void *offset_cast(u32 offset) {
-        return reinterpret_cast<void *>(offset * sizeof(T));
-    }
-
-    template <typename T>
-    inline void bind_attributes_v2(u32 layout_idx) {
-        glVertexAttribPointer(layout_idx, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(f32), offset_cast<f32>(0));
-        glVertexAttribPointer(layout_idx + 1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(f32), offset_cast<f32>(3));
-        glVertexAttribPointer(layout_idx + 2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(f32), offset_cast<f32>(6));
-    }
-
     static_assert(std::is_standard_layout_v<Vertex>, "Vertex type should have standard layout");
 
 } // namespace experimental
@@ -57,10 +49,85 @@ struct Vertex {
     f32 v;
 };
 
+template <>
+struct VertexLayout<experimental::PositionalVertex> {
+    static constexpr std::array attributes {
+        DK_VERTEX_ATTRIBUTE(experimental::PositionalVertex, position, 0),
+    };
+};
+
+template <>
+struct VertexLayout<experimental::TexturingVertex> {
+    static constexpr std::array attributes {
+        DK_VERTEX_ATTRIBUTE(experimental::TexturingVertex, position, 0),
+        make_attribute<std::array<f32, 2>>(2, offsetof(experimental::TexturingVertex, u)),
+    };
+};
+
+template <>
+struct VertexLayout<experimental::Vertex> {
+    static constexpr std::array attributes {
+        DK_VERTEX_ATTRIBUTE(experimental::Vertex, position, 0),
+        DK_VERTEX_ATTRIBUTE(experimental::Vertex, normal, 1),
+        make_attribute<std::array<f32, 2>>(2, offsetof(experimental::Vertex, u)),
+    };
+};
+
+template <>
+struct VertexLayout<Vertex> {
+    static constexpr std::array attributes {
+        DK_VERTEX_ATTRIBUTE(Vertex, position, 0),
+        make_attribute<std::array<f32, 2>>(2, offsetof(Vertex, u)),
+    };
+};
+
+// layouts read u and v together, as a vec2
+static_assert(offsetof(experimental::TexturingVertex, v) == offsetof(experimental::TexturingVertex, u) + sizeof(f32));
+static_assert(offsetof(experimental::Vertex, v) == offsetof(experimental::Vertex, u) + sizeof(f32));
+static_assert(offsetof(Vertex, v) == offsetof(Vertex, u) + sizeof(f32));
+
+/// @brief Enables and points the attributes of the vertex type into the
+/// vertex buffer, in the bound vertex array.
+template <DescribedVertex T>
+void bind_attributes(u32 vertex_buffer) {
+    const VertexStreamBinding stream { vertex_buffer, sizeof(T) };
+    set_attribute_pointers(VertexLayout<T>::attributes, std::span { &stream, 1 });
+}
+
+namespace detail {
+    /// @brief Buffer bound to GL_ARRAY_BUFFER, which the attribute pointers
+    /// of the deprecated setters read from.
+    inline u32 bound_array_buffer() {
+        i32 buffer = 0;
+        glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &buffer);
+        return static_cast<u32>(buffer);
+    }
+} // namespace detail
+
+/// @brief Points a tightly packed vec3 in the bound GL_ARRAY_BUFFER to the
+/// location.
+[[deprecated("use bind_attributes<VertexType>(vertex_buffer), which follows the vertex layout")]]
 inline void bind_attributes(u32 layout_idx) {
-    glVertexAttribPointer(layout_idx, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    const auto position = make_attribute<std::array<f32, 3>>(layout_idx, 0);
+    const VertexStreamBinding stream { detail::bound_array_buffer(), sizeof(std::array<f32, 3>) };
+    set_attribute_pointers(std::span { &position, 1 }, std::span { &stream, 1 });
 }
 
+namespace experimental {
+    /// @brief Points the attributes of experimental::Vertex in the bound
+    /// GL_ARRAY_BUFFER to the locations starting at layout_idx.
+    template <typename T>
+    [[deprecated("use bind_attributes<VertexType>(vertex_buffer), which follows the vertex layout")]]
+    inline void bind_attributes_v2(u32 layout_idx) {
+        auto attributes = VertexLayout<Vertex>::attributes;
+        for (auto &attribute : attributes) {
+            attribute.location += layout_idx;
+        }
+        const VertexStreamBinding stream { detail::bound_array_buffer(), sizeof(Vertex) };
+        set_attribute_pointers(attributes, std::span { &stream, 1 });
+    }
+} // namespace experimental
+
 } // namespace dk::gl
 
 #endif // DK_GL_VERTEX_HPP
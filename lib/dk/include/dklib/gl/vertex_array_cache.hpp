@@ -0,0 +1,71 @@
+#ifndef DK_OPENGL_VERTEX_ARRAY_CACHE_HPP
+#define DK_OPENGL_VERTEX_ARRAY_CACHE_HPP
+
+#include "buffer_object.hpp"
+#include "gltypes.hpp"
+#include "vertex.hpp"
+#include "vertex_format.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace dk::gl {
+
+/// @brief Vertex arrays of the current context, keyed by the vertex layout
+/// and the buffer ranges of its streams.
+///
+/// A vertex array is built once, with the attribute pointers of the layout
+/// and the element buffer, after that a draw needs only its bind. Meshes
+/// with the same layout and buffers share one. The cache does not own the
+/// vertex arrays, they are deleted with the last mesh using them.
+///
+/// Vertex arrays are not shared between contexts, so the cache is per
+/// thread, as is the StateCache.
+class VertexArrayCache {
+public:
+    /// @brief Cache of the context current on the calling thread.
+    static VertexArrayCache &get_instance();
+
+    VertexArrayCache() = default;
+
+    VertexArrayCache(const VertexArrayCache &other) = delete;
+    VertexArrayCache &operator=(const VertexArrayCache &other) = delete;
+
+    /// @brief Vertex array reading the attributes from their streams, with
+    /// the element buffer bound, built when there is none yet.
+    std::shared_ptr<const VertexArray> get(std::span<const VertexAttribute> attributes,
+                                           std::span<const VertexStreamBinding> streams, u32 element_buffer);
+
+    /// @brief Vertex array of interleaved vertices of the type.
+    template <DescribedVertex VertexType>
+    std::shared_ptr<const VertexArray> get(const VertexBuffer &vertices, const ElementBuffer &indices) {
+        const VertexStreamBinding stream { vertices.get_id(), sizeof(VertexType) };
+        return get(VertexLayout<VertexType>::attributes, std::span { &stream, 1 }, indices.get_id());
+    }
+
+    /// @brief Count of the vertex arrays still in use.
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    struct Key {
+        std::uint64_t layout;
+        std::vector<VertexStreamBinding> streams;
+        u32 element_buffer;
+
+        bool operator==(const Key &other) const noexcept = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key &key) const noexcept;
+    };
+
+    std::unordered_map<Key, std::weak_ptr<const VertexArray>, KeyHash> arrays_;
+};
+
+} // namespace dk::gl
+
+#endif // DK_OPENGL_VERTEX_ARRAY_CACHE_HPP
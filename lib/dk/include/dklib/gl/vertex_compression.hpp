@@ -0,0 +1,125 @@
+#ifndef DK_GL_VERTEX_COMPRESSION_HPP
+#define DK_GL_VERTEX_COMPRESSION_HPP
+
+#include <dklib/gl/gltypes.hpp>
+#include <dklib/gl/mesh.hpp>
+#include <dklib/gl/vertex.hpp>
+#include <dklib/gl/vertex_format.hpp>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <stdfloat>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dk::gl {
+
+/// @brief experimental::Vertex in 16 bytes instead of 32.
+///
+/// The position is snorm16 relative to the bounds of its mesh, the w
+/// component is always 1. The normal is octahedral encoded into two snorm16
+/// and the texture coordinates are half floats. A vertex shader decodes them
+/// as:
+///
+///     vec3 p = position.xyz * quantization_scale + quantization_offset;
+///     vec3 n = vec3(normal, 1.0 - abs(normal.x) - abs(normal.y));
+///     if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * sign(n.xy);
+///     n = normalize(n);
+struct CompressedVertex {
+    Normalized<i16, 4> position;
+    Normalized<i16, 2> normal;
+    Half uv[2];
+};
+static_assert(sizeof(CompressedVertex) == 16);
+
+template <>
+struct VertexLayout<CompressedVertex> {
+    static constexpr std::array attributes {
+        DK_VERTEX_ATTRIBUTE(CompressedVertex, position, 0),
+        DK_VERTEX_ATTRIBUTE(CompressedVertex, normal, 1),
+        DK_VERTEX_ATTRIBUTE(CompressedVertex, uv, 2),
+    };
+};
+
+/// @brief Maps the snorm16 positions back to the space of the mesh,
+/// position = snorm * scale + offset.
+struct VertexQuantization {
+    std::array<f32, 3> scale { 1.0f, 1.0f, 1.0f };
+    std::array<f32, 3> offset {};
+
+    /// @brief Quantization covering the bounding box, the offset is its
+    /// center and the scale is half of its extent.
+    static VertexQuantization from_bounds(const std::array<f32, 3> &min, const std::array<f32, 3> &max);
+};
+
+/// @brief Error of the decoded vertices against their fp32 source.
+struct CompressionError {
+    /// Distance in the units of the mesh
+    f32 max_position { 0.0f };
+    f32 mean_position { 0.0f };
+    /// Angle between the normals in degrees, zero normals are skipped
+    f32 max_normal_degrees { 0.0f };
+    f32 mean_normal_degrees { 0.0f };
+    /// Largest difference of a texture coordinate
+    f32 max_uv { 0.0f };
+    f32 mean_uv { 0.0f };
+};
+
+struct CompressedVertices {
+    std::vector<CompressedVertex> vertices;
+    VertexQuantization quantization;
+};
+
+template <typename IndexType>
+struct CompressedMeshData {
+    MeshData<CompressedVertex, IndexType> mesh;
+    VertexQuantization quantization;
+};
+
+/// @brief Quantizes the vertices, with the quantization of their bounds.
+CompressedVertices compress(std::span<const experimental::Vertex> vertices);
+
+/// @brief Quantizes the vertices with the provided quantization, e.g. one
+/// shared by several meshes, positions outside of it are clamped.
+std::vector<CompressedVertex> compress(std::span<const experimental::Vertex> vertices,
+                                       const VertexQuantization &quantization);
+
+std::vector<experimental::Vertex> decompress(std::span<const CompressedVertex> vertices,
+                                             const VertexQuantization &quantization);
+
+/// @brief Error of the compressed vertices, source and compressed vertices
+/// have to be of the same count.
+CompressionError measure_error(std::span<const experimental::Vertex> source, const CompressedVertices &compressed);
+
+/// @brief Compresses the vertices of the mesh at load, the indices are kept.
+template <typename IndexType>
+CompressedMeshData<IndexType> compress(MeshData<experimental::Vertex, IndexType> &&data) {
+    auto compressed = compress(std::span<const experimental::Vertex> { data.vertices });
+    return { { std::move(compressed.vertices), std::move(data.indices) }, compressed.quantization };
+}
+
+/// @brief Half float nearest to the value, ties to even, as F16C does.
+Half float_to_half(f32 value) noexcept;
+f32 half_to_float(Half value) noexcept;
+
+#ifdef __STDCPP_FLOAT16_T__
+inline std::float16_t to_float16(Half value) noexcept { return std::bit_cast<std::float16_t>(value.bits); }
+inline Half from_float16(std::float16_t value) noexcept { return { std::bit_cast<u16>(value) }; }
+#endif
+
+/// @brief Octahedral encoding of the direction, it does not have to be
+/// normalized.
+Normalized<i16, 2> encode_octahedral(f32 x, f32 y, f32 z) noexcept;
+/// @brief Normalized direction of the octahedral encoding.
+std::array<f32, 3> decode_octahedral(Normalized<i16, 2> encoded) noexcept;
+
+/// @brief Name of the instruction set used by the conversions (sse2+f16c,
+/// sse2 or scalar).
+std::string_view vertex_compression_instruction_set();
+
+} // namespace dk::gl
+
+#endif // DK_GL_VERTEX_COMPRESSION_HPP
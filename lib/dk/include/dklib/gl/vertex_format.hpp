@@ -0,0 +1,237 @@
+#ifndef DK_GL_VERTEX_FORMAT_HPP
+#define DK_GL_VERTEX_FORMAT_HPP
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdfloat>
+#include <type_traits>
+
+#include <GL/gl.h>
+#include <GLES3/gl3.h>
+
+#include <dklib/gl/gltypes.hpp>
+#include <dklib/math/vector3d.hpp>
+
+namespace dk::gl {
+
+/// @brief Description of a single vertex attribute, in the terms of
+/// glVertexAttribPointer.
+struct VertexAttribute {
+    u32 location;
+    i32 components;
+    enum32 type;
+    bool normalized;
+    u32 offset;
+    /// Vertex stream (buffer) the attribute is read from
+    u16 binding { 0 };
+    /// Read as an integer (int, uvec2, ...) by the shader, through
+    /// glVertexAttribIPointer, instead of being converted to float
+    bool integer { false };
+
+    bool operator==(const VertexAttribute &other) const noexcept = default;
+};
+
+/// @brief Integer components read as floats in [0, 1] (unsigned types) or
+/// [-1, 1] (signed types), e.g. Normalized<i16, 3> is a snorm16 vector.
+template <typename T, std::size_t N>
+struct Normalized {
+    std::array<T, N> values;
+};
+
+/// @brief Half float stored as its bits, GLhalf is the same type as u16, so
+/// a field of it would be taken for an integer.
+struct Half {
+    u16 bits;
+};
+
+/// @brief Signed normalized 10:10:10:2 vector (GL_INT_2_10_10_10_REV), x in
+/// the lowest bits.
+struct Packed1010102 {
+    u32 bits;
+};
+
+/// @brief Unsigned normalized 10:10:10:2 vector
+/// (GL_UNSIGNED_INT_2_10_10_10_REV), x in the lowest bits.
+struct UPacked1010102 {
+    u32 bits;
+};
+
+/// @brief GL type, component count and the way the shader reads a field of
+/// a vertex, specialized for every type a vertex field may have.
+template <typename T>
+struct AttributeFormat;
+
+namespace detail {
+    template <enum32 gl_type, i32 count, bool is_normalized = false, bool is_integer = false>
+    struct Format {
+        static constexpr enum32 type = gl_type;
+        static constexpr i32 components = count;
+        static constexpr bool normalized = is_normalized;
+        static constexpr bool integer = is_integer;
+    };
+
+    template <typename T>
+    struct ScalarType;
+    template <>
+    struct ScalarType<i8> : std::integral_constant<enum32, GL_BYTE> { };
+    template <>
+    struct ScalarType<u8> : std::integral_constant<enum32, GL_UNSIGNED_BYTE> { };
+    template <>
+    struct ScalarType<i16> : std::integral_constant<enum32, GL_SHORT> { };
+    template <>
+    struct ScalarType<u16> : std::integral_constant<enum32, GL_UNSIGNED_SHORT> { };
+    template <>
+    struct ScalarType<i32> : std::integral_constant<enum32, GL_INT> { };
+    template <>
+    struct ScalarType<u32> : std::integral_constant<enum32, GL_UNSIGNED_INT> { };
+    template <>
+    struct ScalarType<f32> : std::integral_constant<enum32, GL_FLOAT> { };
+    template <>
+    struct ScalarType<Half> : std::integral_constant<enum32, GL_HALF_FLOAT> { };
+#ifdef __STDCPP_FLOAT16_T__
+    template <>
+    struct ScalarType<std::float16_t> : std::integral_constant<enum32, GL_HALF_FLOAT> { };
+#endif
+
+    template <typename T>
+    concept IntegerScalar = std::is_integral_v<T> and requires { ScalarType<T>::value; };
+
+    template <typename T, i32 N>
+    struct VectorFormat : Format<ScalarType<T>::value, N, false, IntegerScalar<T>> { };
+} // namespace detail
+
+template <typename T>
+    requires requires { detail::ScalarType<T>::value; }
+struct AttributeFormat<T> : detail::VectorFormat<T, 1> { };
+
+template <typename T, std::size_t N>
+    requires requires { detail::ScalarType<T>::value; }
+struct AttributeFormat<T[N]> : detail::VectorFormat<T, static_cast<i32>(N)> { };
+
+template <typename T, std::size_t N>
+    requires requires { detail::ScalarType<T>::value; }
+struct AttributeFormat<std::array<T, N>> : detail::VectorFormat<T, static_cast<i32>(N)> { };
+
+template <>
+struct AttributeFormat<math::Vector3D> : detail::Format<GL_FLOAT, 3> { };
+
+template <detail::IntegerScalar T, std::size_t N>
+struct AttributeFormat<Normalized<T, N>> : detail::Format<detail::ScalarType<T>::value, static_cast<i32>(N), true> { };
+
+template <>
+struct AttributeFormat<Packed1010102> : detail::Format<GL_INT_2_10_10_10_REV, 4, true> { };
+
+template <>
+struct AttributeFormat<UPacked1010102> : detail::Format<GL_UNSIGNED_INT_2_10_10_10_REV, 4, true> { };
+
+template <typename T>
+concept AttributeField = requires {
+    AttributeFormat<T>::type;
+    AttributeFormat<T>::components;
+};
+
+/// @brief Attribute of a vertex field of the type, stored at the offset of
+/// the vertex.
+template <AttributeField Field>
+constexpr VertexAttribute make_attribute(u32 location, std::size_t offset, u16 binding = 0) {
+    using Format = AttributeFormat<Field>;
+    return { location, Format::components, Format::type, Format::normalized, static_cast<u32>(offset),
+             binding,  Format::integer };
+}
+
+/// @brief Attribute of the field of the vertex struct, its format and offset
+/// are taken from the declaration of the field.
+#define DK_VERTEX_ATTRIBUTE(VertexType, field, location)                                                               \
+    ::dk::gl::make_attribute<decltype(VertexType::field)>(location, offsetof(VertexType, field))
+
+/// @brief Attributes of a vertex type, specialized for each type that is
+/// stored in a Mesh, usually with DK_VERTEX_ATTRIBUTE:
+///
+///     template <>
+///     struct VertexLayout<MyVertex> {
+///         static constexpr std::array attributes {
+///             DK_VERTEX_ATTRIBUTE(MyVertex, position, 0),
+///             DK_VERTEX_ATTRIBUTE(MyVertex, normal, 1),
+///         };
+///     };
+///
+/// A vertex that is a single field (math::Vector3D, std::array<f32, 2>,
+/// Normalized<i16, 4>, ...) has the layout of that field at location 0.
+template <typename T>
+struct VertexLayout;
+
+template <AttributeField T>
+struct VertexLayout<T> {
+    static constexpr std::array attributes { make_attribute<T>(0, 0) };
+};
+
+template <typename T>
+concept DescribedVertex = requires { VertexLayout<T>::attributes; };
+
+/// @brief Stream of a structure of arrays, every vertex of it is a single
+/// field read at the location.
+template <u32 location, AttributeField Field>
+struct AttributeStream {
+    Field value;
+};
+
+template <u32 location, AttributeField Field>
+struct VertexLayout<AttributeStream<location, Field>> {
+    static constexpr std::array attributes { make_attribute<Field>(location, 0) };
+};
+
+/// @brief Layout of vertices split into several streams, each of them in its
+/// own buffer or its own range of one.
+///
+/// Streams are vertex types with a layout, attributes of the i-th one are
+/// read from the binding i. Split streams keep e.g. the positions apart for
+/// the depth pass, streams of AttributeStream are a structure of arrays:
+///
+///     using SoA = StreamLayout<AttributeStream<0, math::Vector3D>,
+///                              AttributeStream<1, Normalized<i16, 4>>>;
+template <DescribedVertex... Streams>
+struct StreamLayout {
+    static constexpr std::size_t stream_count = sizeof...(Streams);
+    static constexpr std::array<u32, stream_count> strides { static_cast<u32>(sizeof(Streams))... };
+
+private:
+    static constexpr std::size_t attribute_count = (VertexLayout<Streams>::attributes.size() + ...);
+
+    static constexpr std::array<VertexAttribute, attribute_count> collect() {
+        std::array<VertexAttribute, attribute_count> all {};
+        std::size_t next = 0;
+        u16 binding = 0;
+        const auto append = [&](const auto &attributes) {
+            for (auto attribute : attributes) {
+                attribute.binding = binding;
+                all[next++] = attribute;
+            }
+            ++binding;
+        };
+        (append(VertexLayout<Streams>::attributes), ...);
+        return all;
+    }
+
+public:
+    static constexpr std::array<VertexAttribute, attribute_count> attributes = collect();
+};
+
+/// @brief Buffer range a vertex stream is read from.
+struct VertexStreamBinding {
+    u32 buffer;
+    u32 stride;
+    /// Offset of the first vertex in the buffer, in bytes
+    std::size_t offset { 0 };
+
+    bool operator==(const VertexStreamBinding &other) const noexcept = default;
+};
+
+/// @brief Enables the attributes in the bound vertex array and points each
+/// of them to the buffer of its stream, integer attributes through
+/// glVertexAttribIPointer.
+void set_attribute_pointers(std::span<const VertexAttribute> attributes, std::span<const VertexStreamBinding> streams);
+
+} // namespace dk::gl
+
+#endif // DK_GL_VERTEX_FORMAT_HPP
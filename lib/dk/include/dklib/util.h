@@ -1,8 +1,12 @@
 #ifndef DK_UTIL_H
 #define DK_UTIL_H
 
+#include "util/arena.hpp"
+#include "util/flat_hash_map.hpp"
+#include "util/hash.hpp"
 #include "util/opengl_util.hpp"
 #include "util/string_util.hpp"
+#include "util/thread_pool.hpp"
 #include "util/variant_util.hpp"
 
 #endif // DK_UTIL_H
@@ -0,0 +1,52 @@
+#ifndef DK_ARENA_HPP
+#define DK_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace dk::util {
+
+/// @brief Bump allocator handing out memory from big blocks.
+///
+/// Allocations are never freed one by one, everything is released at once by
+/// clear() or by the destructor. Blocks do not move, so the returned memory
+/// stays valid until then. Allocations bigger than a block get a block of
+/// their own.
+class Arena {
+public:
+    explicit Arena(std::size_t block_size = 64 * 1024)
+        : block_size_(block_size) { }
+
+    Arena(const Arena &other) = delete;
+    Arena &operator=(const Arena &other) = delete;
+    /// @brief Takes over the blocks, the other arena is left empty.
+    Arena(Arena &&other) noexcept;
+    Arena &operator=(Arena &&other) noexcept;
+
+    [[nodiscard]] std::span<std::byte> allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    /// @brief Copies the text into the arena, followed by a null character.
+    [[nodiscard]] std::string_view store(std::string_view text);
+
+    void clear() noexcept;
+
+    /// @brief Count of bytes handed out since the last clear.
+    [[nodiscard]] std::size_t used() const noexcept { return used_; }
+    /// @brief Count of bytes allocated in all of the blocks.
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+    std::size_t block_size_;
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    std::byte *cursor_ { nullptr };
+    std::size_t remaining_ { 0 };
+    std::size_t used_ { 0 };
+    std::size_t capacity_ { 0 };
+};
+
+} // namespace dk::util
+
+#endif // DK_ARENA_HPP
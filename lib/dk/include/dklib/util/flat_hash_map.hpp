@@ -0,0 +1,196 @@
+#ifndef DK_FLAT_HASH_MAP_HPP
+#define DK_FLAT_HASH_MAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace dk::util {
+
+/// @brief Finalizer of MurmurHash3, spreads all input bits over the result.
+constexpr std::uint64_t mix_hash(std::uint64_t value) noexcept {
+    value ^= value >> 33U;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33U;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33U;
+    return value;
+}
+
+/// @brief Hash map with open addressing and linear probing.
+///
+/// Keys and values are stored inline in a single array, next to a byte per
+/// slot that holds 7 bits of the hash. Lookups thus touch one or two cache
+/// lines instead of chasing tree or list nodes, and inserting does not
+/// allocate unless the map has to grow. Erasing uses backward shifting, so
+/// there are no tombstones.
+///
+/// Both Key and Value have to be default constructible. References and
+/// pointers to values are invalidated when the map grows.
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+public:
+    FlatHashMap() = default;
+    explicit FlatHashMap(std::size_t expected_size) { reserve(expected_size); }
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return slots_.size(); }
+
+    /// @brief Count of bytes allocated by the map.
+    [[nodiscard]] std::size_t memory_usage() const noexcept {
+        return slots_.capacity() * sizeof(Slot) + control_.capacity() * sizeof(std::uint8_t);
+    }
+
+    /// @brief Makes room for expected_size elements without growing.
+    void reserve(std::size_t expected_size) {
+        const std::size_t required = std::bit_ceil(expected_size + expected_size / 3 + 1);
+        if (required > capacity()) {
+            rehash(std::max<std::size_t>(required, MIN_CAPACITY));
+        }
+    }
+
+    void clear() noexcept {
+        std::fill(control_.begin(), control_.end(), EMPTY);
+        size_ = 0;
+    }
+
+    [[nodiscard]] Value *find(const Key &key) noexcept {
+        return const_cast<Value *>(std::as_const(*this).find(key));
+    }
+
+    [[nodiscard]] const Value *find(const Key &key) const noexcept {
+        if (size_ == 0) {
+            return nullptr;
+        }
+        const std::uint64_t hash = hash_of(key);
+        for (std::size_t idx = home_of(hash);; idx = next(idx)) {
+            if (control_[idx] == EMPTY) {
+                return nullptr;
+            }
+            if (control_[idx] == tag_of(hash) and equal_(slots_[idx].key, key)) {
+                return &slots_[idx].value;
+            }
+        }
+    }
+
+    [[nodiscard]] bool contains(const Key &key) const noexcept { return find(key) != nullptr; }
+
+    /// @brief Inserts a value constructed from args, unless the key is
+    /// already present.
+    ///
+    /// @return Pointer to the value stored under the key and whether it was
+    /// inserted.
+    template <typename... Args>
+    std::pair<Value *, bool> try_emplace(const Key &key, Args &&...args) {
+        if ((size_ + 1) * 4 > capacity() * 3) {
+            rehash(std::max<std::size_t>(capacity() * 2, MIN_CAPACITY));
+        }
+        const std::uint64_t hash = hash_of(key);
+        std::size_t idx = home_of(hash);
+        for (; control_[idx] != EMPTY; idx = next(idx)) {
+            if (control_[idx] == tag_of(hash) and equal_(slots_[idx].key, key)) {
+                return { &slots_[idx].value, false };
+            }
+        }
+        control_[idx] = tag_of(hash);
+        slots_[idx].key = key;
+        slots_[idx].value = Value(std::forward<Args>(args)...);
+        ++size_;
+        return { &slots_[idx].value, true };
+    }
+
+    bool erase(const Key &key) {
+        if (size_ == 0) {
+            return false;
+        }
+        const std::uint64_t hash = hash_of(key);
+        std::size_t idx = home_of(hash);
+        for (;; idx = next(idx)) {
+            if (control_[idx] == EMPTY) {
+                return false;
+            }
+            if (control_[idx] == tag_of(hash) and equal_(slots_[idx].key, key)) {
+                break;
+            }
+        }
+        // Backward shift of the following elements of the probe sequence,
+        // so that no element becomes unreachable.
+        std::size_t hole = idx;
+        for (std::size_t current = next(idx); control_[current] != EMPTY; current = next(current)) {
+            const std::size_t home = home_of(hash_of(slots_[current].key));
+            if (((current - home) & mask()) >= ((current - hole) & mask())) {
+                control_[hole] = control_[current];
+                slots_[hole] = std::move(slots_[current]);
+                hole = current;
+            }
+        }
+        control_[hole] = EMPTY;
+        --size_;
+        return true;
+    }
+
+    /// @brief Calls function(key, value) for every element, in unspecified
+    /// order.
+    template <typename Function>
+    void for_each(Function &&function) const {
+        for (std::size_t idx = 0; idx < capacity(); ++idx) {
+            if (control_[idx] != EMPTY) {
+                function(slots_[idx].key, slots_[idx].value);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        Key key {};
+        Value value {};
+    };
+
+    static constexpr std::uint8_t EMPTY = 0;
+    static constexpr std::size_t MIN_CAPACITY = 16;
+
+    [[nodiscard]] std::uint64_t hash_of(const Key &key) const noexcept {
+        return mix_hash(static_cast<std::uint64_t>(hasher_(key)));
+    }
+    [[nodiscard]] std::size_t mask() const noexcept { return capacity() - 1; }
+    [[nodiscard]] std::size_t home_of(std::uint64_t hash) const noexcept { return hash & mask(); }
+    [[nodiscard]] std::size_t next(std::size_t idx) const noexcept { return (idx + 1) & mask(); }
+    /// Top 7 bits of the hash, with the highest bit set to distinguish it
+    /// from an empty slot.
+    static std::uint8_t tag_of(std::uint64_t hash) noexcept {
+        return static_cast<std::uint8_t>((hash >> 57U) | 0x80U);
+    }
+
+    void rehash(std::size_t new_capacity) {
+        std::vector<Slot> old_slots(new_capacity);
+        std::vector<std::uint8_t> old_control(new_capacity, EMPTY);
+        std::swap(old_slots, slots_);
+        std::swap(old_control, control_);
+        for (std::size_t idx = 0; idx < old_slots.size(); ++idx) {
+            if (old_control[idx] == EMPTY) {
+                continue;
+            }
+            std::size_t target = home_of(hash_of(old_slots[idx].key));
+            while (control_[target] != EMPTY) {
+                target = next(target);
+            }
+            control_[target] = old_control[idx];
+            slots_[target] = std::move(old_slots[idx]);
+        }
+    }
+
+    std::vector<Slot> slots_;
+    std::vector<std::uint8_t> control_;
+    std::size_t size_ { 0 };
+    [[no_unique_address]] Hash hasher_ {};
+    [[no_unique_address]] KeyEqual equal_ {};
+};
+
+} // namespace dk::util
+
+#endif // DK_FLAT_HASH_MAP_HPP
@@ -0,0 +1,34 @@
+#ifndef DK_HASH_HPP
+#define DK_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace dk::util {
+
+inline constexpr std::uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+inline constexpr std::uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+/// @brief 64 bit FNV-1a hash of the text, usable at compile time.
+constexpr std::uint64_t fnv1a(std::string_view text, std::uint64_t hash = FNV_OFFSET_BASIS) noexcept {
+    for (const char c : text) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/// @brief 64 bit FNV-1a hash of the bytes.
+constexpr std::uint64_t fnv1a(std::span<const std::byte> bytes, std::uint64_t hash = FNV_OFFSET_BASIS) noexcept {
+    for (const std::byte b : bytes) {
+        hash ^= static_cast<std::uint8_t>(b);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+} // namespace dk::util
+
+#endif // DK_HASH_HPP
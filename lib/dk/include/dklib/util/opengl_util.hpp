@@ -6,6 +6,7 @@
 #include <GLES3/gl3.h>
 #include <spdlog/spdlog.h>
 #include <string>
+#include <string_view>
 
 #define DECLARE_MAIN(AppType)                                                  \
     int main([[maybe_unused]] int argc, [[maybe_unused]] const char *argv[]) { \
@@ -16,6 +17,9 @@
 
 namespace dk::util {
 std::string get_shader_error_msg(gl::u32 shader_descriptor);
+std::string get_program_error_msg(gl::u32 program_descriptor);
+/// @brief Whether the current context supports the extension.
+bool has_extension(std::string_view name);
 } // namespace dk::util
 
 #endif // DK_OPENGL_UTIL_HPP
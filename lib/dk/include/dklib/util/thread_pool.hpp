@@ -0,0 +1,100 @@
+#ifndef DK_THREAD_POOL_HPP
+#define DK_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dk::util {
+
+/// @brief Fixed size pool of worker threads processing a shared task queue.
+///
+/// Tasks are started in the order in which they were submitted, but they may
+/// finish in any order, thus callers that need deterministic results have to
+/// write them into preallocated slots.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t thread_count = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// @brief Pool shared by the library loaders, sized to the hardware.
+    static ThreadPool &get_instance();
+
+    [[nodiscard]] std::size_t size() const noexcept { return workers_.size(); }
+
+    /// @brief Whether the calling thread is one of the workers of the pool.
+    [[nodiscard]] bool is_worker() const noexcept;
+
+    template <typename Function>
+    std::future<std::invoke_result_t<Function>> submit(Function &&function) {
+        using Result = std::invoke_result_t<Function>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        auto future = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    /// @brief Calls function(begin, end) on consecutive ranges covering
+    /// [0, count) and waits until all of them finish.
+    ///
+    /// The first exception thrown by the ranges is rethrown to the caller,
+    /// once all of them finished. Called from a worker of the pool, the
+    /// ranges run inline, as waiting for the other workers could deadlock.
+    template <typename Function>
+    void parallel_for(std::size_t count, Function &&function, std::size_t min_range = 1) {
+        if (is_worker()) {
+            if (count > 0) {
+                function(std::size_t { 0 }, count);
+            }
+            return;
+        }
+        const std::size_t ranges = std::clamp<std::size_t>(count / std::max<std::size_t>(min_range, 1), 1, size());
+        const std::size_t step = (count + ranges - 1) / ranges;
+        std::vector<std::future<void>> pending;
+        pending.reserve(ranges);
+        for (std::size_t begin = 0; begin < count; begin += step) {
+            const std::size_t end = std::min(begin + step, count);
+            pending.push_back(submit([&function, begin, end]() { function(begin, end); }));
+        }
+        // the ranges reference the function and the stack of the caller,
+        // they all have to finish before anything is rethrown
+        std::exception_ptr first_exception;
+        for (auto &result : pending) {
+            try {
+                result.get();
+            } catch (...) {
+                if (not first_exception) {
+                    first_exception = std::current_exception();
+                }
+            }
+        }
+        if (first_exception) {
+            std::rethrow_exception(first_exception);
+        }
+    }
+
+private:
+    void enqueue(std::function<void()> &&task);
+    void worker_loop(std::stop_token stop_token);
+
+    std::mutex mutex_;
+    std::condition_variable_any condition_;
+    std::queue<std::function<void()>> tasks_;
+    std::vector<std::jthread> workers_;
+};
+
+} // namespace dk::util
+
+#endif // DK_THREAD_POOL_HPP
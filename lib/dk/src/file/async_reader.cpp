@@ -0,0 +1,514 @@
+#include <dklib/file/async_reader.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define DK_HAS_IO_URING 1
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace dk::file {
+namespace {
+    /// Largest single read, bigger files are read in more steps
+    constexpr std::size_t MAX_READ_SIZE = 64 << 20;
+    /// User data of the request waking up the completion thread
+    constexpr std::uint64_t WAKE_UP = 0;
+
+    std::error_code last_error() { return { errno, std::system_category() }; }
+} // namespace
+
+struct AsyncReader::Request {
+    std::filesystem::path path;
+    ReadCallback callback;
+    int fd { -1 };
+    bool is_regular { true };
+    std::vector<std::byte> buffer;
+    std::size_t done { 0 };
+    std::error_code error;
+};
+
+#if defined(DK_HAS_IO_URING)
+/// Submission and completion queues shared with the kernel.
+///
+/// Pushing to the submission queue is guarded by the mutex, completions are
+/// consumed only by the completion thread.
+class AsyncReader::Ring {
+public:
+    static std::unique_ptr<Ring> create(unsigned entries) {
+        io_uring_params params {};
+        const int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            spdlog::info("io_uring is not available: {}", std::strerror(errno));
+            return nullptr;
+        }
+        auto ring = std::unique_ptr<Ring>(new Ring(fd, params));
+        if (not ring->is_valid()) {
+            spdlog::info("io_uring queues could not be mapped: {}", std::strerror(errno));
+            return nullptr;
+        }
+        return ring;
+    }
+
+    ~Ring() {
+        if (sqes_ != MAP_FAILED) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != MAP_FAILED and cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != MAP_FAILED) {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        ::close(fd_);
+    }
+
+    Ring(const Ring &other) = delete;
+    Ring &operator=(const Ring &other) = delete;
+
+    /// @brief Queues the read without submitting it, mutex has to be held.
+    /// @return false when the queue is full
+    bool push_read(Request &request) {
+        io_uring_sqe *sqe = next_sqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        const std::size_t length = std::min(request.buffer.size() - request.done, MAX_READ_SIZE);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = request.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(request.buffer.data() + request.done);
+        sqe->len = static_cast<std::uint32_t>(length);
+        sqe->off = request.done;
+        sqe->user_data = reinterpret_cast<std::uint64_t>(&request);
+        return true;
+    }
+
+    /// @brief Queues a no-op, mutex has to be held.
+    bool push_nop(std::uint64_t user_data) {
+        io_uring_sqe *sqe = next_sqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    /// @brief Hands all of the queued requests to the kernel, mutex has to be
+    /// held.
+    void submit() {
+        while (unsubmitted_ != 0) {
+            const auto count = ::syscall(__NR_io_uring_enter, fd_, unsubmitted_, 0, 0, nullptr, 0);
+            if (count < 0) {
+                if (errno == EINTR or errno == EAGAIN or errno == EBUSY) {
+                    continue;
+                }
+                spdlog::error("io_uring submission failed: {}", std::strerror(errno));
+                throw std::system_error(last_error(), "io_uring_enter");
+            }
+            unsubmitted_ -= static_cast<unsigned>(count);
+        }
+    }
+
+    /// @brief Takes the queued entries the kernel did not consume out of the
+    /// queue again, after a failed submit, mutex has to be held.
+    /// @return user data of the entries
+    std::vector<std::uint64_t> take_back_unsubmitted() {
+        std::vector<std::uint64_t> user_data;
+        unsigned tail = *sq_tail_;
+        for (; unsubmitted_ != 0; --unsubmitted_) {
+            --tail;
+            user_data.push_back(static_cast<const io_uring_sqe *>(sqes_)[sq_array_[tail & sq_mask_]].user_data);
+        }
+        std::atomic_ref(*sq_tail_).store(tail, std::memory_order_release);
+        return user_data;
+    }
+
+    /// @brief Waits for at least one completion and passes all of the
+    /// available ones to the function.
+    template <typename Function>
+    void consume(Function &&on_completion) {
+        while (::syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) {
+            if (errno != EINTR) {
+                spdlog::error("io_uring wait failed: {}", std::strerror(errno));
+                throw std::system_error(last_error(), "io_uring_enter");
+            }
+        }
+        unsigned head = std::atomic_ref(*cq_head_).load(std::memory_order_relaxed);
+        const unsigned tail = std::atomic_ref(*cq_tail_).load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+            on_completion(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref(*cq_head_).store(head, std::memory_order_release);
+    }
+
+    std::mutex mutex;
+
+private:
+    Ring(int fd, const io_uring_params &params)
+        : fd_(fd) {
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool is_single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (is_single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                          IORING_OFF_SQ_RING);
+        cq_ring_ = is_single_mmap ? sq_ring_
+                                  : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                           fd, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (not is_valid()) {
+            return;
+        }
+
+        auto *sq = static_cast<std::byte *>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+        auto *cq = static_cast<std::byte *>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    [[nodiscard]] bool is_valid() const noexcept {
+        return sq_ring_ != MAP_FAILED and cq_ring_ != MAP_FAILED and sqes_ != MAP_FAILED;
+    }
+
+    io_uring_sqe *next_sqe() {
+        const unsigned head = std::atomic_ref(*sq_head_).load(std::memory_order_acquire);
+        const unsigned tail = *sq_tail_;
+        if (tail - head >= sq_entries_) {
+            return nullptr;
+        }
+        const unsigned index = tail & sq_mask_;
+        auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        sq_array_[index] = index;
+        std::atomic_ref(*sq_tail_).store(tail + 1, std::memory_order_release);
+        ++unsubmitted_;
+        return sqe;
+    }
+
+    int fd_;
+    void *sq_ring_ { MAP_FAILED };
+    void *cq_ring_ { MAP_FAILED };
+    void *sqes_ { MAP_FAILED };
+    std::size_t sq_ring_size_ { 0 };
+    std::size_t cq_ring_size_ { 0 };
+    std::size_t sqes_size_ { 0 };
+
+    unsigned *sq_head_ { nullptr };
+    unsigned *sq_tail_ { nullptr };
+    unsigned *sq_array_ { nullptr };
+    unsigned sq_mask_ { 0 };
+    unsigned sq_entries_ { 0 };
+    unsigned unsubmitted_ { 0 };
+
+    unsigned *cq_head_ { nullptr };
+    unsigned *cq_tail_ { nullptr };
+    unsigned cq_mask_ { 0 };
+    io_uring_cqe *cqes_ { nullptr };
+};
+#else
+class AsyncReader::Ring {
+public:
+    static std::unique_ptr<Ring> create(unsigned) { return nullptr; }
+};
+#endif
+
+AsyncReader::AsyncReader(std::size_t queue_depth, Backend preferred)
+    : backend_(preferred)
+    , queue_depth_(std::max<std::size_t>(queue_depth, 1)) {
+    if (backend_ == Backend::IO_URING) {
+        ring_ = Ring::create(static_cast<unsigned>(queue_depth_));
+        if (ring_ == nullptr) {
+            backend_ = Backend::THREAD_POOL;
+        }
+    }
+    if (backend_ == Backend::IO_URING) {
+        completion_thread_ = std::thread([this]() { completion_loop(); });
+    } else {
+        pool_ = std::make_unique<util::ThreadPool>(queue_depth_);
+    }
+}
+
+AsyncReader::~AsyncReader() {
+    wait();
+#if defined(DK_HAS_IO_URING)
+    if (completion_thread_.joinable()) {
+        is_stopping_ = true;
+        {
+            const std::lock_guard lock(ring_->mutex);
+            ring_->push_nop(WAKE_UP);
+            ring_->submit();
+        }
+        completion_thread_.join();
+    }
+#endif
+    // Workers may still be returning from complete(), they have to be gone
+    // before the mutex and the condition are destroyed
+    pool_.reset();
+}
+
+void AsyncReader::read(const std::filesystem::path &filepath, ReadCallback callback) {
+    submit(std::span { &filepath, 1 }, callback);
+}
+
+std::future<std::vector<std::byte>> AsyncReader::read(const std::filesystem::path &filepath) {
+    auto promise = std::make_shared<std::promise<std::vector<std::byte>>>();
+    auto future = promise->get_future();
+    read(filepath, [promise](ReadResult &&result) {
+        if (result.error) {
+            promise->set_exception(
+                std::make_exception_ptr(std::system_error(result.error, "could not read " + result.path.string()))
+            );
+        } else {
+            promise->set_value(std::move(result.bytes));
+        }
+    });
+    return future;
+}
+
+void AsyncReader::read_all(std::span<const std::filesystem::path> filepaths, const ReadCallback &callback) {
+    submit(filepaths, callback);
+}
+
+void AsyncReader::wait() {
+    std::unique_lock lock(mutex_);
+    condition_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+void AsyncReader::submit(std::span<const std::filesystem::path> filepaths, const ReadCallback &callback) {
+    std::vector<std::unique_ptr<Request>> batch;
+    batch.reserve(std::min(filepaths.size(), queue_depth_));
+
+    // Queued requests are handed over to the kernel (or the pool) at once,
+    // when the batch is full or the queue depth is reached.
+    const auto flush = [this, &batch]() {
+        if (batch.empty()) {
+            return;
+        }
+#if defined(DK_HAS_IO_URING)
+        if (backend_ == Backend::IO_URING) {
+            std::vector<std::unique_ptr<Request>> rejected;
+            {
+                const std::lock_guard lock(ring_->mutex);
+                for (auto &request : batch) {
+                    // queue has room for every request in flight
+                    ring_->push_read(*request);
+                }
+                std::error_code error;
+                std::vector<std::uint64_t> unsubmitted;
+                try {
+                    ring_->submit();
+                } catch (const std::system_error &e) {
+                    error = e.code();
+                    unsubmitted = ring_->take_back_unsubmitted();
+                }
+                // requests taken by the kernel belong to the completion
+                // thread from now on, the others are failed here
+                for (auto &request : batch) {
+                    if (std::ranges::find(unsubmitted, reinterpret_cast<std::uint64_t>(request.get()))
+                        == unsubmitted.end()) {
+                        static_cast<void>(request.release());
+                    } else {
+                        request->error = error;
+                        rejected.push_back(std::move(request));
+                    }
+                }
+            }
+            batch.clear();
+            for (auto &request : rejected) {
+                complete(std::move(request));
+            }
+            return;
+        }
+#endif
+        for (auto &request : batch) {
+            pool_->submit([this, request = std::move(request)]() mutable {
+                try {
+                    read_with_pread(*request);
+                } catch (const std::exception &e) {
+                    spdlog::error("read of {} failed: {}", request->path.string(), e.what());
+                    request->error = std::make_error_code(std::errc::not_enough_memory);
+                }
+                complete(std::move(request));
+            });
+        }
+        batch.clear();
+    };
+
+    for (const auto &filepath : filepaths) {
+        {
+            std::unique_lock lock(mutex_);
+            if (pending_ >= queue_depth_) {
+                // the batch has to be on its way before waiting for it
+                lock.unlock();
+                flush();
+                lock.lock();
+            }
+            condition_.wait(lock, [this]() { return pending_ < queue_depth_; });
+            ++pending_;
+        }
+
+        auto request = std::make_unique<Request>();
+        request->path = filepath;
+        request->callback = callback;
+        request->fd = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info {};
+        if (request->fd < 0 or ::fstat(request->fd, &info) != 0) {
+            request->error = last_error();
+            complete(std::move(request));
+            continue;
+        }
+        request->is_regular = S_ISREG(info.st_mode);
+        request->buffer.resize(static_cast<std::size_t>(info.st_size));
+        if (request->is_regular and request->buffer.empty()) {
+            complete(std::move(request));
+        } else if (backend_ == Backend::IO_URING and not request->is_regular) {
+            // size of pipes is not known up front, they are read right away
+            read_with_pread(*request);
+            complete(std::move(request));
+        } else {
+            batch.push_back(std::move(request));
+        }
+    }
+    flush();
+}
+
+void AsyncReader::complete(std::unique_ptr<Request> request) {
+    if (request->fd >= 0) {
+        ::close(request->fd);
+    }
+    if (request->error) {
+        spdlog::error("file: {} could not be read: {}", request->path.string(), request->error.message());
+        request->buffer.clear();
+    }
+    try {
+        request->callback({ std::move(request->path), std::move(request->buffer), request->error });
+    } catch (const std::exception &e) {
+        spdlog::error("read callback failed: {}", e.what());
+    } catch (...) {
+        spdlog::error("read callback failed with an unknown exception");
+    }
+    const std::lock_guard lock(mutex_);
+    --pending_;
+    // Notified under the lock, the destructor may destroy the condition as
+    // soon as it sees no pending reads
+    condition_.notify_all();
+}
+
+void AsyncReader::completion_loop() {
+#if defined(DK_HAS_IO_URING)
+    bool is_woken_up = false;
+    while (not is_woken_up) {
+        std::vector<Request *> unfinished;
+        ring_->consume([&](std::uint64_t user_data, int result) {
+            if (user_data == WAKE_UP) {
+                is_woken_up = is_stopping_;
+                return;
+            }
+            auto *request = reinterpret_cast<Request *>(user_data);
+            if (result == -EINTR or result == -EAGAIN) {
+                unfinished.push_back(request);
+            } else if (result < 0) {
+                request->error = { -result, std::system_category() };
+                complete(std::unique_ptr<Request>(request));
+            } else if (result == 0) {
+                // file got shorter since it was opened
+                request->buffer.resize(request->done);
+                complete(std::unique_ptr<Request>(request));
+            } else {
+                request->done += static_cast<std::size_t>(result);
+                if (request->done < request->buffer.size()) {
+                    unfinished.push_back(request);
+                } else {
+                    complete(std::unique_ptr<Request>(request));
+                }
+            }
+        });
+        if (not unfinished.empty()) {
+            std::error_code error;
+            std::vector<std::uint64_t> unsubmitted;
+            {
+                const std::lock_guard lock(ring_->mutex);
+                for (auto *request : unfinished) {
+                    ring_->push_read(*request);
+                }
+                try {
+                    ring_->submit();
+                } catch (const std::system_error &e) {
+                    error = e.code();
+                    unsubmitted = ring_->take_back_unsubmitted();
+                }
+            }
+            for (const auto user_data : unsubmitted) {
+                auto *request = reinterpret_cast<Request *>(user_data);
+                request->error = error;
+                complete(std::unique_ptr<Request>(request));
+            }
+        }
+    }
+#endif
+}
+
+void AsyncReader::read_with_pread(Request &request) {
+    if (not request.is_regular) {
+        // size is unknown, read until the end of the stream
+        constexpr std::size_t read_size = 64 * 1024;
+        while (true) {
+            request.buffer.resize(request.done + read_size);
+            const ::ssize_t count = ::read(request.fd, request.buffer.data() + request.done, read_size);
+            if (count < 0 and errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                request.error = count < 0 ? last_error() : std::error_code {};
+                break;
+            }
+            request.done += static_cast<std::size_t>(count);
+        }
+        request.buffer.resize(request.done);
+        return;
+    }
+
+    while (request.done < request.buffer.size()) {
+        const ::ssize_t count = ::pread(
+            request.fd, request.buffer.data() + request.done, request.buffer.size() - request.done,
+            static_cast<off_t>(request.done)
+        );
+        if (count < 0 and errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            request.error = last_error();
+            return;
+        }
+        if (count == 0) {
+            request.buffer.resize(request.done);
+            return;
+        }
+        request.done += static_cast<std::size_t>(count);
+    }
+}
+
+} // namespace dk::file
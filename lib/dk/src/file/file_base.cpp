@@ -1,5 +1,16 @@
 #include <dklib/file/file_base.hpp>
 
+#include <spdlog/spdlog.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <stdexcept>
+#include <utility>
+
 namespace dk {
 // void File::open() { file_.open(filename_); }
 //
@@ -24,4 +35,133 @@ namespace dk {
 //
 // bool File::eof() const { }
 //
+
+namespace file {
+    namespace {
+        int to_advice(AccessPattern access) {
+            switch (access) {
+            case AccessPattern::SEQUENTIAL:
+                return MADV_SEQUENTIAL;
+            case AccessPattern::RANDOM:
+                return MADV_RANDOM;
+            default:
+                return MADV_NORMAL;
+            }
+        }
+
+        constexpr std::size_t HUGE_PAGE_SIZE = 2 << 20;
+    } // namespace
+
+    MappedFile::MappedFile(const std::filesystem::path &filepath, const MappingOptions &options) {
+        const int fd = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            spdlog::error("file: {} could not be opened", filepath.string());
+            throw std::runtime_error("could not open the file");
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            spdlog::error("file: {} could not be inspected", filepath.string());
+            throw std::runtime_error("could not stat the file");
+        }
+        if (not S_ISREG(info.st_mode) or info.st_size == 0) {
+            // pipes and devices can not be mapped, pseudo files (/proc, sysfs)
+            // report no size even though they have contents
+            read_into_buffer(fd, filepath);
+            return;
+        }
+
+        size_ = static_cast<std::size_t>(info.st_size);
+        void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED and (errno == ENODEV or errno == EINVAL)) {
+            // file system does not support mapping
+            size_ = 0;
+            read_into_buffer(fd, filepath);
+            return;
+        }
+        // Mapping stays valid after the descriptor is closed
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            spdlog::error("file: {} could not be mapped", filepath.string());
+            throw std::runtime_error("could not map the file");
+        }
+        data_ = mapping;
+        is_mapped_ = true;
+
+        if (options.access != AccessPattern::NORMAL) {
+            advise(options.access);
+        }
+#if defined(MADV_HUGEPAGE)
+        if (options.is_huge_page_allowed and size_ >= HUGE_PAGE_SIZE) {
+            if (::madvise(mapping, size_, MADV_HUGEPAGE) != 0) {
+                spdlog::debug("file: {} can not use huge pages", filepath.string());
+            }
+        }
+#endif
+    }
+
+    MappedFile::~MappedFile() { unmap(); }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , buffer_(std::move(other.buffer_))
+        , is_mapped_(std::exchange(other.is_mapped_, false)) { }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            buffer_ = std::move(other.buffer_);
+            is_mapped_ = std::exchange(other.is_mapped_, false);
+        }
+        return *this;
+    }
+
+    void MappedFile::advise(AccessPattern access, std::size_t offset, std::size_t length) const noexcept {
+        if (not is_mapped_ or offset >= size_) {
+            return;
+        }
+        // madvise needs a page aligned address
+        const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const std::size_t begin = offset & ~(page_size - 1);
+        const std::size_t end = length > size_ - offset ? size_ : offset + length;
+        auto *address = const_cast<std::byte *>(static_cast<const std::byte *>(data_)) + begin;
+        ::madvise(address, end - begin, to_advice(access));
+    }
+
+    void MappedFile::read_into_buffer(int fd, const std::filesystem::path &filepath) {
+        constexpr std::size_t read_size = 64 * 1024;
+        std::size_t used = 0;
+        while (true) {
+            buffer_.resize(used + read_size);
+            const ::ssize_t count = ::read(fd, buffer_.data() + used, read_size);
+            if (count < 0 and errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                ::close(fd);
+                buffer_.clear();
+                spdlog::error("file: {} could not be read", filepath.string());
+                throw std::runtime_error("could not read the file");
+            }
+            if (count == 0) {
+                break;
+            }
+            used += static_cast<std::size_t>(count);
+        }
+        ::close(fd);
+        buffer_.resize(used);
+        buffer_.shrink_to_fit();
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+
+    void MappedFile::unmap() noexcept {
+        if (is_mapped_ and data_ != nullptr) {
+            ::munmap(const_cast<void *>(data_), size_);
+        }
+    }
+} // namespace file
 } // namespace dk
@@ -0,0 +1,131 @@
+#include <dklib/file/file_watcher.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace dk::file {
+namespace {
+    constexpr std::uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO;
+} // namespace
+
+FileWatcher::FileWatcher()
+    : fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+    if (fd_ < 0) {
+        spdlog::error("file watcher: inotify could not be initialized: {}", std::strerror(errno));
+        throw std::runtime_error("inotify could not be initialized");
+    }
+}
+
+FileWatcher::~FileWatcher() { close(fd_); }
+
+FileWatcher::WatchId FileWatcher::watch(const std::filesystem::path &filepath, ChangeCallback callback) {
+    auto path = std::filesystem::absolute(filepath).lexically_normal();
+    const auto directory = path.parent_path();
+    // same directory gets the same descriptor again
+    const int descriptor = inotify_add_watch(fd_, directory.c_str(), WATCH_MASK);
+    if (descriptor < 0) {
+        spdlog::error("file watcher: directory {} could not be watched: {}", directory.string(), std::strerror(errno));
+        throw std::runtime_error("directory could not be watched");
+    }
+    auto &watched = directories_[descriptor];
+    watched.path = directory;
+    ++watched.watch_count;
+
+    const auto id = next_id_++;
+    watches_.emplace(id, Watch { std::move(path), descriptor, std::move(callback) });
+    return id;
+}
+
+void FileWatcher::unwatch(WatchId id) {
+    const auto watch = watches_.find(id);
+    if (watch == watches_.end()) {
+        return;
+    }
+    const auto directory = directories_.find(watch->second.directory);
+    if (directory != directories_.end() and --directory->second.watch_count == 0) {
+        inotify_rm_watch(fd_, directory->first);
+        directories_.erase(directory);
+    }
+    watches_.erase(watch);
+}
+
+std::size_t FileWatcher::poll() {
+    std::vector<std::filesystem::path> changed;
+    bool is_overflowed = false;
+    alignas(inotify_event) std::array<char, 4096> buffer;
+    while (true) {
+        const auto length = read(fd_, buffer.data(), buffer.size());
+        if (length <= 0) {
+            if (length < 0 and errno != EAGAIN and errno != EINTR) {
+                spdlog::warn("file watcher: changes could not be read: {}", std::strerror(errno));
+            }
+            break;
+        }
+        for (std::size_t offset = 0; offset < static_cast<std::size_t>(length);) {
+            inotify_event event {};
+            std::memcpy(&event, buffer.data() + offset, sizeof(event));
+            const char *name = buffer.data() + offset + sizeof(event);
+            offset += sizeof(event) + event.len;
+
+            if (event.mask & IN_Q_OVERFLOW) {
+                is_overflowed = true;
+                continue;
+            }
+            const auto directory = directories_.find(event.wd);
+            if (event.len == 0 or directory == directories_.end()) {
+                continue;
+            }
+            auto path = directory->second.path / name;
+            if (std::ranges::find(changed, path) == changed.end()) {
+                changed.push_back(std::move(path));
+            }
+        }
+    }
+
+    if (is_overflowed) {
+        // the lost events may have been of any of the files
+        spdlog::warn("file watcher: inotify queue overflowed, every watched file is reported as changed");
+        for (const auto &[id, watch] : watches_) {
+            if (std::ranges::find(changed, watch.path) == changed.end()) {
+                changed.push_back(watch.path);
+            }
+        }
+    }
+
+    std::size_t changed_count = 0;
+    for (const auto &path : changed) {
+        std::error_code error;
+        auto written = std::filesystem::last_write_time(path, error);
+        if (error) {
+            written = std::filesystem::file_time_type::clock::now();
+        }
+        // callbacks may add or remove watches, so they are collected first
+        std::vector<ChangeCallback> callbacks;
+        for (const auto &[id, watch] : watches_) {
+            if (watch.path == path) {
+                callbacks.push_back(watch.callback);
+            }
+        }
+        if (callbacks.empty()) {
+            continue;
+        }
+        ++changed_count;
+        spdlog::debug("file watcher: {} changed", path.string());
+        const FileChange change { path, written };
+        for (const auto &callback : callbacks) {
+            callback(change);
+        }
+    }
+    return changed_count;
+}
+
+} // namespace dk::file
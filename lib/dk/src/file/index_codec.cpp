@@ -0,0 +1,157 @@
+#include <dklib/file/index_codec.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace dk::file::index_codec {
+namespace {
+    using gl::u32;
+    using gl::u8;
+
+    constexpr u32 length_of(u8 control, std::size_t lane) noexcept { return ((control >> (2 * lane)) & 3U) + 1; }
+
+    constexpr u32 zigzag(u32 delta) noexcept { return (delta << 1) ^ (0U - (delta >> 31)); }
+    constexpr u32 unzigzag(u32 value) noexcept { return (value >> 1) ^ (0U - (value & 1U)); }
+
+    /// Shuffle masks moving the data bytes of the four indices of a control
+    /// byte into the lanes of a vector, and the total lengths of the indices.
+    struct ShuffleTable {
+        std::array<std::array<u8, 16>, 256> masks {};
+        std::array<u8, 256> lengths {};
+    };
+
+    constexpr ShuffleTable make_shuffle_table() {
+        ShuffleTable table;
+        for (std::size_t control = 0; control < 256; ++control) {
+            u32 source = 0;
+            for (std::size_t lane = 0; lane < 4; ++lane) {
+                const u32 length = length_of(static_cast<u8>(control), lane);
+                for (u32 byte = 0; byte < 4; ++byte) {
+                    // the high bit of a mask byte zeroes the target byte
+                    table.masks[control][lane * 4 + byte] = byte < length ? static_cast<u8>(source + byte) : 0x80;
+                }
+                source += length;
+            }
+            table.lengths[control] = static_cast<u8>(source);
+        }
+        return table;
+    }
+
+    constexpr ShuffleTable SHUFFLE_TABLE = make_shuffle_table();
+
+    using Decode = void (*)(const u8 *control, const u8 *data, const u8 *data_end, u32 *indices, std::size_t count);
+
+    /// Decodes the indices [begin, end), the data points at the first of
+    /// them and previous is the index before it.
+    void decode_range_scalar(const u8 *control, const u8 *data, u32 *indices, std::size_t begin, std::size_t end,
+                             u32 previous) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const u32 length = length_of(control[i / 4], i % 4);
+            u32 value = 0;
+            for (u32 byte = 0; byte < length; ++byte) {
+                value |= u32 { data[byte] } << (8 * byte);
+            }
+            data += length;
+            previous += unzigzag(value);
+            indices[i] = previous;
+        }
+    }
+
+    void decode_scalar(const u8 *control, const u8 *data, const u8 * /* data_end */, u32 *indices, std::size_t count) {
+        decode_range_scalar(control, data, indices, 0, count, 0);
+    }
+
+#if defined(__SSE2__) && defined(__GNUC__)
+    __attribute__((target("ssse3"))) void decode_ssse3(const u8 *control, const u8 *data, const u8 *data_end,
+                                                       u32 *indices, std::size_t count) {
+        const __m128i one = _mm_set1_epi32(1);
+        __m128i previous = _mm_setzero_si128();
+        std::size_t i = 0;
+        // a group loads 16 bytes, whatever its length, the last groups are
+        // left to the scalar loop so that the load stays inside the blob
+        for (; i + 4 <= count and data_end - data >= 16; i += 4) {
+            const u8 group = control[i / 4];
+            const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(SHUFFLE_TABLE.masks[group].data()));
+            __m128i values = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)), mask);
+            data += SHUFFLE_TABLE.lengths[group];
+            values = _mm_xor_si128(_mm_srli_epi32(values, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(values, one)));
+            // inclusive prefix sum of the differences
+            values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+            values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+            values = _mm_add_epi32(values, previous);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(indices + i), values);
+            previous = _mm_shuffle_epi32(values, 0xff);
+        }
+        decode_range_scalar(control, data, indices, i, count, static_cast<u32>(_mm_cvtsi128_si32(previous)));
+    }
+#endif
+
+    struct Dispatch {
+        Decode decode;
+        std::string_view name;
+    };
+
+    const Dispatch &get_dispatch() {
+        static const Dispatch dispatch = []() -> Dispatch {
+#if defined(__SSE2__) && defined(__GNUC__)
+            if (__builtin_cpu_supports("ssse3")) {
+                return { decode_ssse3, "ssse3" };
+            }
+#endif
+            return { decode_scalar, "scalar" };
+        }();
+        return dispatch;
+    }
+
+    /// Count of the data bytes of the first count indices.
+    std::size_t data_size(const u8 *control, std::size_t count) {
+        std::size_t size = 0;
+        for (std::size_t group = 0; group < count / 4; ++group) {
+            size += SHUFFLE_TABLE.lengths[control[group]];
+        }
+        for (std::size_t lane = 0; lane < count % 4; ++lane) {
+            size += length_of(control[count / 4], lane);
+        }
+        return size;
+    }
+} // namespace
+
+std::vector<std::byte> encode(std::span<const gl::u32> indices) {
+    const std::size_t control_size = (indices.size() + 3) / 4;
+    std::vector<std::byte> encoded(max_encoded_size(indices.size()));
+    auto *control = reinterpret_cast<u8 *>(encoded.data());
+    auto *data = control + control_size;
+    u32 previous = 0;
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        const u32 value = zigzag(indices[i] - previous);
+        previous = indices[i];
+        const u32 length = value < (1U << 8) ? 1 : value < (1U << 16) ? 2 : value < (1U << 24) ? 3 : 4;
+        control[i / 4] = static_cast<u8>(control[i / 4] | ((length - 1) << (2 * (i % 4))));
+        for (u32 byte = 0; byte < length; ++byte) {
+            *data++ = static_cast<u8>(value >> (8 * byte));
+        }
+    }
+    encoded.resize(static_cast<std::size_t>(data - reinterpret_cast<u8 *>(encoded.data())));
+    return encoded;
+}
+
+void decode(std::span<const std::byte> encoded, std::span<gl::u32> indices) {
+    const std::size_t control_size = (indices.size() + 3) / 4;
+    const auto *control = reinterpret_cast<const u8 *>(encoded.data());
+    if (encoded.size() < control_size or encoded.size() - control_size < data_size(control, indices.size())) {
+        spdlog::error("index_codec: {} bytes are too few for {} indices", encoded.size(), indices.size());
+        throw std::runtime_error("truncated index blob");
+    }
+    const auto *data_end = control + encoded.size();
+    get_dispatch().decode(control, control + control_size, data_end, indices.data(), indices.size());
+}
+
+std::string_view instruction_set() { return get_dispatch().name; }
+
+} // namespace dk::file::index_codec
@@ -1,5 +1,17 @@
 #include <GL/gl.h>
+#include <GLES3/gl3.h>
 #include <dklib/file/ktx_file.hpp>
+#include <dklib/gl/state_cache.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
 
 using namespace dk::gl::types;
 
@@ -10,8 +22,6 @@ enum class Endianness {
     UNKNOWN,
 };
 
-const u32 KTX_LITTLE_ENDIAN = 0x04030201;
-const u32 KTX_BIG_ENDIAN = 0x01020304;
 namespace {
     Endianness get_endianness(const Header &header) {
         switch (header.endianness) {
@@ -23,32 +33,387 @@ namespace {
             return Endianness::UNKNOWN;
         }
     }
-    u32 calculate_stride(const Header &header, u32 width, u32 padding = 4) {
-        u32 channels = [&header]() -> u32 {
-            switch (header.gl_base_internal_format) {
-            case GL_RED:
-                return 1;
-            case GL_RG:
-                return 2;
-            case GL_BGR:
-            case GL_RGB:
-                return 3;
-            case GL_BGRA:
-            case GL_RGBA:
-                return 4;
-            }
-            return 0;
-        }();
 
-        u32 stride = header.gl_type_size * channels * width;
+    u32 get_channels(const Header &header) {
+        switch (header.gl_base_internal_format) {
+        case GL_RED:
+            return 1;
+        case GL_RG:
+            return 2;
+        case GL_BGR:
+        case GL_RGB:
+            return 3;
+        case GL_BGRA:
+        case GL_RGBA:
+            return 4;
+        }
+        return 0;
+    }
+
+    u32 calculate_stride(const Header &header, u32 width, u32 padding = 4) {
+        u32 stride = header.gl_type_size * get_channels(header) * width;
         stride = (stride + (padding - 1)) & ~(padding - 1);
 
         return stride;
     }
 
-    u32 calculate_face_size(const Header &header) {
-        u32 stride = calculate_stride(header, header.pixel_width);
-        return stride * header.pixel_height;
+    constexpr std::size_t align4(std::size_t value) { return (value + 3) & ~std::size_t { 3 }; }
+
+    [[noreturn]] void reject(const char *reason) {
+        spdlog::error("KTX parsing failed: {}", reason);
+        throw std::runtime_error("invalid KTX file");
     }
+
+    u32 mip_extent(u32 extent, u32 level) { return std::max<u32>(1, extent >> level); }
+
+    /// Count of levels of a full mip chain of the texture
+    u32 full_chain_length(const Header &header) {
+        const u32 largest = std::max({ header.pixel_width, header.pixel_height, header.pixel_depth, 1u });
+        return static_cast<u32>(std::bit_width(largest));
+    }
+
+    /// Count of 2D layers in a single mip level of the array textures
+    u32 layer_count(const Header &header) {
+        const u32 faces = header.faces == 6 ? 6 : 1;
+        return std::max(header.arrayelements, 1u) * faces;
+    }
+
+    bool is_cube_map(const Header &header) { return header.faces == 6 and header.arrayelements == 0; }
 } // namespace
+
+u32 Layout::level_count() const noexcept { return std::max(header.miplevels, 1u); }
+
+u32 Layout::face_count() const noexcept { return is_cube_map(header) ? 6 : 1; }
+
+gl::TextureType Layout::texture_type() const {
+    if (header.pixel_height == 0) {
+        return header.arrayelements == 0 ? gl::TextureType::TEX_1D : gl::TextureType::TEX_1D_ARRAY;
+    } else if (header.pixel_depth != 0) {
+        return gl::TextureType::TEX_3D;
+    } else if (header.faces == 6) {
+        return header.arrayelements == 0 ? gl::TextureType::CUBE_MAP : gl::TextureType::CUBE_MAP_ARRAY;
+    } else if (header.arrayelements != 0) {
+        return gl::TextureType::TEX_2D_ARRAY;
+    }
+    return gl::TextureType::TEX_2D;
+}
+
+const ImageRange &Layout::image(u32 level, u32 face) const {
+    if (level >= level_count() or face >= face_count()) {
+        throw std::out_of_range("KTX image does not exist");
+    }
+    return images[level * face_count() + face];
+}
+
+Layout parse_layout(std::span<const std::byte> bytes) {
+    if (bytes.size() < sizeof(Header)) {
+        reject("file is smaller than the header");
+    }
+    Layout layout {};
+    Header &header = layout.header;
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    if (std::memcmp(header.identifier, IDENTIFIER.data(), IDENTIFIER.size()) != 0) {
+        reject("wrong identifier");
+    }
+
+    const auto endianness = get_endianness(header);
+    if (endianness == Endianness::UNKNOWN) {
+        reject("unknown endianness");
+    }
+    const bool is_swapped = (endianness == Endianness::LITTLE) != (std::endian::native == std::endian::little);
+    const auto native = [is_swapped](u32 value) { return is_swapped ? std::byteswap(value) : value; };
+    if (is_swapped) {
+        // everything after the identifier is a sequence of u32 values
+        auto *fields = reinterpret_cast<std::byte *>(&header) + sizeof(header.identifier);
+        for (std::size_t i = 0; i < (sizeof(Header) - sizeof(header.identifier)) / sizeof(u32); ++i) {
+            u32 value;
+            std::memcpy(&value, fields + i * sizeof(u32), sizeof(u32));
+            value = std::byteswap(value);
+            std::memcpy(fields + i * sizeof(u32), &value, sizeof(u32));
+        }
+        if (header.gl_type_size > 1) {
+            // texel data are exposed in place, so they can not be swapped
+            reject("texel data in foreign byte order are not supported");
+        }
+    }
+    if (header.pixel_width == 0) {
+        reject("texture has zero width");
+    }
+    if (header.faces != 1 and header.faces != 6) {
+        reject("texture has to have either one or six faces");
+    }
+    if (header.miplevels > full_chain_length(header)) {
+        reject("texture has more mip levels than its size allows");
+    }
+
+    const bool is_uncompressed = header.gltype != 0 and get_channels(header) != 0;
+    const u32 faces = layout.face_count();
+    std::size_t offset = sizeof(Header) + std::size_t { header.keypairbytes };
+    layout.images.reserve(std::size_t { layout.level_count() } * faces);
+    for (u32 level = 0; level < layout.level_count(); ++level) {
+        if (offset + sizeof(u32) > bytes.size()) {
+            reject("file is truncated");
+        }
+        u32 image_size;
+        std::memcpy(&image_size, bytes.data() + offset, sizeof(u32));
+        image_size = native(image_size);
+        offset += sizeof(u32);
+
+        ImageRange range {
+            .level = level,
+            .face = 0,
+            .width = mip_extent(header.pixel_width, level),
+            .height = header.pixel_height == 0 ? 1 : mip_extent(header.pixel_height, level),
+            .depth = header.pixel_depth == 0 ? 1 : mip_extent(header.pixel_depth, level),
+            .offset = 0,
+            .size = image_size,
+        };
+        if (is_uncompressed) {
+            std::size_t expected = std::size_t { calculate_stride(header, range.width) } * range.height * range.depth;
+            if (not is_cube_map(header)) {
+                expected *= layer_count(header);
+            }
+            if (expected != image_size) {
+                reject("image size does not match the texture dimensions");
+            }
+        }
+        for (u32 face = 0; face < faces; ++face) {
+            range.face = face;
+            range.offset = offset;
+            if (range.offset + range.size > bytes.size()) {
+                reject("file is truncated");
+            }
+            layout.images.push_back(range);
+            // every face is padded to four bytes (cubePadding), as is every
+            // mip level (mipPadding)
+            offset += align4(image_size);
+        }
+    }
+    return layout;
+}
+
+MappedTexture::MappedTexture(const std::filesystem::path &filepath)
+    // levels are uploaded from the smallest one at the end of the file,
+    // possibly over many frames, read ahead would only waste memory
+    : file_(filepath, { AccessPattern::RANDOM }) {
+    try {
+        layout_ = parse_layout(file_.bytes());
+    } catch (const std::runtime_error &) {
+        spdlog::error("file: {} is not a valid KTX file", filepath.string());
+        throw;
+    }
+}
+
+std::span<const std::byte> MappedTexture::get_image(u32 level, u32 face) const {
+    const auto &range = layout_.image(level, face);
+    return file_.bytes().subspan(range.offset, range.size);
+}
+
+StreamedTexture::StreamedTexture(MappedTexture &&source, std::size_t initial_budget)
+    : source_(std::move(source))
+    , type_(source_.get_layout().texture_type()) {
+    const auto &layout = source_.get_layout();
+    const auto &header = layout.header;
+    const auto target = static_cast<enum32>(type_);
+    if (type_ == gl::TextureType::TEX_1D or type_ == gl::TextureType::TEX_1D_ARRAY) {
+        spdlog::error("1D KTX textures are not supported");
+        throw std::runtime_error("unsupported KTX texture type");
+    }
+
+    // files without mip levels expect them to be generated
+    const bool generates_mipmaps = header.miplevels == 0;
+    const auto storage_levels = static_cast<i32>(generates_mipmaps ? full_chain_length(header) : layout.level_count());
+    const auto &base = layout.image(0);
+    glGenTextures(1, &id_);
+    gl::StateCache::get_instance().bind_texture(target, id_);
+    switch (type_) {
+    case gl::TextureType::TEX_2D:
+    case gl::TextureType::CUBE_MAP:
+        glTexStorage2D(target, storage_levels, header.glinternalformat, static_cast<i32>(base.width),
+                       static_cast<i32>(base.height));
+        break;
+    case gl::TextureType::TEX_3D:
+        glTexStorage3D(target, storage_levels, header.glinternalformat, static_cast<i32>(base.width),
+                       static_cast<i32>(base.height), static_cast<i32>(base.depth));
+        break;
+    default:
+        glTexStorage3D(target, storage_levels, header.glinternalformat, static_cast<i32>(base.width),
+                       static_cast<i32>(base.height), static_cast<i32>(layer_count(header)));
+        break;
+    }
+    // KTX rows are padded to four bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, storage_levels - 1);
+
+    if (generates_mipmaps) {
+        upload_level(0);
+        glGenerateMipmap(target);
+        resident_level_ = 0;
+        return;
+    }
+
+    resident_level_ = layout.level_count();
+    stream(initial_budget);
+}
+
+StreamedTexture::~StreamedTexture() {
+    if (id_ != 0) {
+        gl::StateCache::get_instance().forget_texture(id_);
+        glDeleteTextures(1, &id_);
+    }
+}
+
+StreamedTexture::StreamedTexture(StreamedTexture &&other) noexcept
+    : source_(std::move(other.source_))
+    , type_(other.type_)
+    , id_(std::exchange(other.id_, 0))
+    , resident_level_(other.resident_level_) { }
+
+StreamedTexture &StreamedTexture::operator=(StreamedTexture &&other) noexcept {
+    if (this != &other) {
+        if (id_ != 0) {
+            gl::StateCache::get_instance().forget_texture(id_);
+            glDeleteTextures(1, &id_);
+        }
+        source_ = std::move(other.source_);
+        type_ = other.type_;
+        id_ = std::exchange(other.id_, 0);
+        resident_level_ = other.resident_level_;
+    }
+    return *this;
+}
+
+bool StreamedTexture::stream(std::size_t byte_budget) {
+    const auto &layout = source_.get_layout();
+    std::size_t used = 0;
+    while (not is_complete()) {
+        const std::size_t size = layout.image(resident_level_ - 1).size * layout.face_count();
+        if (used != 0 and used + size > byte_budget) {
+            break;
+        }
+        upload_level(resident_level_ - 1);
+        used += size;
+    }
+    return is_complete();
+}
+
+u32 StreamedTexture::release() noexcept { return std::exchange(id_, 0); }
+
+void StreamedTexture::upload_level(u32 level) {
+    const auto &layout = source_.get_layout();
+    const auto &header = layout.header;
+    const auto target = static_cast<enum32>(type_);
+    gl::StateCache::get_instance().bind_texture(target, id_);
+    for (u32 face = 0; face < layout.face_count(); ++face) {
+        const auto &range = layout.image(level, face);
+        const auto data = source_.get_image(level, face);
+        const auto lod = static_cast<i32>(level);
+        const auto width = static_cast<i32>(range.width);
+        const auto height = static_cast<i32>(range.height);
+        const auto size = static_cast<i32>(data.size());
+        const auto depth = static_cast<i32>(type_ == gl::TextureType::TEX_3D ? range.depth : layer_count(header));
+
+        if (type_ == gl::TextureType::TEX_2D or type_ == gl::TextureType::CUBE_MAP) {
+            const enum32 face_target = type_ == gl::TextureType::CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : target;
+            if (layout.is_compressed()) {
+                glCompressedTexSubImage2D(face_target, lod, 0, 0, width, height, header.glinternalformat, size,
+                                          data.data());
+            } else {
+                glTexSubImage2D(face_target, lod, 0, 0, width, height, header.glformat, header.gltype, data.data());
+            }
+        } else if (layout.is_compressed()) {
+            glCompressedTexSubImage3D(target, lod, 0, 0, 0, width, height, depth, header.glinternalformat, size,
+                                      data.data());
+        } else {
+            glTexSubImage3D(target, lod, 0, 0, 0, width, height, depth, header.glformat, header.gltype, data.data());
+        }
+    }
+    // Only the uploaded levels are sampled, which keeps the texture complete
+    resident_level_ = level;
+    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, static_cast<i32>(level));
+}
+
+u32 load(const std::string &filename) {
+    StreamedTexture texture(MappedTexture { filename }, std::numeric_limits<std::size_t>::max());
+    return texture.release();
+}
+
+void save(const std::filesystem::path &filepath, const Header &header,
+          std::span<const std::span<const std::byte>> images) {
+    Header written = header;
+    std::memcpy(written.identifier, IDENTIFIER.data(), IDENTIFIER.size());
+    // values are written in the native byte order, readers recognize it by
+    // the way this one is stored
+    written.endianness = KTX_LITTLE_ENDIAN;
+    written.keypairbytes = 0;
+
+    const u32 faces = is_cube_map(written) ? 6 : 1;
+    const u32 levels = std::max(written.miplevels, 1u);
+    if (images.size() != std::size_t { levels } * faces) {
+        spdlog::error("KTX file needs {} images, {} were provided", levels * faces, images.size());
+        throw std::invalid_argument("wrong count of images");
+    }
+
+    std::ofstream fout(filepath, std::ios::binary | std::ios::trunc);
+    if (not fout.is_open()) {
+        spdlog::error("file: {} could not be opened for writing", filepath.string());
+        throw std::runtime_error("could not open the file");
+    }
+    constexpr char padding[4] {};
+    fout.write(reinterpret_cast<const char *>(&written), sizeof(written));
+    for (u32 level = 0; level < levels; ++level) {
+        const auto image_size = static_cast<u32>(images[level * faces].size());
+        fout.write(reinterpret_cast<const char *>(&image_size), sizeof(image_size));
+        for (u32 face = 0; face < faces; ++face) {
+            const auto image = images[level * faces + face];
+            if (image.size() != image_size) {
+                throw std::invalid_argument("faces of a level have to have the same size");
+            }
+            fout.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+            fout.write(padding, static_cast<std::streamsize>(align4(image.size()) - image.size()));
+        }
+    }
+    if (not fout.good()) {
+        spdlog::error("file: {} could not be written", filepath.string());
+        throw std::runtime_error("could not write the file");
+    }
+}
+
+void save(const std::filesystem::path &filepath, std::span<const gl::Image> mip_chain, bool is_srgb) {
+    if (mip_chain.empty()) {
+        throw std::invalid_argument("mip chain is empty");
+    }
+    const auto &base = mip_chain.front();
+    Header header {};
+    header.gltype = GL_UNSIGNED_BYTE;
+    header.gl_type_size = 1;
+    switch (base.channels) {
+    case 1:
+        header.glformat = GL_RED;
+        header.glinternalformat = GL_R8;
+        break;
+    case 3:
+        header.glformat = GL_RGB;
+        header.glinternalformat = is_srgb ? GL_SRGB8 : GL_RGB8;
+        break;
+    case 4:
+        header.glformat = GL_RGBA;
+        header.glinternalformat = is_srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        break;
+    default:
+        throw std::invalid_argument("unsupported channel count");
+    }
+    header.gl_base_internal_format = header.glformat;
+    header.pixel_width = base.width;
+    header.pixel_height = base.height;
+    header.faces = 1;
+    header.miplevels = static_cast<u32>(mip_chain.size());
+
+    std::vector<std::span<const std::byte>> images;
+    images.reserve(mip_chain.size());
+    for (const auto &image : mip_chain) {
+        images.push_back(std::as_bytes(std::span { image.pixels }));
+    }
+    save(filepath, header, images);
+}
 } // namespace dk::file::ktx
@@ -0,0 +1,218 @@
+#include <dklib/file/mesh_file.hpp>
+
+#include <cstring>
+#include <fstream>
+
+namespace dk::file::dkmesh {
+namespace {
+    constexpr std::size_t align_up(std::size_t value) {
+        return (value + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+    }
+
+    void write_padding(std::ofstream &fout, std::size_t from, std::size_t to) {
+        static constexpr char zeroes[BLOB_ALIGNMENT] {};
+        fout.write(zeroes, static_cast<std::streamsize>(to - from));
+    }
+
+    /// Indices of the blob as u32, whatever their size.
+    std::vector<gl::u32> widen_indices(std::span<const std::byte> indices, gl::u32 index_size) {
+        std::vector<gl::u32> widened(indices.size() / index_size);
+        for (std::size_t i = 0; i < widened.size(); ++i) {
+            switch (index_size) {
+            case sizeof(gl::u8):
+                widened[i] = std::to_integer<gl::u8>(indices[i]);
+                break;
+            case sizeof(gl::u16): {
+                gl::u16 index = 0;
+                std::memcpy(&index, indices.data() + i * sizeof(index), sizeof(index));
+                widened[i] = index;
+                break;
+            }
+            default:
+                std::memcpy(&widened[i], indices.data() + i * sizeof(gl::u32), sizeof(gl::u32));
+                break;
+            }
+        }
+        return widened;
+    }
+
+    /// Header values come from the file, thus their products and sums may
+    /// wrap around, these report it instead.
+    bool multiply(std::size_t lhs, std::size_t rhs, std::size_t &result) {
+        return not __builtin_mul_overflow(lhs, rhs, &result);
+    }
+
+    bool add(std::size_t lhs, std::size_t rhs, std::size_t &result) {
+        return not __builtin_add_overflow(lhs, rhs, &result);
+    }
+
+    bool is_valid_index_blob(const Header &header) {
+        std::size_t size = 0;
+        switch (header.index_encoding) {
+        case IndexEncoding::RAW:
+            return multiply(header.index_count, header.index_size, size) and header.index_bytes == size;
+        case IndexEncoding::DELTA_VARINT:
+            // max_encoded_size stays below 5 bytes per index, the lower bound
+            // keeps a huge count from allocating its indices before the
+            // decoder finds out that the blob is too short
+            return multiply(header.index_count, sizeof(gl::u32) + 1, size)
+                and header.index_bytes >= index_codec::min_encoded_size(header.index_count)
+                and header.index_bytes <= index_codec::max_encoded_size(header.index_count);
+        }
+        return false;
+    }
+
+    template <typename IndexType>
+    bool are_indices_in_range(std::span<const std::byte> indices, std::size_t vertex_count) {
+        for (std::size_t offset = 0; offset < indices.size(); offset += sizeof(IndexType)) {
+            IndexType index = 0;
+            std::memcpy(&index, indices.data() + offset, sizeof(index));
+            if (index >= vertex_count) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Whether all of the raw indices point to one of the vertices.
+    bool are_indices_in_range(std::span<const std::byte> indices, gl::u32 index_size, std::size_t vertex_count) {
+        switch (index_size) {
+        case sizeof(gl::u8):
+            return are_indices_in_range<gl::u8>(indices, vertex_count);
+        case sizeof(gl::u16):
+            return are_indices_in_range<gl::u16>(indices, vertex_count);
+        default:
+            return are_indices_in_range<gl::u32>(indices, vertex_count);
+        }
+    }
+
+    [[noreturn]] void reject(const std::filesystem::path &filepath, const char *reason) {
+        spdlog::error("file: {} is not a valid mesh file: {}", filepath.string(), reason);
+        throw std::runtime_error("invalid mesh file");
+    }
+} // namespace
+
+gl::enum32 index_type_of(gl::u32 index_size) {
+    switch (index_size) {
+    case sizeof(gl::u8):
+        return GL_UNSIGNED_BYTE;
+    case sizeof(gl::u16):
+        return GL_UNSIGNED_SHORT;
+    case sizeof(gl::u32):
+        return GL_UNSIGNED_INT;
+    default:
+        throw std::invalid_argument("unsupported index size");
+    }
+}
+
+void write(const std::filesystem::path &filepath, const MeshBlobs &blobs) {
+    Header header {};
+    std::memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+    header.endianness = ENDIANNESS;
+    header.version = VERSION;
+    header.header_size = sizeof(Header);
+    header.attribute_count = static_cast<gl::u32>(blobs.attributes.size());
+    header.vertex_stride = blobs.vertex_stride;
+    header.index_type = index_type_of(blobs.index_size);
+    header.index_size = blobs.index_size;
+    header.vertex_count = blobs.vertices.size() / blobs.vertex_stride;
+    header.index_count = blobs.indices.size() / blobs.index_size;
+    header.index_encoding = blobs.index_encoding;
+
+    std::vector<std::byte> encoded;
+    auto indices = blobs.indices;
+    if (blobs.index_encoding == IndexEncoding::DELTA_VARINT) {
+        encoded = index_codec::encode(std::span<const gl::u32> { widen_indices(blobs.indices, blobs.index_size) });
+        indices = encoded;
+    }
+    header.index_bytes = indices.size();
+
+    const std::size_t attributes_end = sizeof(Header) + blobs.attributes.size_bytes();
+    header.vertex_offset = align_up(attributes_end);
+    header.index_offset = align_up(header.vertex_offset + blobs.vertices.size());
+
+    const auto &[min, max] = blobs.bounds;
+    std::memcpy(header.bounds_min, &min, sizeof(header.bounds_min));
+    std::memcpy(header.bounds_max, &max, sizeof(header.bounds_max));
+
+    std::ofstream fout(filepath, std::ios::binary | std::ios::trunc);
+    if (not fout.is_open()) {
+        spdlog::error("file: {} could not be opened for writing", filepath.string());
+        throw std::runtime_error("could not open the file");
+    }
+    fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char *>(blobs.attributes.data()), static_cast<std::streamsize>(blobs.attributes.size_bytes()));
+    write_padding(fout, attributes_end, header.vertex_offset);
+    fout.write(reinterpret_cast<const char *>(blobs.vertices.data()), static_cast<std::streamsize>(blobs.vertices.size()));
+    write_padding(fout, header.vertex_offset + blobs.vertices.size(), header.index_offset);
+    fout.write(reinterpret_cast<const char *>(indices.data()), static_cast<std::streamsize>(indices.size()));
+    if (not fout.good()) {
+        spdlog::error("file: {} could not be written", filepath.string());
+        throw std::runtime_error("could not write the file");
+    }
+}
+
+MappedMesh::MappedMesh(const std::filesystem::path &filepath)
+    : file_(filepath, { AccessPattern::SEQUENTIAL }) {
+    const auto bytes = file_.bytes();
+    if (bytes.size() < sizeof(Header)) {
+        reject(filepath, "file is too small");
+    }
+    // Mappings are page aligned, thus the header is suitably aligned too
+    header_ = reinterpret_cast<const Header *>(bytes.data());
+    if (std::memcmp(header_->identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0) {
+        reject(filepath, "wrong identifier");
+    }
+    if (header_->endianness != ENDIANNESS) {
+        reject(filepath, "file was written with different endianness");
+    }
+    if (header_->version != VERSION or header_->header_size != sizeof(Header)) {
+        reject(filepath, "unsupported version");
+    }
+    if (header_->vertex_stride == 0 or header_->index_type != index_type_of(header_->index_size)) {
+        reject(filepath, "malformed layout");
+    }
+
+    std::size_t attributes_end = 0;
+    std::size_t vertices_size = 0;
+    std::size_t vertices_end = 0;
+    std::size_t indices_end = 0;
+    const std::size_t indices_size = header_->index_bytes;
+    if (not is_valid_index_blob(*header_)) {
+        reject(filepath, "malformed index blob");
+    }
+    if (not multiply(header_->attribute_count, sizeof(gl::VertexAttribute), attributes_end)
+        or not add(attributes_end, sizeof(Header), attributes_end)
+        or not multiply(header_->vertex_count, header_->vertex_stride, vertices_size)
+        or not add(header_->vertex_offset, vertices_size, vertices_end)
+        or not add(header_->index_offset, indices_size, indices_end)) {
+        reject(filepath, "blob sizes overflow");
+    }
+    if (attributes_end > header_->vertex_offset or vertices_end > header_->index_offset or indices_end > bytes.size()
+        or header_->vertex_offset % BLOB_ALIGNMENT != 0 or header_->index_offset % BLOB_ALIGNMENT != 0) {
+        reject(filepath, "blobs are out of bounds");
+    }
+
+    attributes_ = { reinterpret_cast<const gl::VertexAttribute *>(bytes.data() + sizeof(Header)),
+                    header_->attribute_count };
+    vertices_ = bytes.subspan(header_->vertex_offset, vertices_size);
+    indices_ = bytes.subspan(header_->index_offset, indices_size);
+    // compressed indices are checked once they are decoded
+    if (header_->index_encoding == IndexEncoding::RAW
+        and not are_indices_in_range(indices_, header_->index_size, header_->vertex_count)) {
+        reject(filepath, "indices point past the vertices");
+    }
+}
+
+void MappedMesh::check_decoded_indices(std::span<const gl::u32> indices) const {
+    if (std::ranges::any_of(indices, [&](gl::u32 index) { return index >= header_->vertex_count; })) {
+        spdlog::error("mesh file: decoded indices point past its {} vertices", header_->vertex_count);
+        throw std::runtime_error("invalid mesh file");
+    }
+}
+
+Bounds MappedMesh::get_bounds() const noexcept {
+    return { { header_->bounds_min[0], header_->bounds_min[1], header_->bounds_min[2] },
+             { header_->bounds_max[0], header_->bounds_max[1], header_->bounds_max[2] } };
+}
+} // namespace dk::file::dkmesh
@@ -5,7 +5,17 @@
 
 #include <dklib/util.h>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
 #include <filesystem>
+#include <span>
+#include <spanstream>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace dk {
 
@@ -65,17 +75,413 @@ namespace file::obj::experimental {
        {
         } */
 
+    namespace {
+        /// Finds the end of the current line, 16 bytes at a time when SSE2 is
+        /// available.
+        const char *find_line_end(const char *first, const char *last) noexcept {
+#if defined(__SSE2__)
+            const __m128i newline = _mm_set1_epi8('\n');
+            while (last - first >= 16) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+                const auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+                if (mask != 0) {
+                    return first + std::countr_zero(mask);
+                }
+                first += 16;
+            }
+#endif
+            while (first != last and *first != '\n') {
+                ++first;
+            }
+            return first;
+        }
+
+        constexpr bool is_blank(char c) noexcept {
+            return c == ' ' or c == '\t' or c == '\r';
+        }
+
+        /// Cursor over a single line of the file.
+        class LineScanner {
+        public:
+            LineScanner(const char *first, const char *last, std::size_t line_number, std::size_t chunk_offset)
+                : it_(first)
+                , last_(last)
+                , line_number_(line_number)
+                , chunk_offset_(chunk_offset) { }
+
+            void skip_blanks() noexcept {
+                while (it_ != last_ and is_blank(*it_)) {
+                    ++it_;
+                }
+            }
+
+            [[nodiscard]] bool at_end() noexcept {
+                skip_blanks();
+                return it_ == last_;
+            }
+
+            std::string_view keyword() noexcept {
+                skip_blanks();
+                const char *begin = it_;
+                while (it_ != last_ and not is_blank(*it_)) {
+                    ++it_;
+                }
+                return { begin, static_cast<std::size_t>(it_ - begin) };
+            }
+
+            gl::f32 number() {
+                skip_blanks();
+                if (it_ != last_ and *it_ == '+') {
+                    ++it_;
+                }
+                gl::f32 value = 0.0f;
+                const auto [ptr, ec] = std::from_chars(it_, last_, value);
+                if (ec != std::errc {}) {
+                    fail("expected a number");
+                }
+                it_ = ptr;
+                return value;
+            }
+
+            gl::f32 optional_number(gl::f32 fallback) {
+                return at_end() ? fallback : number();
+            }
+
+            /// Parses an index of a corner component, returns zero if it is
+            /// omitted.
+            gl::i64 index() {
+                if (it_ == last_ or is_blank(*it_) or *it_ == '/') {
+                    return 0;
+                }
+                gl::i64 value = 0;
+                const auto [ptr, ec] = std::from_chars(it_, last_, value);
+                if (ec != std::errc {} or value == 0) {
+                    fail("expected a face index");
+                }
+                it_ = ptr;
+                return value;
+            }
+
+            bool consume(char c) noexcept {
+                if (it_ != last_ and *it_ == c) {
+                    ++it_;
+                    return true;
+                }
+                return false;
+            }
+
+            [[noreturn]] void fail(std::string_view what) const {
+                if (chunk_offset_ == 0) {
+                    spdlog::error("OBJ parsing failed on line {}: {}", line_number_, what);
+                } else {
+                    spdlog::error(
+                        "OBJ parsing failed on line {} of the chunk at byte {}: {}", line_number_,
+                        chunk_offset_, what
+                    );
+                }
+                throw std::runtime_error("malformed OBJ file");
+            }
+
+        private:
+            const char *it_;
+            const char *last_;
+            std::size_t line_number_;
+            std::size_t chunk_offset_;
+        };
+
+        enum Component : std::size_t {
+            POSITION,
+            TEXTURE,
+            NORMAL,
+            COMPONENT_COUNT,
+        };
+
+        /// Negative index, that is relative to the count of records read so
+        /// far. Such index cannot be resolved until the counts of all of the
+        /// previous chunks are known.
+        struct RelativeIndex {
+            std::size_t corner;
+            Component component;
+            /// Count of the records in the chunk plus the negative index
+            gl::i64 local_index;
+        };
+
+        /// Positive index past the records of the chunk, which may point to
+        /// the records of the previous chunks. It is checked once their counts
+        /// are known.
+        struct ForwardIndex {
+            std::size_t corner;
+            Component component;
+            /// Count of the records in the chunk when the index was read
+            std::size_t local_count;
+        };
+
+        /// Part of the file that starts and ends on a line boundary.
+        struct Chunk {
+            std::string_view text;
+            std::size_t offset { 0 };
+            ObjData data;
+            std::vector<RelativeIndex> relative;
+            std::vector<ForwardIndex> forward;
+        };
+
+        struct ParsedCorner {
+            FaceCorner corner;
+            std::array<gl::i64, COMPONENT_COUNT> local_index {};
+            std::array<bool, COMPONENT_COUNT> is_relative {};
+            std::array<std::size_t, COMPONENT_COUNT> local_count {};
+            std::array<bool, COMPONENT_COUNT> is_forward {};
+        };
+
+        gl::u32 &component_of(FaceCorner &corner, Component component) {
+            switch (component) {
+            case TEXTURE:
+                return corner.texture;
+            case NORMAL:
+                return corner.normal;
+            default:
+                return corner.position;
+            }
+        }
+
+        /// Converts one based OBJ index into zero based one, negative indices
+        /// are only recorded, see RelativeIndex.
+        ///
+        /// Positive index has to point to one of the records read so far. The
+        /// first chunk knows all of them, other chunks record the indices past
+        /// their own records, see ForwardIndex.
+        void parse_component(LineScanner &scanner, ParsedCorner &parsed, Component component, std::size_t count,
+                             bool is_first_chunk) {
+            const gl::i64 index = scanner.index();
+            if (index > 0) {
+                // MISSING_INDEX is not a valid zero based index
+                if (index > static_cast<gl::i64>(MISSING_INDEX)) {
+                    scanner.fail("face index does not fit 32 bits");
+                }
+                if (static_cast<std::size_t>(index - 1) >= count) {
+                    if (is_first_chunk) {
+                        scanner.fail("face index points past the records read so far");
+                    }
+                    parsed.is_forward[component] = true;
+                    parsed.local_count[component] = count;
+                }
+                component_of(parsed.corner, component) = static_cast<gl::u32>(index - 1);
+            } else if (index < 0) {
+                parsed.is_relative[component] = true;
+                parsed.local_index[component] = static_cast<gl::i64>(count) + index;
+            }
+        }
+
+        ParsedCorner parse_corner(LineScanner &scanner, const Chunk &chunk) {
+            const auto &data = chunk.data;
+            const bool is_first_chunk = chunk.offset == 0;
+            ParsedCorner parsed;
+            parse_component(scanner, parsed, POSITION, data.positions.size(), is_first_chunk);
+            if (parsed.corner.position == MISSING_INDEX and not parsed.is_relative[POSITION]) {
+                scanner.fail("face corner is missing a position");
+            }
+            if (scanner.consume('/')) {
+                parse_component(scanner, parsed, TEXTURE, data.textures.size(), is_first_chunk);
+                if (scanner.consume('/')) {
+                    parse_component(scanner, parsed, NORMAL, data.normals.size(), is_first_chunk);
+                }
+            }
+            return parsed;
+        }
+
+        void emit_corner(Chunk &chunk, const ParsedCorner &parsed) {
+            for (std::size_t component = 0; component < COMPONENT_COUNT; ++component) {
+                if (parsed.is_relative[component]) {
+                    chunk.relative.push_back(
+                        { chunk.data.corners.size(), static_cast<Component>(component), parsed.local_index[component] }
+                    );
+                }
+                if (parsed.is_forward[component]) {
+                    chunk.forward.push_back(
+                        { chunk.data.corners.size(), static_cast<Component>(component), parsed.local_count[component] }
+                    );
+                }
+            }
+            chunk.data.corners.push_back(parsed.corner);
+        }
+
+        void parse_face(LineScanner &scanner, Chunk &chunk) {
+            ParsedCorner first;
+            ParsedCorner previous;
+            std::size_t count = 0;
+            while (not scanner.at_end()) {
+                const ParsedCorner corner = parse_corner(scanner, chunk);
+                if (count >= 2) {
+                    emit_corner(chunk, first);
+                    emit_corner(chunk, previous);
+                    emit_corner(chunk, corner);
+                }
+                if (count == 0) {
+                    first = corner;
+                }
+                previous = corner;
+                ++count;
+            }
+            if (count < 3) {
+                scanner.fail("face has less than three corners");
+            }
+        }
+
+        void parse_chunk(Chunk &chunk) {
+            auto &data = chunk.data;
+            const char *it = chunk.text.data();
+            const char *const last = chunk.text.data() + chunk.text.size();
+            std::size_t line_number = 0;
+            while (it < last) {
+                const char *line_end = find_line_end(it, last);
+                ++line_number;
+
+                LineScanner scanner(it, line_end, line_number, chunk.offset);
+                const auto keyword = scanner.keyword();
+                if (keyword == "v") {
+                    const auto x = scanner.number();
+                    const auto y = scanner.number();
+                    const auto z = scanner.number();
+                    data.positions.emplace_back(x, y, z);
+                } else if (keyword == "vn") {
+                    const auto x = scanner.number();
+                    const auto y = scanner.number();
+                    const auto z = scanner.number();
+                    data.normals.emplace_back(x, y, z);
+                } else if (keyword == "vt") {
+                    const auto u = scanner.number();
+                    const auto v = scanner.optional_number(0.0f);
+                    data.textures.push_back({ u, v });
+                } else if (keyword == "f") {
+                    parse_face(scanner, chunk);
+                }
+
+                it = line_end + 1;
+            }
+        }
+
+        /// Record counts of the chunks before the current one.
+        struct ChunkBase {
+            std::array<std::size_t, COMPONENT_COUNT> records {};
+            std::size_t corners { 0 };
+        };
+
+        /// Resolves relative indices of the chunk and writes them into the
+        /// merged corners, checks its forward indices.
+        void resolve_relative(const Chunk &chunk, const ChunkBase &base, std::span<FaceCorner> corners) {
+            for (const auto &[corner, component, local_count] : chunk.forward) {
+                const gl::u32 index = component_of(corners[base.corners + corner], component);
+                if (index >= base.records[component] + local_count) {
+                    spdlog::error("OBJ parsing failed: face index {} points past the records read so far", index + 1);
+                    throw std::runtime_error("malformed OBJ file");
+                }
+            }
+            for (const auto &[corner, component, local_index] : chunk.relative) {
+                const gl::i64 index = static_cast<gl::i64>(base.records[component]) + local_index;
+                if (index < 0) {
+                    spdlog::error("OBJ parsing failed: relative face index points before the first record");
+                    throw std::runtime_error("malformed OBJ file");
+                }
+                component_of(corners[base.corners + corner], component) = static_cast<gl::u32>(index);
+            }
+        }
+
+        std::vector<Chunk> split_into_chunks(std::string_view text, std::size_t chunk_count) {
+            std::vector<Chunk> chunks;
+            std::size_t begin = 0;
+            for (std::size_t i = 1; i <= chunk_count and begin < text.size(); ++i) {
+                std::size_t end = text.size() * i / chunk_count;
+                if (end < begin) {
+                    end = begin;
+                }
+                if (end < text.size()) {
+                    end = text.find('\n', end);
+                    end = end == std::string_view::npos ? text.size() : end + 1;
+                }
+                if (end > begin) {
+                    chunks.push_back({ text.substr(begin, end - begin), begin, {}, {}, {} });
+                }
+                begin = end;
+            }
+            return chunks;
+        }
+
+        template <typename T>
+        void copy_records(const std::vector<T> &source, std::vector<T> &target, std::size_t offset) {
+            std::copy(source.begin(), source.end(), target.begin() + static_cast<std::ptrdiff_t>(offset));
+        }
+    } // namespace
+
+    ObjData parse(std::string_view text) {
+        Chunk chunk { text, 0, {}, {}, {} };
+        parse_chunk(chunk);
+        resolve_relative(chunk, {}, chunk.data.corners);
+        return std::move(chunk.data);
+    }
+
+    ObjData parse(std::string_view text, util::ThreadPool &pool, std::size_t min_chunk_size) {
+        // More chunks than threads, so that the lines with faces, which are
+        // slower to parse, are spread evenly over the workers.
+        const std::size_t chunk_count = std::clamp<std::size_t>(
+            text.size() / std::max<std::size_t>(min_chunk_size, 1), 1, pool.size() * 4
+        );
+        auto chunks = split_into_chunks(text, chunk_count);
+        pool.parallel_for(chunks.size(), [&chunks](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                parse_chunk(chunks[i]);
+            }
+        });
+
+        // Exclusive prefix sum of the record counts, which makes the merge
+        // independent on the order in which the chunks were parsed.
+        std::vector<ChunkBase> bases(chunks.size());
+        ChunkBase total;
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            bases[i] = total;
+            total.records[POSITION] += chunks[i].data.positions.size();
+            total.records[TEXTURE] += chunks[i].data.textures.size();
+            total.records[NORMAL] += chunks[i].data.normals.size();
+            total.corners += chunks[i].data.corners.size();
+        }
+
+        ObjData data;
+        data.positions.resize(total.records[POSITION]);
+        data.textures.resize(total.records[TEXTURE]);
+        data.normals.resize(total.records[NORMAL]);
+        data.corners.resize(total.corners);
+        pool.parallel_for(chunks.size(), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const auto &chunk = chunks[i];
+                copy_records(chunk.data.positions, data.positions, bases[i].records[POSITION]);
+                copy_records(chunk.data.textures, data.textures, bases[i].records[TEXTURE]);
+                copy_records(chunk.data.normals, data.normals, bases[i].records[NORMAL]);
+                copy_records(chunk.data.corners, data.corners, bases[i].corners);
+                resolve_relative(chunk, bases[i], data.corners);
+            }
+        });
+        return data;
+    }
+
+    ObjData parse_mapped(const std::filesystem::path &filepath) {
+        spdlog::info("Mapping a file: {}", filepath.string());
+        const MappedFile file(filepath, { AccessPattern::SEQUENTIAL });
+        return parse(file.text());
+    }
+
+    ObjData parse_mapped(const std::filesystem::path &filepath, util::ThreadPool &pool) {
+        spdlog::info("Mapping a file: {}", filepath.string());
+        const MappedFile file(filepath, { AccessPattern::SEQUENTIAL });
+        return parse(file.text(), pool);
+    }
+
 } // namespace file::obj::experimental
 
 gl::TriangularMesh ObjFile::read(const std::string &filepath) {
-    std::ifstream fin;
-    fin.open(filepath);
-
     spdlog::info("Opening a file: {}", filepath);
 
-    if (not fin.is_open()) {
-        throw std::runtime_error("could not open the file");
-    }
+    const file::MappedFile file(filepath, { file::AccessPattern::SEQUENTIAL });
+    const auto text = file.text();
+    std::ispanstream fin(std::span { text.data(), text.size() });
 
     std::vector<Coordinates> positions;
     std::vector<Coordinates> normals;
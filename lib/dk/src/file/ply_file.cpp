@@ -0,0 +1,438 @@
+#include <dklib/file/ply_file.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+
+namespace dk::file::ply {
+namespace {
+    [[noreturn]] void reject(std::string_view reason) {
+        spdlog::error("PLY parsing failed: {}", reason);
+        throw std::runtime_error("malformed PLY file");
+    }
+
+    ScalarType scalar_type_from(std::string_view name) {
+        if (name == "char" or name == "int8") {
+            return ScalarType::INT8;
+        } else if (name == "uchar" or name == "uint8") {
+            return ScalarType::UINT8;
+        } else if (name == "short" or name == "int16") {
+            return ScalarType::INT16;
+        } else if (name == "ushort" or name == "uint16") {
+            return ScalarType::UINT16;
+        } else if (name == "int" or name == "int32") {
+            return ScalarType::INT32;
+        } else if (name == "uint" or name == "uint32") {
+            return ScalarType::UINT32;
+        } else if (name == "float" or name == "float32") {
+            return ScalarType::FLOAT32;
+        } else if (name == "double" or name == "float64") {
+            return ScalarType::FLOAT64;
+        }
+        reject("unknown property type");
+    }
+
+    template <typename T>
+    T load(const std::byte *ptr, bool is_swapped) {
+        T value;
+        std::memcpy(&value, ptr, sizeof(T));
+        if constexpr (sizeof(T) > 1) {
+            if (is_swapped) {
+                auto bits = std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+                std::reverse(bits.begin(), bits.end());
+                value = std::bit_cast<T>(bits);
+            }
+        }
+        return value;
+    }
+
+    template <typename Result>
+    Result load_as(const std::byte *ptr, ScalarType type, bool is_swapped) {
+        switch (type) {
+        case ScalarType::INT8:
+            return static_cast<Result>(load<gl::i8>(ptr, is_swapped));
+        case ScalarType::UINT8:
+            return static_cast<Result>(load<gl::u8>(ptr, is_swapped));
+        case ScalarType::INT16:
+            return static_cast<Result>(load<gl::i16>(ptr, is_swapped));
+        case ScalarType::UINT16:
+            return static_cast<Result>(load<gl::u16>(ptr, is_swapped));
+        case ScalarType::INT32:
+            return static_cast<Result>(load<gl::i32>(ptr, is_swapped));
+        case ScalarType::UINT32:
+            return static_cast<Result>(load<gl::u32>(ptr, is_swapped));
+        case ScalarType::FLOAT32:
+            return static_cast<Result>(load<gl::f32>(ptr, is_swapped));
+        case ScalarType::FLOAT64:
+            return static_cast<Result>(load<gl::f64>(ptr, is_swapped));
+        }
+        return Result {};
+    }
+
+    /// Reading position in the body of the file.
+    class Cursor {
+    public:
+        Cursor(std::span<const std::byte> bytes, std::size_t offset)
+            : bytes_(bytes)
+            , offset_(offset) { }
+
+        /// Takes count items of the size, the counts come from the file and
+        /// may be anything.
+        const std::byte *take(std::size_t count, std::size_t item_size = 1) {
+            std::size_t size = 0;
+            if (__builtin_mul_overflow(count, item_size, &size) or size > bytes_.size() - offset_) {
+                reject("file is truncated");
+            }
+            const std::byte *ptr = bytes_.data() + offset_;
+            offset_ += size;
+            return ptr;
+        }
+
+    private:
+        std::span<const std::byte> bytes_;
+        std::size_t offset_;
+    };
+
+    /// Skips a single record of the element, which may contain lists.
+    void skip_record(Cursor &cursor, const Element &element, bool is_swapped) {
+        for (const auto &property : element.properties) {
+            if (property.is_list) {
+                const auto count = load_as<std::size_t>(cursor.take(size_of(property.count_type)), property.count_type, is_swapped);
+                cursor.take(count, size_of(property.type));
+            } else {
+                cursor.take(size_of(property.type));
+            }
+        }
+    }
+
+    void skip_element(Cursor &cursor, const Element &element, bool is_swapped) {
+        if (const auto stride = element.stride(); stride != 0) {
+            cursor.take(element.count, stride);
+            return;
+        }
+        for (std::size_t i = 0; i < element.count; ++i) {
+            skip_record(cursor, element, is_swapped);
+        }
+    }
+
+    /// Copies a single property of a record into a float of the vertex.
+    struct FieldDecoder {
+        std::size_t source_offset;
+        ScalarType type;
+        std::size_t target_offset;
+    };
+
+    /// Decoder specialized for the declared vertex properties and the layout
+    /// of the target vertex type.
+    class VertexDecoder {
+    public:
+        VertexDecoder(const Element &element, const VertexTarget &target, bool is_swapped)
+            : source_stride_(element.stride())
+            , target_stride_(target.stride)
+            , is_swapped_(is_swapped) {
+            if (source_stride_ == 0) {
+                reject("vertex element must not contain lists");
+            }
+            for (const auto &attribute : target.attributes) {
+                if (attribute.type != GL_FLOAT) {
+                    spdlog::error("PLY vertices can only be decoded into float attributes");
+                    throw std::invalid_argument("unsupported vertex attribute type");
+                }
+                const auto names = property_names(attribute.location);
+                for (gl::i32 component = 0; component < attribute.components; ++component) {
+                    if (const auto offset = find_offset(element, names, component); offset.has_value()) {
+                        fields_.push_back(
+                            { offset->first, offset->second, attribute.offset + component * sizeof(gl::f32) }
+                        );
+                    }
+                }
+            }
+            // When the record has the same layout as the vertex, the whole
+            // element is copied at once.
+            is_bulk_copy_ = not is_swapped_ and source_stride_ == target_stride_
+                and fields_.size() * sizeof(gl::f32) == target_stride_
+                and std::ranges::all_of(fields_, [](const FieldDecoder &field) {
+                        return field.type == ScalarType::FLOAT32 and field.source_offset == field.target_offset;
+                    });
+            is_float_only_ = not is_swapped_ and std::ranges::all_of(fields_, [](const FieldDecoder &field) {
+                return field.type == ScalarType::FLOAT32;
+            });
+        }
+
+        void decode(const std::byte *source, std::size_t count, std::byte *target) const {
+            if (is_bulk_copy_) {
+                std::memcpy(target, source, count * target_stride_);
+            } else if (is_float_only_) {
+                for (std::size_t i = 0; i < count; ++i, source += source_stride_, target += target_stride_) {
+                    for (const auto &field : fields_) {
+                        std::memcpy(target + field.target_offset, source + field.source_offset, sizeof(gl::f32));
+                    }
+                }
+            } else {
+                for (std::size_t i = 0; i < count; ++i, source += source_stride_, target += target_stride_) {
+                    for (const auto &field : fields_) {
+                        const auto value = load_as<gl::f32>(source + field.source_offset, field.type, is_swapped_);
+                        std::memcpy(target + field.target_offset, &value, sizeof(value));
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] std::size_t source_stride() const noexcept { return source_stride_; }
+        [[nodiscard]] bool is_bulk_copy() const noexcept { return is_bulk_copy_; }
+
+    private:
+        using Names = std::array<std::array<std::string_view, 3>, 3>;
+
+        /// Accepted property names of each component of the attribute.
+        static Names property_names(gl::u32 location) {
+            switch (location) {
+            case 0:
+                return { { { "x", "y", "z" } } };
+            case 1:
+                return { { { "nx", "ny", "nz" } } };
+            case 2:
+                return { { { "s", "t", "" }, { "u", "v", "" }, { "texture_u", "texture_v", "" } } };
+            default:
+                return {};
+            }
+        }
+
+        static std::optional<std::pair<std::size_t, ScalarType>>
+        find_offset(const Element &element, const Names &names, gl::i32 component) {
+            std::size_t offset = 0;
+            for (const auto &property : element.properties) {
+                for (const auto &alternative : names) {
+                    const auto name = alternative[static_cast<std::size_t>(component)];
+                    if (not name.empty() and property.name == name) {
+                        return std::make_pair(offset, property.type);
+                    }
+                }
+                offset += size_of(property.type);
+            }
+            return std::nullopt;
+        }
+
+        std::vector<FieldDecoder> fields_;
+        std::size_t source_stride_;
+        std::size_t target_stride_;
+        bool is_swapped_;
+        bool is_bulk_copy_ { false };
+        bool is_float_only_ { false };
+    };
+
+    void decode_faces(
+        Cursor &cursor, const Element &element, std::size_t vertex_count, bool is_swapped, std::vector<gl::u32> &indices
+    ) {
+        const auto is_index_list = [](const Property &property) {
+            return property.is_list and (property.name == "vertex_indices" or property.name == "vertex_index");
+        };
+        if (std::ranges::none_of(element.properties, is_index_list)) {
+            reject("face element has no vertex_indices list");
+        }
+        indices.reserve(indices.size() + element.count * 3);
+        for (std::size_t face = 0; face < element.count; ++face) {
+            for (const auto &property : element.properties) {
+                if (not property.is_list) {
+                    cursor.take(size_of(property.type));
+                    continue;
+                }
+                const auto count = load_as<std::size_t>(cursor.take(size_of(property.count_type)), property.count_type, is_swapped);
+                const auto item_size = size_of(property.type);
+                const std::byte *items = cursor.take(count, item_size);
+                if (not is_index_list(property)) {
+                    continue;
+                }
+                if (count < 3) {
+                    reject("face has less than three corners");
+                }
+                const auto index_at = [&](std::size_t corner) {
+                    const auto index = load_as<gl::u32>(items + corner * item_size, property.type, is_swapped);
+                    if (index >= vertex_count) {
+                        reject("face references undefined vertex");
+                    }
+                    return index;
+                };
+                for (std::size_t corner = 2; corner < count; ++corner) {
+                    indices.push_back(index_at(0));
+                    indices.push_back(index_at(corner - 1));
+                    indices.push_back(index_at(corner));
+                }
+            }
+        }
+    }
+} // namespace
+
+std::size_t size_of(ScalarType type) {
+    switch (type) {
+    case ScalarType::INT8:
+    case ScalarType::UINT8:
+        return 1;
+    case ScalarType::INT16:
+    case ScalarType::UINT16:
+        return 2;
+    case ScalarType::INT32:
+    case ScalarType::UINT32:
+    case ScalarType::FLOAT32:
+        return 4;
+    case ScalarType::FLOAT64:
+        return 8;
+    }
+    return 0;
+}
+
+std::size_t Element::stride() const {
+    std::size_t stride = 0;
+    for (const auto &property : properties) {
+        if (property.is_list) {
+            return 0;
+        }
+        stride += size_of(property.type);
+    }
+    return stride;
+}
+
+Header parse_header(std::span<const std::byte> bytes) {
+    const std::string_view text { reinterpret_cast<const char *>(bytes.data()), bytes.size() };
+    // the marker has to be a whole line, it may appear in a comment too
+    constexpr std::string_view end_marker = "end_header";
+    auto end = std::string_view::npos;
+    auto body = std::string_view::npos;
+    for (std::size_t line = 0; line < text.size();) {
+        const auto line_end = text.find('\n', line);
+        if (line_end == std::string_view::npos) {
+            break;
+        }
+        auto content = text.substr(line, line_end - line);
+        if (content.ends_with('\r')) {
+            content.remove_suffix(1);
+        }
+        if (content == end_marker) {
+            end = line;
+            body = line_end;
+            break;
+        }
+        line = line_end + 1;
+    }
+    if (not text.starts_with("ply") or end == std::string_view::npos or body == std::string_view::npos) {
+        reject("missing ply header");
+    }
+
+    Header header;
+    header.body_offset = body + 1;
+    bool has_format = false;
+    std::istringstream lines { std::string { text.substr(0, end) } };
+    for (std::string line; std::getline(lines, line);) {
+        std::istringstream ss(line);
+        std::string keyword;
+        ss >> keyword;
+        if (keyword == "format") {
+            std::string format;
+            ss >> format;
+            if (format == "binary_little_endian") {
+                header.format = Format::BINARY_LITTLE_ENDIAN;
+            } else if (format == "binary_big_endian") {
+                header.format = Format::BINARY_BIG_ENDIAN;
+            } else {
+                header.format = Format::ASCII;
+            }
+            has_format = true;
+        } else if (keyword == "element") {
+            Element element;
+            ss >> element.name >> element.count;
+            if (ss.fail()) {
+                reject("malformed element declaration");
+            }
+            header.elements.push_back(std::move(element));
+        } else if (keyword == "property") {
+            if (header.elements.empty()) {
+                reject("property declared before any element");
+            }
+            Property property;
+            std::string type;
+            ss >> type;
+            if (type == "list") {
+                std::string count_type;
+                ss >> count_type >> type;
+                property.is_list = true;
+                property.count_type = scalar_type_from(count_type);
+                if (property.count_type == ScalarType::FLOAT32 or property.count_type == ScalarType::FLOAT64) {
+                    reject("list count type must be an integer");
+                }
+            }
+            property.type = scalar_type_from(type);
+            ss >> property.name;
+            header.elements.back().properties.push_back(std::move(property));
+        }
+        // comments and obj_info lines are ignored
+    }
+    if (not has_format) {
+        reject("missing format declaration");
+    }
+
+    // the counts are checked against the body before anything is allocated
+    // for them, a record takes at least its scalars and list counts, or a
+    // line of an ASCII file
+    std::size_t remaining = bytes.size() - header.body_offset;
+    for (const auto &element : header.elements) {
+        std::size_t record_size = 1;
+        if (header.format != Format::ASCII) {
+            record_size = 0;
+            for (const auto &property : element.properties) {
+                record_size += size_of(property.is_list ? property.count_type : property.type);
+            }
+        }
+        std::size_t element_size = 0;
+        if (element.count != 0 and record_size == 0) {
+            reject("element has records without properties");
+        }
+        if (__builtin_mul_overflow(element.count, record_size, &element_size) or element_size > remaining) {
+            reject("element count exceeds the file size");
+        }
+        remaining -= element_size;
+    }
+    return header;
+}
+
+std::size_t count_of(const Header &header, std::string_view element_name) {
+    for (const auto &element : header.elements) {
+        if (element.name == element_name) {
+            return element.count;
+        }
+    }
+    return 0;
+}
+
+void decode(
+    const Header &header, std::span<const std::byte> bytes, const VertexTarget &target, std::vector<gl::u32> &indices
+) {
+    if (header.format == Format::ASCII) {
+        spdlog::error("ASCII PLY files are not supported, only the binary ones");
+        throw std::runtime_error("unsupported PLY format");
+    }
+    const bool is_swapped = (header.format == Format::BINARY_LITTLE_ENDIAN) != (std::endian::native == std::endian::little);
+    const std::size_t vertex_count = count_of(header, "vertex");
+    if (target.vertices.size() < vertex_count * target.stride) {
+        throw std::invalid_argument("vertex target is too small");
+    }
+
+    Cursor cursor(bytes, header.body_offset);
+    for (const auto &element : header.elements) {
+        if (element.name == "vertex") {
+            const VertexDecoder decoder(element, target, is_swapped);
+            const std::byte *records = cursor.take(element.count, decoder.source_stride());
+            decoder.decode(records, element.count, target.vertices.data());
+        } else if (element.name == "face") {
+            decode_faces(cursor, element, vertex_count, is_swapped, indices);
+        } else {
+            skip_element(cursor, element, is_swapped);
+        }
+    }
+}
+} // namespace dk::file::ply
@@ -107,6 +107,8 @@ Application::Application(std::string &&title) {
     );
 
     context = SDL_GL_CreateContext(window.get());
+    // names cached for a previous context mean nothing in this one
+    gl::StateCache::get_instance().invalidate();
 
     SDL_GL_SetSwapInterval(1);
 
@@ -151,6 +153,13 @@ void Application::handle_events() {
     }
 }
 
+gl::HotReloader &Application::get_hot_reloader() {
+    if (hot_reloader_ == nullptr) {
+        hot_reloader_ = std::make_unique<gl::HotReloader>();
+    }
+    return *hot_reloader_;
+}
+
 void Application::run(Application &app) {
     spdlog::info("Starting the application");
     bool running = true;
@@ -185,13 +194,22 @@ void Application::run(Application &app) {
         ImGui::NewFrame();
         // ImGui::ShowDemoWindow();
 
+        if (hot_reloader_ != nullptr) {
+            hot_reloader_->update();
+        }
         render(static_cast<dk::gl::f64>(SDL_GetTicks()) / 1000);
         render_gui();
 
         ImGui::Render();
+        // the backend restores the state it changes, the StateCache stays
+        // valid across it
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
         SDL_GL_SwapWindow(window.get());
+        if (hot_reloader_ != nullptr) {
+            hot_reloader_->frame_presented();
+        }
+        gl::StateCache::get_instance().end_frame();
     } while (running_);
     spdlog::info("Ending the application");
 }
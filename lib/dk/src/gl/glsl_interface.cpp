@@ -0,0 +1,450 @@
+#include <dklib/gl/glsl_interface.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+namespace dk::gl::glsl {
+namespace {
+    bool is_identifier_char(char c) { return std::isalnum(static_cast<unsigned char>(c)) != 0 or c == '_'; }
+
+    /// Splits the source into identifiers, numbers and single punctuation
+    /// characters, without the comments and preprocessor directives.
+    std::vector<std::string_view> tokenize(std::string_view source) {
+        std::vector<std::string_view> tokens;
+        bool is_line_start = true;
+        std::size_t i = 0;
+        while (i < source.size()) {
+            const char c = source[i];
+            if (c == '\n') {
+                is_line_start = true;
+                ++i;
+            } else if (std::isspace(static_cast<unsigned char>(c)) != 0) {
+                ++i;
+            } else if (source.substr(i, 2) == "//") {
+                i = std::min(source.find('\n', i), source.size());
+            } else if (source.substr(i, 2) == "/*") {
+                const auto end = source.find("*/", i + 2);
+                i = end == std::string_view::npos ? source.size() : end + 2;
+            } else if (c == '#' and is_line_start) {
+                // directive ends with the line, unless it is continued
+                while (i < source.size() and (source[i] != '\n' or source[i - 1] == '\\')) {
+                    ++i;
+                }
+            } else if (is_identifier_char(c)) {
+                const auto begin = i;
+                while (i < source.size() and is_identifier_char(source[i])) {
+                    ++i;
+                }
+                tokens.push_back(source.substr(begin, i - begin));
+                is_line_start = false;
+            } else {
+                tokens.push_back(source.substr(i, 1));
+                is_line_start = false;
+                ++i;
+            }
+        }
+        return tokens;
+    }
+
+    std::optional<i32> to_integer(std::string_view token) {
+        i32 value = 0;
+        const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (error != std::errc {} or end != token.data() + token.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    constexpr std::array QUALIFIERS = {
+        "const",  "uniform",   "buffer",   "in",     "out",      "inout",    "attribute", "varying",
+        "flat",   "smooth",    "noperspective", "centroid", "sample", "patch", "highp",     "mediump",
+        "lowp",   "invariant", "precise",  "coherent", "volatile", "restrict", "readonly",  "writeonly",
+        "shared", "row_major", "column_major",
+    };
+
+    /// Declaration split into its qualifiers and the rest.
+    struct Declaration {
+        std::vector<std::string_view> qualifiers;
+        std::optional<i32> location;
+        std::optional<i32> binding;
+        std::span<const std::string_view> rest;
+
+        [[nodiscard]] bool has(std::string_view qualifier) const {
+            return std::ranges::find(qualifiers, qualifier) != qualifiers.end();
+        }
+    };
+
+    Declaration split_declaration(std::span<const std::string_view> tokens) {
+        Declaration declaration;
+        std::size_t i = 0;
+        while (i < tokens.size()) {
+            if (tokens[i] == "layout" and i + 1 < tokens.size() and tokens[i + 1] == "(") {
+                // layout(key = value, key, ...)
+                i += 2;
+                while (i < tokens.size() and tokens[i] != ")") {
+                    const auto key = tokens[i];
+                    if (i + 2 < tokens.size() and tokens[i + 1] == "=") {
+                        if (key == "location") {
+                            declaration.location = to_integer(tokens[i + 2]);
+                        } else if (key == "binding") {
+                            declaration.binding = to_integer(tokens[i + 2]);
+                        }
+                        i += 2;
+                    }
+                    ++i;
+                }
+                ++i;
+            } else if (std::ranges::find(QUALIFIERS, tokens[i]) != QUALIFIERS.end()) {
+                declaration.qualifiers.push_back(tokens[i]);
+                ++i;
+            } else {
+                break;
+            }
+        }
+        declaration.rest = tokens.subspan(i);
+        return declaration;
+    }
+
+    /// Reads "[N]", returns the position after it.
+    std::size_t read_array_size(std::span<const std::string_view> tokens, std::size_t i, std::optional<u32> &size) {
+        if (i >= tokens.size() or tokens[i] != "[") {
+            return i;
+        }
+        const auto close = std::ranges::find(tokens.subspan(i), "]") - tokens.begin();
+        const auto value = close == static_cast<std::ptrdiff_t>(i + 2) ? to_integer(tokens[i + 1]) : std::nullopt;
+        size = value.has_value() ? static_cast<u32>(*value) : 0;
+        return static_cast<std::size_t>(close) + 1;
+    }
+
+    /// Reads "type name[N] = value, other, ..." into the variables.
+    void read_variables(const Declaration &declaration, std::vector<Variable> &variables) {
+        const auto tokens = declaration.rest;
+        if (tokens.size() < 2) {
+            return;
+        }
+        std::optional<u32> type_array_size;
+        auto i = read_array_size(tokens, 1, type_array_size);
+        while (i < tokens.size()) {
+            Variable variable {
+                .type = std::string(tokens[0]),
+                .name = std::string(tokens[i]),
+                .array_size = type_array_size,
+                .location = declaration.location,
+                .binding = declaration.binding,
+            };
+            i = read_array_size(tokens, i + 1, variable.array_size);
+            variables.push_back(std::move(variable));
+            // skip the initializer up to the next declarator
+            int depth = 0;
+            while (i < tokens.size() and (depth > 0 or tokens[i] != ",")) {
+                depth += tokens[i] == "(" ? 1 : tokens[i] == ")" ? -1 : 0;
+                ++i;
+            }
+            ++i;
+        }
+    }
+
+    class Parser {
+    public:
+        explicit Parser(std::string_view source)
+            : tokens_(tokenize(source)) { }
+
+        Interface parse(ShaderType type) {
+            Interface interface;
+            while (pos_ < tokens_.size()) {
+                const auto begin = pos_;
+                while (pos_ < tokens_.size() and tokens_[pos_] != ";" and tokens_[pos_] != "{") {
+                    ++pos_;
+                }
+                const auto declaration = split_declaration(std::span { tokens_ }.subspan(begin, pos_ - begin));
+                if (pos_ == tokens_.size()) {
+                    break;
+                }
+                if (tokens_[pos_] == ";") {
+                    ++pos_;
+                    if (declaration.has("uniform")) {
+                        read_variables(declaration, interface.uniforms);
+                    } else if (type == ShaderType::VERTEX and (declaration.has("in") or declaration.has("attribute"))) {
+                        read_variables(declaration, interface.attributes);
+                    }
+                } else if (declaration.has("uniform") or declaration.has("buffer")) {
+                    interface.blocks.push_back(read_block(declaration));
+                } else {
+                    // functions, structs and in/out blocks
+                    skip_braces();
+                    if (not declaration.has("in") and not declaration.has("out") and not is_struct(declaration)) {
+                        continue;
+                    }
+                    while (pos_ < tokens_.size() and tokens_[pos_] != ";") {
+                        ++pos_;
+                    }
+                    ++pos_;
+                }
+            }
+            return interface;
+        }
+
+    private:
+        static bool is_struct(const Declaration &declaration) {
+            return not declaration.rest.empty() and declaration.rest.front() == "struct";
+        }
+
+        /// Skips from "{" past the matching "}".
+        void skip_braces() {
+            int depth = 0;
+            do {
+                if (pos_ == tokens_.size()) {
+                    spdlog::error("GLSL source has unbalanced braces");
+                    throw std::runtime_error("GLSL source has unbalanced braces");
+                }
+                depth += tokens_[pos_] == "{" ? 1 : tokens_[pos_] == "}" ? -1 : 0;
+                ++pos_;
+            } while (depth > 0);
+        }
+
+        Block read_block(const Declaration &declaration) {
+            Block block {
+                .name = declaration.rest.empty() ? std::string {} : std::string(declaration.rest.front()),
+                .instance = {},
+                .is_storage = declaration.has("buffer"),
+                .binding = declaration.binding,
+                .members = {},
+            };
+            ++pos_;
+            while (pos_ < tokens_.size() and tokens_[pos_] != "}") {
+                const auto begin = pos_;
+                while (pos_ < tokens_.size() and tokens_[pos_] != ";") {
+                    ++pos_;
+                }
+                read_variables(split_declaration(std::span { tokens_ }.subspan(begin, pos_ - begin)), block.members);
+                ++pos_;
+            }
+            if (pos_ >= tokens_.size()) {
+                spdlog::error("GLSL block {} is not closed", block.name);
+                throw std::runtime_error("GLSL source has unbalanced braces");
+            }
+            ++pos_;
+            if (pos_ < tokens_.size() and tokens_[pos_] != ";") {
+                block.instance = tokens_[pos_];
+            }
+            while (pos_ < tokens_.size() and tokens_[pos_] != ";") {
+                ++pos_;
+            }
+            ++pos_;
+            return block;
+        }
+
+        std::vector<std::string_view> tokens_;
+        std::size_t pos_ { 0 };
+    };
+
+    template <typename T>
+    void merge_by_name(std::vector<T> &into, const std::vector<T> &from) {
+        for (const auto &item : from) {
+            if (std::ranges::find(into, item.name, &T::name) == into.end()) {
+                into.push_back(item);
+            }
+        }
+    }
+
+    std::string to_upper_snake(std::string_view name) {
+        std::string result;
+        for (std::size_t i = 0; i < name.size(); ++i) {
+            const auto c = static_cast<unsigned char>(name[i]);
+            if (std::isupper(c) != 0 and i > 0 and std::islower(static_cast<unsigned char>(name[i - 1])) != 0) {
+                result += '_';
+            }
+            result += static_cast<char>(std::toupper(c));
+        }
+        return result;
+    }
+
+    std::string_view stage_name(ShaderType type) {
+        switch (type) {
+        case ShaderType::VERTEX:
+            return "VERTEX";
+        case ShaderType::FRAGMENT:
+            return "FRAGMENT";
+        case ShaderType::GEOMETRY:
+            return "GEOMETRY";
+        case ShaderType::TESS_CONTROL:
+            return "TESS_CONTROL";
+        case ShaderType::TESS_EVALUATION:
+            return "TESS_EVALUATION";
+        case ShaderType::COMPUTE:
+            return "COMPUTE";
+        }
+        return "UNKNOWN";
+    }
+
+    /// Typed setters of the uniform, empty when the type has none.
+    std::vector<std::string> make_setters(const Variable &uniform) {
+        const auto member = uniform.name + "_";
+        const auto setter = [&](std::string_view parameters, std::string_view call) {
+            return fmt::format("    void set_{}({}) const noexcept {{ {}.{}; }}\n", uniform.name, parameters, member,
+                               call);
+        };
+        if (uniform.array_size.has_value()) {
+            return {};
+        }
+        const auto &type = uniform.type;
+        if (type == "float") {
+            return { setter("dk::gl::f32 value", "set(value)") };
+        }
+        if (type == "int") {
+            return { setter("dk::gl::i32 value", "set(value)") };
+        }
+        if (type == "uint") {
+            return { setter("dk::gl::u32 value", "set(value)") };
+        }
+        if (type == "bool") {
+            return { setter("bool value", "set(static_cast<dk::gl::i32>(value))") };
+        }
+        if (type.find("sampler") != std::string::npos or type.find("image") != std::string::npos) {
+            return { setter("dk::gl::i32 unit", "set(unit)") };
+        }
+        if (type == "mat2" or type == "mat3" or type == "mat4") {
+            const auto size = type.back();
+            return { setter(fmt::format("const vmath::mat{} &value", size), fmt::format("set_matrix{}(value)", size)) };
+        }
+        constexpr std::array<std::array<std::string_view, 3>, 3> VECTORS = { {
+            { "vec", "dk::gl::f32", "vmath::vec" },
+            { "ivec", "dk::gl::i32", "vmath::ivec" },
+            { "uvec", "dk::gl::u32", "vmath::uvec" },
+        } };
+        for (const auto &[prefix, scalar, vector] : VECTORS) {
+            if (type.size() != prefix.size() + 1 or not type.starts_with(prefix)) {
+                continue;
+            }
+            const auto count = type.back() - '0';
+            if (count < 2 or count > 4) {
+                continue;
+            }
+            constexpr std::array<std::string_view, 4> COMPONENTS = { "x", "y", "z", "w" };
+            std::string parameters;
+            std::string arguments;
+            for (int i = 0; i < count; ++i) {
+                parameters += fmt::format("{}{} {}", i == 0 ? "" : ", ", scalar, COMPONENTS[static_cast<std::size_t>(i)]);
+                arguments += fmt::format("{}{}", i == 0 ? "" : ", ", COMPONENTS[static_cast<std::size_t>(i)]);
+            }
+            return {
+                setter(parameters, fmt::format("set({})", arguments)),
+                setter(fmt::format("const {}{} &value", vector, count),
+                       fmt::format("set(std::span<const {0}, {1}> {{ static_cast<const {0} *>(value), {1} }})", scalar,
+                                   count)),
+            };
+        }
+        return {};
+    }
+} // namespace
+
+void Interface::merge(const Interface &other) {
+    merge_by_name(uniforms, other.uniforms);
+    merge_by_name(blocks, other.blocks);
+    merge_by_name(attributes, other.attributes);
+}
+
+Interface parse_interface(std::string_view source, ShaderType type) { return Parser(source).parse(type); }
+
+std::string generate_header(std::string_view name, std::span<const ShaderFile> shaders, const Interface &interface) {
+    const auto guard = fmt::format("DK_GLSL_{}_HPP", to_upper_snake(name));
+    std::string out;
+    out += "// Generated by dk_glsl_interface from\n";
+    for (const auto &shader : shaders) {
+        out += fmt::format("//   {}\n", shader.path.generic_string());
+    }
+    out += "// Do not edit, it is generated again whenever the shaders change.\n";
+    out += fmt::format("#ifndef {0}\n#define {0}\n\n", guard);
+    out += "#include <dklib/gl/program.hpp>\n#include <dklib/gl/uniform.hpp>\n#include <dklib/math/vmath.h>\n\n";
+    out += "#include <span>\n#include <string>\n\n";
+    out += "namespace dk::glsl {\n\n";
+    out += fmt::format("struct {} {{\n", name);
+
+    for (const auto &shader : shaders) {
+        out += fmt::format("    static constexpr const char *{}_SHADER = \"{}\";\n", stage_name(shader.type),
+                           shader.path.generic_string());
+    }
+    for (const auto &attribute : interface.attributes) {
+        if (attribute.location.has_value()) {
+            out += fmt::format("    static constexpr dk::gl::u32 {}_LOCATION = {};\n", to_upper_snake(attribute.name),
+                               *attribute.location);
+        }
+    }
+    for (const auto &block : interface.blocks) {
+        const auto constant = to_upper_snake(block.name);
+        out += fmt::format("    static constexpr const char *{}_BLOCK = \"{}\";\n", constant, block.name);
+        if (block.binding.has_value()) {
+            out += fmt::format("    static constexpr dk::gl::u32 {}_BINDING = {};\n", constant, *block.binding);
+        }
+    }
+    for (const auto &uniform : interface.uniforms) {
+        if (uniform.location.has_value()) {
+            out += fmt::format("    static constexpr dk::gl::i32 {}_LOCATION = {};\n", to_upper_snake(uniform.name),
+                               *uniform.location);
+        }
+        if (uniform.binding.has_value()) {
+            out += fmt::format("    static constexpr dk::gl::u32 {}_BINDING = {};\n", to_upper_snake(uniform.name),
+                               *uniform.binding);
+        }
+    }
+
+    out += "\n    /// @brief Attaches the shaders of the interface to the program.\n";
+    out += "    static dk::gl::Program &attach_shaders(dk::gl::Program &program) {\n        return program";
+    for (const auto &shader : shaders) {
+        out += fmt::format("\n            .attach_shader(std::string({0}_SHADER), dk::gl::ShaderType::{0})",
+                           stage_name(shader.type));
+    }
+    out += ";\n    }\n\n";
+
+    out += "    /// @brief Resolves the uniforms of the linked program, their names are\n";
+    out += "    /// hashed at compile time.\n";
+    if (interface.uniforms.empty()) {
+        out += fmt::format("    explicit {}([[maybe_unused]] dk::gl::Program &program) {{ }}\n", name);
+    } else {
+        out += fmt::format("    explicit {}(dk::gl::Program &program)\n", name);
+        for (std::size_t i = 0; i < interface.uniforms.size(); ++i) {
+            const auto &uniform = interface.uniforms[i];
+            out += fmt::format("        {} {}_(resolve(program, \"{}\"))\n", i == 0 ? ':' : ',', uniform.name,
+                               uniform.name);
+        }
+        out += "    { }\n";
+    }
+
+    for (const auto &uniform : interface.uniforms) {
+        out += "\n";
+        const auto setters = make_setters(uniform);
+        if (setters.empty()) {
+            out += fmt::format("    // {} {}{}: no typed setter, use get_{}()\n", uniform.type, uniform.name,
+                               uniform.array_size.has_value() ? "[]" : "", uniform.name);
+        }
+        for (const auto &setter : setters) {
+            out += setter;
+        }
+        out += fmt::format("    [[nodiscard]] const dk::gl::Uniform &get_{0}() const noexcept {{ return {0}_; }}\n",
+                           uniform.name);
+    }
+
+    out += "\nprivate:\n";
+    out += "    static dk::gl::Uniform resolve(dk::gl::Program &program, const dk::gl::ResourceName &name) {\n";
+    out += "        // drivers remove the uniforms the shaders do not use, setting them does nothing\n";
+    out += "        if (not program.find_uniform(name).has_value()) {\n";
+    out += "            return { -1, std::string(name.text) };\n";
+    out += "        }\n";
+    out += "        return program.make_uniform(name);\n";
+    out += "    }\n";
+    if (not interface.uniforms.empty()) {
+        out += "\n";
+    }
+    for (const auto &uniform : interface.uniforms) {
+        out += fmt::format("    dk::gl::Uniform {}_;\n", uniform.name);
+    }
+    out += "};\n\n} // namespace dk::glsl\n\n";
+    out += fmt::format("#endif // {}\n", guard);
+    return out;
+}
+} // namespace dk::gl::glsl
@@ -0,0 +1,71 @@
+#include <dklib/gl/headless_context.hpp>
+#include <dklib/gl/state_cache.hpp>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <spdlog/spdlog.h>
+
+#include <stdexcept>
+
+namespace dk::gl {
+namespace {
+    EGLDisplay get_display() {
+        const auto get_platform_display
+            = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (get_platform_display != nullptr) {
+            const auto display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY) {
+                return display;
+            }
+        }
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+} // namespace
+
+HeadlessContext::HeadlessContext(gl::i32 major, gl::i32 minor) {
+    const auto display = get_display();
+    if (display == EGL_NO_DISPLAY or eglInitialize(display, nullptr, nullptr) != EGL_TRUE) {
+        spdlog::error("EGL display could not be initialized, error {:#x}", eglGetError());
+        throw std::runtime_error("EGL display could not be initialized");
+    }
+    display_ = display;
+
+    if (eglBindAPI(EGL_OPENGL_API) != EGL_TRUE) {
+        eglTerminate(display);
+        spdlog::error("EGL does not support desktop OpenGL");
+        throw std::runtime_error("EGL does not support desktop OpenGL");
+    }
+
+    const EGLint attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+    // no config, the context is never bound to a surface
+    const auto context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+    if (context == EGL_NO_CONTEXT) {
+        eglTerminate(display);
+        spdlog::error("OpenGL {}.{} context could not be created, error {:#x}", major, minor, eglGetError());
+        throw std::runtime_error("OpenGL context could not be created");
+    }
+    context_ = context;
+    make_current();
+}
+
+HeadlessContext::~HeadlessContext() {
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    StateCache::get_instance().invalidate();
+    eglDestroyContext(display_, context_);
+    eglTerminate(display_);
+}
+
+void HeadlessContext::make_current() const {
+    if (eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, context_) != EGL_TRUE) {
+        spdlog::error("EGL context could not be made current, error {:#x}", eglGetError());
+        throw std::runtime_error("EGL context could not be made current");
+    }
+    // the names cached for the previously current context mean nothing here
+    StateCache::get_instance().invalidate();
+}
+} // namespace dk::gl
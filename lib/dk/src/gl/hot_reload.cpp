@@ -0,0 +1,99 @@
+#include <dklib/gl/hot_reload.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace dk::gl {
+
+void HotReloader::watch(Program &program, ProgramCallback on_reload) {
+    auto &watch = programs_.emplace_back(ProgramWatch { &program, std::move(on_reload), {} });
+    watch_files(watch);
+}
+
+void HotReloader::unwatch(const Program &program) {
+    std::erase_if(programs_, [&](ProgramWatch &watch) {
+        if (watch.program != &program) {
+            return false;
+        }
+        for (const auto id : watch.ids) {
+            watcher_.unwatch(id);
+        }
+        return true;
+    });
+}
+
+void HotReloader::watch_files(ProgramWatch &watch) {
+    // new watches come first, so the directories stay watched all the time
+    auto previous = std::exchange(watch.ids, {});
+    for (const auto &path : watch.program->get_files()) {
+        watch.ids.push_back(watcher_.watch(path, [this, &watch](const file::FileChange &change) {
+            const auto result = watch.program->reload(change.path);
+            watch_files(watch);
+            if (result == ReloadResult::UNCHANGED) {
+                return;
+            }
+            // a failed reload leaves the previous program in place
+            if (result == ReloadResult::RELOADED and watch.on_reload) {
+                watch.on_reload(*watch.program);
+            }
+            reloaded(change, result == ReloadResult::RELOADED);
+        }));
+    }
+    for (const auto id : previous) {
+        watcher_.unwatch(id);
+    }
+}
+
+void HotReloader::watch(const std::filesystem::path &filepath, ReloadFunction reload) {
+    unwatch(filepath);
+    const auto id = watcher_.watch(filepath, [this, reload = std::move(reload)](const file::FileChange &change) {
+        try {
+            reload(change.path);
+            reloaded(change, true);
+        } catch (const std::exception &error) {
+            spdlog::error("{} could not be reloaded: {}", change.path.string(), error.what());
+            reloaded(change, false);
+        }
+    });
+    assets_.emplace(filepath.string(), id);
+}
+
+void HotReloader::unwatch(const std::filesystem::path &filepath) {
+    const auto asset = assets_.find(filepath.string());
+    if (asset != assets_.end()) {
+        watcher_.unwatch(asset->second);
+        assets_.erase(asset);
+    }
+}
+
+std::size_t HotReloader::update() {
+    update_reload_count_ = 0;
+    watcher_.poll();
+    return update_reload_count_;
+}
+
+void HotReloader::reloaded(const file::FileChange &change, bool is_success) {
+    if (not is_success) {
+        ++stats_.failure_count;
+        return;
+    }
+    ++stats_.reload_count;
+    ++update_reload_count_;
+    pending_written_ = std::min(pending_written_.value_or(change.written), change.written);
+}
+
+void HotReloader::frame_presented() {
+    if (not pending_written_.has_value()) {
+        return;
+    }
+    const auto latency = std::filesystem::file_time_type::clock::now() - *pending_written_;
+    stats_.last_latency = std::chrono::duration_cast<std::chrono::duration<f64, std::milli>>(latency);
+    stats_.max_latency = std::max(stats_.max_latency, stats_.last_latency);
+    pending_written_.reset();
+    spdlog::info("Reload presented {:.1f} ms after the file was written", stats_.last_latency.count());
+}
+
+} // namespace dk::gl
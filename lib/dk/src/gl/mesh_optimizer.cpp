@@ -0,0 +1,372 @@
+#include <dklib/gl/mesh_optimizer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+namespace dk::gl {
+namespace {
+    void check_indices(std::span<const u32> indices, std::size_t vertex_count) {
+        if (indices.size() % 3 != 0) {
+            spdlog::error("Mesh optimizer got {} indices, which is not a triangle list", indices.size());
+            throw std::runtime_error("indices are not a triangle list");
+        }
+        const auto out_of_range = std::ranges::find_if(indices, [&](u32 index) { return index >= vertex_count; });
+        if (out_of_range != indices.end()) {
+            spdlog::error("Mesh optimizer got the index {} of only {} vertices", *out_of_range, vertex_count);
+            throw std::runtime_error("index out of range");
+        }
+    }
+
+    /// FIFO cache of the vertex indices, an entry is cached as long as fewer
+    /// than size entries were added after it.
+    class FifoCache {
+    public:
+        FifoCache(std::size_t entry_count, std::size_t size)
+            : added_at_(entry_count, 0)
+            , size_(size)
+            , timestamp_(size + 1) { }
+
+        /// @return whether the entry was missing
+        bool access(std::size_t entry) {
+            if (timestamp_ - added_at_[entry] <= size_) {
+                return false;
+            }
+            added_at_[entry] = timestamp_++;
+            return true;
+        }
+
+        u32 access_triangle(const u32 *triangle) {
+            return static_cast<u32>(access(triangle[0])) + access(triangle[1]) + access(triangle[2]);
+        }
+
+        void flush() { timestamp_ += size_ + 1; }
+
+    private:
+        std::vector<std::size_t> added_at_;
+        std::size_t size_;
+        std::size_t timestamp_;
+    };
+
+    // Forsyth, "Linear-Speed Vertex Cache Optimisation", scores of a vertex
+    // by its position in a simulated LRU cache and by its triangles left.
+    constexpr std::size_t FORSYTH_CACHE_SIZE = 32;
+    constexpr f32 CACHE_DECAY_POWER = 1.5f;
+    constexpr f32 LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr f32 VALENCE_BOOST_SCALE = 2.0f;
+    constexpr f32 VALENCE_BOOST_POWER = 0.5f;
+    constexpr std::size_t VALENCE_TABLE_SIZE = 64;
+    constexpr u32 NO_TRIANGLE = ~u32 { 0 };
+
+    class VertexScores {
+    public:
+        VertexScores() {
+            for (std::size_t position = 0; position < FORSYTH_CACHE_SIZE; ++position) {
+                if (position < 3) {
+                    cache_scores_[position] = LAST_TRIANGLE_SCORE;
+                } else {
+                    const f32 scaler = 1.0f / static_cast<f32>(FORSYTH_CACHE_SIZE - 3);
+                    cache_scores_[position]
+                        = std::pow(1.0f - static_cast<f32>(position - 3) * scaler, CACHE_DECAY_POWER);
+                }
+            }
+            for (std::size_t valence = 1; valence < VALENCE_TABLE_SIZE; ++valence) {
+                valence_scores_[valence] = valence_score(valence);
+            }
+        }
+
+        /// Score of a vertex, the cache position is negative outside of it.
+        [[nodiscard]] f32 get(i32 cache_position, u32 remaining) const {
+            if (remaining == 0) {
+                return -1.0f;
+            }
+            const f32 cache_score = cache_position < 0 ? 0.0f : cache_scores_[static_cast<std::size_t>(cache_position)];
+            return cache_score + (remaining < VALENCE_TABLE_SIZE ? valence_scores_[remaining] : valence_score(remaining));
+        }
+
+    private:
+        static f32 valence_score(std::size_t remaining) {
+            return VALENCE_BOOST_SCALE * std::pow(static_cast<f32>(remaining), -VALENCE_BOOST_POWER);
+        }
+
+        std::array<f32, FORSYTH_CACHE_SIZE> cache_scores_ {};
+        std::array<f32, VALENCE_TABLE_SIZE> valence_scores_ {};
+    };
+
+    struct Float3 {
+        f32 x, y, z;
+    };
+
+    Float3 operator-(const Float3 &lhs, const Float3 &rhs) { return { lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z }; }
+    Float3 operator+(const Float3 &lhs, const Float3 &rhs) { return { lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z }; }
+    Float3 operator*(const Float3 &lhs, f32 value) { return { lhs.x * value, lhs.y * value, lhs.z * value }; }
+    f32 dot(const Float3 &lhs, const Float3 &rhs) { return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z; }
+    Float3 cross(const Float3 &lhs, const Float3 &rhs) {
+        return { lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x };
+    }
+
+    /// Area weighted sums of the triangles of a cluster, or of the mesh.
+    struct SurfaceSums {
+        Float3 centroid { 0.0f, 0.0f, 0.0f };
+        /// Twice the area weighted normal
+        Float3 normal { 0.0f, 0.0f, 0.0f };
+        f32 area { 0.0f };
+
+        void add(const Float3 &a, const Float3 &b, const Float3 &c) {
+            const Float3 product = cross(b - a, c - a);
+            const f32 triangle_area = std::sqrt(dot(product, product)) * 0.5f;
+            centroid = centroid + (a + b + c) * (triangle_area / 3.0f);
+            normal = normal + product;
+            area += triangle_area;
+        }
+
+        [[nodiscard]] Float3 get_centroid() const {
+            return area > 0.0f ? centroid * (1.0f / area) : Float3 { 0.0f, 0.0f, 0.0f };
+        }
+    };
+} // namespace
+
+VertexCacheStats analyze_vertex_cache(std::span<const u32> indices, std::size_t vertex_count, std::size_t vertex_size,
+                                      u32 cache_size) {
+    check_indices(indices, vertex_count);
+    VertexCacheStats stats;
+    if (indices.empty()) {
+        return stats;
+    }
+    // 16 KiB of 64 byte lines
+    constexpr std::size_t LINE_SIZE = 64;
+    constexpr std::size_t LINE_COUNT = 256;
+    FifoCache vertex_cache(vertex_count, cache_size);
+    FifoCache line_cache((vertex_count * vertex_size + LINE_SIZE - 1) / LINE_SIZE, LINE_COUNT);
+    std::size_t transformed = 0;
+    std::size_t fetched = 0;
+    for (const auto index : indices) {
+        if (not vertex_cache.access(index)) {
+            continue;
+        }
+        ++transformed;
+        // vertices hitting the post-transform cache are not fetched
+        if (vertex_size != 0) {
+            const std::size_t first_line = index * vertex_size / LINE_SIZE;
+            const std::size_t last_line = (index * vertex_size + vertex_size - 1) / LINE_SIZE;
+            for (std::size_t line = first_line; line <= last_line; ++line) {
+                fetched += line_cache.access(line) ? LINE_SIZE : 0;
+            }
+        }
+    }
+    stats.acmr = static_cast<f32>(transformed) / static_cast<f32>(indices.size() / 3);
+    stats.atvr = static_cast<f32>(transformed) / static_cast<f32>(vertex_count);
+    if (vertex_size != 0) {
+        stats.overfetch = static_cast<f32>(fetched) / static_cast<f32>(vertex_count * vertex_size);
+    }
+    return stats;
+}
+
+std::vector<u32> optimize_vertex_cache(std::span<const u32> indices, std::size_t vertex_count) {
+    check_indices(indices, vertex_count);
+    const std::size_t triangle_count = indices.size() / 3;
+
+    // triangles of each vertex, the first remaining[vertex] of them are not
+    // emitted yet
+    std::vector<u32> offsets(vertex_count + 1, 0);
+    for (const auto index : indices) {
+        ++offsets[index + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<u32> remaining(vertex_count);
+    std::vector<u32> adjacency(indices.size());
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        const u32 vertex = indices[i];
+        adjacency[offsets[vertex] + remaining[vertex]++] = static_cast<u32>(i / 3);
+    }
+
+    const VertexScores score_of;
+    std::vector<i32> cache_positions(vertex_count, -1);
+    std::vector<f32> scores(vertex_count);
+    for (std::size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        scores[vertex] = score_of.get(-1, remaining[vertex]);
+    }
+    std::vector<f32> triangle_scores(triangle_count);
+    for (std::size_t triangle = 0; triangle < triangle_count; ++triangle) {
+        triangle_scores[triangle]
+            = scores[indices[triangle * 3]] + scores[indices[triangle * 3 + 1]] + scores[indices[triangle * 3 + 2]];
+    }
+    std::vector<bool> emitted(triangle_count, false);
+
+    std::vector<u32> result;
+    result.reserve(indices.size());
+    std::vector<u32> cache;
+    std::vector<u32> next_cache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    next_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    u32 best = triangle_count == 0
+        ? NO_TRIANGLE
+        : static_cast<u32>(std::ranges::max_element(triangle_scores) - triangle_scores.begin());
+    std::size_t cursor = 0;
+
+    for (std::size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count) {
+        if (best == NO_TRIANGLE) {
+            // dead end, none of the cached vertices has triangles left
+            while (emitted[cursor]) {
+                ++cursor;
+            }
+            best = static_cast<u32>(cursor);
+        }
+        const u32 *triangle = indices.data() + std::size_t { best } * 3;
+        result.insert(result.end(), triangle, triangle + 3);
+        emitted[best] = true;
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            const u32 vertex = triangle[corner];
+            u32 *triangles = adjacency.data() + offsets[vertex];
+            const u32 count = remaining[vertex];
+            u32 *found = std::find(triangles, triangles + count, best);
+            std::swap(*found, triangles[count - 1]);
+            --remaining[vertex];
+        }
+
+        // the vertices of the triangle move to the front of the cache
+        next_cache.clear();
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            if (std::ranges::find(next_cache, triangle[corner]) == next_cache.end()) {
+                next_cache.push_back(triangle[corner]);
+            }
+        }
+        for (const auto vertex : cache) {
+            if (std::find(triangle, triangle + 3, vertex) == triangle + 3) {
+                next_cache.push_back(vertex);
+            }
+        }
+
+        for (std::size_t position = 0; position < next_cache.size(); ++position) {
+            const u32 vertex = next_cache[position];
+            const i32 cache_position = position < FORSYTH_CACHE_SIZE ? static_cast<i32>(position) : -1;
+            cache_positions[vertex] = cache_position;
+            const f32 score = score_of.get(cache_position, remaining[vertex]);
+            const f32 delta = score - scores[vertex];
+            scores[vertex] = score;
+            for (u32 i = 0; i < remaining[vertex]; ++i) {
+                triangle_scores[adjacency[offsets[vertex] + i]] += delta;
+            }
+        }
+
+        // the next triangle is the best one of the cached vertices
+        best = NO_TRIANGLE;
+        f32 best_score = -1.0f;
+        next_cache.resize(std::min(next_cache.size(), FORSYTH_CACHE_SIZE));
+        for (const auto vertex : next_cache) {
+            for (u32 i = 0; i < remaining[vertex]; ++i) {
+                const u32 candidate = adjacency[offsets[vertex] + i];
+                if (triangle_scores[candidate] > best_score) {
+                    best_score = triangle_scores[candidate];
+                    best = candidate;
+                }
+            }
+        }
+        std::swap(cache, next_cache);
+    }
+    return result;
+}
+
+std::vector<u32> optimize_overdraw(std::span<const u32> indices, std::span<const math::Vector3D> positions,
+                                   f32 threshold) {
+    check_indices(indices, positions.size());
+    const std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return {};
+    }
+
+    // hard boundaries, where all of the vertices of a triangle miss, thus
+    // the cache was flushed anyway
+    FifoCache cache(positions.size(), DEFAULT_VERTEX_CACHE_SIZE);
+    std::vector<std::size_t> hard_boundaries;
+    for (std::size_t triangle = 0; triangle < triangle_count; ++triangle) {
+        if (cache.access_triangle(indices.data() + triangle * 3) == 3 or triangle == 0) {
+            hard_boundaries.push_back(triangle);
+        }
+    }
+    hard_boundaries.push_back(triangle_count);
+
+    // soft boundaries, a cluster ends as soon as its ACMR with a cold cache
+    // is within the threshold of the ACMR of the whole hard cluster
+    std::vector<std::size_t> boundaries;
+    for (std::size_t hard = 0; hard + 1 < hard_boundaries.size(); ++hard) {
+        const std::size_t start = hard_boundaries[hard];
+        const std::size_t end = hard_boundaries[hard + 1];
+        cache.flush();
+        u32 cluster_misses = 0;
+        for (std::size_t triangle = start; triangle < end; ++triangle) {
+            cluster_misses += cache.access_triangle(indices.data() + triangle * 3);
+        }
+        const f32 cluster_threshold = threshold * static_cast<f32>(cluster_misses) / static_cast<f32>(end - start);
+
+        boundaries.push_back(start);
+        cache.flush();
+        u32 running_misses = 0;
+        u32 running_triangles = 0;
+        for (std::size_t triangle = start; triangle < end; ++triangle) {
+            running_misses += cache.access_triangle(indices.data() + triangle * 3);
+            ++running_triangles;
+            if (static_cast<f32>(running_misses) / static_cast<f32>(running_triangles) <= cluster_threshold) {
+                boundaries.push_back(triangle + 1);
+                cache.flush();
+                running_misses = 0;
+                running_triangles = 0;
+            }
+        }
+        if (boundaries.back() == end) {
+            boundaries.pop_back();
+        }
+    }
+    boundaries.push_back(triangle_count);
+
+    const auto corner = [&](std::size_t triangle, std::size_t i) {
+        const auto &position = positions[indices[triangle * 3 + i]];
+        return Float3 { position.x, position.y, position.z };
+    };
+    SurfaceSums mesh;
+    std::vector<SurfaceSums> clusters(boundaries.size() - 1);
+    for (std::size_t cluster = 0; cluster < clusters.size(); ++cluster) {
+        for (std::size_t triangle = boundaries[cluster]; triangle < boundaries[cluster + 1]; ++triangle) {
+            clusters[cluster].add(corner(triangle, 0), corner(triangle, 1), corner(triangle, 2));
+            mesh.add(corner(triangle, 0), corner(triangle, 1), corner(triangle, 2));
+        }
+    }
+
+    // clusters facing away from the center are drawn first, they are more
+    // likely to occlude the others
+    const Float3 mesh_centroid = mesh.get_centroid();
+    std::vector<f32> sort_keys(clusters.size());
+    for (std::size_t cluster = 0; cluster < clusters.size(); ++cluster) {
+        const auto &sums = clusters[cluster];
+        const f32 normal_length = std::sqrt(dot(sums.normal, sums.normal));
+        const Float3 normal = normal_length > 0.0f ? sums.normal * (1.0f / normal_length) : sums.normal;
+        sort_keys[cluster] = dot(sums.get_centroid() - mesh_centroid, normal);
+    }
+    std::vector<std::size_t> order(clusters.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, [&](std::size_t lhs, std::size_t rhs) { return sort_keys[lhs] > sort_keys[rhs]; });
+
+    std::vector<u32> result;
+    result.reserve(indices.size());
+    for (const auto cluster : order) {
+        result.insert(result.end(), indices.begin() + static_cast<std::ptrdiff_t>(boundaries[cluster] * 3),
+                      indices.begin() + static_cast<std::ptrdiff_t>(boundaries[cluster + 1] * 3));
+    }
+    return result;
+}
+
+std::pair<std::vector<u32>, std::size_t> make_vertex_fetch_remap(std::span<const u32> indices,
+                                                                 std::size_t vertex_count) {
+    check_indices(indices, vertex_count);
+    std::vector<u32> remap(vertex_count, INVALID_REMAP);
+    u32 next = 0;
+    for (const auto index : indices) {
+        if (remap[index] == INVALID_REMAP) {
+            remap[index] = next++;
+        }
+    }
+    return { std::move(remap), next };
+}
+
+} // namespace dk::gl
@@ -0,0 +1,297 @@
+#include <dklib/gl/mipmap.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace dk::gl {
+namespace {
+    constexpr u32 ALPHA_CHANNEL = 3;
+    /// Resolution of the linear to sRGB table
+    constexpr std::size_t ENCODE_STEPS = 1 << 14;
+
+    f32 srgb_to_linear(f32 value) {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    f32 linear_to_srgb(f32 value) {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    struct TransferTables {
+        std::array<f32, 256> decode;
+        std::array<u8, ENCODE_STEPS + 1> encode;
+
+        TransferTables() {
+            for (std::size_t i = 0; i < decode.size(); ++i) {
+                decode[i] = srgb_to_linear(static_cast<f32>(i) / 255.0f);
+            }
+            for (std::size_t i = 0; i < encode.size(); ++i) {
+                const f32 srgb = linear_to_srgb(static_cast<f32>(i) / ENCODE_STEPS);
+                encode[i] = static_cast<u8>(std::lround(std::clamp(srgb, 0.0f, 1.0f) * 255.0f));
+            }
+        }
+    };
+
+    const TransferTables &get_tables() {
+        static const TransferTables tables;
+        return tables;
+    }
+
+    bool is_linear_channel(const MipmapOptions &options, u32 channel) {
+        return not options.is_srgb or channel == ALPHA_CHANNEL;
+    }
+
+    u8 encode(f32 value, bool is_linear) {
+        value = std::clamp(value, 0.0f, 1.0f);
+        if (is_linear) {
+            return static_cast<u8>(value * 255.0f + 0.5f);
+        }
+        return get_tables().encode[static_cast<std::size_t>(value * ENCODE_STEPS + 0.5f)];
+    }
+
+    /// Separable kernel, the target pixel x is computed from the source
+    /// pixels 2x + first, ..., 2x + first + weights.size() - 1.
+    struct Kernel {
+        std::vector<f32> weights;
+        int first;
+    };
+
+    f64 bessel_i0(f64 x) {
+        f64 sum = 1.0;
+        f64 term = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    Kernel make_kernel(MipFilter filter) {
+        if (filter == MipFilter::BOX) {
+            return { { 0.5f, 0.5f }, 0 };
+        }
+        constexpr int radius = 4;
+        constexpr f64 beta = 4.0;
+        Kernel kernel { {}, -(radius - 1) };
+        f64 total = 0.0;
+        std::array<f64, 2 * radius> weights {};
+        for (int k = 0; k < 2 * radius; ++k) {
+            // distance from the center of the target pixel in source pixels
+            const f64 distance = (kernel.first + k) - 0.5;
+            const f64 t = distance / 2.0;
+            const f64 sinc = std::sin(std::numbers::pi * t) / (std::numbers::pi * t);
+            const f64 ratio = distance / radius;
+            const f64 window = bessel_i0(beta * std::sqrt(1.0 - ratio * ratio)) / bessel_i0(beta);
+            weights[static_cast<std::size_t>(k)] = sinc * window;
+            total += weights[static_cast<std::size_t>(k)];
+        }
+        for (const f64 weight : weights) {
+            kernel.weights.push_back(static_cast<f32>(weight / total));
+        }
+        return kernel;
+    }
+
+    // Vertical pass, target += weight * source over a whole row. Every lane
+    // is computed with the same multiply and add, so all of the variants
+    // give identical results.
+    using ScaleAdd = void (*)(f32 *target, const f32 *source, f32 weight, std::size_t count);
+
+    void scale_add_scalar(f32 *target, const f32 *source, f32 weight, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            target[i] += weight * source[i];
+        }
+    }
+
+#if defined(__SSE2__)
+    void scale_add_sse2(f32 *target, const f32 *source, f32 weight, std::size_t count) {
+        const __m128 w = _mm_set1_ps(weight);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 product = _mm_mul_ps(w, _mm_loadu_ps(source + i));
+            _mm_storeu_ps(target + i, _mm_add_ps(_mm_loadu_ps(target + i), product));
+        }
+        scale_add_scalar(target + i, source + i, weight, count - i);
+    }
+
+#if defined(__GNUC__)
+    __attribute__((target("avx"))) void scale_add_avx(f32 *target, const f32 *source, f32 weight, std::size_t count) {
+        const __m256 w = _mm256_set1_ps(weight);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256 product = _mm256_mul_ps(w, _mm256_loadu_ps(source + i));
+            _mm256_storeu_ps(target + i, _mm256_add_ps(_mm256_loadu_ps(target + i), product));
+        }
+        scale_add_scalar(target + i, source + i, weight, count - i);
+    }
+#endif
+#endif
+
+    struct Dispatch {
+        ScaleAdd scale_add;
+        std::string_view name;
+    };
+
+    const Dispatch &get_dispatch() {
+        static const Dispatch dispatch = []() -> Dispatch {
+#if defined(__SSE2__)
+#if defined(__GNUC__)
+            if (__builtin_cpu_supports("avx")) {
+                return { scale_add_avx, "avx" };
+            }
+#endif
+            return { scale_add_sse2, "sse2" };
+#else
+            return { scale_add_scalar, "scalar" };
+#endif
+        }();
+        return dispatch;
+    }
+
+    /// Horizontal pass of a single row, `source` holds `source_width`
+    /// pixels of `Channels` floats.
+    template <u32 Channels>
+    void filter_row(const Kernel &kernel, const f32 *source, u32 source_width, f32 *target, u32 target_width) {
+        const int last = static_cast<int>(source_width) - 1;
+        for (u32 x = 0; x < target_width; ++x) {
+            const int origin = 2 * static_cast<int>(x) + kernel.first;
+#if defined(__SSE2__)
+            if constexpr (Channels == 4) {
+                // a whole RGBA pixel fits into a single register
+                __m128 sum = _mm_setzero_ps();
+                for (std::size_t k = 0; k < kernel.weights.size(); ++k) {
+                    const auto sx = static_cast<std::size_t>(std::clamp(origin + static_cast<int>(k), 0, last));
+                    const __m128 product = _mm_mul_ps(_mm_set1_ps(kernel.weights[k]), _mm_loadu_ps(source + sx * 4));
+                    sum = _mm_add_ps(sum, product);
+                }
+                _mm_storeu_ps(target + std::size_t { x } * 4, sum);
+                continue;
+            }
+#endif
+            std::array<f32, Channels> sum {};
+            for (std::size_t k = 0; k < kernel.weights.size(); ++k) {
+                const auto sx = static_cast<std::size_t>(std::clamp(origin + static_cast<int>(k), 0, last));
+                for (u32 c = 0; c < Channels; ++c) {
+                    sum[c] += kernel.weights[k] * source[sx * Channels + c];
+                }
+            }
+            std::copy(sum.begin(), sum.end(), target + std::size_t { x } * Channels);
+        }
+    }
+
+    /// Image in the linear space with unpadded rows.
+    struct LinearImage {
+        u32 width;
+        u32 height;
+        std::vector<f32> values;
+    };
+
+    template <u32 Channels>
+    void downsample(
+        const Kernel &kernel, const MipmapOptions &options, const LinearImage &source, LinearImage &target,
+        Image &encoded, util::ThreadPool &pool
+    ) {
+        const auto scale_add = get_dispatch().scale_add;
+        const std::size_t source_row = std::size_t { source.width } * Channels;
+        const std::size_t target_row = std::size_t { target.width } * Channels;
+        const int last = static_cast<int>(source.height) - 1;
+
+        pool.parallel_for(
+            target.height,
+            [&](std::size_t begin, std::size_t end) {
+                std::vector<f32> column(source_row);
+                for (std::size_t y = begin; y < end; ++y) {
+                    std::fill(column.begin(), column.end(), 0.0f);
+                    const int origin = 2 * static_cast<int>(y) + kernel.first;
+                    for (std::size_t k = 0; k < kernel.weights.size(); ++k) {
+                        const auto sy = static_cast<std::size_t>(std::clamp(origin + static_cast<int>(k), 0, last));
+                        scale_add(column.data(), source.values.data() + sy * source_row, kernel.weights[k], source_row);
+                    }
+
+                    f32 *values = target.values.data() + y * target_row;
+                    filter_row<Channels>(kernel, column.data(), source.width, values, target.width);
+
+                    auto pixels = encoded.row(static_cast<u32>(y));
+                    for (std::size_t i = 0; i < target_row; ++i) {
+                        pixels[i] = encode(values[i], is_linear_channel(options, static_cast<u32>(i % Channels)));
+                    }
+                }
+            },
+            16
+        );
+    }
+
+    LinearImage decode(const Image &image, const MipmapOptions &options, util::ThreadPool &pool) {
+        const auto &tables = get_tables();
+        const std::size_t row_size = std::size_t { image.width } * image.channels;
+        LinearImage linear { image.width, image.height, std::vector<f32>(row_size * image.height) };
+        pool.parallel_for(
+            image.height,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t y = begin; y < end; ++y) {
+                    const auto pixels = image.row(static_cast<u32>(y));
+                    f32 *values = linear.values.data() + y * row_size;
+                    for (std::size_t i = 0; i < row_size; ++i) {
+                        values[i] = is_linear_channel(options, static_cast<u32>(i % image.channels))
+                            ? pixels[i] / 255.0f
+                            : tables.decode[pixels[i]];
+                    }
+                }
+            },
+            16
+        );
+        return linear;
+    }
+} // namespace
+
+Image::Image(u32 width, u32 height, u32 channels)
+    : width(width)
+    , height(height)
+    , channels(channels)
+    , pixels(stride() * height) { }
+
+std::vector<Image> generate_mipmaps(const Image &image, const MipmapOptions &options, util::ThreadPool &pool) {
+    if (image.channels != 1 and image.channels != 3 and image.channels != 4) {
+        spdlog::error("mipmaps can not be generated for an image with {} channels", image.channels);
+        throw std::invalid_argument("unsupported channel count");
+    }
+    if (image.width == 0 or image.height == 0 or image.pixels.size() < image.stride() * image.height) {
+        spdlog::error("mipmaps can not be generated for an image with no or missing pixels");
+        throw std::invalid_argument("invalid image");
+    }
+
+    const auto kernel = make_kernel(options.filter);
+    std::vector<Image> chain { image };
+    LinearImage source = decode(image, options, pool);
+    while (source.width > 1 or source.height > 1) {
+        const u32 width = std::max(source.width / 2, 1u);
+        const u32 height = std::max(source.height / 2, 1u);
+        LinearImage target { width, height, std::vector<f32>(std::size_t { width } * height * image.channels) };
+        Image &encoded = chain.emplace_back(width, height, image.channels);
+        switch (image.channels) {
+        case 1:
+            downsample<1>(kernel, options, source, target, encoded, pool);
+            break;
+        case 3:
+            downsample<3>(kernel, options, source, target, encoded, pool);
+            break;
+        default:
+            downsample<4>(kernel, options, source, target, encoded, pool);
+            break;
+        }
+        source = std::move(target);
+    }
+    return chain;
+}
+
+std::string_view mipmap_instruction_set() { return get_dispatch().name; }
+
+} // namespace dk::gl
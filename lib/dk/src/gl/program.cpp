@@ -1,59 +1,357 @@
 #include <dklib/gl/program.hpp>
+#include <dklib/gl/state_cache.hpp>
+
+#include <dklib/util/hash.hpp>
+
+#include <algorithm>
+#include <utility>
 
 namespace dk::gl {
+namespace {
+    std::string_view get_string(enum32 name) {
+        const auto *string = reinterpret_cast<const char *>(glGetString(name));
+        return string == nullptr ? std::string_view {} : std::string_view { string };
+    }
+
+    bool is_link_success(gl::u32 program) {
+        gl::i32 is_link_success = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &is_link_success);
+        return is_link_success == GL_TRUE;
+    }
+} // namespace
+
 Program::Program()
-    : program_descriptor_(glCreateProgram()) { }
+    : Program(&ProgramBinaryCache::get_instance()) { }
+
+Program::Program(ProgramBinaryCache *binary_cache)
+    : binary_cache_(binary_cache)
+    , program_descriptor_(glCreateProgram())
+    , uniform_stats_(std::make_unique<UniformStats>()) { }
+
+Program::Program(Program &&other) noexcept
+    : shaders_(std::move(other.shaders_))
+    , binary_cache_(other.binary_cache_)
+    , is_separable_(other.is_separable_)
+    , is_from_binary_cache_(other.is_from_binary_cache_)
+    , is_binary_retrievable_(other.is_binary_retrievable_)
+    , is_completion_queryable_(other.is_completion_queryable_)
+    , binary_key_(other.binary_key_)
+    , state_(std::exchange(other.state_, LinkState::NONE))
+    , program_descriptor_(std::exchange(other.program_descriptor_, 0))
+    , reflection_(std::move(other.reflection_))
+    // moving the deque keeps its elements in place, the Uniforms stay valid
+    , uniform_shadows_(std::move(other.uniform_shadows_))
+    , shadow_of_uniform_(std::move(other.shadow_of_uniform_))
+    , uniform_stats_(std::move(other.uniform_stats_)) { }
+
+Program &Program::operator=(Program &&other) noexcept {
+    if (this != &other) {
+        if (program_descriptor_ != 0) {
+            StateCache::get_instance().forget_program(program_descriptor_);
+            glDeleteProgram(program_descriptor_);
+        }
+        shaders_ = std::move(other.shaders_);
+        binary_cache_ = other.binary_cache_;
+        is_separable_ = other.is_separable_;
+        is_from_binary_cache_ = other.is_from_binary_cache_;
+        is_binary_retrievable_ = other.is_binary_retrievable_;
+        is_completion_queryable_ = other.is_completion_queryable_;
+        binary_key_ = other.binary_key_;
+        state_ = std::exchange(other.state_, LinkState::NONE);
+        program_descriptor_ = std::exchange(other.program_descriptor_, 0);
+        reflection_ = std::move(other.reflection_);
+        uniform_shadows_ = std::move(other.uniform_shadows_);
+        shadow_of_uniform_ = std::move(other.shadow_of_uniform_);
+        uniform_stats_ = std::move(other.uniform_stats_);
+    }
+    return *this;
+}
 
 Program::~Program() {
-    glDeleteVertexArrays(1, &vertex_array_id_);
+    if (program_descriptor_ == 0) {
+        return;
+    }
+    StateCache::get_instance().forget_program(program_descriptor_);
     glDeleteProgram(program_descriptor_);
 }
 
-Program &Program::link() {
-    glLinkProgram(program_descriptor_);
-    glGenVertexArrays(1, &vertex_array_id_);
-    glBindVertexArray(vertex_array_id_);
+Program &Program::link() { return submit().wait(); }
+
+Program &Program::submit() {
+    if (state_ != LinkState::NONE) {
+        return *this;
+    }
+    gl::i32 format_count = 0;
+    if (binary_cache_ != nullptr) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    }
+    // takes effect by the next glLinkProgram or glProgramBinary
+    glProgramParameteri(program_descriptor_, GL_PROGRAM_SEPARABLE, is_separable_ ? GL_TRUE : GL_FALSE);
+    is_binary_retrievable_ = format_count > 0;
+    auto &state = StateCache::get_instance();
+    is_completion_queryable_ = state.has_extension("GL_KHR_parallel_shader_compile")
+                            or state.has_extension("GL_ARB_parallel_shader_compile");
+    binary_key_ = is_binary_retrievable_ ? get_binary_key() : 0;
+
+    is_from_binary_cache_ = is_binary_retrievable_ and load_binary(binary_key_);
+    if (not is_from_binary_cache_) {
+        submit_compile_and_link();
+    }
+
+    state_ = LinkState::SUBMITTED;
     return *this;
 }
 
-[[nodiscard]] gl::i32 Program::get_uniform(const std::string &name) const {
-    if (auto it = uniform_cache_.find(name); it != uniform_cache_.end()) {
-        return it->second.get_location();
+bool Program::is_ready() const {
+    if (state_ != LinkState::SUBMITTED) {
+        return state_ == LinkState::LINKED;
     }
-    auto location = glGetUniformLocation(program_descriptor_, name.c_str());
-    if (location < 0) {
-        spdlog::error("Could not get uniform location of '{}'", name);
-        throw std::runtime_error("Could not get uniform location");
+    if (not is_completion_queryable_) {
+        return true;
     }
-    return location;
+    gl::i32 is_complete = GL_FALSE;
+    glGetProgramiv(program_descriptor_, GL_COMPLETION_STATUS_KHR, &is_complete);
+    return is_complete == GL_TRUE;
 }
 
-// NOTE: this is unusable until we have some real matrix type
-[[nodiscard]] gl::Uniform Program::get_uniform(bool t, const std::string &name) {
-    if (auto it = uniform_cache_.find(name); it != uniform_cache_.end()) {
-        return it->second;
+Program &Program::wait() {
+    submit();
+    if (state_ == LinkState::LINKED) {
+        return *this;
     }
-    auto location = glGetUniformLocation(program_descriptor_, name.data());
-    if (location < 0) {
-        spdlog::error("Could not get uniform location of '{}'", name);
-        throw std::runtime_error("Could not get uniform location");
+    check_link();
+    reflection_ = ProgramReflection(program_descriptor_);
+    uniform_shadows_.clear();
+    shadow_of_uniform_.clear();
+    for (const auto &uniform : reflection_.get_uniforms()) {
+        shadow_of_uniform_.push_back(uniform_shadows_.size());
+        uniform_shadows_.push_back({ .program = program_descriptor_, .location = uniform.location });
     }
-    auto uniform = uniform_cache_.try_emplace(name, location, name);
-    return uniform.first->second;
+    if (is_binary_retrievable_ and not is_from_binary_cache_) {
+        store_binary(binary_key_);
+    }
+    state_ = LinkState::LINKED;
+    return *this;
 }
 
-[[nodiscard]] gl::i32 Program::get_attribute(const std::string &name) const {
-    if (auto it = uniform_cache_.find(name); it != uniform_cache_.end()) {
-        return it->second.get_location();
+std::uint64_t Program::get_binary_key() const {
+    std::uint64_t key = util::FNV_OFFSET_BASIS;
+    for (const auto &shader : shaders_) {
+        const std::uint64_t stage[] = { static_cast<std::uint64_t>(shader.get_type()), shader.get_source().hash };
+        key = util::fnv1a(std::as_bytes(std::span { stage }), key);
+    }
+    if (is_separable_) {
+        key = util::fnv1a(std::string_view { "separable" }, key);
+    }
+    // binaries are valid only for the driver that produced them
+    for (const auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        key = util::fnv1a(get_string(name), key);
+    }
+    return key;
+}
+
+bool Program::load_binary(std::uint64_t key) {
+    const auto binary = binary_cache_->load(key);
+    if (not binary.has_value()) {
+        return false;
     }
-    auto location = glGetUniformLocation(program_descriptor_, name.data());
-    if (location < 0) {
-        spdlog::error("Could not get uniform location of '{}'", name);
+    glProgramBinary(program_descriptor_, binary->format, binary->bytes.data(),
+                    static_cast<gl::i32>(binary->bytes.size()));
+    gl::i32 is_link_success = GL_FALSE;
+    glGetProgramiv(program_descriptor_, GL_LINK_STATUS, &is_link_success);
+    if (is_link_success != GL_TRUE) {
+        // e.g. the driver got updated without changing its version string
+        spdlog::warn("Cached program binary was rejected by the driver, compiling the shaders");
+        binary_cache_->invalidate(key);
+        return false;
+    }
+    spdlog::debug("Program restored from the binary cache");
+    return true;
+}
+
+void Program::submit_compile_and_link() {
+    // Nothing is queried here, any query would wait for the compiler
+    for (auto &shader : shaders_) {
+        glAttachShader(program_descriptor_, shader.get());
+    }
+    if (binary_cache_ != nullptr) {
+        glProgramParameteri(program_descriptor_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program_descriptor_);
+}
+
+void Program::check_link() {
+    if (not is_link_success(program_descriptor_)) {
+        throw std::runtime_error(report_link_failure(program_descriptor_));
+    }
+}
+
+const char *Program::report_link_failure(gl::u32 program) {
+    // Failed shader is the more useful report, so it is looked for first
+    for (auto &shader : shaders_) {
+        if (not shader.compile()) {
+            spdlog::error("Compilation of shader {} was not succesful", shader.get_filepath());
+            auto msg = util::get_shader_error_msg(shader.get());
+            spdlog::error("shader log contents:\n {}", msg);
+            // errors are reported as <source string>:<line>, see ShaderPreprocessor
+            for (std::size_t i = 1; i < shader.get_files().size(); ++i) {
+                spdlog::error("source string {}: {}", i, shader.get_files()[i].string());
+            }
+            return "compilation of shader was not successful";
+        }
+    }
+    spdlog::error("Linking of program was not succesful");
+    spdlog::error("program log contents:\n {}", util::get_program_error_msg(program));
+    return "linking of program was not successful";
+}
+
+ReloadResult Program::reload(const std::filesystem::path &changed_file) {
+    const auto file = std::filesystem::absolute(changed_file).lexically_normal();
+    bool is_changed = false;
+    for (auto &shader : shaders_) {
+        const auto &files = shader.get_files();
+        const bool is_affected = std::ranges::any_of(
+            files, [&](const auto &path) { return std::filesystem::absolute(path).lexically_normal() == file; });
+        try {
+            is_changed = (is_affected and shader.reload()) or is_changed;
+        } catch (const std::runtime_error &error) {
+            spdlog::error("Shader {} could not be reloaded: {}", shader.get_filepath(), error.what());
+            return ReloadResult::FAILED;
+        }
+    }
+    if (not is_changed) {
+        return ReloadResult::UNCHANGED;
+    }
+    if (state_ == LinkState::NONE) {
+        // linked with the new sources once it is needed
+        return ReloadResult::RELOADED;
+    }
+    if (state_ == LinkState::SUBMITTED) {
+        // the pending link uses the previous shaders, so it is dropped and
+        // submitted again with the new ones
+        StateCache::get_instance().forget_program(program_descriptor_);
+        glDeleteProgram(program_descriptor_);
+        program_descriptor_ = glCreateProgram();
+        state_ = LinkState::NONE;
+        submit();
+        return ReloadResult::RELOADED;
+    }
+
+    const auto program = glCreateProgram();
+    for (auto &shader : shaders_) {
+        glAttachShader(program, shader.get());
+    }
+    glProgramParameteri(program, GL_PROGRAM_SEPARABLE, is_separable_ ? GL_TRUE : GL_FALSE);
+    if (is_binary_retrievable_) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+    if (not is_link_success(program)) {
+        spdlog::error("Reloaded program was not linked, keeping the previous one");
+        static_cast<void>(report_link_failure(program));
+        glDeleteProgram(program);
+        return ReloadResult::FAILED;
+    }
+
+    StateCache::get_instance().forget_program(program_descriptor_);
+    glDeleteProgram(program_descriptor_);
+    program_descriptor_ = program;
+    remap_uniform_shadows(ProgramReflection(program_descriptor_));
+    is_from_binary_cache_ = false;
+    if (is_binary_retrievable_) {
+        binary_key_ = get_binary_key();
+        store_binary(binary_key_);
+    }
+    spdlog::info("Program reloaded after {} changed", file.string());
+    return ReloadResult::RELOADED;
+}
+
+void Program::remap_uniform_shadows(ProgramReflection &&reflection) {
+    // linking resets the uniforms to their initial values, and uniforms the
+    // new program lacks keep a location that uploads ignore
+    for (auto &shadow : uniform_shadows_) {
+        shadow.size = 0;
+        shadow.program = program_descriptor_;
+        shadow.location = -1;
+    }
+    std::vector<std::size_t> shadow_of_uniform;
+    shadow_of_uniform.reserve(reflection.get_uniforms().size());
+    for (const auto &uniform : reflection.get_uniforms()) {
+        const auto previous = reflection_.find_uniform(ResourceName { uniform.name });
+        if (previous.has_value()) {
+            shadow_of_uniform.push_back(shadow_of_uniform_[*previous]);
+        } else {
+            shadow_of_uniform.push_back(uniform_shadows_.size());
+            uniform_shadows_.push_back({ .program = program_descriptor_ });
+        }
+        uniform_shadows_[shadow_of_uniform.back()].location = uniform.location;
+    }
+    reflection_ = std::move(reflection);
+    shadow_of_uniform_ = std::move(shadow_of_uniform);
+}
+
+std::vector<std::filesystem::path> Program::get_files() const {
+    std::vector<std::filesystem::path> files;
+    for (const auto &shader : shaders_) {
+        for (const auto &path : shader.get_files()) {
+            if (std::ranges::find(files, path) == files.end()) {
+                files.push_back(path);
+            }
+        }
+    }
+    return files;
+}
+
+void Program::store_binary(std::uint64_t key) const {
+    gl::i32 length = 0;
+    glGetProgramiv(program_descriptor_, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<std::byte> bytes(static_cast<std::size_t>(length));
+    enum32 format = 0;
+    glGetProgramBinary(program_descriptor_, length, nullptr, &format, bytes.data());
+    binary_cache_->store(key, format, bytes);
+}
+
+[[nodiscard]] gl::i32 Program::get_uniform(const std::string &name) const {
+    return get_uniform_location(ResourceName { name });
+}
+
+[[nodiscard]] gl::i32 Program::get_uniform_location(const ResourceName &name) const {
+    const auto handle = reflection_.find_uniform(name);
+    if (not handle.has_value() or reflection_.get_uniform(*handle).location < 0) {
+        spdlog::error("Could not get uniform location of '{}'", name.text);
         throw std::runtime_error("Could not get uniform location");
     }
-    return location;
+    return reflection_.get_uniform(*handle).location;
+}
+
+// NOTE: this is unusable until we have some real matrix type
+[[nodiscard]] gl::Uniform Program::get_uniform([[maybe_unused]] bool t, const std::string &name) {
+    return make_uniform(ResourceName { name });
+}
+
+[[nodiscard]] gl::Uniform Program::make_uniform(const ResourceName &name) {
+    const auto location = get_uniform_location(name);
+    const auto handle = *reflection_.find_uniform(name);
+    return { location, std::string(name.text), uniform_shadows_[shadow_of_uniform_[handle]], *uniform_stats_ };
+}
+
+[[nodiscard]] gl::i32 Program::get_attribute(const std::string &name) const {
+    const auto handle = reflection_.find_attribute(ResourceName { name });
+    if (not handle.has_value()) {
+        spdlog::error("Could not get attribute location of '{}'", name);
+        throw std::runtime_error("Could not get attribute location");
+    }
+    return reflection_.get_attribute(*handle).location;
 }
 
-void Program::use() const { glUseProgram(program_descriptor_); }
+void Program::use() {
+    if (state_ != LinkState::LINKED) {
+        wait();
+    }
+    StateCache::get_instance().use_program(program_descriptor_);
+}
 
 } // namespace dk::gl
@@ -0,0 +1,121 @@
+#include <dklib/gl/program_cache.hpp>
+
+#include <dklib/file/file_base.hpp>
+#include <dklib/util/hash.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace dk::gl {
+namespace {
+    constexpr char IDENTIFIER[8] = { 'D', 'K', 'P', 'R', 'O', 'G', '\r', '\n' };
+    constexpr u32 VERSION = 1;
+
+    struct EntryHeader {
+        char identifier[8];
+        u32 version;
+        u32 format;
+        u64 key;
+        u64 size;
+        u64 checksum;
+    };
+
+    std::filesystem::path default_directory() {
+        if (const char *directory = std::getenv("DK_PROGRAM_CACHE_DIR"); directory != nullptr) {
+            return directory;
+        }
+        if (const char *cache = std::getenv("XDG_CACHE_HOME"); cache != nullptr) {
+            return std::filesystem::path(cache) / "dklib" / "programs";
+        }
+        if (const char *home = std::getenv("HOME"); home != nullptr) {
+            return std::filesystem::path(home) / ".cache" / "dklib" / "programs";
+        }
+        return std::filesystem::temp_directory_path() / "dklib" / "programs";
+    }
+} // namespace
+
+ProgramBinaryCache::ProgramBinaryCache(std::filesystem::path directory)
+    : directory_(std::move(directory)) {
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        spdlog::warn("program cache: {} could not be created: {}", directory_.string(), error.message());
+    }
+}
+
+ProgramBinaryCache &ProgramBinaryCache::get_instance() {
+    static ProgramBinaryCache instance(default_directory());
+    return instance;
+}
+
+std::optional<ProgramBinary> ProgramBinaryCache::load(std::uint64_t key) const {
+    const auto path = path_of(key);
+    if (not std::filesystem::exists(path)) {
+        return std::nullopt;
+    }
+    try {
+        const file::MappedFile file(path, { file::AccessPattern::SEQUENTIAL });
+        const auto bytes = file.bytes();
+        EntryHeader header {};
+        if (bytes.size() >= sizeof(header)) {
+            std::memcpy(&header, bytes.data(), sizeof(header));
+        }
+        const auto payload = bytes.subspan(std::min(sizeof(header), bytes.size()));
+        if (std::memcmp(header.identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0 or header.version != VERSION
+            or header.key != key or header.size != payload.size() or header.checksum != util::fnv1a(payload)) {
+            spdlog::warn("program cache: {} is corrupted, it is removed", path.string());
+            invalidate(key);
+            return std::nullopt;
+        }
+        return ProgramBinary { header.format, { payload.begin(), payload.end() } };
+    } catch (const std::runtime_error &) {
+        return std::nullopt;
+    }
+}
+
+void ProgramBinaryCache::store(std::uint64_t key, enum32 format, std::span<const std::byte> bytes) const {
+    EntryHeader header {
+        .identifier = {},
+        .version = VERSION,
+        .format = format,
+        .key = key,
+        .size = bytes.size(),
+        .checksum = util::fnv1a(bytes),
+    };
+    std::memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+    const auto path = path_of(key);
+    auto temporary = path;
+    temporary += ".tmp" + std::to_string(::getpid());
+    {
+        std::ofstream fout(temporary, std::ios::binary | std::ios::trunc);
+        fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        fout.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (not fout.good()) {
+            spdlog::warn("program cache: {} could not be written", temporary.string());
+            std::error_code error;
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        spdlog::warn("program cache: {} could not be stored: {}", path.string(), error.message());
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+void ProgramBinaryCache::invalidate(std::uint64_t key) const {
+    std::error_code error;
+    std::filesystem::remove(path_of(key), error);
+}
+
+std::filesystem::path ProgramBinaryCache::path_of(std::uint64_t key) const {
+    return directory_ / fmt::format("{:016x}.bin", key);
+}
+} // namespace dk::gl
@@ -0,0 +1,150 @@
+#include <dklib/gl/program_pipeline.hpp>
+
+#include <dklib/gl/state_cache.hpp>
+#include <dklib/util/hash.hpp>
+
+#include <GLES3/gl31.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace dk::gl {
+namespace {
+    gl::enum32 stage_bit(gl::ShaderType type) {
+        switch (type) {
+        case gl::ShaderType::VERTEX:
+            return GL_VERTEX_SHADER_BIT;
+        case gl::ShaderType::FRAGMENT:
+            return GL_FRAGMENT_SHADER_BIT;
+        case gl::ShaderType::TESS_CONTROL:
+            return GL_TESS_CONTROL_SHADER_BIT;
+        case gl::ShaderType::TESS_EVALUATION:
+            return GL_TESS_EVALUATION_SHADER_BIT;
+        case gl::ShaderType::GEOMETRY:
+            return GL_GEOMETRY_SHADER_BIT;
+        case gl::ShaderType::COMPUTE:
+            return GL_COMPUTE_SHADER_BIT;
+        }
+        return 0;
+    }
+} // namespace
+
+ProgramPipeline::ProgramPipeline() { glGenProgramPipelines(1, &id_); }
+
+ProgramPipeline::~ProgramPipeline() {
+    if (id_ != 0) {
+        StateCache::get_instance().forget_program_pipeline(id_);
+        glDeleteProgramPipelines(1, &id_);
+    }
+}
+
+ProgramPipeline::ProgramPipeline(ProgramPipeline &&other) noexcept
+    : id_(std::exchange(other.id_, 0))
+    , stages_(std::move(other.stages_)) { }
+
+ProgramPipeline &ProgramPipeline::operator=(ProgramPipeline &&other) noexcept {
+    if (this != &other) {
+        if (id_ != 0) {
+            StateCache::get_instance().forget_program_pipeline(id_);
+            glDeleteProgramPipelines(1, &id_);
+        }
+        id_ = std::exchange(other.id_, 0);
+        stages_ = std::move(other.stages_);
+    }
+    return *this;
+}
+
+ProgramPipeline &ProgramPipeline::use_stages(Program &program) {
+    if (not program.is_separable()) {
+        spdlog::error("Program {} is not separable, it can not be a stage of a pipeline", program.get_id());
+        throw std::runtime_error("program is not separable");
+    }
+    gl::enum32 bits = 0;
+    for (const auto &shader : program.get_shaders()) {
+        bits |= stage_bit(shader.get_type());
+    }
+    // stages of the program are taken from the programs used for them before
+    for (auto &stage : stages_) {
+        stage.bits &= ~bits;
+    }
+    std::erase_if(stages_, [](const Stage &stage) { return stage.bits == 0; });
+    stages_.push_back({ &program, bits });
+    return *this;
+}
+
+void ProgramPipeline::bind() {
+    for (auto &stage : stages_) {
+        if (not stage.program->is_linked()) {
+            stage.program->wait();
+        }
+        if (stage.used_id != stage.program->get_id()) {
+            glUseProgramStages(id_, stage.bits, stage.program->get_id());
+            stage.used_id = stage.program->get_id();
+        }
+    }
+    auto &state = StateCache::get_instance();
+    state.use_program(0);
+    state.bind_program_pipeline(id_);
+}
+
+void ProgramPipeline::set_active(const Program &program) const { glActiveShaderProgram(id_, program.get_id()); }
+
+bool ProgramPipeline::validate() const {
+    glValidateProgramPipeline(id_);
+    gl::i32 is_valid = GL_FALSE;
+    glGetProgramPipelineiv(id_, GL_VALIDATE_STATUS, &is_valid);
+    if (is_valid == GL_TRUE) {
+        return true;
+    }
+    gl::i32 log_size = 0;
+    glGetProgramPipelineiv(id_, GL_INFO_LOG_LENGTH, &log_size);
+    std::string log(static_cast<std::size_t>(std::max(log_size, 0)), '\0');
+    glGetProgramPipelineInfoLog(id_, log_size, nullptr, log.data());
+    spdlog::error("Program pipeline {} is not valid:\n {}", id_, log);
+    return false;
+}
+
+PipelineCache::PipelineCache(ProgramBinaryCache *binary_cache, ShaderPreprocessor &preprocessor)
+    : binary_cache_(binary_cache)
+    , preprocessor_(preprocessor) { }
+
+Program &PipelineCache::get_stage(const Stage &stage) {
+    // preprocessing is cheap and nothing is compiled before submit()
+    Shader shader(stage.path.string(), stage.type, preprocessor_, stage.defines);
+    const std::uint64_t key_parts[] = { static_cast<std::uint64_t>(stage.type), shader.get_source().hash };
+    auto &program = stages_[util::fnv1a(std::as_bytes(std::span { key_parts }))];
+    if (program == nullptr) {
+        program = std::make_unique<Program>(binary_cache_);
+        program->set_separable().attach_shader(std::move(shader)).submit();
+    }
+    return *program;
+}
+
+ProgramPipeline &PipelineCache::get(std::span<const Stage> stages) {
+    std::vector<std::pair<gl::ShaderType, Program *>> programs;
+    programs.reserve(stages.size());
+    for (const auto &stage : stages) {
+        programs.emplace_back(stage.type, &get_stage(stage));
+    }
+    std::ranges::sort(programs, {}, [](const auto &stage) { return static_cast<gl::enum32>(stage.first); });
+
+    // stage programs live as long as the cache, so their addresses identify
+    // them
+    std::uint64_t key = util::FNV_OFFSET_BASIS;
+    for (const auto &[type, program] : programs) {
+        const std::uint64_t parts[] = { static_cast<std::uint64_t>(type), reinterpret_cast<std::uintptr_t>(program) };
+        key = util::fnv1a(std::as_bytes(std::span { parts }), key);
+    }
+    auto &pipeline = pipelines_[key];
+    if (pipeline == nullptr) {
+        pipeline = std::make_unique<ProgramPipeline>();
+        for (const auto &[type, program] : programs) {
+            pipeline->use_stages(*program);
+        }
+    }
+    return *pipeline;
+}
+
+} // namespace dk::gl
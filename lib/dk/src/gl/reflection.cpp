@@ -0,0 +1,101 @@
+#include <dklib/gl/reflection.hpp>
+
+#include <GLES3/gl31.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace dk::gl {
+namespace {
+    std::string get_resource_name(u32 program, enum32 interface, u32 index, i32 length) {
+        std::string name(static_cast<std::size_t>(std::max(length, 1)), '\0');
+        gl::i32 written = 0;
+        glGetProgramResourceName(program, interface, index, static_cast<gl::i32>(name.size()), &written, name.data());
+        name.resize(static_cast<std::size_t>(written));
+        // arrays are reported as their first element
+        if (name.ends_with("[0]")) {
+            name.resize(name.size() - 3);
+        }
+        return name;
+    }
+
+    template <std::size_t N>
+    std::array<i32, N> get_resource(u32 program, enum32 interface, u32 index, const std::array<enum32, N> &props) {
+        std::array<i32, N> values {};
+        glGetProgramResourceiv(program, interface, index, static_cast<gl::i32>(N), props.data(),
+                               static_cast<gl::i32>(N), nullptr, values.data());
+        return values;
+    }
+
+    u32 get_resource_count(u32 program, enum32 interface) {
+        gl::i32 count = 0;
+        glGetProgramInterfaceiv(program, interface, GL_ACTIVE_RESOURCES, &count);
+        return static_cast<u32>(count);
+    }
+
+    /// Sorts the table by the hashes, which have to be unique.
+    template <typename Info>
+    void sort_by_hash(std::vector<Info> &table) {
+        std::ranges::sort(table, {}, &Info::hash);
+        const auto duplicate = std::ranges::adjacent_find(table, {}, &Info::hash);
+        if (duplicate != table.end()) {
+            spdlog::error("Resources '{}' and '{}' have the same name hash", duplicate->name, (duplicate + 1)->name);
+            throw std::runtime_error("Resource names have the same hash");
+        }
+    }
+} // namespace
+
+ProgramReflection::ProgramReflection(u32 program) {
+    const auto block_count = get_resource_count(program, GL_UNIFORM_BLOCK);
+    // block indices of the uniforms point into the sorted table
+    std::vector<i32> block_order(block_count);
+    blocks_.reserve(block_count);
+    for (u32 i = 0; i < block_count; ++i) {
+        const auto [length, binding, data_size] = get_resource(
+            program, GL_UNIFORM_BLOCK, i,
+            std::array<enum32, 3> { GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE });
+        auto name = get_resource_name(program, GL_UNIFORM_BLOCK, i, length);
+        const auto hash = util::fnv1a(name);
+        blocks_.push_back({ std::move(name), hash, i, binding, data_size });
+    }
+    sort_by_hash(blocks_);
+    for (std::size_t i = 0; i < blocks_.size(); ++i) {
+        block_order[blocks_[i].index] = static_cast<i32>(i);
+    }
+
+    const auto uniform_count = get_resource_count(program, GL_UNIFORM);
+    uniforms_.reserve(uniform_count);
+    for (u32 i = 0; i < uniform_count; ++i) {
+        const auto [length, type, location, array_size, block_index, offset] = get_resource(
+            program, GL_UNIFORM, i,
+            std::array<enum32, 6> { GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE, GL_BLOCK_INDEX, GL_OFFSET });
+        auto name = get_resource_name(program, GL_UNIFORM, i, length);
+        const auto hash = util::fnv1a(name);
+        const auto block = block_index < 0 ? -1 : block_order[static_cast<std::size_t>(block_index)];
+        uniforms_.push_back({
+            std::move(name),
+            hash,
+            static_cast<enum32>(type),
+            location,
+            array_size,
+            block,
+            block < 0 ? -1 : offset,
+        });
+    }
+    sort_by_hash(uniforms_);
+
+    const auto attribute_count = get_resource_count(program, GL_PROGRAM_INPUT);
+    attributes_.reserve(attribute_count);
+    for (u32 i = 0; i < attribute_count; ++i) {
+        const auto [length, type, location, array_size] = get_resource(
+            program, GL_PROGRAM_INPUT, i,
+            std::array<enum32, 4> { GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE });
+        auto name = get_resource_name(program, GL_PROGRAM_INPUT, i, length);
+        const auto hash = util::fnv1a(name);
+        attributes_.push_back({ std::move(name), hash, static_cast<enum32>(type), location, array_size });
+    }
+    sort_by_hash(attributes_);
+}
+} // namespace dk::gl
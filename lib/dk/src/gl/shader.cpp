@@ -1,18 +1,138 @@
 #include <dklib/gl/shader.hpp>
 
+#include <dklib/util/hash.hpp>
+
+#include <utility>
+
 namespace dk::gl {
-Shader::Shader(std::string &&filepath, gl::ShaderType type) {
-    descriptor_ = glCreateShader(static_cast<GLenum>(type));
-    get_source_from_file(std::forward<std::string>(filepath));
-    const char *c_str = str_source.c_str();
-    glShaderSource(descriptor_, 1, &c_str, nullptr);
-    glCompileShader(descriptor_);
+namespace {
+    gl::u32 submit_source(gl::ShaderType type, const ShaderSource &source) {
+        // Source is passed together with its length, so no copy is made here
+        const char *text = source.text.data();
+        const auto length = static_cast<gl::i32>(source.text.size());
+        const auto descriptor = glCreateShader(static_cast<GLenum>(type));
+        glShaderSource(descriptor, 1, &text, &length);
+        glCompileShader(descriptor);
+        return descriptor;
+    }
+} // namespace
+
+ShaderVariantCache::ShaderVariantCache(std::vector<std::filesystem::path> include_directories)
+    : preprocessor_(std::move(include_directories)) { }
+
+ShaderVariantCache::~ShaderVariantCache() {
+    for (const auto &[key, descriptor] : shaders_) {
+        glDeleteShader(descriptor);
+    }
+}
+
+gl::u32 ShaderVariantCache::get(gl::ShaderType type, const ShaderSource &source) {
+    const std::uint64_t stage[] = { static_cast<std::uint64_t>(type), source.hash };
+    auto &descriptor = shaders_[util::fnv1a(std::as_bytes(std::span { stage }))];
+    if (descriptor != 0) {
+        ++hit_count_;
+        return descriptor;
+    }
+    descriptor = submit_source(type, source);
+    return descriptor;
+}
+
+Shader::Shader(std::string &&filepath, gl::ShaderType type)
+    : Shader(std::move(filepath), type, ShaderPreprocessor::get_instance()) { }
+
+Shader::Shader(std::string &&filepath, gl::ShaderType type, ShaderPreprocessor &preprocessor,
+               std::span<const ShaderDefine> defines)
+    : filepath_(std::move(filepath))
+    , type_(type)
+    , preprocessor_(&preprocessor)
+    , defines_(defines.begin(), defines.end()) {
+    spdlog::debug("attaching shader with filepath: {}", filepath_);
+    // Source is shared by every shader compiled from the same file
+    auto preprocessed = preprocessor.preprocess(filepath_, defines_);
+    source_ = preprocessed.source;
+    files_ = std::move(preprocessed.files);
+}
+
+Shader::Shader(std::string &&filepath, gl::ShaderType type, std::span<const ShaderDefine> defines,
+               ShaderVariantCache &variants)
+    : filepath_(std::move(filepath))
+    , type_(type)
+    , preprocessor_(&variants.get_preprocessor())
+    , defines_(defines.begin(), defines.end())
+    , variants_(&variants) {
+    spdlog::debug("attaching shader variant with filepath: {}", filepath_);
+    auto preprocessed = variants.get_preprocessor().preprocess(filepath_, defines);
+    source_ = preprocessed.source;
+    files_ = std::move(preprocessed.files);
 }
 
 Shader::~Shader() {
     // WARNING: this can be done much earlier, basically in the moment that
     // program is linked, perhaps I could add something to the link() function.
-    glDeleteShader(descriptor_);
+    if (descriptor_ != 0 and variants_ == nullptr) {
+        glDeleteShader(descriptor_);
+    }
+}
+
+Shader::Shader(Shader &&other) noexcept
+    : filepath_(std::move(other.filepath_))
+    , type_(other.type_)
+    , source_(other.source_)
+    , files_(std::move(other.files_))
+    , preprocessor_(other.preprocessor_)
+    , defines_(std::move(other.defines_))
+    , variants_(other.variants_)
+    , descriptor_(std::exchange(other.descriptor_, 0)) { }
+
+Shader &Shader::operator=(Shader &&other) noexcept {
+    if (this != &other) {
+        if (descriptor_ != 0 and variants_ == nullptr) {
+            glDeleteShader(descriptor_);
+        }
+        filepath_ = std::move(other.filepath_);
+        type_ = other.type_;
+        source_ = other.source_;
+        files_ = std::move(other.files_);
+        preprocessor_ = other.preprocessor_;
+        defines_ = std::move(other.defines_);
+        variants_ = other.variants_;
+        descriptor_ = std::exchange(other.descriptor_, 0);
+    }
+    return *this;
+}
+
+void Shader::submit() {
+    if (descriptor_ != 0) {
+        return;
+    }
+    descriptor_ = variants_ == nullptr ? submit_source(type_, source_) : variants_->get(type_, source_);
+}
+
+bool Shader::reload() {
+    auto preprocessed = preprocessor_->preprocess(filepath_, defines_);
+    files_ = std::move(preprocessed.files);
+    if (preprocessed.source.hash == source_.hash) {
+        return false;
+    }
+    source_ = preprocessed.source;
+    // programs the shader is attached to keep it until they are deleted
+    if (descriptor_ != 0 and variants_ == nullptr) {
+        glDeleteShader(descriptor_);
+    }
+    descriptor_ = 0;
+    return true;
+}
+
+bool Shader::compile() {
+    submit();
+    gl::i32 is_compilation_success = GL_FALSE;
+    glGetShaderiv(descriptor_, GL_COMPILE_STATUS, &is_compilation_success);
+    return is_compilation_success == GL_TRUE;
+}
+
+gl::u32 Shader::get() {
+    submit();
+    return descriptor_;
 }
 
 } // namespace dk::gl
@@ -0,0 +1,180 @@
+#include <dklib/gl/shader_preprocessor.hpp>
+
+#include <dklib/util/hash.hpp>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+namespace dk::gl {
+namespace {
+    std::string_view trim(std::string_view text) {
+        const auto begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    /// Name of the directive of the line and the rest of it, both empty when
+    /// the line is not a directive.
+    std::pair<std::string_view, std::string_view> split_directive(std::string_view line) {
+        line = trim(line);
+        if (not line.starts_with('#')) {
+            return {};
+        }
+        line = trim(line.substr(1));
+        const auto end = std::min(line.find_first_of(" \t"), line.size());
+        return { line.substr(0, end), trim(line.substr(end)) };
+    }
+} // namespace
+
+struct ShaderPreprocessor::Expansion {
+    std::vector<ShaderDefine> defines;
+    std::vector<std::filesystem::path> files;
+    /// Files being expanded, to find the ones including themselves
+    std::vector<std::filesystem::path> stack;
+    std::vector<std::filesystem::path> included_once;
+    ShaderSource root;
+    std::string text;
+    bool is_version_found { false };
+    bool is_changed { false };
+
+    void append_defines(std::size_t next_line) {
+        for (const auto &define : defines) {
+            text += fmt::format("#define {} {}\n", define.name, define.value);
+        }
+        text += fmt::format("#line {} 0\n", next_line);
+    }
+};
+
+ShaderPreprocessor::ShaderPreprocessor(std::vector<std::filesystem::path> include_directories)
+    : ShaderPreprocessor(std::move(include_directories), ShaderSourceCache::get_instance()) { }
+
+ShaderPreprocessor::ShaderPreprocessor(std::vector<std::filesystem::path> include_directories,
+                                       ShaderSourceCache &sources)
+    : include_directories_(std::move(include_directories))
+    , sources_(sources) { }
+
+ShaderPreprocessor &ShaderPreprocessor::get_instance() {
+    static ShaderPreprocessor instance;
+    return instance;
+}
+
+PreprocessedSource ShaderPreprocessor::preprocess(const std::filesystem::path &filepath,
+                                                  std::span<const ShaderDefine> defines) {
+    Expansion expansion;
+    expansion.defines.assign(defines.begin(), defines.end());
+    std::ranges::stable_sort(expansion.defines, {}, &ShaderDefine::name);
+    expand(filepath, expansion);
+
+    if (not expansion.is_changed and expansion.defines.empty()) {
+        return { expansion.root, std::move(expansion.files) };
+    }
+    if (not expansion.is_version_found) {
+        auto text = std::move(expansion.text);
+        expansion.text.clear();
+        expansion.append_defines(1);
+        expansion.text += text;
+    }
+    return { store(expansion.text), std::move(expansion.files) };
+}
+
+void ShaderPreprocessor::expand(const std::filesystem::path &filepath, Expansion &expansion) {
+    const auto file = filepath.lexically_normal();
+    if (std::ranges::find(expansion.stack, file) != expansion.stack.end()) {
+        spdlog::error("shader preprocessor: {} includes itself", file.string());
+        throw std::runtime_error("shader includes itself");
+    }
+    if (std::ranges::find(expansion.included_once, file) != expansion.included_once.end()) {
+        return;
+    }
+
+    const auto source = sources_.get(file);
+    const bool is_root = expansion.stack.empty();
+    if (is_root) {
+        expansion.root = source;
+    }
+    auto index = static_cast<std::size_t>(std::ranges::find(expansion.files, file) - expansion.files.begin());
+    if (index == expansion.files.size()) {
+        expansion.files.push_back(file);
+    }
+    if (not is_root) {
+        expansion.text += fmt::format("#line 1 {}\n", index);
+    }
+
+    expansion.stack.push_back(file);
+    const auto text = source.text;
+    std::size_t line_number = 0;
+    for (std::size_t begin = 0; begin < text.size();) {
+        const auto end = std::min(text.find('\n', begin), text.size());
+        const auto line = text.substr(begin, end - begin);
+        begin = end + 1;
+        ++line_number;
+
+        const auto [directive, argument] = split_directive(line);
+        if (directive == "include") {
+            const bool is_quoted = argument.starts_with('"') and argument.ends_with('"');
+            const bool is_angled = argument.starts_with('<') and argument.ends_with('>');
+            if (argument.size() < 3 or not(is_quoted or is_angled)) {
+                spdlog::error("shader preprocessor: {}:{} malformed #include", file.string(), line_number);
+                throw std::runtime_error("malformed #include in shader");
+            }
+            expand(resolve(argument.substr(1, argument.size() - 2), is_quoted, file), expansion);
+            expansion.text += fmt::format("#line {} {}\n", line_number + 1, index);
+            expansion.is_changed = true;
+            continue;
+        }
+        if (directive == "pragma" and argument == "once") {
+            // the pragma is left in the text, drivers ignore unknown ones
+            expansion.included_once.push_back(file);
+        }
+        expansion.text += line;
+        expansion.text += '\n';
+        if (is_root and directive == "version" and not expansion.is_version_found) {
+            expansion.is_version_found = true;
+            if (not expansion.defines.empty()) {
+                expansion.append_defines(line_number + 1);
+            }
+        }
+    }
+    expansion.stack.pop_back();
+}
+
+std::filesystem::path ShaderPreprocessor::resolve(std::string_view name, bool is_quoted,
+                                                  const std::filesystem::path &including_file) const {
+    if (is_quoted) {
+        auto path = including_file.parent_path() / name;
+        if (std::filesystem::exists(path)) {
+            return path;
+        }
+    }
+    for (const auto &directory : include_directories_) {
+        auto path = directory / name;
+        if (std::filesystem::exists(path)) {
+            return path;
+        }
+    }
+    spdlog::error("shader preprocessor: {} included by {} was not found", name, including_file.string());
+    throw std::runtime_error("included shader was not found");
+}
+
+ShaderSource ShaderPreprocessor::store(std::string_view text) {
+    const auto hash = util::fnv1a(text);
+    const std::lock_guard lock { mutex_ };
+    auto &stored = texts_[hash];
+    if (stored != text) {
+        stored = arena_.store(text);
+    }
+    return { stored, hash };
+}
+
+std::size_t ShaderPreprocessor::size() const {
+    const std::lock_guard lock { mutex_ };
+    return texts_.size();
+}
+
+} // namespace dk::gl
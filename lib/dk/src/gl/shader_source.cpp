@@ -0,0 +1,71 @@
+#include <dklib/gl/shader_source.hpp>
+
+#include <dklib/file/file_base.hpp>
+#include <dklib/util/hash.hpp>
+
+#include <spdlog/spdlog.h>
+
+namespace dk::gl {
+ShaderSourceCache &ShaderSourceCache::get_instance() {
+    static ShaderSourceCache instance;
+    return instance;
+}
+
+ShaderSource ShaderSourceCache::get(const std::filesystem::path &filepath) {
+    std::error_code error;
+    const auto modified = std::filesystem::last_write_time(filepath, error);
+    const auto size = error ? 0 : std::filesystem::file_size(filepath, error);
+    if (error) {
+        spdlog::error("shader source: {} could not be inspected: {}", filepath.string(), error.message());
+        throw std::runtime_error("could not open the shader source");
+    }
+
+    const std::lock_guard lock { mutex_ };
+    auto found = entries_.find(filepath.string());
+    if (found != entries_.end() and found->second.modified == modified and found->second.size == size) {
+        ++hit_count_;
+        return found->second.source;
+    }
+
+    // the entry is added only once the file was read, a failed load leaves
+    // no entry behind
+    const file::MappedFile file(filepath, { file::AccessPattern::SEQUENTIAL });
+    const auto hash = util::fnv1a(file.text());
+    if (found == entries_.end()) {
+        found = entries_.emplace(filepath.string(), Entry {}).first;
+    }
+    auto &entry = found->second;
+    if (entry.source.text.data() == nullptr or entry.source.hash != hash) {
+        entry.source = { arena_.store(file.text()), hash };
+        spdlog::debug("shader source: {} loaded\n{}", filepath.string(), entry.source.text);
+    } else {
+        // touched without changing the contents
+        ++hit_count_;
+    }
+    entry.modified = modified;
+    entry.size = file.size();
+    return entry.source;
+}
+
+void ShaderSourceCache::clear() {
+    const std::lock_guard lock { mutex_ };
+    entries_.clear();
+    arena_.clear();
+    hit_count_ = 0;
+}
+
+std::size_t ShaderSourceCache::size() const {
+    const std::lock_guard lock { mutex_ };
+    return entries_.size();
+}
+
+std::size_t ShaderSourceCache::get_hit_count() const {
+    const std::lock_guard lock { mutex_ };
+    return hit_count_;
+}
+
+std::size_t ShaderSourceCache::memory_usage() const {
+    const std::lock_guard lock { mutex_ };
+    return arena_.used();
+}
+} // namespace dk::gl
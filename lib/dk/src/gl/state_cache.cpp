@@ -0,0 +1,204 @@
+#include <dklib/gl/state_cache.hpp>
+
+#include <GL/glext.h>
+#include <GLES3/gl31.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace dk::gl {
+
+StateCache &StateCache::get_instance() {
+    thread_local StateCache cache;
+    return cache;
+}
+
+StateCache::StateCache() { invalidate(); }
+
+std::size_t StateCache::buffer_slot(enum32 target) noexcept {
+    switch (target) {
+    case GL_ELEMENT_ARRAY_BUFFER:
+        return ELEMENT_ARRAY_SLOT;
+    case GL_ARRAY_BUFFER:
+        return 1;
+    case GL_COPY_READ_BUFFER:
+        return 2;
+    case GL_COPY_WRITE_BUFFER:
+        return 3;
+    case GL_UNIFORM_BUFFER:
+        return 4;
+    case GL_SHADER_STORAGE_BUFFER:
+        return 5;
+    case GL_DRAW_INDIRECT_BUFFER:
+        return 6;
+    case GL_DISPATCH_INDIRECT_BUFFER:
+        return 7;
+    case GL_PIXEL_PACK_BUFFER:
+        return 8;
+    case GL_PIXEL_UNPACK_BUFFER:
+        return 9;
+    case GL_ATOMIC_COUNTER_BUFFER:
+        return 10;
+    case GL_TEXTURE_BUFFER:
+        return 11;
+    case GL_QUERY_BUFFER:
+        return 12;
+    case GL_TRANSFORM_FEEDBACK_BUFFER:
+        return 13;
+    default:
+        return UNTRACKED;
+    }
+}
+
+std::size_t StateCache::texture_slot(enum32 target) noexcept {
+    switch (target) {
+    case GL_TEXTURE_2D:
+        return 0;
+    case GL_TEXTURE_CUBE_MAP:
+        return 1;
+    case GL_TEXTURE_2D_ARRAY:
+        return 2;
+    case GL_TEXTURE_3D:
+        return 3;
+    case GL_TEXTURE_CUBE_MAP_ARRAY:
+        return 4;
+    case GL_TEXTURE_1D:
+        return 5;
+    case GL_TEXTURE_1D_ARRAY:
+        return 6;
+    case GL_TEXTURE_BUFFER:
+        return 7;
+    case GL_TEXTURE_2D_MULTISAMPLE:
+        return 8;
+    case GL_TEXTURE_2D_MULTISAMPLE_ARRAY:
+        return 9;
+    case GL_TEXTURE_RECTANGLE:
+        return 10;
+    default:
+        return UNTRACKED;
+    }
+}
+
+void StateCache::issue_use_program(u32 program) { glUseProgram(program); }
+
+void StateCache::issue_bind_program_pipeline(u32 pipeline) { glBindProgramPipeline(pipeline); }
+
+void StateCache::issue_bind_vertex_array(u32 vertex_array) { glBindVertexArray(vertex_array); }
+
+void StateCache::issue_bind_buffer(enum32 target, u32 buffer) { glBindBuffer(target, buffer); }
+
+void StateCache::bind_buffer_base(enum32 target, u32 index, u32 buffer) {
+    glBindBufferBase(target, index, buffer);
+    ++frame_.issued;
+    if (const auto slot = buffer_slot(target); slot != UNTRACKED) {
+        buffers_[slot] = buffer;
+    }
+}
+
+void StateCache::bind_buffer_range(enum32 target, u32 index, u32 buffer, iptr offset, sptr size) {
+    glBindBufferRange(target, index, buffer, offset, size);
+    ++frame_.issued;
+    if (const auto slot = buffer_slot(target); slot != UNTRACKED) {
+        buffers_[slot] = buffer;
+    }
+}
+
+void StateCache::bind_texture(u32 unit, enum32 target, u32 texture) {
+    if (set(active_texture_, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    bind_texture(target, texture);
+}
+
+void StateCache::bind_texture(enum32 target, u32 texture) {
+    const auto slot = texture_slot(target);
+    if (slot == UNTRACKED or active_texture_ >= TEXTURE_UNIT_COUNT) {
+        // the active unit is either unknown or not tracked
+        ++frame_.issued;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (set(textures_[(active_texture_ * TEXTURE_TARGET_COUNT) + slot], texture)) {
+        glBindTexture(target, texture);
+    }
+}
+
+void StateCache::set_capability(enum32 capability, bool is_enabled) {
+    auto found = std::ranges::find(capabilities_, capability, &std::pair<enum32, bool>::first);
+    if (found == capabilities_.end()) {
+        capabilities_.emplace_back(capability, is_enabled);
+    } else if (found->second == is_enabled) {
+        ++frame_.elided;
+        return;
+    } else {
+        found->second = is_enabled;
+    }
+    ++frame_.issued;
+    if (is_enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void StateCache::forget_program(u32 program) {
+    if (program_ == program) {
+        program_ = UNKNOWN;
+    }
+}
+
+void StateCache::forget_program_pipeline(u32 pipeline) {
+    if (pipeline_ == pipeline) {
+        pipeline_ = UNKNOWN;
+    }
+}
+
+void StateCache::forget_vertex_array(u32 vertex_array) {
+    if (vertex_array_ == vertex_array) {
+        vertex_array_ = UNKNOWN;
+        buffers_[ELEMENT_ARRAY_SLOT] = UNKNOWN;
+    }
+}
+
+void StateCache::forget_buffer(u32 buffer) {
+    std::ranges::replace(buffers_, buffer, UNKNOWN);
+}
+
+void StateCache::forget_texture(u32 texture) {
+    std::ranges::replace(textures_, texture, UNKNOWN);
+}
+
+void StateCache::invalidate() {
+    program_ = UNKNOWN;
+    pipeline_ = UNKNOWN;
+    vertex_array_ = UNKNOWN;
+    buffers_.fill(UNKNOWN);
+    active_texture_ = UNKNOWN;
+    textures_.fill(UNKNOWN);
+    capabilities_.clear();
+    are_extensions_known_ = false;
+}
+
+bool StateCache::has_extension(std::string_view name) {
+    if (not are_extensions_known_) {
+        i32 count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        extensions_.clear();
+        for (i32 i = 0; i < count; ++i) {
+            const auto *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<u32>(i)));
+            if (extension != nullptr) {
+                extensions_.emplace_back(extension);
+            }
+        }
+        std::ranges::sort(extensions_);
+        are_extensions_known_ = true;
+    }
+    return std::ranges::binary_search(extensions_, name, std::less<> {});
+}
+
+StateStats StateCache::end_frame() {
+    last_frame_ = std::exchange(frame_, {});
+    return last_frame_;
+}
+
+} // namespace dk::gl
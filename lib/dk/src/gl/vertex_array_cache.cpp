@@ -0,0 +1,74 @@
+#include <dklib/gl/state_cache.hpp>
+#include <dklib/gl/vertex_array_cache.hpp>
+
+#include <dklib/util/hash.hpp>
+
+#include <GLES3/gl3.h>
+
+#include <algorithm>
+
+namespace dk::gl {
+namespace {
+    std::uint64_t hash_layout(std::span<const VertexAttribute> attributes) {
+        // hashed field by field, the padding of VertexAttribute is not
+        // guaranteed to be zeroed
+        std::uint64_t hash = util::FNV_OFFSET_BASIS;
+        for (const auto &attribute : attributes) {
+            const std::uint64_t parts[] = {
+                attribute.location,
+                static_cast<std::uint64_t>(attribute.components),
+                attribute.type,
+                attribute.normalized ? 1U : 0U,
+                attribute.offset,
+                attribute.binding,
+                attribute.integer ? 1U : 0U,
+            };
+            hash = util::fnv1a(std::as_bytes(std::span { parts }), hash);
+        }
+        return hash;
+    }
+} // namespace
+
+VertexArrayCache &VertexArrayCache::get_instance() {
+    thread_local VertexArrayCache cache;
+    return cache;
+}
+
+std::size_t VertexArrayCache::KeyHash::operator()(const Key &key) const noexcept {
+    std::uint64_t hash = util::FNV_OFFSET_BASIS;
+    for (const auto &stream : key.streams) {
+        const std::uint64_t parts[] = { stream.buffer, stream.stride, stream.offset };
+        hash = util::fnv1a(std::as_bytes(std::span { parts }), hash);
+    }
+    const std::uint64_t parts[] = { key.layout, key.element_buffer };
+    return static_cast<std::size_t>(util::fnv1a(std::as_bytes(std::span { parts }), hash));
+}
+
+std::shared_ptr<const VertexArray> VertexArrayCache::get(std::span<const VertexAttribute> attributes,
+                                                         std::span<const VertexStreamBinding> streams,
+                                                         u32 element_buffer) {
+    Key key { hash_layout(attributes), { streams.begin(), streams.end() }, element_buffer };
+    if (const auto found = arrays_.find(key); found != arrays_.end()) {
+        if (auto shared = found->second.lock()) {
+            return shared;
+        }
+    }
+    // arrays are built rarely, dropping the deleted ones here keeps the
+    // map as small as the count of the live ones
+    std::erase_if(arrays_, [](const auto &entry) { return entry.second.expired(); });
+
+    auto array = std::make_shared<VertexArray>();
+    auto &state = StateCache::get_instance();
+    array->bind();
+    set_attribute_pointers(attributes, streams);
+    state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer);
+    arrays_[std::move(key)] = array;
+    return array;
+}
+
+std::size_t VertexArrayCache::size() const {
+    return static_cast<std::size_t>(
+        std::ranges::count_if(arrays_, [](const auto &entry) { return not entry.second.expired(); }));
+}
+
+} // namespace dk::gl
@@ -0,0 +1,378 @@
+#include <dklib/gl/vertex_compression.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace dk::gl {
+namespace {
+    constexpr f32 SNORM16_MAX = 32767.0f;
+
+    /// Position relative to the quantization, position = snorm * scale +
+    /// offset is inverted with a multiply, so that all of the variants do the
+    /// same operations.
+    struct Quantizer {
+        std::array<f32, 3> inverse_scale;
+        std::array<f32, 3> offset;
+
+        explicit Quantizer(const VertexQuantization &quantization)
+            : inverse_scale { 1.0f / quantization.scale[0], 1.0f / quantization.scale[1], 1.0f / quantization.scale[2] }
+            , offset(quantization.offset) { }
+    };
+
+    // Every kernel rounds to nearest even, std::nearbyint in the default
+    // rounding mode and _mm_cvtps_epi32 alike, and maps NaN to 0, so all of
+    // the variants give identical results.
+    i16 to_snorm16(f32 value) {
+        if (std::isnan(value)) {
+            return 0;
+        }
+        return static_cast<i16>(std::nearbyint(std::clamp(value, -1.0f, 1.0f) * SNORM16_MAX));
+    }
+
+    f32 from_snorm16(i16 value) { return std::max(static_cast<f32>(value) / SNORM16_MAX, -1.0f); }
+
+    std::array<f32, 2> fold_octahedral(f32 x, f32 y, f32 z) {
+        const f32 l1 = std::max(std::abs(x) + std::abs(y) + std::abs(z), std::numeric_limits<f32>::min());
+        const f32 px = x / l1;
+        const f32 py = y / l1;
+        if (z < 0.0f) {
+            return { (1.0f - std::abs(py)) * std::copysign(1.0f, px), (1.0f - std::abs(px)) * std::copysign(1.0f, py) };
+        }
+        return { px, py };
+    }
+
+    using QuantizePositions = void (*)(const experimental::Vertex *source, CompressedVertex *target, std::size_t count,
+                                       const Quantizer &quantizer);
+    using EncodeNormals = void (*)(const experimental::Vertex *source, CompressedVertex *target, std::size_t count);
+    using EncodeUvs = void (*)(const experimental::Vertex *source, CompressedVertex *target, std::size_t count);
+
+    void quantize_positions_scalar(const experimental::Vertex *source, CompressedVertex *target, std::size_t count,
+                                   const Quantizer &quantizer) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto &position = source[i].position;
+            target[i].position.values = {
+                to_snorm16((position.x - quantizer.offset[0]) * quantizer.inverse_scale[0]),
+                to_snorm16((position.y - quantizer.offset[1]) * quantizer.inverse_scale[1]),
+                to_snorm16((position.z - quantizer.offset[2]) * quantizer.inverse_scale[2]),
+                static_cast<i16>(SNORM16_MAX),
+            };
+        }
+    }
+
+    void encode_normals_scalar(const experimental::Vertex *source, CompressedVertex *target, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto &normal = source[i].normal;
+            const auto folded = fold_octahedral(normal.x, normal.y, normal.z);
+            target[i].normal.values = { to_snorm16(folded[0]), to_snorm16(folded[1]) };
+        }
+    }
+
+    void encode_uvs_scalar(const experimental::Vertex *source, CompressedVertex *target, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            target[i].uv[0] = float_to_half(source[i].u);
+            target[i].uv[1] = float_to_half(source[i].v);
+        }
+    }
+
+#if defined(__SSE2__)
+    /// Rounded snorm16 of the four values, in the lanes of the result.
+    __m128i to_snorm16_sse2(__m128 values) {
+        // min and max return their second operand for NaN, it is zeroed first
+        const __m128 ordered = _mm_and_ps(values, _mm_cmpord_ps(values, values));
+        const __m128 clamped = _mm_max_ps(_mm_min_ps(ordered, _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+        return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(SNORM16_MAX)));
+    }
+
+    void quantize_positions_sse2(const experimental::Vertex *source, CompressedVertex *target, std::size_t count,
+                                 const Quantizer &quantizer) {
+        const __m128 inverse_x = _mm_set1_ps(quantizer.inverse_scale[0]);
+        const __m128 inverse_y = _mm_set1_ps(quantizer.inverse_scale[1]);
+        const __m128 inverse_z = _mm_set1_ps(quantizer.inverse_scale[2]);
+        const __m128 offset_x = _mm_set1_ps(quantizer.offset[0]);
+        const __m128 offset_y = _mm_set1_ps(quantizer.offset[1]);
+        const __m128 offset_z = _mm_set1_ps(quantizer.offset[2]);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const auto *v = source + i;
+            const __m128 x = _mm_setr_ps(v[0].position.x, v[1].position.x, v[2].position.x, v[3].position.x);
+            const __m128 y = _mm_setr_ps(v[0].position.y, v[1].position.y, v[2].position.y, v[3].position.y);
+            const __m128 z = _mm_setr_ps(v[0].position.z, v[1].position.z, v[2].position.z, v[3].position.z);
+            alignas(16) i32 qx[4];
+            alignas(16) i32 qy[4];
+            alignas(16) i32 qz[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(qx), to_snorm16_sse2(_mm_mul_ps(_mm_sub_ps(x, offset_x), inverse_x)));
+            _mm_store_si128(reinterpret_cast<__m128i *>(qy), to_snorm16_sse2(_mm_mul_ps(_mm_sub_ps(y, offset_y), inverse_y)));
+            _mm_store_si128(reinterpret_cast<__m128i *>(qz), to_snorm16_sse2(_mm_mul_ps(_mm_sub_ps(z, offset_z), inverse_z)));
+            for (std::size_t lane = 0; lane < 4; ++lane) {
+                target[i + lane].position.values = { static_cast<i16>(qx[lane]), static_cast<i16>(qy[lane]),
+                                                     static_cast<i16>(qz[lane]), static_cast<i16>(SNORM16_MAX) };
+            }
+        }
+        quantize_positions_scalar(source + i, target + i, count - i, quantizer);
+    }
+
+    void encode_normals_sse2(const experimental::Vertex *source, CompressedVertex *target, std::size_t count) {
+        const __m128 sign_mask = _mm_set1_ps(-0.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 smallest = _mm_set1_ps(std::numeric_limits<f32>::min());
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const auto *v = source + i;
+            const __m128 x = _mm_setr_ps(v[0].normal.x, v[1].normal.x, v[2].normal.x, v[3].normal.x);
+            const __m128 y = _mm_setr_ps(v[0].normal.y, v[1].normal.y, v[2].normal.y, v[3].normal.y);
+            const __m128 z = _mm_setr_ps(v[0].normal.z, v[1].normal.z, v[2].normal.z, v[3].normal.z);
+            // a NaN sum is kept as std::max does, max returns its second operand
+            const __m128 l1 = _mm_max_ps(
+                smallest,
+                _mm_add_ps(_mm_add_ps(_mm_andnot_ps(sign_mask, x), _mm_andnot_ps(sign_mask, y)), _mm_andnot_ps(sign_mask, z)));
+            const __m128 px = _mm_div_ps(x, l1);
+            const __m128 py = _mm_div_ps(y, l1);
+            // the lower hemisphere is folded over the diagonals
+            const __m128 sign_x = _mm_or_ps(one, _mm_and_ps(px, sign_mask));
+            const __m128 sign_y = _mm_or_ps(one, _mm_and_ps(py, sign_mask));
+            const __m128 folded_x = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(sign_mask, py)), sign_x);
+            const __m128 folded_y = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(sign_mask, px)), sign_y);
+            const __m128 is_lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+            const __m128 ox = _mm_or_ps(_mm_and_ps(is_lower, folded_x), _mm_andnot_ps(is_lower, px));
+            const __m128 oy = _mm_or_ps(_mm_and_ps(is_lower, folded_y), _mm_andnot_ps(is_lower, py));
+            alignas(16) i32 qx[4];
+            alignas(16) i32 qy[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(qx), to_snorm16_sse2(ox));
+            _mm_store_si128(reinterpret_cast<__m128i *>(qy), to_snorm16_sse2(oy));
+            for (std::size_t lane = 0; lane < 4; ++lane) {
+                target[i + lane].normal.values = { static_cast<i16>(qx[lane]), static_cast<i16>(qy[lane]) };
+            }
+        }
+        encode_normals_scalar(source + i, target + i, count - i);
+    }
+
+#if defined(__GNUC__)
+    __attribute__((target("f16c"))) void encode_uvs_f16c(const experimental::Vertex *source, CompressedVertex *target,
+                                                         std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            const __m128 uvs = _mm_setr_ps(source[i].u, source[i].v, source[i + 1].u, source[i + 1].v);
+            alignas(16) u16 halves[8];
+            _mm_store_si128(reinterpret_cast<__m128i *>(halves), _mm_cvtps_ph(uvs, _MM_FROUND_TO_NEAREST_INT));
+            target[i].uv[0] = { halves[0] };
+            target[i].uv[1] = { halves[1] };
+            target[i + 1].uv[0] = { halves[2] };
+            target[i + 1].uv[1] = { halves[3] };
+        }
+        encode_uvs_scalar(source + i, target + i, count - i);
+    }
+#endif
+#endif
+
+    struct Dispatch {
+        QuantizePositions quantize_positions;
+        EncodeNormals encode_normals;
+        EncodeUvs encode_uvs;
+        std::string_view name;
+    };
+
+    const Dispatch &get_dispatch() {
+        static const Dispatch dispatch = []() -> Dispatch {
+#if defined(__SSE2__)
+#if defined(__GNUC__)
+            if (__builtin_cpu_supports("f16c")) {
+                return { quantize_positions_sse2, encode_normals_sse2, encode_uvs_f16c, "sse2+f16c" };
+            }
+#endif
+            return { quantize_positions_sse2, encode_normals_sse2, encode_uvs_scalar, "sse2" };
+#else
+            return { quantize_positions_scalar, encode_normals_scalar, encode_uvs_scalar, "scalar" };
+#endif
+        }();
+        return dispatch;
+    }
+
+    f32 distance(const math::Vector3D &lhs, const math::Vector3D &rhs) {
+        const f32 dx = lhs.x - rhs.x;
+        const f32 dy = lhs.y - rhs.y;
+        const f32 dz = lhs.z - rhs.z;
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    f32 angle_degrees(const math::Vector3D &lhs, const math::Vector3D &rhs) {
+        // atan2 keeps the precision of small angles, which acos of the dot
+        // product loses near 1
+        const f32 cx = lhs.y * rhs.z - lhs.z * rhs.y;
+        const f32 cy = lhs.z * rhs.x - lhs.x * rhs.z;
+        const f32 cz = lhs.x * rhs.y - lhs.y * rhs.x;
+        const f32 dot = lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+        return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot) * 180.0f / std::numbers::pi_v<f32>;
+    }
+} // namespace
+
+VertexQuantization VertexQuantization::from_bounds(const std::array<f32, 3> &min, const std::array<f32, 3> &max) {
+    VertexQuantization quantization;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        const f32 half_extent = (max[axis] - min[axis]) * 0.5f;
+        // a flat axis would divide by zero, any scale represents it exactly
+        quantization.scale[axis] = half_extent > 0.0f ? half_extent : 1.0f;
+        quantization.offset[axis] = (min[axis] + max[axis]) * 0.5f;
+    }
+    return quantization;
+}
+
+CompressedVertices compress(std::span<const experimental::Vertex> vertices) {
+    if (vertices.empty()) {
+        return {};
+    }
+    std::array<f32, 3> min { std::numeric_limits<f32>::max(), std::numeric_limits<f32>::max(),
+                             std::numeric_limits<f32>::max() };
+    std::array<f32, 3> max { std::numeric_limits<f32>::lowest(), std::numeric_limits<f32>::lowest(),
+                             std::numeric_limits<f32>::lowest() };
+    for (const auto &vertex : vertices) {
+        const std::array<f32, 3> position { vertex.position.x, vertex.position.y, vertex.position.z };
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            min[axis] = std::min(min[axis], position[axis]);
+            max[axis] = std::max(max[axis], position[axis]);
+        }
+    }
+    auto quantization = VertexQuantization::from_bounds(min, max);
+    return { compress(vertices, quantization), quantization };
+}
+
+std::vector<CompressedVertex> compress(std::span<const experimental::Vertex> vertices,
+                                       const VertexQuantization &quantization) {
+    std::vector<CompressedVertex> compressed(vertices.size());
+    const auto &dispatch = get_dispatch();
+    dispatch.quantize_positions(vertices.data(), compressed.data(), vertices.size(), Quantizer(quantization));
+    dispatch.encode_normals(vertices.data(), compressed.data(), vertices.size());
+    dispatch.encode_uvs(vertices.data(), compressed.data(), vertices.size());
+    return compressed;
+}
+
+std::vector<experimental::Vertex> decompress(std::span<const CompressedVertex> vertices,
+                                             const VertexQuantization &quantization) {
+    std::vector<experimental::Vertex> decompressed;
+    decompressed.reserve(vertices.size());
+    for (const auto &vertex : vertices) {
+        const auto &position = vertex.position.values;
+        const auto normal = decode_octahedral(vertex.normal);
+        decompressed.push_back({
+            { from_snorm16(position[0]) * quantization.scale[0] + quantization.offset[0],
+              from_snorm16(position[1]) * quantization.scale[1] + quantization.offset[1],
+              from_snorm16(position[2]) * quantization.scale[2] + quantization.offset[2] },
+            { normal[0], normal[1], normal[2] },
+            half_to_float(vertex.uv[0]),
+            half_to_float(vertex.uv[1]),
+        });
+    }
+    return decompressed;
+}
+
+CompressionError measure_error(std::span<const experimental::Vertex> source, const CompressedVertices &compressed) {
+    if (source.size() != compressed.vertices.size()) {
+        spdlog::error("Compressed vertices are {}, but their source has {} vertices", compressed.vertices.size(),
+                      source.size());
+        throw std::runtime_error("compressed vertices do not match their source");
+    }
+    const auto decoded = decompress(compressed.vertices, compressed.quantization);
+    CompressionError error;
+    f64 position_sum = 0.0;
+    f64 normal_sum = 0.0;
+    f64 uv_sum = 0.0;
+    std::size_t normal_count = 0;
+    for (std::size_t i = 0; i < source.size(); ++i) {
+        const f32 position = distance(source[i].position, decoded[i].position);
+        error.max_position = std::max(error.max_position, position);
+        position_sum += position;
+
+        const auto &normal = source[i].normal;
+        if (normal.x != 0.0f or normal.y != 0.0f or normal.z != 0.0f) {
+            const f32 angle = angle_degrees(normal, decoded[i].normal);
+            error.max_normal_degrees = std::max(error.max_normal_degrees, angle);
+            normal_sum += angle;
+            ++normal_count;
+        }
+
+        const f32 uv = std::max(std::abs(source[i].u - decoded[i].u), std::abs(source[i].v - decoded[i].v));
+        error.max_uv = std::max(error.max_uv, uv);
+        uv_sum += uv;
+    }
+    if (not source.empty()) {
+        const auto count = static_cast<f64>(source.size());
+        error.mean_position = static_cast<f32>(position_sum / count);
+        error.mean_uv = static_cast<f32>(uv_sum / count);
+    }
+    if (normal_count != 0) {
+        error.mean_normal_degrees = static_cast<f32>(normal_sum / static_cast<f64>(normal_count));
+    }
+    return error;
+}
+
+Half float_to_half(f32 value) noexcept {
+    const auto bits = std::bit_cast<u32>(value);
+    const u32 sign = (bits >> 16) & 0x8000U;
+    const u32 magnitude = bits & 0x7fffffffU;
+    if (magnitude >= 0x7f800000U) {
+        // infinity stays one, NaN stays quiet with its upper payload
+        const u32 payload = magnitude > 0x7f800000U ? 0x200U | ((magnitude >> 13) & 0x3ffU) : 0U;
+        return { static_cast<u16>(sign | 0x7c00U | payload) };
+    }
+    if (magnitude >= 0x47800000U) {
+        return { static_cast<u16>(sign | 0x7c00U) };
+    }
+    if (magnitude < 0x38800000U) {
+        // subnormal halves are multiples of 2^-24, the scaling is exact and
+        // the rounding of 1024 gives the smallest normal half
+        const f32 scaled = std::bit_cast<f32>(magnitude) * 16777216.0f;
+        return { static_cast<u16>(sign | static_cast<u32>(std::nearbyint(scaled))) };
+    }
+    // exponent rebias from 127 to 15, the mantissa rounded to even, a carry
+    // out of it increments the exponent, up to infinity
+    u32 half = (magnitude - 0x38000000U) >> 13;
+    const u32 rest = magnitude & 0x1fffU;
+    if (rest > 0x1000U or (rest == 0x1000U and (half & 1U) != 0)) {
+        ++half;
+    }
+    return { static_cast<u16>(sign | half) };
+}
+
+f32 half_to_float(Half value) noexcept {
+    const u32 sign = static_cast<u32>(value.bits & 0x8000U) << 16;
+    const u32 exponent = (value.bits >> 10) & 0x1fU;
+    const u32 mantissa = value.bits & 0x3ffU;
+    if (exponent == 0) {
+        const f32 magnitude = static_cast<f32>(mantissa) / 16777216.0f;
+        return sign != 0 ? -magnitude : magnitude;
+    }
+    if (exponent == 0x1fU) {
+        return std::bit_cast<f32>(sign | 0x7f800000U | (mantissa << 13));
+    }
+    return std::bit_cast<f32>(sign | ((exponent + 112U) << 23) | (mantissa << 13));
+}
+
+Normalized<i16, 2> encode_octahedral(f32 x, f32 y, f32 z) noexcept {
+    const auto folded = fold_octahedral(x, y, z);
+    return { { to_snorm16(folded[0]), to_snorm16(folded[1]) } };
+}
+
+std::array<f32, 3> decode_octahedral(Normalized<i16, 2> encoded) noexcept {
+    f32 x = from_snorm16(encoded.values[0]);
+    f32 y = from_snorm16(encoded.values[1]);
+    const f32 z = 1.0f - std::abs(x) - std::abs(y);
+    if (z < 0.0f) {
+        const f32 folded_x = (1.0f - std::abs(y)) * std::copysign(1.0f, x);
+        y = (1.0f - std::abs(x)) * std::copysign(1.0f, y);
+        x = folded_x;
+    }
+    const f32 length = std::sqrt(x * x + y * y + z * z);
+    return { x / length, y / length, z / length };
+}
+
+std::string_view vertex_compression_instruction_set() { return get_dispatch().name; }
+
+} // namespace dk::gl
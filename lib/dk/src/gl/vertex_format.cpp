@@ -0,0 +1,35 @@
+#include <dklib/gl/state_cache.hpp>
+#include <dklib/gl/vertex_format.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace dk::gl {
+
+void set_attribute_pointers(std::span<const VertexAttribute> attributes, std::span<const VertexStreamBinding> streams) {
+    auto &state = StateCache::get_instance();
+    for (const auto &attribute : attributes) {
+        if (attribute.binding >= streams.size()) {
+            spdlog::error("Vertex attribute {} reads the stream {}, but there are {} streams", attribute.location,
+                          attribute.binding, streams.size());
+            throw std::runtime_error("vertex attribute of a missing stream");
+        }
+        const auto &stream = streams[attribute.binding];
+        // the pointer captures the buffer bound to GL_ARRAY_BUFFER
+        state.bind_buffer(GL_ARRAY_BUFFER, stream.buffer);
+        const auto *pointer = reinterpret_cast<const void *>(static_cast<std::uintptr_t>(stream.offset + attribute.offset));
+        glEnableVertexAttribArray(attribute.location);
+        if (attribute.integer) {
+            glVertexAttribIPointer(attribute.location, attribute.components, attribute.type,
+                                   static_cast<gl::size>(stream.stride), pointer);
+        } else {
+            glVertexAttribPointer(attribute.location, attribute.components, attribute.type,
+                                  attribute.normalized ? GL_TRUE : GL_FALSE, static_cast<gl::size>(stream.stride),
+                                  pointer);
+        }
+    }
+}
+
+} // namespace dk::gl
@@ -0,0 +1,67 @@
+#include <dklib/util/arena.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace dk::util {
+Arena::Arena(Arena &&other) noexcept
+    : block_size_(other.block_size_)
+    , blocks_(std::move(other.blocks_))
+    , cursor_(std::exchange(other.cursor_, nullptr))
+    , remaining_(std::exchange(other.remaining_, 0))
+    , used_(std::exchange(other.used_, 0))
+    , capacity_(std::exchange(other.capacity_, 0)) {
+    other.blocks_.clear();
+}
+
+Arena &Arena::operator=(Arena &&other) noexcept {
+    if (this != &other) {
+        block_size_ = other.block_size_;
+        blocks_ = std::move(other.blocks_);
+        other.blocks_.clear();
+        cursor_ = std::exchange(other.cursor_, nullptr);
+        remaining_ = std::exchange(other.remaining_, 0);
+        used_ = std::exchange(other.used_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+    }
+    return *this;
+}
+
+std::span<std::byte> Arena::allocate(std::size_t size, std::size_t alignment) {
+    const auto misalignment = reinterpret_cast<std::uintptr_t>(cursor_) & (alignment - 1);
+    std::size_t padding = misalignment == 0 ? 0 : alignment - misalignment;
+    if (cursor_ == nullptr or padding + size > remaining_) {
+        const std::size_t block_size = std::max(block_size_, size + alignment);
+        // new[] of bytes is aligned for any fundamental type only
+        blocks_.push_back(std::make_unique_for_overwrite<std::byte[]>(block_size));
+        cursor_ = blocks_.back().get();
+        remaining_ = block_size;
+        capacity_ += block_size;
+        const auto offset = reinterpret_cast<std::uintptr_t>(cursor_) & (alignment - 1);
+        padding = offset == 0 ? 0 : alignment - offset;
+    }
+    std::byte *result = cursor_ + padding;
+    cursor_ = result + size;
+    remaining_ -= padding + size;
+    used_ += size;
+    return { result, size };
+}
+
+std::string_view Arena::store(std::string_view text) {
+    auto memory = allocate(text.size() + 1, 1);
+    auto *characters = reinterpret_cast<char *>(memory.data());
+    std::memcpy(characters, text.data(), text.size());
+    characters[text.size()] = '\0';
+    return { characters, text.size() };
+}
+
+void Arena::clear() noexcept {
+    blocks_.clear();
+    cursor_ = nullptr;
+    remaining_ = 0;
+    used_ = 0;
+    capacity_ = 0;
+}
+} // namespace dk::util
@@ -16,4 +16,29 @@ std::string get_shader_error_msg(gl::u32 descriptor) {
     return retval;
 }
 
+std::string get_program_error_msg(gl::u32 descriptor) {
+    gl::size log_size = 0;
+    glGetProgramiv(descriptor, GL_INFO_LOG_LENGTH, &log_size);
+
+    std::string retval {};
+    retval.resize(static_cast<gl::u32>(log_size));
+
+    glGetProgramInfoLog(descriptor, log_size, nullptr, retval.data());
+    if (glGetError() != 0) {
+        spdlog::error("Getting information about program failed with code {}", glGetError());
+        throw std::runtime_error("Getting information about program failed");
+    }
+    return retval;
+}
+bool has_extension(std::string_view name) {
+    gl::i32 count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (gl::i32 i = 0; i < count; ++i) {
+        const auto *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<gl::u32>(i)));
+        if (extension != nullptr and name == extension) {
+            return true;
+        }
+    }
+    return false;
+}
 } // namespace dk::util
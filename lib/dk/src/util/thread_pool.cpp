@@ -0,0 +1,55 @@
+#include <dklib/util/thread_pool.hpp>
+
+namespace dk::util {
+namespace {
+    /// Pool of the worker running on this thread, if any
+    thread_local const ThreadPool *current_pool = nullptr;
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t thread_count) {
+    thread_count = std::max<std::size_t>(thread_count, 1);
+    workers_.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        workers_.emplace_back([this](std::stop_token stop_token) { worker_loop(stop_token); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    for (auto &worker : workers_) {
+        worker.request_stop();
+    }
+    condition_.notify_all();
+    // Workers are joined by the jthread destructors
+}
+
+ThreadPool &ThreadPool::get_instance() {
+    static ThreadPool instance;
+    return instance;
+}
+
+bool ThreadPool::is_worker() const noexcept { return current_pool == this; }
+
+void ThreadPool::enqueue(std::function<void()> &&task) {
+    {
+        const std::lock_guard lock { mutex_ };
+        tasks_.push(std::move(task));
+    }
+    condition_.notify_one();
+}
+
+void ThreadPool::worker_loop(std::stop_token stop_token) {
+    current_pool = this;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock { mutex_ };
+            if (not condition_.wait(lock, stop_token, [this]() { return not tasks_.empty(); })) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+} // namespace dk::util
@@ -0,0 +1,87 @@
+#include <doctest/doctest.h>
+#include <dklib/file/async_reader.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+std::vector<std::filesystem::path> make_files(std::size_t count) {
+    std::vector<std::filesystem::path> paths;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto path = std::filesystem::temp_directory_path() / ("dk_test_async_reader_" + std::to_string(i) + ".txt");
+        std::ofstream(path) << std::string(i * 1000, static_cast<char>('a' + i % 26));
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
+
+bool has_contents(std::span<const std::byte> bytes, std::size_t i) {
+    return bytes.size() == i * 1000
+        and std::ranges::all_of(bytes, [i](std::byte b) { return std::to_integer<std::size_t>(b) == 'a' + i % 26; });
+}
+} // namespace
+
+TEST_SUITE("[FILE] Asynchronous reader") {
+    TEST_CASE("files should be read by every backend") {
+        const auto paths = make_files(40);
+        for (const auto backend : { file::AsyncReader::Backend::IO_URING, file::AsyncReader::Backend::THREAD_POOL }) {
+            // queue is shallower than the count of files, so the reads wait
+            // for each other
+            file::AsyncReader reader(8, backend);
+            std::mutex mutex;
+            std::vector<file::ReadResult> results;
+            reader.read_all(paths, [&](file::ReadResult &&result) {
+                const std::lock_guard lock(mutex);
+                results.push_back(std::move(result));
+            });
+            reader.wait();
+
+            REQUIRE(results.size() == paths.size());
+            for (const auto &result : results) {
+                CHECK_FALSE(result.error);
+                const auto i = static_cast<std::size_t>(std::ranges::find(paths, result.path) - paths.begin());
+                CHECK(has_contents(result.bytes, i));
+            }
+        }
+        for (const auto &path : paths) {
+            std::filesystem::remove(path);
+        }
+    }
+
+    TEST_CASE("throwing callbacks should not stop the reader") {
+        const auto paths = make_files(4);
+        for (const auto backend : { file::AsyncReader::Backend::IO_URING, file::AsyncReader::Backend::THREAD_POOL }) {
+            std::atomic<std::size_t> calls { 0 };
+            {
+                file::AsyncReader reader(2, backend);
+                reader.read_all(paths, [&](file::ReadResult &&) {
+                    ++calls;
+                    throw 42;
+                });
+            }
+            CHECK(calls == paths.size());
+        }
+        for (const auto &path : paths) {
+            std::filesystem::remove(path);
+        }
+    }
+
+    TEST_CASE("futures should hold the contents or the error") {
+        const auto paths = make_files(3);
+        file::AsyncReader reader;
+        auto contents = reader.read(paths[2]);
+        auto missing = reader.read("/nonexistent/dk_test_async_reader");
+        CHECK(has_contents(contents.get(), 2));
+        CHECK_THROWS_AS(missing.get(), std::system_error);
+        for (const auto &path : paths) {
+            std::filesystem::remove(path);
+        }
+    }
+}
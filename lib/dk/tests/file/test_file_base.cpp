@@ -0,0 +1,72 @@
+#include <doctest/doctest.h>
+#include <dklib/file/file_base.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <sys/stat.h>
+
+using namespace dk;
+
+TEST_SUITE("[FILE] Mapped file") {
+    TEST_CASE("regular file should be mapped") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mapped_file.txt";
+        const std::string contents(10000, 'x');
+        std::ofstream(path) << contents;
+
+        file::MappedFile file(path, { file::AccessPattern::SEQUENTIAL, true });
+        CHECK(file.is_mapped());
+        CHECK(file.size() == contents.size());
+        CHECK(file.text() == contents);
+        // hints are allowed anywhere, even past the end
+        file.advise(file::AccessPattern::RANDOM, 5000, 100);
+        file.advise(file::AccessPattern::NORMAL, 20000);
+
+        const file::MappedFile moved(std::move(file));
+        CHECK(moved.text() == contents);
+        CHECK(file.size() == 0);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("empty file should give an empty span") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mapped_file_empty.txt";
+        std::ofstream { path };
+        const file::MappedFile file(path);
+        CHECK(file.bytes().empty());
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("pseudo file without a size should be read into a buffer") {
+        const std::filesystem::path path = "/proc/self/status";
+        if (not std::filesystem::exists(path)) {
+            MESSAGE("no procfs, skipped");
+            return;
+        }
+        const file::MappedFile file(path);
+        CHECK_FALSE(file.is_mapped());
+        CHECK(file.text().starts_with("Name:"));
+    }
+
+    TEST_CASE("pipe should be read into a buffer") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mapped_file.fifo";
+        std::filesystem::remove(path);
+        REQUIRE(::mkfifo(path.c_str(), 0600) == 0);
+        const std::string contents(200000, 'p');
+        std::jthread writer([&] { std::ofstream(path) << contents; });
+
+        file::MappedFile file(path);
+        writer.join();
+        CHECK_FALSE(file.is_mapped());
+        CHECK(file.text() == contents);
+
+        file::MappedFile other = std::move(file);
+        CHECK(other.text() == contents);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("missing file should be reported") {
+        CHECK_THROWS_AS(file::MappedFile { "/nonexistent/dk_test_mapped_file" }, std::runtime_error);
+    }
+}
@@ -0,0 +1,81 @@
+#include <doctest/doctest.h>
+#include <dklib/file/file_watcher.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace dk;
+
+TEST_SUITE("[FILE] File watcher") {
+    const auto directory = std::filesystem::temp_directory_path() / "dk_test_file_watcher";
+
+    TEST_CASE("written files should be reported once per poll") {
+        std::filesystem::create_directories(directory);
+        const auto watched = directory / "watched.glsl";
+        const auto other = directory / "other.glsl";
+        std::ofstream(watched) << "original";
+
+        file::FileWatcher watcher;
+        std::vector<std::filesystem::path> changes;
+        watcher.watch(watched, [&](const file::FileChange &change) { changes.push_back(change.path); });
+        CHECK(watcher.poll() == 0);
+
+        std::ofstream(watched) << "first";
+        std::ofstream(watched) << "second";
+        std::ofstream(other) << "not watched";
+        CHECK(watcher.poll() == 1);
+        REQUIRE(changes.size() == 1);
+        CHECK(changes[0] == std::filesystem::absolute(watched));
+        CHECK(watcher.poll() == 0);
+    }
+
+    TEST_CASE("files replaced by a rename should be reported") {
+        std::filesystem::create_directories(directory);
+        const auto watched = directory / "renamed.glsl";
+        std::ofstream(watched) << "original";
+
+        file::FileWatcher watcher;
+        std::size_t change_count = 0;
+        const auto id = watcher.watch(watched, [&](const file::FileChange &) { ++change_count; });
+
+        // the way most editors save
+        const auto temporary = directory / "renamed.glsl.tmp";
+        std::ofstream(temporary) << "saved";
+        std::filesystem::rename(temporary, watched);
+        watcher.poll();
+        CHECK(change_count == 1);
+
+        watcher.unwatch(id);
+        CHECK(watcher.size() == 0);
+        std::ofstream(watched) << "unwatched";
+        watcher.poll();
+        CHECK(change_count == 1);
+    }
+
+    TEST_CASE("overflowed queue should report every watched file") {
+        std::size_t max_queued_events = 0;
+        std::ifstream("/proc/sys/fs/inotify/max_queued_events") >> max_queued_events;
+        if (max_queued_events == 0 or max_queued_events > 100000) {
+            MESSAGE("inotify queue size unknown or too large, skipped");
+            return;
+        }
+        const auto burst = directory / "burst";
+        std::filesystem::remove_all(burst);
+        std::filesystem::create_directories(burst);
+        const auto watched = burst / "untouched.glsl";
+        std::ofstream(watched) << "original";
+
+        file::FileWatcher watcher;
+        std::size_t change_count = 0;
+        watcher.watch(watched, [&](const file::FileChange &) { ++change_count; });
+        // more writes than the queue holds, none of them of the watched file
+        for (std::size_t i = 0; i <= max_queued_events; ++i) {
+            std::ofstream(burst / std::to_string(i)) << i;
+        }
+        CHECK(watcher.poll() == 1);
+        CHECK(change_count == 1);
+        std::filesystem::remove_all(burst);
+    }
+}
@@ -0,0 +1,77 @@
+#include <doctest/doctest.h>
+#include <dklib/file/index_codec.hpp>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+/// Triangles of a grid of quads, row after row, as meshes usually come.
+std::vector<gl::u32> make_grid_indices(gl::u32 width, gl::u32 height) {
+    std::vector<gl::u32> indices;
+    for (gl::u32 y = 0; y + 1 < height; ++y) {
+        for (gl::u32 x = 0; x + 1 < width; ++x) {
+            const gl::u32 corner = y * width + x;
+            indices.insert(indices.end(), { corner, corner + 1, corner + width, corner + 1, corner + width + 1, corner + width });
+        }
+    }
+    return indices;
+}
+
+std::vector<gl::u32> round_trip(const std::vector<gl::u32> &indices) {
+    const auto encoded = file::index_codec::encode(std::span<const gl::u32> { indices });
+    std::vector<gl::u32> decoded(indices.size());
+    file::index_codec::decode(encoded, decoded);
+    return decoded;
+}
+} // namespace
+
+TEST_SUITE("[INDEX CODEC] Compressed indices") {
+    TEST_CASE("indices should survive the round trip") {
+        CHECK(round_trip({}).empty());
+        CHECK(round_trip({ 7 }) == std::vector<gl::u32> { 7 });
+
+        // every count modulo 4 and around the 16 byte loads of the decoder
+        std::mt19937 generator(3);
+        for (std::size_t count = 0; count < 70; ++count) {
+            std::vector<gl::u32> indices(count);
+            for (auto &index : indices) {
+                index = generator() >> (generator() % 32);
+            }
+            REQUIRE(round_trip(indices) == indices);
+        }
+    }
+
+    TEST_CASE("extreme differences should wrap around") {
+        constexpr auto max = std::numeric_limits<gl::u32>::max();
+        const std::vector<gl::u32> indices { 0, max, 0, max, 1U << 31, 0, (1U << 31) - 1, 1U << 31, 5, 5, 5, 0 };
+        CHECK(round_trip(indices) == indices);
+    }
+
+    TEST_CASE("meshes with vertex locality should take few bytes per index") {
+        const auto indices = make_grid_indices(300, 300);
+        const auto encoded = file::index_codec::encode(std::span<const gl::u32> { indices });
+        CHECK(encoded.size() <= file::index_codec::max_encoded_size(indices.size()));
+        const double bytes_per_index = static_cast<double>(encoded.size()) / static_cast<double>(indices.size());
+        CHECK(bytes_per_index < 2.0);
+        CHECK(round_trip(indices) == indices);
+    }
+
+    TEST_CASE("narrower index types should be decoded") {
+        const std::vector<gl::u16> indices { 0, 1, 2, 2, 1, 65535 };
+        const auto encoded = file::index_codec::encode(std::span<const gl::u16> { indices });
+        CHECK(file::index_codec::decode<gl::u16>(encoded, indices.size()) == indices);
+    }
+
+    TEST_CASE("truncated blobs should be rejected") {
+        const auto indices = make_grid_indices(10, 10);
+        auto encoded = file::index_codec::encode(std::span<const gl::u32> { indices });
+        encoded.pop_back();
+        std::vector<gl::u32> decoded(indices.size());
+        CHECK_THROWS_AS(file::index_codec::decode(encoded, decoded), std::runtime_error);
+        CHECK_THROWS_AS(file::index_codec::decode({}, decoded), std::runtime_error);
+    }
+}
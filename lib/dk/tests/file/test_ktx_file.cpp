@@ -0,0 +1,141 @@
+#include <doctest/doctest.h>
+#include <dklib/file/ktx_file.hpp>
+
+#include <GL/gl.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+/// Builds an uncompressed GL_UNSIGNED_BYTE texture, every byte of a level
+/// (and face) holds the value of `level * 16 + face`.
+std::vector<std::byte> make_ktx(
+    gl::u32 format, gl::u32 channels, gl::u32 width, gl::u32 height, gl::u32 levels, gl::u32 faces,
+    gl::u32 endianness = file::ktx::KTX_LITTLE_ENDIAN, gl::u32 keypairbytes = 0
+) {
+    const bool is_swapped = endianness != file::ktx::KTX_LITTLE_ENDIAN;
+    const auto put = [&](std::vector<std::byte> &out, gl::u32 value) {
+        value = is_swapped ? std::byteswap(value) : value;
+        const auto *ptr = reinterpret_cast<const std::byte *>(&value);
+        out.insert(out.end(), ptr, ptr + sizeof(value));
+    };
+
+    std::vector<std::byte> out;
+    for (const auto c : file::ktx::IDENTIFIER) {
+        out.push_back(static_cast<std::byte>(c));
+    }
+    out.resize(out.size() + sizeof(gl::u32));
+    std::memcpy(out.data() + file::ktx::IDENTIFIER.size(), &endianness, sizeof(endianness));
+    for (const gl::u32 value : { gl::u32 { GL_UNSIGNED_BYTE }, 1u, format, format, format, width, height, 0u, 0u,
+                                 faces, levels, keypairbytes }) {
+        put(out, value);
+    }
+    out.resize(out.size() + keypairbytes, std::byte { 0x7f });
+
+    for (gl::u32 level = 0; level < levels; ++level) {
+        const gl::u32 w = std::max(1u, width >> level);
+        const gl::u32 h = std::max(1u, height >> level);
+        const gl::u32 stride = (w * channels + 3) & ~3u;
+        const gl::u32 size = stride * h;
+        put(out, size);
+        for (gl::u32 face = 0; face < faces; ++face) {
+            out.resize(out.size() + size, static_cast<std::byte>(level * 16 + face));
+            out.resize((out.size() + 3) & ~std::size_t { 3 });
+        }
+    }
+    return out;
+}
+
+bool is_filled_with(std::span<const std::byte> image, int value) {
+    return std::ranges::all_of(image, [value](std::byte b) { return std::to_integer<int>(b) == value; });
+}
+} // namespace
+
+TEST_SUITE("[KTX] Texture layout") {
+    TEST_CASE("mip levels of a 2D texture should be located") {
+        const auto bytes = make_ktx(GL_RGBA, 4, 8, 4, 4, 1, file::ktx::KTX_LITTLE_ENDIAN, 12);
+        const auto layout = file::ktx::parse_layout(bytes);
+        CHECK(layout.texture_type() == gl::TextureType::TEX_2D);
+        REQUIRE(layout.level_count() == 4);
+        CHECK(layout.face_count() == 1);
+
+        CHECK(layout.image(0).offset == sizeof(file::ktx::Header) + 12 + sizeof(gl::u32));
+        CHECK(layout.image(0).size == 8 * 4 * 4);
+        CHECK(layout.image(2).width == 2);
+        CHECK(layout.image(2).height == 1);
+        CHECK(layout.image(3).width == 1);
+        CHECK(layout.image(3).size == 4);
+        for (gl::u32 level = 0; level < 4; ++level) {
+            const auto &range = layout.image(level);
+            CHECK(is_filled_with(std::span { bytes }.subspan(range.offset, range.size), static_cast<int>(level * 16)));
+        }
+    }
+
+    TEST_CASE("rows and faces of a cube map should be padded") {
+        // RGB rows of width 3 take 9 bytes and are padded to 12
+        const auto bytes = make_ktx(GL_RGB, 3, 3, 3, 2, 6);
+        const auto layout = file::ktx::parse_layout(bytes);
+        CHECK(layout.texture_type() == gl::TextureType::CUBE_MAP);
+        REQUIRE(layout.face_count() == 6);
+        CHECK(layout.image(0, 0).size == 12 * 3);
+        CHECK(layout.image(0, 1).offset == layout.image(0, 0).offset + 12 * 3);
+        CHECK(layout.image(1, 0).size == 4);
+        for (gl::u32 face = 0; face < 6; ++face) {
+            const auto &range = layout.image(1, face);
+            CHECK(is_filled_with(std::span { bytes }.subspan(range.offset, range.size), static_cast<int>(16 + face)));
+        }
+        CHECK_THROWS_AS(layout.image(2, 0), std::out_of_range);
+    }
+
+    TEST_CASE("big endian header should be swapped") {
+        const auto bytes = make_ktx(GL_RED, 1, 4, 4, 3, 1, file::ktx::KTX_BIG_ENDIAN);
+        const auto layout = file::ktx::parse_layout(bytes);
+        CHECK(layout.header.pixel_width == 4);
+        CHECK(layout.header.glformat == GL_RED);
+        CHECK(layout.image(1).size == 4 * 2);
+    }
+
+    TEST_CASE("mapped texture should expose the images in place") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_ktx_file.ktx";
+        const auto bytes = make_ktx(GL_RGBA, 4, 16, 16, 5, 1);
+        {
+            std::ofstream out(path, std::ios::binary);
+            out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+        const file::ktx::MappedTexture texture(path);
+        CHECK(texture.get_level_count() == 5);
+        CHECK(texture.get_header().pixel_height == 16);
+        const auto level = texture.get_image(1);
+        CHECK(level.size() == 8 * 8 * 4);
+        CHECK(is_filled_with(level, 16));
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("invalid files should be rejected") {
+        auto bytes = make_ktx(GL_RGBA, 4, 8, 8, 4, 1);
+        auto truncated = bytes;
+        truncated.resize(truncated.size() - 8);
+        CHECK_THROWS_AS(file::ktx::parse_layout(truncated), std::runtime_error);
+
+        auto wrong_identifier = bytes;
+        wrong_identifier[1] = std::byte { 'X' };
+        CHECK_THROWS_AS(file::ktx::parse_layout(wrong_identifier), std::runtime_error);
+
+        auto wrong_endianness = bytes;
+        wrong_endianness[12] = std::byte { 0 };
+        CHECK_THROWS_AS(file::ktx::parse_layout(wrong_endianness), std::runtime_error);
+
+        const auto too_many_levels = make_ktx(GL_RGBA, 4, 4, 4, 3, 1);
+        auto patched = too_many_levels;
+        const gl::u32 levels = 9;
+        std::memcpy(patched.data() + offsetof(file::ktx::Header, miplevels), &levels, sizeof(levels));
+        CHECK_THROWS_AS(file::ktx::parse_layout(patched), std::runtime_error);
+    }
+}
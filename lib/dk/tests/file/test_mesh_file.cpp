@@ -0,0 +1,150 @@
+#include <doctest/doctest.h>
+#include <dklib/file/mesh_file.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace dk;
+
+namespace {
+/// Rewrites the header of the file with the changes of the function.
+template <typename Function>
+void patch_header(const std::filesystem::path &path, Function &&function) {
+    file::dkmesh::Header header {};
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    function(header);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+gl::MeshData<gl::experimental::Vertex, gl::u16> make_triangle() {
+    gl::MeshData<gl::experimental::Vertex, gl::u16> mesh;
+    mesh.vertices = {
+        { { -1.0f, 0.0f, 0.5f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f },
+        { { 1.0f, -2.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 1.0f, 0.0f },
+        { { 0.0f, 3.0f, -0.5f }, { 0.0f, 0.0f, 1.0f }, 0.5f, 1.0f },
+    };
+    mesh.indices = { 0, 1, 2 };
+    return mesh;
+}
+} // namespace
+
+TEST_SUITE("[DKMESH] Binary mesh cache") {
+    TEST_CASE("written mesh should be readable through the mapping") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mesh_file.dkmesh";
+        const auto mesh = make_triangle();
+        file::dkmesh::write(path, mesh);
+
+        const file::dkmesh::MappedMesh mapped(path);
+        const auto &header = mapped.get_header();
+        CHECK(header.version == file::dkmesh::VERSION);
+        CHECK(header.vertex_count == 3);
+        CHECK(header.index_count == 3);
+        CHECK(header.index_type == GL_UNSIGNED_SHORT);
+        CHECK(header.vertex_offset % file::dkmesh::BLOB_ALIGNMENT == 0);
+        CHECK(header.index_offset % file::dkmesh::BLOB_ALIGNMENT == 0);
+
+        CHECK(mapped.holds<gl::experimental::Vertex, gl::u16>());
+        CHECK_FALSE(mapped.holds<gl::experimental::Vertex, gl::u32>());
+        CHECK_FALSE(mapped.holds<gl::experimental::TexturingVertex, gl::u16>());
+
+        const auto vertices = mapped.get_vertices_as<gl::experimental::Vertex>();
+        REQUIRE(vertices.size() == 3);
+        CHECK(std::memcmp(vertices.data(), mesh.vertices.data(), vertices.size_bytes()) == 0);
+        // indices are not compressed unless asked for, so they can be mapped
+        CHECK(mapped.get_index_encoding() == file::dkmesh::IndexEncoding::RAW);
+        const auto indices = mapped.read_indices<gl::u16>();
+        REQUIRE(indices.size() == 3);
+        CHECK(indices == mesh.indices);
+
+        const auto bounds = mapped.get_bounds();
+        CHECK(bounds.min == math::Vector3D(-1.0f, -2.0f, -0.5f));
+        CHECK(bounds.max == math::Vector3D(1.0f, 3.0f, 0.5f));
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("raw indices should be mapped as they are") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mesh_file_raw.dkmesh";
+        const auto mesh = make_triangle();
+        file::dkmesh::write(path, mesh, file::dkmesh::IndexEncoding::RAW);
+
+        const file::dkmesh::MappedMesh mapped(path);
+        CHECK(mapped.get_index_encoding() == file::dkmesh::IndexEncoding::RAW);
+        CHECK(mapped.get_header().index_bytes == 3 * sizeof(gl::u16));
+        const auto indices = mapped.get_indices_as<gl::u16>();
+        REQUIRE(indices.size() == 3);
+        CHECK(indices[2] == 2);
+        CHECK(mapped.read_indices<gl::u16>() == mesh.indices);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("compressed indices should be decoded") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mesh_file_compressed.dkmesh";
+        const auto mesh = make_triangle();
+        file::dkmesh::write(path, mesh, file::dkmesh::IndexEncoding::DELTA_VARINT);
+
+        const file::dkmesh::MappedMesh mapped(path);
+        CHECK(mapped.get_index_encoding() == file::dkmesh::IndexEncoding::DELTA_VARINT);
+        // one control byte and a byte per index
+        CHECK(mapped.get_indices().size() == 4);
+        CHECK(mapped.read_indices<gl::u16>() == mesh.indices);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("files with a wrong identifier should be rejected") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mesh_file_invalid.dkmesh";
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << std::string(sizeof(file::dkmesh::Header) + 64, 'x');
+        }
+        CHECK_THROWS_AS(file::dkmesh::MappedMesh { path }, std::runtime_error);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("sizes wrapping around should be rejected") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mesh_file_overflow.dkmesh";
+        file::dkmesh::write(path, make_triangle(), file::dkmesh::IndexEncoding::RAW);
+        REQUIRE_NOTHROW(file::dkmesh::MappedMesh { path });
+
+        // 2^59 + 3 vertices of 32 bytes wrap to the size of 3 vertices
+        patch_header(path, [](file::dkmesh::Header &header) { header.vertex_count += gl::u64 { 1 } << 59; });
+        CHECK_THROWS_AS(file::dkmesh::MappedMesh { path }, std::runtime_error);
+        patch_header(path, [](file::dkmesh::Header &header) { header.vertex_count -= gl::u64 { 1 } << 59; });
+        REQUIRE_NOTHROW(file::dkmesh::MappedMesh { path });
+
+        // 2^63 + 3 indices of 2 bytes wrap to the size of 3 indices
+        patch_header(path, [](file::dkmesh::Header &header) { header.index_count += gl::u64 { 1 } << 63; });
+        CHECK_THROWS_AS(file::dkmesh::MappedMesh { path }, std::runtime_error);
+        patch_header(path, [](file::dkmesh::Header &header) { header.index_count -= gl::u64 { 1 } << 63; });
+
+        patch_header(path, [](file::dkmesh::Header &header) { header.index_offset = ~gl::u64 { 0 } - 63; });
+        CHECK_THROWS_AS(file::dkmesh::MappedMesh { path }, std::runtime_error);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("compressed blob too short for its count should be rejected before decoding") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mesh_file_short.dkmesh";
+        file::dkmesh::write(path, make_triangle(), file::dkmesh::IndexEncoding::DELTA_VARINT);
+        // 2^40 indices would allocate 4 TiB before the decoder throws
+        patch_header(path, [](file::dkmesh::Header &header) { header.index_count = gl::u64 { 1 } << 40; });
+        CHECK_THROWS_AS(file::dkmesh::MappedMesh { path }, std::runtime_error);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("indices past the vertices should be rejected") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mesh_file_index_range.dkmesh";
+        const auto drop_vertex = [](file::dkmesh::Header &header) { header.vertex_count = 2; };
+
+        file::dkmesh::write(path, make_triangle(), file::dkmesh::IndexEncoding::RAW);
+        patch_header(path, drop_vertex);
+        CHECK_THROWS_AS(file::dkmesh::MappedMesh { path }, std::runtime_error);
+
+        file::dkmesh::write(path, make_triangle(), file::dkmesh::IndexEncoding::DELTA_VARINT);
+        patch_header(path, drop_vertex);
+        const file::dkmesh::MappedMesh mapped(path);
+        CHECK_THROWS_AS(static_cast<void>(mapped.read_indices<gl::u16>()), std::runtime_error);
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,139 @@
+#include <doctest/doctest.h>
+#include <dklib/file/obj_file.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+using namespace dk;
+using namespace dk::file::obj::experimental;
+
+namespace {
+constexpr std::string_view cube_side = R"(# two triangles
+o Side
+v -1.0 -1.0 0.0
+v 1.0 -1.0 0.0
+v 1.0 1.0 0.0
+v -1.0 1.0 0.0
+vn 0.0 0.0 1.0
+vt 0.0 0.0
+vt 1.0 0.0
+vt 1.0 1.0
+vt 0.0 1.0
+s 0
+f 1/1/1 2/2/1 3/3/1
+f 1/1/1 3/3/1 4/4/1
+)";
+} // namespace
+
+TEST_SUITE("[OBJ] Memory mapped OBJ parsing") {
+    TEST_CASE("it should parse all record types") {
+        const auto data = parse(cube_side);
+        CHECK(data.positions.size() == 4);
+        CHECK(data.normals.size() == 1);
+        CHECK(data.textures.size() == 4);
+        REQUIRE(data.corners.size() == 6);
+        CHECK(data.positions[2].x == 1.0f);
+        CHECK(data.positions[2].y == 1.0f);
+        CHECK(data.textures[3].v == 1.0f);
+        CHECK(data.corners[5].position == 3);
+        CHECK(data.corners[5].texture == 3);
+        CHECK(data.corners[5].normal == 0);
+    }
+
+    TEST_CASE("it should triangulate polygons as a fan") {
+        const auto data = parse("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n");
+        REQUIRE(data.corners.size() == 6);
+        CHECK(data.corners[3].position == 0);
+        CHECK(data.corners[4].position == 2);
+        CHECK(data.corners[5].position == 3);
+        CHECK(data.corners[0].texture == MISSING_INDEX);
+        CHECK(data.corners[0].normal == MISSING_INDEX);
+    }
+
+    TEST_CASE("it should resolve relative indices and omitted components") {
+        const auto data = parse("v 0 0 0\r\nv 1 0 0\r\nv 1 1 0\r\nvn 0 0 1\r\nf -3//-1 -2//-1 -1//-1\r\n");
+        REQUIRE(data.corners.size() == 3);
+        CHECK(data.corners[0].position == 0);
+        CHECK(data.corners[2].position == 2);
+        CHECK(data.corners[1].texture == MISSING_INDEX);
+        CHECK(data.corners[1].normal == 0);
+    }
+
+    TEST_CASE("it should reject malformed records") {
+        CHECK_THROWS_AS(parse("v 1.0 oops 2.0\n"), std::runtime_error);
+        CHECK_THROWS_AS(parse("v 0 0 0\nf 1 1\n"), std::runtime_error);
+        CHECK_THROWS_AS(parse("f -1 -1 -1\n"), std::runtime_error);
+    }
+
+    TEST_CASE("it should reject indices past the records read so far") {
+        const std::string triangle = "v 0 0 0\nv 1 0 0\nv 1 1 0\n";
+        CHECK_THROWS_AS(parse(triangle + "f 1 2 4\n"), std::runtime_error);
+        // 2^32 + 1 would wrap around to the first position
+        CHECK_THROWS_AS(parse(triangle + "f 4294967297 2 3\n"), std::runtime_error);
+        CHECK_THROWS_AS(parse(triangle + "f 1/4294967296 2 3\n"), std::runtime_error);
+
+        // the index points past the records of its own chunk only
+        std::string text;
+        for (int i = 0; i < 64; ++i) {
+            text += triangle;
+        }
+        dk::util::ThreadPool pool(4);
+        CHECK(parse(text + "f 1 2 192\n", pool, 64).corners.back().position == 191);
+        CHECK_THROWS_AS(parse(text + "f 1 2 193\n", pool, 64), std::runtime_error);
+    }
+
+    TEST_CASE("it should deduplicate shared corners") {
+        const auto mesh = assemble<gl::experimental::Vertex>(parse(cube_side));
+        CHECK(mesh.vertices.size() == 4);
+        REQUIRE(mesh.indices.size() == 6);
+        CHECK(mesh.indices[3] == mesh.indices[0]);
+        CHECK(mesh.indices[4] == mesh.indices[2]);
+        CHECK(mesh.vertices[2].u == 1.0f);
+        CHECK(mesh.vertices[2].normal.z == 1.0f);
+    }
+
+    TEST_CASE("it should produce the same mesh as the stream reader") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_obj_file.obj";
+        {
+            std::ofstream out(path);
+            out << cube_side;
+        }
+        const auto streamed = read_data<gl::experimental::Vertex>(path, ReadMode::STREAM);
+        const auto mapped = read_data<gl::experimental::Vertex>(path, ReadMode::MAPPED);
+        std::filesystem::remove(path);
+
+        CHECK(streamed.indices == mapped.indices);
+        REQUIRE(streamed.vertices.size() == mapped.vertices.size());
+        for (std::size_t i = 0; i < mapped.vertices.size(); ++i) {
+            CHECK(streamed.vertices[i].position == mapped.vertices[i].position);
+            CHECK(streamed.vertices[i].normal == mapped.vertices[i].normal);
+            CHECK(streamed.vertices[i].u == mapped.vertices[i].u);
+            CHECK(streamed.vertices[i].v == mapped.vertices[i].v);
+        }
+    }
+
+    TEST_CASE("parallel parsing should be identical to the serial one") {
+        std::string text;
+        for (int i = 0; i < 64; ++i) {
+            text += cube_side;
+            // Relative indices referencing records of the previous chunks
+            text += "f -4/-4/-1 -3/-3/-1 -2/-2/-1 -1/-1/-1\n";
+        }
+        dk::util::ThreadPool pool(4);
+        const auto serial = parse(text);
+        const auto parallel = parse(text, pool, 64);
+
+        REQUIRE(serial.positions.size() == parallel.positions.size());
+        REQUIRE(serial.textures.size() == parallel.textures.size());
+        REQUIRE(serial.normals.size() == parallel.normals.size());
+        REQUIRE(serial.corners.size() == parallel.corners.size());
+        CHECK(std::memcmp(serial.positions.data(), parallel.positions.data(), serial.positions.size() * sizeof(math::Vector3D)) == 0);
+        CHECK(std::memcmp(serial.textures.data(), parallel.textures.data(), serial.textures.size() * sizeof(TextureCoordinates)) == 0);
+        CHECK(std::memcmp(serial.normals.data(), parallel.normals.data(), serial.normals.size() * sizeof(math::Vector3D)) == 0);
+        CHECK(std::memcmp(serial.corners.data(), parallel.corners.data(), serial.corners.size() * sizeof(FaceCorner)) == 0);
+        CHECK(parallel.corners.back().position == parallel.positions.size() - 1);
+    }
+}
@@ -0,0 +1,211 @@
+#include <doctest/doctest.h>
+#include <dklib/file/ply_file.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+class PlyBuilder {
+public:
+    explicit PlyBuilder(std::string_view header) {
+        for (const char c : header) {
+            bytes_.push_back(static_cast<std::byte>(c));
+        }
+    }
+
+    template <typename T>
+    PlyBuilder &put(T value) {
+        const auto *ptr = reinterpret_cast<const std::byte *>(&value);
+        bytes_.insert(bytes_.end(), ptr, ptr + sizeof(T));
+        return *this;
+    }
+
+    [[nodiscard]] std::span<const std::byte> bytes() const { return bytes_; }
+
+private:
+    std::vector<std::byte> bytes_;
+};
+
+constexpr std::string_view TEXTURED_QUAD_HEADER = "ply\n"
+                                                  "format binary_little_endian 1.0\n"
+                                                  "comment textured quad\n"
+                                                  "element vertex 4\n"
+                                                  "property float x\n"
+                                                  "property float y\n"
+                                                  "property float z\n"
+                                                  "property float s\n"
+                                                  "property float t\n"
+                                                  "element face 1\n"
+                                                  "property list uchar uint vertex_indices\n"
+                                                  "end_header\n";
+
+PlyBuilder make_textured_quad() {
+    PlyBuilder builder(TEXTURED_QUAD_HEADER);
+    for (int i = 0; i < 4; ++i) {
+        builder.put(static_cast<float>(i)).put(1.0f).put(2.0f).put(0.25f * i).put(0.5f);
+    }
+    builder.put(gl::u8 { 4 }).put(0u).put(1u).put(2u).put(3u);
+    return builder;
+}
+} // namespace
+
+TEST_SUITE("[PLY] Binary PLY reader") {
+    TEST_CASE("header should describe elements and properties") {
+        const auto builder = make_textured_quad();
+        const auto header = file::ply::parse_header(builder.bytes());
+        CHECK(header.format == file::ply::Format::BINARY_LITTLE_ENDIAN);
+        REQUIRE(header.elements.size() == 2);
+        CHECK(header.elements[0].name == "vertex");
+        CHECK(header.elements[0].stride() == 20);
+        CHECK(header.elements[1].properties[0].is_list);
+        CHECK(header.elements[1].stride() == 0);
+        CHECK(header.body_offset == TEXTURED_QUAD_HEADER.size());
+        CHECK(file::ply::count_of(header, "face") == 1);
+    }
+
+    TEST_CASE("matching layout should be copied and quads triangulated") {
+        const auto builder = make_textured_quad();
+        const auto mesh = file::ply::read_data<gl::experimental::TexturingVertex>(builder.bytes());
+        REQUIRE(mesh.vertices.size() == 4);
+        CHECK(mesh.vertices[3].position.x == 3.0f);
+        CHECK(mesh.vertices[3].position.z == 2.0f);
+        CHECK(mesh.vertices[2].u == 0.5f);
+        CHECK(mesh.vertices[2].v == 0.5f);
+        CHECK(mesh.indices == std::vector<gl::u32> { 0, 1, 2, 0, 2, 3 });
+    }
+
+    TEST_CASE("other property types should be converted to floats") {
+        PlyBuilder builder("ply\n"
+                           "format binary_big_endian 1.0\n"
+                           "element vertex 3\n"
+                           "property double x\n"
+                           "property double y\n"
+                           "property double z\n"
+                           "property short nx\n"
+                           "property short ny\n"
+                           "property short nz\n"
+                           "element material 1\n"
+                           "property uchar red\n"
+                           "element face 1\n"
+                           "property uchar flags\n"
+                           "property list uchar ushort vertex_index\n"
+                           "end_header\n");
+        const auto big = [](auto value) {
+            auto bits = std::bit_cast<std::array<std::byte, sizeof(value)>>(value);
+            std::reverse(bits.begin(), bits.end());
+            return std::bit_cast<decltype(value)>(bits);
+        };
+        for (int i = 0; i < 3; ++i) {
+            builder.put(big(double(i))).put(big(-1.5)).put(big(0.0));
+            builder.put(big(gl::i16 { 0 })).put(big(gl::i16 { 1 })).put(big(gl::i16 { 0 }));
+        }
+        builder.put(gl::u8 { 7 });
+        builder.put(gl::u8 { 0 }).put(gl::u8 { 3 }).put(big(gl::u16 { 2 })).put(big(gl::u16 { 1 })).put(big(gl::u16 { 0 }));
+
+        const auto mesh = file::ply::read_data<gl::experimental::Vertex, gl::u16>(builder.bytes());
+        REQUIRE(mesh.vertices.size() == 3);
+        CHECK(mesh.vertices[2].position.x == 2.0f);
+        CHECK(mesh.vertices[1].position.y == -1.5f);
+        CHECK(mesh.vertices[0].normal.y == 1.0f);
+        CHECK(mesh.indices == std::vector<gl::u16> { 2, 1, 0 });
+    }
+
+    TEST_CASE("invalid files should be rejected") {
+        const PlyBuilder ascii("ply\nformat ascii 1.0\nelement vertex 0\nend_header\n");
+        CHECK_THROWS_AS(file::ply::read_data(ascii.bytes()), std::runtime_error);
+
+        const PlyBuilder no_magic("obj\nformat binary_little_endian 1.0\nend_header\n");
+        CHECK_THROWS_AS(file::ply::parse_header(no_magic.bytes()), std::runtime_error);
+
+        PlyBuilder truncated(TEXTURED_QUAD_HEADER);
+        truncated.put(1.0f);
+        CHECK_THROWS_AS(file::ply::read_data<gl::experimental::TexturingVertex>(truncated.bytes()), std::runtime_error);
+
+        PlyBuilder bad_index(TEXTURED_QUAD_HEADER);
+        for (int i = 0; i < 20; ++i) {
+            bad_index.put(0.0f);
+        }
+        bad_index.put(gl::u8 { 3 }).put(0u).put(1u).put(9u);
+        CHECK_THROWS_AS(file::ply::read_data<gl::experimental::TexturingVertex>(bad_index.bytes()), std::runtime_error);
+
+        // 2^62 corners of 4 bytes would wrap around to no bytes at all
+        const auto make_forged_face = [](std::string_view count_type) {
+            const std::string header = "ply\n"
+                                       "format binary_little_endian 1.0\n"
+                                       "element vertex 3\n"
+                                       "property float x\n"
+                                       "property float y\n"
+                                       "property float z\n"
+                                       "element face 1\n"
+                                       "property list "
+                                     + std::string(count_type) + " uint vertex_indices\nend_header\n";
+            PlyBuilder builder(header);
+            for (int i = 0; i < 9; ++i) {
+                builder.put(0.0f);
+            }
+            builder.put(4.611686e18f);
+            return builder;
+        };
+        const auto float_count = make_forged_face("float");
+        CHECK_THROWS_AS(file::ply::read_data<gl::experimental::TexturingVertex>(float_count.bytes()),
+                        std::runtime_error);
+
+        // the decoder does not rely on the header checks
+        const auto forged = make_forged_face("uint");
+        auto header = file::ply::parse_header(forged.bytes());
+        header.elements[1].properties[0].count_type = file::ply::ScalarType::FLOAT32;
+        std::vector<gl::experimental::TexturingVertex> vertices(3);
+        std::vector<gl::u32> indices;
+        const file::ply::VertexTarget target { gl::VertexLayout<gl::experimental::TexturingVertex>::attributes,
+                                               sizeof(gl::experimental::TexturingVertex),
+                                               std::as_writable_bytes(std::span { vertices }) };
+        CHECK_THROWS_AS(file::ply::decode(header, forged.bytes(), target, indices), std::runtime_error);
+    }
+
+    TEST_CASE("end_header should only be matched as a whole line") {
+        PlyBuilder builder("ply\n"
+                           "format binary_little_endian 1.0\n"
+                           "comment written before end_header\n"
+                           "element vertex 1\n"
+                           "property float x\n"
+                           "end_header\r\n");
+        builder.put(1.5f);
+        const auto header = file::ply::parse_header(builder.bytes());
+        REQUIRE(header.elements.size() == 1);
+        CHECK(header.elements[0].count == 1);
+        CHECK(header.body_offset == builder.bytes().size() - sizeof(float));
+    }
+
+    TEST_CASE("counts beyond the file size should be rejected before decoding") {
+        PlyBuilder huge("ply\n"
+                        "format binary_little_endian 1.0\n"
+                        "element vertex 1000000000000\n"
+                        "property float x\n"
+                        "end_header\n");
+        huge.put(1.0f);
+        CHECK_THROWS_AS(file::ply::parse_header(huge.bytes()), std::runtime_error);
+
+        // records with lists take at least their counts
+        PlyBuilder faces("ply\n"
+                         "format binary_little_endian 1.0\n"
+                         "element face 3\n"
+                         "property list uchar uint vertex_indices\n"
+                         "end_header\n");
+        faces.put(gl::u8 { 0 }).put(gl::u8 { 0 });
+        CHECK_THROWS_AS(file::ply::parse_header(faces.bytes()), std::runtime_error);
+
+        PlyBuilder wrapping("ply\n"
+                            "format binary_little_endian 1.0\n"
+                            "element vertex 4611686018427387905\n"
+                            "property float x\n"
+                            "end_header\n");
+        wrapping.put(1.0f);
+        CHECK_THROWS_AS(file::ply::parse_header(wrapping.bytes()), std::runtime_error);
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef DK_TESTS_GL_TEST_CONTEXT_HPP
+#define DK_TESTS_GL_TEST_CONTEXT_HPP
+
+#include <doctest/doctest.h>
+#include <dklib/gl/headless_context.hpp>
+#include <dklib/gl/program.hpp>
+
+#include <GLES3/gl3.h>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+/// Fixtures shared by the GL tests
+namespace dk::test {
+
+/// @brief Headless context for the test, nullptr when there is no EGL driver
+/// and the test should be skipped.
+inline std::unique_ptr<gl::HeadlessContext> try_make_context() {
+    try {
+        return std::make_unique<gl::HeadlessContext>();
+    } catch (const std::runtime_error &) {
+        return nullptr;
+    }
+}
+
+/// @brief Writes the text into the file, its directories are created first.
+inline std::filesystem::path write_file(const std::filesystem::path &path, const std::string &text) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << text;
+    return path;
+}
+
+/// @brief Program of the two stages, their sources are written into the
+/// directory first. Throws when it does not link.
+inline gl::Program make_program(const std::filesystem::path &directory, const std::string &vertex,
+                                const std::string &fragment) {
+    gl::Program program(nullptr);
+    program.attach_shader(write_file(directory / "shader.vert", vertex).string(), gl::ShaderType::VERTEX)
+        .attach_shader(write_file(directory / "shader.frag", fragment).string(), gl::ShaderType::FRAGMENT)
+        .link();
+    return program;
+}
+
+/// @brief Program drawing the vertices at their positions (location 0), in
+/// the color of their normals (location 1).
+inline gl::Program make_normal_color_program(const std::filesystem::path &directory) {
+    return make_program(directory,
+                        "#version 450 core\n"
+                        "layout (location = 0) in vec3 position;\n"
+                        "layout (location = 1) in vec3 normal;\n"
+                        "out vec3 vertex_color;\n"
+                        "void main() {\n"
+                        "    vertex_color = normal;\n"
+                        "    gl_Position = vec4(position, 1.0);\n"
+                        "}\n",
+                        "#version 450 core\n"
+                        "in vec3 vertex_color;\n"
+                        "out vec4 result;\n"
+                        "void main() { result = vec4(vertex_color, 1.0); }\n");
+}
+
+/// @brief Runs the draw into a cleared framebuffer of a single RGBA8 pixel
+/// and reads the pixel back.
+template <typename Draw>
+std::array<gl::u8, 4> draw_pixel(Draw &&draw) {
+    gl::u32 framebuffer = 0;
+    gl::u32 renderbuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    glViewport(0, 0, 1, 1);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    draw();
+
+    std::array<gl::u8, 4> pixel {};
+    glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel.data());
+    glDeleteRenderbuffers(1, &renderbuffer);
+    glDeleteFramebuffers(1, &framebuffer);
+    return pixel;
+}
+
+} // namespace dk::test
+
+/// @brief Makes a headless context current until the end of the test case, or
+/// skips the rest of it when there is no EGL driver.
+#define DK_REQUIRE_GL_CONTEXT()                                                                                      \
+    const auto dk_gl_test_context = ::dk::test::try_make_context();                                                  \
+    if (dk_gl_test_context == nullptr) {                                                                             \
+        MESSAGE("no EGL driver, skipped");                                                                           \
+        return;                                                                                                      \
+    }                                                                                                                \
+    static_cast<void>(0)
+
+#endif // DK_TESTS_GL_TEST_CONTEXT_HPP
@@ -0,0 +1,179 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/block_layout.hpp>
+#include <dklib/gl/program.hpp>
+#include "gl_test_context.hpp"
+
+#include <GLES3/gl31.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using namespace dk;
+
+namespace {
+struct Light {
+    vmath::vec3 direction;
+    gl::f32 intensity;
+};
+
+struct Material {
+    vmath::mat4 model;
+    vmath::vec3 tint;
+    gl::f32 alpha;
+    vmath::vec2 uv_scale;
+    gl::f32 weights[3];
+    Light light;
+    vmath::mat3 normal;
+};
+
+const char *const MATERIAL_MEMBERS = "{ mat4 model; vec3 tint; float alpha; vec2 uv_scale; float weights[3];"
+                                     " Light light; mat3 normal; }";
+
+gl::f32 read_f32(std::span<const std::byte> bytes, std::size_t offset) {
+    gl::f32 value = 0.0f;
+    std::memcpy(&value, bytes.data() + offset, sizeof(value));
+    return value;
+}
+} // namespace
+
+template <>
+struct gl::BlockFields<Light> {
+    static constexpr auto value = std::tuple { &Light::direction, &Light::intensity };
+};
+
+template <>
+struct gl::BlockFields<Material> {
+    static constexpr auto value = std::tuple { &Material::model,   &Material::tint,  &Material::alpha,
+                                               &Material::uv_scale, &Material::weights, &Material::light,
+                                               &Material::normal };
+};
+
+using Std140 = gl::BlockLayout<Material, gl::LayoutStandard::STD140>;
+using Std430 = gl::BlockLayout<Material, gl::LayoutStandard::STD430>;
+static_assert(Std140::offsets == std::array<std::size_t, 7> { 0, 64, 76, 80, 96, 144, 160 });
+static_assert(Std140::size == 208 and Std140::alignment == 16);
+static_assert(Std430::offsets == std::array<std::size_t, 7> { 0, 64, 76, 80, 88, 112, 128 });
+static_assert(Std430::size == 176 and Std430::alignment == 16);
+static_assert(gl::BlockLayout<Light>::size == 16);
+
+TEST_SUITE("[GL] Block layout") {
+    TEST_CASE("fields should be packed at the layout offsets") {
+        Material material {};
+        material.alpha = 0.5f;
+        material.weights[0] = 1.0f;
+        material.weights[1] = 2.0f;
+        material.weights[2] = 3.0f;
+        material.light.intensity = 4.0f;
+        for (int i = 0; i < 3; ++i) {
+            material.normal[i][i] = 1.0f;
+        }
+
+        std::vector<std::byte> std140(Std140::size);
+        Std140::pack(material, std140);
+        CHECK(read_f32(std140, 76) == 0.5f);
+        CHECK(read_f32(std140, 96 + 16) == 2.0f);
+        CHECK(read_f32(std140, 144 + 12) == 4.0f);
+        // columns of mat3 are padded to vec4
+        CHECK(read_f32(std140, 160) == 1.0f);
+        CHECK(read_f32(std140, 160 + 16 + 4) == 1.0f);
+
+        std::vector<std::byte> std430(Std430::size);
+        Std430::pack(material, std430);
+        CHECK(read_f32(std430, 88 + 4) == 2.0f);
+        CHECK(read_f32(std430, 112 + 12) == 4.0f);
+    }
+
+    TEST_CASE("elements of block array should respect the alignment") {
+        gl::BlockArray<Material> array(3, 256);
+        CHECK(array.get_stride() == 256);
+        CHECK(array.size() == 3);
+        CHECK(array.size_bytes() == 768);
+        CHECK(array.get_offset(2) == 512);
+    }
+
+    TEST_CASE("offsets should match the driver") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_block_layout";
+        std::filesystem::create_directories(directory);
+        const auto vertex = directory / "shader.vert";
+        std::ofstream(vertex) << "#version 430 core\n"
+                                 "struct Light { vec3 direction; float intensity; };\n"
+                                 "layout (std140, binding = 0) uniform Materials "
+                              << MATERIAL_MEMBERS
+                              << " materials;\n"
+                                 "layout (std430, binding = 1) buffer Objects "
+                              << MATERIAL_MEMBERS
+                              << " objects;\n"
+                                 "void main() {\n"
+                                 "    gl_Position = materials.model * objects.model * vec4(materials.tint, 1.0);\n"
+                                 "}\n";
+
+        gl::Program program(nullptr);
+        program.attach_shader(vertex.string(), gl::ShaderType::VERTEX).link();
+
+        const char *names[] = { "model", "tint", "alpha", "uv_scale", "weights[0]", "light.direction", "normal" };
+        for (std::size_t i = 0; i < std::size(names); ++i) {
+            const auto query_offset = [&](gl::enum32 interface, const std::string &name) {
+                const auto index = glGetProgramResourceIndex(program.get_id(), interface, name.c_str());
+                CHECK(index != GL_INVALID_INDEX);
+                const gl::enum32 property = GL_OFFSET;
+                gl::i32 offset = -1;
+                glGetProgramResourceiv(program.get_id(), interface, index, 1, &property, 1, nullptr, &offset);
+                return static_cast<std::size_t>(offset);
+            };
+            CHECK(query_offset(GL_UNIFORM, std::string("Materials.") + names[i]) == Std140::offsets[i]);
+            CHECK(query_offset(GL_BUFFER_VARIABLE, std::string("Objects.") + names[i]) == Std430::offsets[i]);
+        }
+
+        const auto materials = program.get_reflection().find_block("Materials");
+        REQUIRE(materials.has_value());
+        CHECK(static_cast<std::size_t>(program.get_reflection().get_block(*materials).data_size) == Std140::size);
+
+        std::filesystem::remove_all(directory);
+    }
+
+    TEST_CASE("changed elements should be uploaded") {
+        DK_REQUIRE_GL_CONTEXT();
+        gl::BlockArray<Material> array(4);
+        gl::UniformBuffer buffer;
+        buffer.allocate(array.size_bytes());
+        array.upload(buffer);
+
+        Material material {};
+        material.alpha = 0.75f;
+        array.set(2, material);
+        array.upload(buffer);
+
+        const auto *mapped = static_cast<const std::byte *>(
+            glMapBufferRange(GL_UNIFORM_BUFFER, 0, static_cast<gl::sptr>(array.size_bytes()), GL_MAP_READ_BIT));
+        REQUIRE(mapped != nullptr);
+        CHECK(std::memcmp(mapped, array.bytes().data(), array.size_bytes()) == 0);
+        CHECK(read_f32({ mapped, array.size_bytes() }, array.get_offset(2) + 76) == 0.75f);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        CHECK(glGetError() == GL_NO_ERROR);
+    }
+
+    TEST_CASE("shrunk array should upload only the remaining elements") {
+        DK_REQUIRE_GL_CONTEXT();
+        gl::BlockArray<Material> array(10);
+        gl::UniformBuffer buffer;
+        buffer.allocate(array.size_bytes());
+        array.upload(buffer);
+
+        Material material {};
+        material.alpha = 0.5f;
+        array.set(9, material);
+        array.resize(5);
+        array.upload(buffer);
+        CHECK(glGetError() == GL_NO_ERROR);
+
+        const auto *mapped = static_cast<const std::byte *>(
+            glMapBufferRange(GL_UNIFORM_BUFFER, 0, static_cast<gl::sptr>(array.size_bytes()), GL_MAP_READ_BIT));
+        REQUIRE(mapped != nullptr);
+        CHECK(std::memcmp(mapped, array.bytes().data(), array.size_bytes()) == 0);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    }
+}
@@ -0,0 +1,132 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/glsl_interface.hpp>
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+using namespace dk;
+
+namespace {
+const gl::glsl::Variable *find(const std::vector<gl::glsl::Variable> &variables, std::string_view name) {
+    const auto it = std::ranges::find(variables, name, &gl::glsl::Variable::name);
+    return it == variables.end() ? nullptr : &*it;
+}
+} // namespace
+
+TEST_SUITE("[GL] GLSL interface") {
+    TEST_CASE("uniforms should be read with their layouts") {
+        const auto interface = gl::glsl::parse_interface(R"(
+#version 450 core
+// uniform float commented_out;
+/* uniform float
+   also_commented_out; */
+#define LIGHTS 4
+layout(location = 3) uniform mat4 mv_matrix;
+uniform vec3 light_dir, light_color;
+uniform float weights[8];
+uniform vec4 lights[LIGHTS];
+layout(binding = 2) uniform sampler2D albedo;
+)",
+                                                         gl::ShaderType::FRAGMENT);
+
+        REQUIRE(interface.uniforms.size() == 6);
+        CHECK(find(interface.uniforms, "commented_out") == nullptr);
+        CHECK(find(interface.uniforms, "also_commented_out") == nullptr);
+
+        const auto *mv = find(interface.uniforms, "mv_matrix");
+        REQUIRE(mv != nullptr);
+        CHECK(mv->type == "mat4");
+        CHECK(mv->location == 3);
+
+        const auto *color = find(interface.uniforms, "light_color");
+        REQUIRE(color != nullptr);
+        CHECK(color->type == "vec3");
+        CHECK_FALSE(color->location.has_value());
+
+        CHECK(find(interface.uniforms, "weights")->array_size == 8u);
+        // sizes given by macros are not known
+        CHECK(find(interface.uniforms, "lights")->array_size == 0u);
+        CHECK(find(interface.uniforms, "albedo")->binding == 2);
+    }
+
+    TEST_CASE("blocks, attributes and functions") {
+        const auto interface = gl::glsl::parse_interface(R"(
+#version 450 core
+layout(location = 0) in vec3 position;
+layout(location = 2) in vec2 uv;
+in vec3 normal;
+out VS_OUT { vec2 uv; } vs_out;
+struct Light { vec3 position; };
+layout(std140, binding = 1) uniform Camera {
+    mat4 proj_matrix;
+    mat4 view_matrix;
+} camera;
+layout(std430, binding = 3) buffer Objects { mat4 models[]; };
+uniform float time;
+void main() {
+    uniform_like_local = 1.0;
+    if (time > 0.0) { gl_Position = vec4(position, 1.0); }
+}
+)",
+                                                         gl::ShaderType::VERTEX);
+
+        REQUIRE(interface.attributes.size() == 3);
+        CHECK(find(interface.attributes, "position")->location == 0);
+        CHECK(find(interface.attributes, "uv")->location == 2);
+        CHECK_FALSE(find(interface.attributes, "normal")->location.has_value());
+
+        REQUIRE(interface.blocks.size() == 2);
+        const auto &camera = interface.blocks[0];
+        CHECK(camera.name == "Camera");
+        CHECK(camera.instance == "camera");
+        CHECK_FALSE(camera.is_storage);
+        CHECK(camera.binding == 1);
+        CHECK(camera.members.size() == 2);
+        const auto &objects = interface.blocks[1];
+        CHECK(objects.is_storage);
+        CHECK(objects.binding == 3);
+        CHECK(objects.instance.empty());
+
+        REQUIRE(interface.uniforms.size() == 1);
+        CHECK(interface.uniforms[0].name == "time");
+    }
+
+    TEST_CASE("stages should be merged") {
+        auto interface = gl::glsl::parse_interface("uniform mat4 mv_matrix;\nin vec3 position;\n",
+                                                   gl::ShaderType::VERTEX);
+        interface.merge(gl::glsl::parse_interface("uniform mat4 mv_matrix;\nuniform vec4 tint;\nin vec3 color;\n",
+                                                  gl::ShaderType::FRAGMENT));
+
+        CHECK(interface.uniforms.size() == 2);
+        // inputs of the fragment stage are not attributes
+        CHECK(interface.attributes.size() == 1);
+    }
+
+    TEST_CASE("unbalanced braces should be reported") {
+        CHECK_THROWS_AS(gl::glsl::parse_interface("void main() {\n", gl::ShaderType::VERTEX), std::runtime_error);
+    }
+
+    TEST_CASE("header should have typed setters") {
+        const auto interface = gl::glsl::parse_interface(R"(
+layout(location = 1) in vec3 position;
+layout(location = 4) uniform mat4 mv_matrix;
+uniform vec3 tint;
+uniform float weights[2];
+layout(binding = 0) uniform sampler2D albedo;
+)",
+                                                         gl::ShaderType::VERTEX);
+        const std::array shaders { gl::glsl::ShaderFile { gl::ShaderType::VERTEX, "shaders/main.vert.glsl" } };
+        const auto header = gl::glsl::generate_header("MainProgram", shaders, interface);
+
+        CHECK(header.find("struct MainProgram {") != std::string::npos);
+        CHECK(header.find("VERTEX_SHADER = \"shaders/main.vert.glsl\"") != std::string::npos);
+        CHECK(header.find("POSITION_LOCATION = 1;") != std::string::npos);
+        CHECK(header.find("MV_MATRIX_LOCATION = 4;") != std::string::npos);
+        CHECK(header.find("ALBEDO_BINDING = 0;") != std::string::npos);
+        CHECK(header.find("void set_mv_matrix(const vmath::mat4 &") != std::string::npos);
+        CHECK(header.find("void set_tint(dk::gl::f32 x, dk::gl::f32 y, dk::gl::f32 z)") != std::string::npos);
+        CHECK(header.find("set_weights") == std::string::npos);
+        CHECK(header.find("get_weights()") != std::string::npos);
+    }
+}
@@ -0,0 +1,93 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/hot_reload.hpp>
+#include "gl_test_context.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+template <typename T = gl::u32>
+std::vector<T> read_buffer(gl::u32 buffer, std::size_t count) {
+    std::vector<T> values(count);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    const void *mapped = glMapBufferRange(GL_COPY_READ_BUFFER, 0, static_cast<gl::sptr>(count * sizeof(T)),
+                                          GL_MAP_READ_BIT);
+    std::memcpy(values.data(), mapped, count * sizeof(T));
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+    return values;
+}
+} // namespace
+
+TEST_SUITE("[GL] Hot reload") {
+    TEST_CASE("program should be relinked when an included file changes") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_hot_reload";
+        std::filesystem::create_directories(directory);
+        const auto common = test::write_file(directory / "common.glsl", "uniform vec4 tint;\n");
+        const auto vertex
+            = test::write_file(directory / "shader.vert", "#version 330 core\nvoid main() { gl_Position = vec4(0.0); }\n");
+        const auto fragment = test::write_file(directory / "shader.frag",
+                                               "#version 330 core\n#include \"common.glsl\"\nout vec4 color;\n"
+                                               "void main() { color = tint; }\n");
+
+        gl::Program program(nullptr);
+        program.attach_shader(std::string(vertex), gl::ShaderType::VERTEX)
+            .attach_shader(std::string(fragment), gl::ShaderType::FRAGMENT)
+            .link();
+        CHECK(program.get_files().size() == 3);
+
+        gl::HotReloader reloader;
+        std::size_t callback_count = 0;
+        reloader.watch(program, [&](gl::Program &reloaded) {
+            ++callback_count;
+            CHECK(reloaded.find_uniform("scale").has_value());
+        });
+        const auto original_id = program.get_id();
+
+        test::write_file(common, "uniform vec4 tint;\nuniform float scale;\n");
+        test::write_file(fragment, "#version 330 core\n#include \"common.glsl\"\nout vec4 color;\n"
+                         "void main() { color = tint * scale; }\n");
+        CHECK(reloader.update() == 1);
+        CHECK(callback_count == 1);
+        CHECK(program.is_linked());
+        CHECK(program.get_id() != original_id);
+        CHECK(program.make_uniform("scale").get_location() >= 0);
+
+        reloader.frame_presented();
+        CHECK(reloader.get_stats().reload_count == 1);
+        CHECK(reloader.get_stats().last_latency.count() >= 0.0);
+
+        // broken shader keeps the previous program
+        const auto reloaded_id = program.get_id();
+        test::write_file(common, "uniform vec4 tint\n");
+        CHECK(reloader.update() == 0);
+        CHECK(reloader.get_stats().failure_count == 1);
+        CHECK(program.get_id() == reloaded_id);
+        CHECK(callback_count == 1);
+    }
+
+    TEST_CASE("mesh should upload only the changed buffers") {
+        DK_REQUIRE_GL_CONTEXT();
+        using TestMesh = gl::Mesh<gl::u32, gl::u32>;
+        TestMesh mesh(std::vector<gl::u32> { 1, 2, 3, 4 }, std::vector<gl::u32> { 0, 1, 2 });
+
+        const auto changed_vertex = mesh.update({ { 1, 2, 7, 4 }, { 0, 1, 2 } });
+        CHECK(changed_vertex.vertices);
+        CHECK_FALSE(changed_vertex.indices);
+        CHECK(read_buffer(mesh.get_vertex_buffer().get_id(), 4) == std::vector<gl::u32> { 1, 2, 7, 4 });
+
+        const auto grown = mesh.update({ { 1, 2, 7, 4 }, { 0, 1, 2, 2, 3, 0 } });
+        CHECK_FALSE(grown.vertices);
+        CHECK(grown.indices);
+        CHECK(mesh.get_indices().size() == 6);
+        // four vertices are addressed by u8 indices on the GPU
+        CHECK(mesh.get_index_type() == GL_UNSIGNED_BYTE);
+        CHECK(read_buffer<gl::u8>(mesh.get_element_buffer().get_id(), 6) == std::vector<gl::u8> { 0, 1, 2, 2, 3, 0 });
+    }
+}
@@ -0,0 +1,90 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/index_format.hpp>
+#include <dklib/gl/mesh.hpp>
+#include <dklib/gl/program.hpp>
+#include "gl_test_context.hpp"
+
+#include <GLES3/gl3.h>
+
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+gl::i32 get_buffer_size(const gl::ElementBuffer &buffer) {
+    gl::i32 size = 0;
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer.get_id());
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return size;
+}
+
+/// Vertices of which only the last three cover the viewport, their normal is
+/// the expected color.
+gl::MeshData<gl::experimental::Vertex> make_mesh(gl::u32 vertex_count) {
+    gl::MeshData<gl::experimental::Vertex> data;
+    data.vertices.resize(vertex_count, { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, 0.0f, 0.0f });
+    data.vertices[vertex_count - 3] = { { -1.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f };
+    data.vertices[vertex_count - 2] = { { 3.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f };
+    data.vertices[vertex_count - 1] = { { -1.0f, 3.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f };
+    data.indices = { vertex_count - 3, vertex_count - 2, vertex_count - 1 };
+    return data;
+}
+} // namespace
+
+TEST_SUITE("[GL] Index format") {
+    TEST_CASE("the narrowest index type should address every vertex") {
+        static_assert(gl::narrowest_index_type(0) == GL_UNSIGNED_BYTE);
+        static_assert(gl::narrowest_index_type(256) == GL_UNSIGNED_BYTE);
+        static_assert(gl::narrowest_index_type(257) == GL_UNSIGNED_SHORT);
+        static_assert(gl::narrowest_index_type(65536) == GL_UNSIGNED_SHORT);
+        static_assert(gl::narrowest_index_type(65537) == GL_UNSIGNED_INT);
+        // never wider than the indices themselves
+        static_assert(gl::narrowest_index_type<gl::u16>(1 << 20) == GL_UNSIGNED_SHORT);
+        static_assert(gl::narrowest_index_type<gl::u8>(10) == GL_UNSIGNED_BYTE);
+
+        const std::vector<gl::u32> indices { 0, 1, 255 };
+        const auto bytes = gl::narrow_indices(std::span<const gl::u32> { indices }, GL_UNSIGNED_BYTE);
+        CHECK(bytes == std::vector<std::byte> { std::byte { 0 }, std::byte { 1 }, std::byte { 255 } });
+        CHECK(gl::narrow_indices(std::span<const gl::u32> { indices }, GL_UNSIGNED_SHORT).size() == 6);
+    }
+
+    TEST_CASE("meshes should draw with the narrowest index buffer") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_index_format";
+        auto program = test::make_normal_color_program(directory);
+
+        const auto draw_blue = [&](const auto &mesh) {
+            const auto pixel = test::draw_pixel([&] {
+                program.use();
+                mesh.draw();
+            });
+            return pixel == std::array<gl::u8, 4> { 0, 0, 255, 255 };
+        };
+
+        gl::Mesh<gl::experimental::Vertex> small(make_mesh(3));
+        CHECK(small.get_index_type() == GL_UNSIGNED_BYTE);
+        CHECK(get_buffer_size(small.get_element_buffer()) == 3);
+        CHECK(draw_blue(small));
+
+        const gl::Mesh<gl::experimental::Vertex> medium(make_mesh(300));
+        CHECK(medium.get_index_type() == GL_UNSIGNED_SHORT);
+        CHECK(get_buffer_size(medium.get_element_buffer()) == 6);
+        CHECK(draw_blue(medium));
+
+        const gl::Mesh<gl::experimental::Vertex> large(make_mesh(70000));
+        CHECK(large.get_index_type() == GL_UNSIGNED_INT);
+        CHECK(get_buffer_size(large.get_element_buffer()) == 12);
+        CHECK(draw_blue(large));
+
+        // the index type follows the vertex count of the update
+        small.update(make_mesh(300));
+        CHECK(small.get_index_type() == GL_UNSIGNED_SHORT);
+        CHECK(get_buffer_size(small.get_element_buffer()) == 6);
+        CHECK(draw_blue(small));
+        std::filesystem::remove_all(directory);
+    }
+}
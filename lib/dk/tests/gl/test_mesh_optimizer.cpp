@@ -0,0 +1,195 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/mesh_optimizer.hpp>
+#include <dklib/gl/vertex.hpp>
+#include "gl_test_context.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+/// Flat grid of quads facing +z, its vertices and triangles shuffled as if
+/// they came from a file without any locality.
+gl::MeshData<gl::experimental::Vertex> make_shuffled_grid(gl::u32 width, gl::u32 height, gl::f32 z = 0.0f) {
+    std::mt19937 generator(11);
+    std::vector<gl::u32> slots(static_cast<std::size_t>(width) * height);
+    std::iota(slots.begin(), slots.end(), 0U);
+    std::ranges::shuffle(slots, generator);
+
+    gl::MeshData<gl::experimental::Vertex> data;
+    data.vertices.resize(slots.size());
+    for (gl::u32 y = 0; y < height; ++y) {
+        for (gl::u32 x = 0; x < width; ++x) {
+            data.vertices[slots[y * width + x]] = {
+                { static_cast<gl::f32>(x), static_cast<gl::f32>(y), z }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f
+            };
+        }
+    }
+    std::vector<std::array<gl::u32, 3>> triangles;
+    for (gl::u32 y = 0; y + 1 < height; ++y) {
+        for (gl::u32 x = 0; x + 1 < width; ++x) {
+            const gl::u32 corner = y * width + x;
+            triangles.push_back({ slots[corner], slots[corner + 1], slots[corner + width] });
+            triangles.push_back({ slots[corner + 1], slots[corner + width + 1], slots[corner + width] });
+        }
+    }
+    std::ranges::shuffle(triangles, generator);
+    for (const auto &triangle : triangles) {
+        data.indices.insert(data.indices.end(), triangle.begin(), triangle.end());
+    }
+    return data;
+}
+
+/// Triangles as sorted corner positions, which does not depend on the order
+/// of the vertices nor of the triangles.
+std::vector<std::array<gl::f32, 9>> triangles_of(const gl::MeshData<gl::experimental::Vertex> &data) {
+    std::vector<std::array<gl::f32, 9>> triangles;
+    for (std::size_t i = 0; i < data.indices.size(); i += 3) {
+        std::array<gl::f32, 9> triangle {};
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            const auto &position = data.vertices[data.indices[i + corner]].position;
+            triangle[corner * 3] = position.x;
+            triangle[corner * 3 + 1] = position.y;
+            triangle[corner * 3 + 2] = position.z;
+        }
+        triangles.push_back(triangle);
+    }
+    std::ranges::sort(triangles);
+    return triangles;
+}
+} // namespace
+
+TEST_SUITE("[GL] Mesh optimizer") {
+    TEST_CASE("the cache simulator should count the transformed vertices") {
+        const std::vector<gl::u32> triangle { 0, 1, 2 };
+        const auto single = gl::analyze_vertex_cache(triangle, 3);
+        CHECK(single.acmr == doctest::Approx(3.0f));
+        CHECK(single.atvr == doctest::Approx(1.0f));
+        CHECK(single.overfetch == 0.0f);
+
+        // the second triangle of the quad reuses two cached vertices
+        const std::vector<gl::u32> quad { 0, 1, 2, 2, 1, 3 };
+        CHECK(gl::analyze_vertex_cache(quad, 4).acmr == doctest::Approx(2.0f));
+
+        // a cache of 3 entries evicts vertex 0 before it is used again
+        const std::vector<gl::u32> evicted { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+        CHECK(gl::analyze_vertex_cache(evicted, 6, 0, 3).atvr == doctest::Approx(1.5f));
+        CHECK(gl::analyze_vertex_cache(evicted, 6, 0, 6).atvr == doctest::Approx(1.0f));
+
+        // 32 byte vertices fill two to a cache line
+        CHECK(gl::analyze_vertex_cache(quad, 4, 32).overfetch == doctest::Approx(1.0f));
+    }
+
+    TEST_CASE("vertex cache optimization should lower the ACMR and keep the triangles") {
+        const auto data = make_shuffled_grid(40, 40);
+        const auto before = gl::analyze_vertex_cache(data.indices, data.vertices.size());
+        const auto indices = gl::optimize_vertex_cache(data.indices, data.vertices.size());
+        const auto after = gl::analyze_vertex_cache(indices, data.vertices.size());
+        CHECK(before.acmr > 2.0f);
+        CHECK(after.acmr < 0.8f);
+        CHECK(after.atvr < 1.4f);
+
+        // the same triangles with the same winding, maybe of rotated corners
+        auto rotated = data;
+        rotated.indices = indices;
+        CHECK(triangles_of(rotated) == triangles_of(data));
+        for (std::size_t i = 0; i < indices.size(); i += 3) {
+            const auto &a = data.vertices[indices[i]].position;
+            const auto &b = data.vertices[indices[i + 1]].position;
+            const auto &c = data.vertices[indices[i + 2]].position;
+            // counterclockwise seen from +z
+            REQUIRE((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x) > 0.0f);
+        }
+    }
+
+    TEST_CASE("overdraw optimization should draw the outer clusters first") {
+        // the grid further from the center along its normal is drawn last
+        auto back = make_shuffled_grid(6, 6, 0.0f);
+        const auto front = make_shuffled_grid(6, 6, 1.0f);
+        auto indices = gl::optimize_vertex_cache(back.indices, back.vertices.size());
+        const auto offset = static_cast<gl::u32>(back.vertices.size());
+        const auto front_indices = gl::optimize_vertex_cache(front.indices, front.vertices.size());
+        for (const auto index : front_indices) {
+            indices.push_back(index + offset);
+        }
+        back.vertices.insert(back.vertices.end(), front.vertices.begin(), front.vertices.end());
+        const auto positions = gl::detail::positions_of(std::span<const gl::experimental::Vertex> { back.vertices });
+
+        const auto sorted = gl::optimize_overdraw(indices, positions);
+        REQUIRE(sorted.size() == indices.size());
+        CHECK(sorted.front() >= offset);
+        CHECK(sorted.back() < offset);
+
+        const auto before = gl::analyze_vertex_cache(indices, positions.size());
+        const auto after = gl::analyze_vertex_cache(sorted, positions.size());
+        CHECK(after.acmr <= before.acmr * 1.1f);
+    }
+
+    TEST_CASE("vertex fetch remap should follow the first use") {
+        const std::vector<gl::u32> indices { 3, 1, 4, 1, 4, 0 };
+        const auto [remap, used_count] = gl::make_vertex_fetch_remap(indices, 6);
+        CHECK(used_count == 4);
+        CHECK(remap == std::vector<gl::u32> { 3, 1, gl::INVALID_REMAP, 0, 2, gl::INVALID_REMAP });
+    }
+
+    TEST_CASE("all passes should report their statistics") {
+        auto data = make_shuffled_grid(30, 30);
+        // a vertex no triangle uses
+        data.vertices.push_back({ { 100.0f, 100.0f, 100.0f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f });
+        const auto source = data;
+
+        const auto passes = gl::optimize(data);
+        REQUIRE(passes.size() == 3);
+        CHECK(passes[0].name == "vertex cache");
+        CHECK(passes[1].name == "overdraw");
+        CHECK(passes[2].name == "vertex fetch");
+        CHECK(passes[0].after.acmr < passes[0].before.acmr * 0.5f);
+        CHECK(passes[1].after.acmr <= passes[1].before.acmr * 1.1f);
+        // reordering the vertices leaves the transforms as they are
+        CHECK(passes[2].after.acmr == passes[2].before.acmr);
+        CHECK(passes[2].after.overfetch < passes[2].before.overfetch);
+        for (std::size_t pass = 1; pass < passes.size(); ++pass) {
+            CHECK(passes[pass].before.acmr == passes[pass - 1].after.acmr);
+        }
+
+        CHECK(data.vertices.size() == source.vertices.size() - 1);
+        CHECK(triangles_of(data) == triangles_of(source));
+        // vertices are stored in the order of their first use
+        gl::u32 next = 0;
+        for (const auto index : data.indices) {
+            REQUIRE(index <= next);
+            next = std::max(next, index + 1);
+        }
+    }
+
+    TEST_CASE("invalid indices should be rejected") {
+        const std::vector<gl::u32> out_of_range { 0, 1, 3 };
+        CHECK_THROWS_AS(gl::optimize_vertex_cache(out_of_range, 3), std::runtime_error);
+        const std::vector<gl::u32> not_triangles { 0, 1 };
+        CHECK_THROWS_AS(gl::analyze_vertex_cache(not_triangles, 3), std::runtime_error);
+    }
+
+    TEST_CASE("optimizing a mesh should upload the optimized geometry") {
+        DK_REQUIRE_GL_CONTEXT();
+        auto data = make_shuffled_grid(20, 20);
+        auto expected = data;
+        gl::optimize(expected);
+
+        gl::Mesh<gl::experimental::Vertex> mesh(std::move(data));
+        const auto passes = gl::optimize(mesh);
+        CHECK(passes.size() == 3);
+        CHECK(mesh.get_indices() == expected.indices);
+        CHECK(mesh.get_index_count() == expected.indices.size());
+
+        // without a CPU side copy there is nothing to reorder
+        gl::Mesh<gl::experimental::Vertex> from_spans(std::span<const gl::experimental::Vertex> { expected.vertices },
+                                                      std::span<const gl::u32> { expected.indices });
+        CHECK_THROWS_AS(gl::optimize(from_spans), std::runtime_error);
+    }
+}
@@ -0,0 +1,95 @@
+#include <doctest/doctest.h>
+#include <dklib/file/ktx_file.hpp>
+#include <dklib/gl/mipmap.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+using namespace dk;
+
+namespace {
+gl::Image make_checkerboard(gl::u32 width, gl::u32 height, gl::u32 channels) {
+    gl::Image image(width, height, channels);
+    for (gl::u32 y = 0; y < height; ++y) {
+        auto row = image.row(y);
+        for (gl::u32 x = 0; x < width; ++x) {
+            for (gl::u32 c = 0; c < channels; ++c) {
+                row[x * channels + c] = ((x + y) % 2 == 0) ? 255 : 0;
+            }
+        }
+    }
+    return image;
+}
+} // namespace
+
+TEST_SUITE("[GL] Mipmap generation") {
+    TEST_CASE("chain should go down to a single pixel") {
+        const auto chain = gl::generate_mipmaps(make_checkerboard(13, 4, 3));
+        REQUIRE(chain.size() == 4);
+        CHECK(chain[1].width == 6);
+        CHECK(chain[1].height == 2);
+        CHECK(chain[3].width == 1);
+        CHECK(chain[3].height == 1);
+        // rows of 13 RGB pixels are padded from 39 to 40 bytes
+        CHECK(chain[0].stride() == 40);
+        CHECK(chain[2].pixels.size() == 3 * 4);
+    }
+
+    TEST_CASE("box filter should average in the linear space") {
+        const auto chain = gl::generate_mipmaps(make_checkerboard(4, 4, 4));
+        // half of the light is 188 in sRGB, not 128, alpha is averaged linearly
+        CHECK(chain[1].row(0)[0] == 188);
+        CHECK(chain[1].row(0)[3] == 128);
+
+        const auto linear = gl::generate_mipmaps(make_checkerboard(4, 4, 1), { gl::MipFilter::BOX, false });
+        CHECK(linear[2].pixels[0] == 128);
+    }
+
+    TEST_CASE("result should not depend on the count of threads") {
+        auto image = make_checkerboard(64, 48, 4);
+        for (std::size_t i = 0; i < image.pixels.size(); ++i) {
+            image.pixels[i] = static_cast<gl::u8>(i * 7 % 251);
+        }
+        util::ThreadPool single(1);
+        util::ThreadPool many(4);
+        for (const auto filter : { gl::MipFilter::BOX, gl::MipFilter::KAISER }) {
+            const auto expected = gl::generate_mipmaps(image, { filter, true }, single);
+            const auto actual = gl::generate_mipmaps(image, { filter, true }, many);
+            REQUIRE(expected.size() == actual.size());
+            for (std::size_t level = 0; level < expected.size(); ++level) {
+                CHECK(expected[level].pixels == actual[level].pixels);
+            }
+        }
+    }
+
+    TEST_CASE("kaiser filter should keep flat areas flat") {
+        gl::Image image(32, 32, 1);
+        std::fill(image.pixels.begin(), image.pixels.end(), gl::u8 { 77 });
+        const auto chain = gl::generate_mipmaps(image, { gl::MipFilter::KAISER, true });
+        for (const auto &level : chain) {
+            CHECK(std::ranges::all_of(level.row(0), [](gl::u8 value) { return value == 77; }));
+        }
+    }
+
+    TEST_CASE("written chain should be readable as KTX") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_mipmap.ktx";
+        const auto chain = gl::generate_mipmaps(make_checkerboard(16, 8, 3));
+        file::ktx::save(path, chain);
+
+        const file::ktx::MappedTexture texture(path);
+        CHECK(texture.get_header().glinternalformat == GL_SRGB8);
+        REQUIRE(texture.get_level_count() == chain.size());
+        for (gl::u32 level = 0; level < chain.size(); ++level) {
+            const auto image = texture.get_image(level);
+            REQUIRE(image.size() == chain[level].pixels.size());
+            CHECK(std::memcmp(image.data(), chain[level].pixels.data(), image.size()) == 0);
+        }
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("unsupported images should be rejected") {
+        CHECK_THROWS_AS(gl::generate_mipmaps(gl::Image(4, 4, 2)), std::invalid_argument);
+        CHECK_THROWS_AS(gl::generate_mipmaps(gl::Image {}), std::invalid_argument);
+    }
+}
@@ -0,0 +1,77 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/program.hpp>
+#include "gl_test_context.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dk;
+
+TEST_SUITE("[GL] Program") {
+    TEST_CASE("submitted programs should be linked by wait") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_program";
+        const auto vertex
+            = test::write_file(directory / "shader.vert", "#version 330 core\nvoid main() { gl_Position = vec4(0.0); }\n")
+                  .string();
+
+        std::vector<std::unique_ptr<gl::Program>> programs;
+        for (int i = 0; i < 4; ++i) {
+            const auto fragment = test::write_file(directory / ("shader_" + std::to_string(i) + ".frag"),
+                                                   "#version 330 core\nout vec4 color;\nvoid main() { color = vec4("
+                                                       + std::to_string(i) + ".0); }\n")
+                                      .string();
+            auto &program = programs.emplace_back(std::make_unique<gl::Program>(nullptr));
+            program->attach_shader(std::string(vertex), gl::ShaderType::VERTEX)
+                .attach_shader(std::string(fragment), gl::ShaderType::FRAGMENT)
+                .submit();
+            CHECK_FALSE(program->is_linked());
+        }
+        for (auto &program : programs) {
+            program->wait();
+            CHECK(program->is_linked());
+            CHECK(program->is_ready());
+        }
+        std::filesystem::remove_all(directory);
+    }
+
+    TEST_CASE("reload between submit and wait should link the new sources") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_program_reload";
+        const auto vertex
+            = test::write_file(directory / "shader.vert", "#version 330 core\nvoid main() { gl_Position = vec4(0.0); }\n");
+        const auto fragment = test::write_file(directory / "shader.frag",
+                                               "#version 330 core\nuniform vec4 first;\nout vec4 color;\n"
+                                               "void main() { color = first; }\n");
+
+        gl::Program program(nullptr);
+        program.attach_shader(vertex.string(), gl::ShaderType::VERTEX)
+            .attach_shader(fragment.string(), gl::ShaderType::FRAGMENT)
+            .submit();
+        test::write_file(fragment, "#version 330 core\nuniform vec4 second;\nout vec4 color;\n"
+                                   "void main() { color = second; }\n");
+        CHECK(program.reload(fragment) == gl::ReloadResult::RELOADED);
+        program.wait();
+        CHECK(program.is_linked());
+        CHECK_FALSE(program.find_uniform("first").has_value());
+        CHECK(program.find_uniform("second").has_value());
+        std::filesystem::remove_all(directory);
+    }
+
+    TEST_CASE("compilation error should be reported by wait") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_program_error";
+        const auto vertex
+            = test::write_file(directory / "broken.vert", "#version 330 core\nvoid main() { oops }\n").string();
+
+        gl::Program program(nullptr);
+        program.attach_shader(std::string(vertex), gl::ShaderType::VERTEX);
+        CHECK_NOTHROW(program.submit());
+        CHECK_THROWS_AS(program.wait(), std::runtime_error);
+        CHECK_FALSE(program.is_linked());
+        CHECK_THROWS_AS(program.use(), std::runtime_error);
+        std::filesystem::remove_all(directory);
+    }
+}
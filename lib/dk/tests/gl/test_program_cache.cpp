@@ -0,0 +1,100 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/program.hpp>
+#include <dklib/gl/program_cache.hpp>
+#include "gl_test_context.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+std::filesystem::path make_cache_directory(const char *name) {
+    const auto directory = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(directory);
+    return directory;
+}
+} // namespace
+
+TEST_SUITE("[GL] Program binary cache") {
+    TEST_CASE("stored binary should be loaded back") {
+        const gl::ProgramBinaryCache cache(make_cache_directory("dk_test_program_cache"));
+        const std::vector<std::byte> bytes { std::byte { 1 }, std::byte { 2 }, std::byte { 3 } };
+
+        CHECK_FALSE(cache.load(42).has_value());
+        cache.store(42, 0x1234, bytes);
+        const auto binary = cache.load(42);
+        REQUIRE(binary.has_value());
+        CHECK(binary->format == 0x1234);
+        CHECK(binary->bytes == bytes);
+
+        cache.invalidate(42);
+        CHECK_FALSE(cache.load(42).has_value());
+        std::filesystem::remove_all(cache.get_directory());
+    }
+
+    TEST_CASE("corrupted entry should be removed") {
+        const gl::ProgramBinaryCache cache(make_cache_directory("dk_test_program_cache_corrupted"));
+        const std::vector<std::byte> bytes(64, std::byte { 7 });
+        cache.store(7, 1, bytes);
+
+        const auto entry = cache.get_directory() / "0000000000000007.bin";
+        REQUIRE(std::filesystem::exists(entry));
+        {
+            std::fstream file(entry, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(-1, std::ios::end);
+            file.put('x');
+        }
+        CHECK_FALSE(cache.load(7).has_value());
+        CHECK_FALSE(std::filesystem::exists(entry));
+
+        // truncated entry
+        cache.store(7, 1, bytes);
+        std::filesystem::resize_file(entry, 10);
+        CHECK_FALSE(cache.load(7).has_value());
+        std::filesystem::remove_all(cache.get_directory());
+    }
+
+    TEST_CASE("second link should be served by the cache") {
+        DK_REQUIRE_GL_CONTEXT();
+        gl::i32 format_count = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+        if (format_count == 0) {
+            MESSAGE("driver has no program binary formats, skipped");
+            return;
+        }
+
+        const auto directory = make_cache_directory("dk_test_program_cache_gl");
+        std::filesystem::create_directories(directory);
+        const auto vertex = directory / "shader.vert";
+        const auto fragment = directory / "shader.frag";
+        std::ofstream(vertex) << "#version 330 core\nvoid main() { gl_Position = vec4(0.0); }\n";
+        std::ofstream(fragment) << "#version 330 core\nout vec4 color;\nvoid main() { color = vec4(1.0); }\n";
+
+        gl::ProgramBinaryCache cache(directory / "programs");
+        const auto link = [&] {
+            auto program = std::make_unique<gl::Program>(&cache);
+            program->attach_shader(vertex.string(), gl::ShaderType::VERTEX)
+                .attach_shader(fragment.string(), gl::ShaderType::FRAGMENT)
+                .link();
+            return program;
+        };
+
+        const auto cold = link();
+        CHECK_FALSE(cold->is_from_binary_cache());
+        const auto warm = link();
+        CHECK(warm->is_from_binary_cache());
+        CHECK(warm->get_binary_key() == cold->get_binary_key());
+
+        // binary the driver refuses falls back to the compilation
+        const std::vector<std::byte> garbage(16, std::byte { 0 });
+        cache.store(cold->get_binary_key(), 0, garbage);
+        const auto rejected = link();
+        CHECK_FALSE(rejected->is_from_binary_cache());
+        CHECK(link()->is_from_binary_cache());
+
+        std::filesystem::remove_all(directory);
+    }
+}
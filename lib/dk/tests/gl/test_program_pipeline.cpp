@@ -0,0 +1,87 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/program_pipeline.hpp>
+#include "gl_test_context.hpp"
+
+#include <GLES3/gl31.h>
+
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+using namespace dk;
+
+namespace {
+/// Color of the single pixel of the framebuffer after a draw of a triangle
+/// covering it.
+std::array<gl::u8, 4> draw_pixel(gl::ProgramPipeline &pipeline) {
+    gl::u32 vertex_array = 0;
+    glGenVertexArrays(1, &vertex_array);
+    const auto pixel = test::draw_pixel([&] {
+        glBindVertexArray(vertex_array);
+        pipeline.bind();
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    });
+    glDeleteVertexArrays(1, &vertex_array);
+    return pixel;
+}
+} // namespace
+
+TEST_SUITE("[GL] Program pipeline") {
+    TEST_CASE("shared vertex stage should be linked once") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_program_pipeline";
+        std::filesystem::create_directories(directory);
+        const auto vertex = test::write_file(directory / "fullscreen.vert",
+                                             "#version 450 core\n"
+                                             "void main() {\n"
+                                             "    const vec2 corners[3] = vec2[](vec2(-1.0, -1.0), vec2(3.0, -1.0), vec2(-1.0, 3.0));\n"
+                                             "    gl_Position = vec4(corners[gl_VertexID], 0.0, 1.0);\n"
+                                             "}\n");
+        const auto fragment = test::write_file(directory / "color.frag",
+                                               "#version 450 core\n"
+                                               "uniform float intensity;\n"
+                                               "layout(location = 0) out vec4 color;\n"
+                                               "void main() {\n"
+                                               "#ifdef RED\n"
+                                               "    color = vec4(intensity, 0.0, 0.0, 1.0);\n"
+                                               "#else\n"
+                                               "    color = vec4(0.0, intensity, 0.0, 1.0);\n"
+                                               "#endif\n"
+                                               "}\n");
+
+        gl::PipelineCache cache(nullptr);
+        auto &green = cache.get({ { gl::ShaderType::VERTEX, vertex }, { gl::ShaderType::FRAGMENT, fragment } });
+        auto &red = cache.get({ { gl::ShaderType::FRAGMENT, fragment, { { "RED" } } }, { gl::ShaderType::VERTEX, vertex } });
+        // the order of the stages does not matter
+        auto &green_again = cache.get({ { gl::ShaderType::FRAGMENT, fragment }, { gl::ShaderType::VERTEX, vertex } });
+        CHECK(&green == &green_again);
+        CHECK(&green != &red);
+        CHECK(cache.get_stage_count() == 3);
+        CHECK(cache.get_pipeline_count() == 2);
+
+        auto &red_stage = cache.get_stage({ gl::ShaderType::FRAGMENT, fragment, { { "RED" } } });
+        red.bind();
+        CHECK(red.validate());
+        red.set_active(red_stage);
+        red_stage.make_uniform("intensity").set(1.0f);
+        const auto red_pixel = draw_pixel(red);
+        CHECK(red_pixel[0] == 255);
+        CHECK(red_pixel[1] == 0);
+
+        auto &green_stage = cache.get_stage({ gl::ShaderType::FRAGMENT, fragment });
+        green.bind();
+        green.set_active(green_stage);
+        green_stage.make_uniform("intensity").set(1.0f);
+        const auto green_pixel = draw_pixel(green);
+        CHECK(green_pixel[0] == 0);
+        CHECK(green_pixel[1] == 255);
+    }
+
+    TEST_CASE("programs that are not separable should be refused") {
+        DK_REQUIRE_GL_CONTEXT();
+        gl::Program program(nullptr);
+        gl::ProgramPipeline pipeline;
+        CHECK_THROWS_AS(pipeline.use_stages(program), std::runtime_error);
+    }
+}
@@ -0,0 +1,85 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/program.hpp>
+#include <dklib/gl/reflection.hpp>
+#include "gl_test_context.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using namespace dk;
+
+namespace {
+constexpr gl::ResourceName MVP_NAME = "mvp";
+static_assert(MVP_NAME.hash == util::fnv1a("mvp"));
+} // namespace
+
+TEST_SUITE("[GL] Program reflection") {
+    TEST_CASE("literal and run time names should have the same hash") {
+        const std::string name = "mvp";
+        CHECK(gl::ResourceName { name }.hash == MVP_NAME.hash);
+        CHECK(gl::ResourceName { name }.text == MVP_NAME.text);
+    }
+
+    TEST_CASE("active resources should be reflected after the link") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_reflection";
+        std::filesystem::create_directories(directory);
+        const auto vertex = directory / "shader.vert";
+        const auto fragment = directory / "shader.frag";
+        std::ofstream(vertex) << "#version 330 core\n"
+                                 "layout (location = 0) in vec3 position;\n"
+                                 "layout (location = 2) in vec2 uv;\n"
+                                 "layout (std140) uniform Camera { mat4 view; mat4 projection; };\n"
+                                 "uniform mat4 mvp;\n"
+                                 "out vec2 v_uv;\n"
+                                 "void main() {\n"
+                                 "    v_uv = uv;\n"
+                                 "    gl_Position = projection * view * mvp * vec4(position, 1.0);\n"
+                                 "}\n";
+        std::ofstream(fragment) << "#version 330 core\n"
+                                   "in vec2 v_uv;\n"
+                                   "uniform vec4 tints[3];\n"
+                                   "out vec4 color;\n"
+                                   "void main() { color = tints[0] + tints[2] * v_uv.x; }\n";
+
+        gl::Program program(nullptr);
+        program.attach_shader(vertex.string(), gl::ShaderType::VERTEX)
+            .attach_shader(fragment.string(), gl::ShaderType::FRAGMENT)
+            .link();
+        const auto &reflection = program.get_reflection();
+
+        const auto mvp = program.find_uniform("mvp");
+        REQUIRE(mvp.has_value());
+        CHECK(reflection.get_uniform(*mvp).location == program.get_uniform_location("mvp"));
+        CHECK(reflection.get_uniform(*mvp).type == GL_FLOAT_MAT4);
+        CHECK(program.get_uniform("mvp") >= 0);
+
+        const auto tints = program.find_uniform("tints");
+        REQUIRE(tints.has_value());
+        CHECK(reflection.get_uniform(*tints).array_size == 3);
+
+        const auto camera = reflection.find_block("Camera");
+        REQUIRE(camera.has_value());
+        CHECK(reflection.get_block(*camera).data_size == 128);
+        const auto projection = program.find_uniform("projection");
+        REQUIRE(projection.has_value());
+        CHECK(reflection.get_uniform(*projection).block_index == static_cast<gl::i32>(*camera));
+        CHECK(reflection.get_uniform(*projection).offset == 64);
+        CHECK(reflection.get_uniform(*projection).location == -1);
+
+        CHECK(program.get_attribute("position") == 0);
+        CHECK(program.get_attribute("uv") == 2);
+        CHECK_FALSE(program.find_uniform("missing").has_value());
+        CHECK_THROWS_AS((void)program.get_uniform_location("missing"), std::runtime_error);
+
+        // a name sharing the hash of an active uniform is still missing
+        auto colliding = gl::ResourceName { std::string_view { "not_mvp" } };
+        colliding.hash = MVP_NAME.hash;
+        CHECK_FALSE(program.find_uniform(colliding).has_value());
+        CHECK_THROWS_AS((void)program.get_uniform_location(colliding), std::runtime_error);
+
+        std::filesystem::remove_all(directory);
+    }
+}
@@ -0,0 +1,101 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/program.hpp>
+#include <dklib/gl/shader_preprocessor.hpp>
+#include "gl_test_context.hpp"
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using namespace dk;
+
+TEST_SUITE("[GL] Shader preprocessor") {
+    const auto directory = std::filesystem::temp_directory_path() / "dk_test_shader_preprocessor";
+
+    TEST_CASE("includes should be resolved") {
+        test::write_file(directory / "common" / "lighting.glsl", "#pragma once\nfloat lambert(vec3 n, vec3 l) { return max(dot(n, l), 0.0); }\n");
+        test::write_file(directory / "local.glsl", "#include <lighting.glsl>\nconst float AMBIENT = 0.1;\n");
+        const auto shader = test::write_file(directory / "shader.frag",
+                                             "#version 330 core\n#include \"local.glsl\"\n#include <lighting.glsl>\nvoid main() {}\n");
+
+        gl::ShaderSourceCache sources;
+        gl::ShaderPreprocessor preprocessor({ directory / "common" }, sources);
+        const auto result = preprocessor.preprocess(shader);
+
+        CHECK(result.source.text
+              == "#version 330 core\n"
+                 "#line 1 1\n"
+                 "#line 1 2\n"
+                 "#pragma once\n"
+                 "float lambert(vec3 n, vec3 l) { return max(dot(n, l), 0.0); }\n"
+                 "#line 2 1\n"
+                 "const float AMBIENT = 0.1;\n"
+                 "#line 3 0\n"
+                 // included once only
+                 "#line 4 0\n"
+                 "void main() {}\n");
+        REQUIRE(result.files.size() == 3);
+        CHECK(result.files[0] == shader.lexically_normal());
+        CHECK(result.files[2] == (directory / "common" / "lighting.glsl").lexically_normal());
+    }
+
+    TEST_CASE("defines should be injected after the version") {
+        const auto shader = test::write_file(directory / "defines.frag", "#version 330 core\nvoid main() {}\n");
+
+        gl::ShaderSourceCache sources;
+        gl::ShaderPreprocessor preprocessor({}, sources);
+        const std::array first { gl::ShaderDefine { "USE_NORMAL_MAP" }, gl::ShaderDefine { "LIGHTS", "4" } };
+        const std::array second { gl::ShaderDefine { "LIGHTS", "4" }, gl::ShaderDefine { "USE_NORMAL_MAP" } };
+        const auto a = preprocessor.preprocess(shader, first);
+        const auto b = preprocessor.preprocess(shader, second);
+
+        CHECK(a.source.text == "#version 330 core\n#define LIGHTS 4\n#define USE_NORMAL_MAP 1\n#line 2 0\nvoid main() {}\n");
+        // same permutation shares the text
+        CHECK(a.source.text.data() == b.source.text.data());
+        CHECK(a.source.hash == b.source.hash);
+        CHECK(preprocessor.size() == 1);
+
+        // nothing to do, the cached source is used as it is
+        const auto plain = preprocessor.preprocess(shader);
+        CHECK(plain.source.text.data() == sources.get(shader).text.data());
+    }
+
+    TEST_CASE("missing and recursive includes should be reported") {
+        const auto missing = test::write_file(directory / "missing.frag", "#include \"nonexistent.glsl\"\n");
+        const auto recursive = test::write_file(directory / "recursive.glsl", "#include \"recursive.glsl\"\n");
+
+        gl::ShaderSourceCache sources;
+        gl::ShaderPreprocessor preprocessor({}, sources);
+        CHECK_THROWS_AS(preprocessor.preprocess(missing), std::runtime_error);
+        CHECK_THROWS_AS(preprocessor.preprocess(recursive), std::runtime_error);
+    }
+
+    TEST_CASE("permutations with the same text should be compiled once") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto vertex = test::write_file(directory / "variant.vert", "#version 330 core\nvoid main() { gl_Position = vec4(0.0); }\n").string();
+        const auto fragment = test::write_file(directory / "variant.frag",
+                                               "#version 330 core\nout vec4 color;\n"
+                                               "void main() {\n#ifdef TINTED\n    color = vec4(1.0);\n#else\n    color = vec4(0.0);\n#endif\n}\n")
+                                  .string();
+
+        gl::ShaderVariantCache variants;
+        const std::array<gl::ShaderDefine, 0> none {};
+        const std::array tinted { gl::ShaderDefine { "TINTED" } };
+        std::array<std::unique_ptr<gl::Program>, 3> programs;
+        for (std::size_t i = 0; i < programs.size(); ++i) {
+            programs[i] = std::make_unique<gl::Program>(nullptr);
+            programs[i]
+                ->attach_shader(std::string(vertex), gl::ShaderType::VERTEX, std::span<const gl::ShaderDefine> { none }, variants)
+                .attach_shader(std::string(fragment), gl::ShaderType::FRAGMENT,
+                               i == 0 ? std::span<const gl::ShaderDefine> { none } : std::span<const gl::ShaderDefine> { tinted },
+                               variants)
+                .link();
+            CHECK(programs[i]->is_linked());
+        }
+        // one vertex shader and two fragment shaders
+        CHECK(variants.size() == 3);
+        CHECK(variants.get_hit_count() == 3);
+    }
+}
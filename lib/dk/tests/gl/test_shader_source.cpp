@@ -0,0 +1,52 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/shader_source.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+using namespace dk;
+
+TEST_SUITE("[GL] Shader source cache") {
+    TEST_CASE("same file should be read only once") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_shader_source.vert";
+        std::ofstream(path) << "#version 330 core\nvoid main() {}\n";
+
+        gl::ShaderSourceCache cache;
+        const auto first = cache.get(path);
+        const auto second = cache.get(path);
+        CHECK(first.text == "#version 330 core\nvoid main() {}\n");
+        CHECK(first.text.data() == second.text.data());
+        CHECK(first.text.data()[first.text.size()] == '\0');
+        CHECK(cache.size() == 1);
+        CHECK(cache.get_hit_count() == 1);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("changed file should be read again") {
+        const auto path = std::filesystem::temp_directory_path() / "dk_test_shader_source_changed.frag";
+        std::ofstream(path) << "void main() {}\n";
+
+        gl::ShaderSourceCache cache;
+        const auto original = cache.get(path);
+
+        // touched without a change keeps the text
+        std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(1));
+        const auto touched = cache.get(path);
+        CHECK(touched.text.data() == original.text.data());
+
+        std::ofstream(path) << "void main() { }\n";
+        std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(2));
+        const auto changed = cache.get(path);
+        CHECK(changed.text == "void main() { }\n");
+        CHECK(changed.hash != original.hash);
+        // views of the outdated text stay valid until the cache is cleared
+        CHECK(original.text == "void main() {}\n");
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("missing file should be reported") {
+        gl::ShaderSourceCache cache;
+        CHECK_THROWS_AS(cache.get("/nonexistent/dk_test_shader_source.vert"), std::runtime_error);
+    }
+}
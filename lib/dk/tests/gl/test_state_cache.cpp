@@ -0,0 +1,125 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/buffer_object.hpp>
+#include <dklib/gl/state_cache.hpp>
+#include "gl_test_context.hpp"
+
+#include <GLES3/gl31.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+gl::u32 get_binding(gl::enum32 binding) {
+    gl::i32 value = 0;
+    glGetIntegerv(binding, &value);
+    return static_cast<gl::u32>(value);
+}
+} // namespace
+
+TEST_SUITE("[GL] State cache") {
+    TEST_CASE("redundant binds should be elided") {
+        DK_REQUIRE_GL_CONTEXT();
+        auto &state = gl::StateCache::get_instance();
+        gl::VertexBuffer first(std::vector<gl::f32> { 1.0f, 2.0f });
+        gl::VertexBuffer second(std::vector<gl::f32> { 3.0f });
+        state.end_frame();
+
+        first.bind();
+        first.bind();
+        second.bind();
+        second.bind();
+        CHECK(get_binding(GL_ARRAY_BUFFER_BINDING) == second.get_id());
+        const auto stats = state.end_frame();
+        CHECK(stats.issued == 2);
+        CHECK(stats.elided == 2);
+        CHECK(state.get_last_frame_stats().issued == 2);
+        CHECK(state.get_frame_stats().issued == 0);
+
+        state.enable(GL_DEPTH_TEST);
+        state.enable(GL_DEPTH_TEST);
+        state.disable(GL_DEPTH_TEST);
+        CHECK(glIsEnabled(GL_DEPTH_TEST) == GL_FALSE);
+        CHECK(state.get_frame_stats().issued == 2);
+        CHECK(state.get_frame_stats().elided == 1);
+
+        // state changed behind the back of the cache
+        glBindBuffer(GL_ARRAY_BUFFER, first.get_id());
+        state.invalidate();
+        second.bind();
+        CHECK(get_binding(GL_ARRAY_BUFFER_BINDING) == second.get_id());
+    }
+
+    TEST_CASE("element array binding should follow the vertex array") {
+        DK_REQUIRE_GL_CONTEXT();
+        gl::ElementBuffer indices(std::vector<gl::u32> { 0, 1, 2 });
+        gl::VertexArray first;
+        gl::VertexArray second;
+
+        first.bind();
+        indices.bind();
+        second.bind();
+        // the second vertex array has no element buffer yet
+        indices.bind();
+        CHECK(get_binding(GL_ELEMENT_ARRAY_BUFFER_BINDING) == indices.get_id());
+        first.bind();
+        CHECK(get_binding(GL_ELEMENT_ARRAY_BUFFER_BINDING) == indices.get_id());
+    }
+
+    TEST_CASE("names of deleted objects should be bound again") {
+        DK_REQUIRE_GL_CONTEXT();
+        auto buffer = std::make_optional<gl::VertexBuffer>(std::vector<gl::f32> { 1.0f });
+        buffer->bind();
+        buffer.reset();
+        CHECK(get_binding(GL_ARRAY_BUFFER_BINDING) == 0);
+
+        // the driver may hand out the deleted name again
+        gl::VertexBuffer reused;
+        reused.bind();
+        CHECK(get_binding(GL_ARRAY_BUFFER_BINDING) == reused.get_id());
+    }
+
+    TEST_CASE("textures should be tracked per unit") {
+        DK_REQUIRE_GL_CONTEXT();
+        auto &state = gl::StateCache::get_instance();
+        gl::u32 textures[2] {};
+        glGenTextures(2, textures);
+        state.bind_texture(0, GL_TEXTURE_2D, textures[0]);
+        state.bind_texture(1, GL_TEXTURE_2D, textures[1]);
+        state.end_frame();
+
+        state.bind_texture(0, GL_TEXTURE_2D, textures[0]);
+        state.bind_texture(1, GL_TEXTURE_2D, textures[1]);
+        CHECK(state.get_frame_stats().elided == 2);
+        // only the active unit changed
+        CHECK(state.get_frame_stats().issued == 2);
+        CHECK(get_binding(GL_ACTIVE_TEXTURE) == GL_TEXTURE1);
+        CHECK(get_binding(GL_TEXTURE_BINDING_2D) == textures[1]);
+
+        state.forget_texture(textures[0]);
+        state.forget_texture(textures[1]);
+        glDeleteTextures(2, textures);
+    }
+
+    TEST_CASE("extensions should match the driver") {
+        DK_REQUIRE_GL_CONTEXT();
+        auto &state = gl::StateCache::get_instance();
+        gl::i32 count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        REQUIRE(count > 0);
+        const std::string first = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, 0));
+        const auto last_index = static_cast<gl::u32>(count - 1);
+        const std::string last = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, last_index));
+        CHECK(state.has_extension(first));
+        CHECK(state.has_extension(last));
+        CHECK_FALSE(state.has_extension("GL_DK_no_such_extension"));
+        // a prefix of a name is not the extension
+        CHECK_FALSE(state.has_extension(first.substr(0, first.size() - 1)));
+
+        state.invalidate();
+        CHECK(state.has_extension(first));
+    }
+}
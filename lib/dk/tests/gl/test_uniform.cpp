@@ -0,0 +1,197 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/program.hpp>
+#include <dklib/gl/uniform.hpp>
+#include "gl_test_context.hpp"
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+using namespace dk;
+
+TEST_SUITE("[GL] Uniform") {
+    TEST_CASE("unchanged values should not be uploaded again") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_uniform";
+        std::filesystem::create_directories(directory);
+        const auto vertex = directory / "shader.vert";
+        const auto fragment = directory / "shader.frag";
+        std::ofstream(vertex) << "#version 330 core\n"
+                                 "uniform mat4 model;\n"
+                                 "uniform vec3 offset;\n"
+                                 "void main() { gl_Position = model * vec4(offset, 1.0); }\n";
+        std::ofstream(fragment) << "#version 330 core\n"
+                                   "uniform float alpha;\n"
+                                   "out vec4 color;\n"
+                                   "void main() { color = vec4(alpha); }\n";
+
+        gl::Program program(nullptr);
+        program.attach_shader(vertex.string(), gl::ShaderType::VERTEX)
+            .attach_shader(fragment.string(), gl::ShaderType::FRAGMENT)
+            .link();
+        program.use();
+
+        const auto offset = program.make_uniform("offset");
+        const auto alpha = program.make_uniform("alpha");
+        const auto model = program.make_uniform("model");
+        // shadow is shared by every Uniform of the same name
+        const auto offset_copy = program.get_uniform(true, "offset");
+
+        const std::array<gl::f32, 3> value { 1.0f, 2.0f, 3.0f };
+        offset.set(value);
+        offset_copy.set(value);
+        offset.set(1.0f, 2.0f, 3.0f);
+        alpha.set(0.5f);
+        alpha.set(0.5f);
+        alpha.set(0.25f);
+        std::array<gl::f32, 16> identity {};
+        identity[0] = identity[5] = identity[10] = identity[15] = 1.0f;
+        model.set_matrix4(identity.data());
+        model.set_matrix4(identity.data());
+
+        CHECK(glGetError() == GL_NO_ERROR);
+        CHECK(program.get_uniform_stats().upload_count == 4);
+        CHECK(program.get_uniform_stats().skipped_count == 4);
+
+        std::array<gl::f32, 3> uploaded {};
+        glGetUniformfv(program.get_id(), offset.get_location(), uploaded.data());
+        CHECK(uploaded == value);
+        gl::f32 uploaded_alpha = 0.0f;
+        glGetUniformfv(program.get_id(), alpha.get_location(), &uploaded_alpha);
+        CHECK(uploaded_alpha == 0.25f);
+
+        std::filesystem::remove_all(directory);
+    }
+
+    TEST_CASE("uniforms should reach their program whichever program is current") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_uniform_owner";
+        const auto vertex = test::write_file(directory / "shader.vert", "#version 330 core\n"
+                                                                        "uniform mat4 model;\n"
+                                                                        "void main() { gl_Position = model[0]; }\n");
+        const auto fragment = test::write_file(directory / "shader.frag", "#version 330 core\n"
+                                                                          "uniform float alpha;\n"
+                                                                          "out vec4 color;\n"
+                                                                          "void main() { color = vec4(alpha); }\n");
+        const auto make_program = [&] {
+            auto program = std::make_unique<gl::Program>(nullptr);
+            program->attach_shader(vertex.string(), gl::ShaderType::VERTEX)
+                .attach_shader(fragment.string(), gl::ShaderType::FRAGMENT)
+                .link();
+            return program;
+        };
+        const auto first = make_program();
+        const auto second = make_program();
+
+        // set while the other program is current
+        second->use();
+        const auto alpha = first->make_uniform("alpha");
+        alpha.set(0.5f);
+        gl::f32 first_alpha = 0.0f;
+        gl::f32 second_alpha = 0.0f;
+        glGetUniformfv(first->get_id(), alpha.get_location(), &first_alpha);
+        glGetUniformfv(second->get_id(), alpha.get_location(), &second_alpha);
+        CHECK(first_alpha == 0.5f);
+        CHECK(second_alpha == 0.0f);
+
+        // the same matrix transposed is another value
+        first->use();
+        const auto model = first->make_uniform("model");
+        std::array<gl::f32, 16> matrix {};
+        matrix[1] = 1.0f;
+        model.set(matrix);
+        model.set(matrix, true);
+        std::array<gl::f32, 16> uploaded {};
+        glGetUniformfv(first->get_id(), model.get_location(), uploaded.data());
+        CHECK(uploaded[4] == 1.0f);
+        CHECK(uploaded[1] == 0.0f);
+        CHECK(first->get_uniform_stats().upload_count == 3);
+        CHECK(first->get_uniform_stats().skipped_count == 0);
+        CHECK(glGetError() == GL_NO_ERROR);
+
+        std::filesystem::remove_all(directory);
+    }
+
+    TEST_CASE("uniforms should follow their program when it is moved") {
+        DK_REQUIRE_GL_CONTEXT();
+        static_assert(not std::is_copy_constructible_v<gl::Program>);
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_uniform_move";
+        const auto vertex = test::write_file(directory / "shader.vert",
+                                             "#version 330 core\nvoid main() { gl_Position = vec4(0.0); }\n");
+        const auto fragment = test::write_file(directory / "shader.frag", "#version 330 core\n"
+                                                                          "uniform float alpha;\n"
+                                                                          "out vec4 color;\n"
+                                                                          "void main() { color = vec4(alpha); }\n");
+        gl::Program program(nullptr);
+        program.attach_shader(vertex.string(), gl::ShaderType::VERTEX)
+            .attach_shader(fragment.string(), gl::ShaderType::FRAGMENT)
+            .link();
+        const auto id = program.get_id();
+        const auto alpha = program.make_uniform("alpha");
+        alpha.set(0.5f);
+
+        gl::Program moved(std::move(program));
+        CHECK(moved.get_id() == id);
+        CHECK(program.get_id() == 0);
+        alpha.set(0.5f);
+        alpha.set(0.25f);
+        gl::f32 uploaded = 0.0f;
+        glGetUniformfv(moved.get_id(), alpha.get_location(), &uploaded);
+        CHECK(uploaded == 0.25f);
+        CHECK(moved.get_uniform_stats().upload_count == 2);
+        CHECK(moved.get_uniform_stats().skipped_count == 1);
+        CHECK(glGetError() == GL_NO_ERROR);
+
+        std::filesystem::remove_all(directory);
+    }
+
+    TEST_CASE("uniforms made before a reload should follow their names") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_uniform_reload";
+        const auto vertex = test::write_file(directory / "shader.vert",
+                                             "#version 330 core\nvoid main() { gl_Position = vec4(0.0); }\n");
+        const auto fragment = test::write_file(directory / "shader.frag",
+                                               "#version 330 core\n"
+                                               "uniform float alpha;\n"
+                                               "uniform float beta;\n"
+                                               "out vec4 color;\n"
+                                               "void main() { color = vec4(alpha, beta, 0.0, 1.0); }\n");
+        gl::Program program(nullptr);
+        program.attach_shader(vertex.string(), gl::ShaderType::VERTEX)
+            .attach_shader(fragment.string(), gl::ShaderType::FRAGMENT)
+            .link();
+        const auto alpha = program.make_uniform("alpha");
+        const auto beta = program.make_uniform("beta");
+        alpha.set(0.5f);
+        beta.set(0.25f);
+
+        // beta is gone, gamma may take its place among the handles
+        test::write_file(fragment, "#version 330 core\n"
+                                   "uniform float gamma;\n"
+                                   "uniform float alpha;\n"
+                                   "out vec4 color;\n"
+                                   "void main() { color = vec4(alpha, gamma, 0.0, 1.0); }\n");
+        REQUIRE(program.reload(fragment) == gl::ReloadResult::RELOADED);
+        const auto gamma = program.make_uniform("gamma");
+        // the link reset the values, none of these is skipped
+        gamma.set(0.25f);
+        alpha.set(0.5f);
+        beta.set(0.75f);
+        CHECK(program.get_uniform_stats().skipped_count == 0);
+        CHECK(alpha.get_location() == program.get_uniform_location("alpha"));
+        CHECK(beta.get_location() == -1);
+
+        gl::f32 uploaded_alpha = 0.0f;
+        gl::f32 uploaded_gamma = 0.0f;
+        glGetUniformfv(program.get_id(), alpha.get_location(), &uploaded_alpha);
+        glGetUniformfv(program.get_id(), gamma.get_location(), &uploaded_gamma);
+        CHECK(uploaded_alpha == 0.5f);
+        CHECK(uploaded_gamma == 0.25f);
+        CHECK(glGetError() == GL_NO_ERROR);
+
+        std::filesystem::remove_all(directory);
+    }
+}
@@ -0,0 +1,126 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/mesh.hpp>
+#include <dklib/gl/program.hpp>
+#include <dklib/gl/vertex_array_cache.hpp>
+#include "gl_test_context.hpp"
+
+#include <GLES3/gl3.h>
+
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+gl::u32 get_binding(gl::enum32 binding) {
+    gl::i32 value = 0;
+    glGetIntegerv(binding, &value);
+    return static_cast<gl::u32>(value);
+}
+
+/// Triangle covering the single pixel of the framebuffer, its normal is the
+/// expected color.
+gl::MeshData<gl::experimental::Vertex> make_triangle() {
+    return {
+        {
+            { { -1.0f, -1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, 0.0f, 0.0f },
+            { { 3.0f, -1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, 0.0f, 0.0f },
+            { { -1.0f, 3.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, 0.0f, 0.0f },
+        },
+        { 0, 1, 2 },
+    };
+}
+} // namespace
+
+TEST_SUITE("[GL] Vertex array cache") {
+    TEST_CASE("vertex arrays should be shared by layout and buffers") {
+        DK_REQUIRE_GL_CONTEXT();
+        gl::VertexArrayCache cache;
+        gl::VertexBuffer vertices(std::vector<gl::f32>(8, 0.0f));
+        gl::ElementBuffer indices(std::vector<gl::u32> { 0 });
+
+        auto first = cache.get<gl::experimental::Vertex>(vertices, indices);
+        auto same = cache.get<gl::experimental::Vertex>(vertices, indices);
+        const auto other_layout = cache.get<gl::experimental::TexturingVertex>(vertices, indices);
+        CHECK(first == same);
+        CHECK(first != other_layout);
+        CHECK(cache.size() == 2);
+
+        first->bind();
+        CHECK(get_binding(GL_ELEMENT_ARRAY_BUFFER_BINDING) == indices.get_id());
+
+        // the cache does not keep unused vertex arrays alive
+        first.reset();
+        same.reset();
+        CHECK(cache.size() == 1);
+    }
+
+    TEST_CASE("default constructed mesh should get its vertex array by the first upload") {
+        DK_REQUIRE_GL_CONTEXT();
+        auto &cache = gl::VertexArrayCache::get_instance();
+        const auto before = cache.size();
+        gl::Mesh<gl::experimental::Vertex> mesh;
+        CHECK(mesh.get_vertex_array() == nullptr);
+        CHECK(cache.size() == before);
+
+        static_cast<void>(mesh.update(make_triangle()));
+        REQUIRE(mesh.get_vertex_array() != nullptr);
+        CHECK(cache.size() == before + 1);
+        mesh.get_vertex_array()->bind();
+        CHECK(get_binding(GL_ELEMENT_ARRAY_BUFFER_BINDING) == mesh.get_element_buffer().get_id());
+    }
+
+    TEST_CASE("making a mesh should keep the element buffer of the bound vertex array") {
+        DK_REQUIRE_GL_CONTEXT();
+        const gl::Mesh<gl::experimental::Vertex> first(make_triangle());
+        REQUIRE(first.get_vertex_array() != nullptr);
+        first.get_vertex_array()->bind();
+        const gl::Mesh<gl::experimental::Vertex> second(make_triangle());
+        CHECK(first.get_vertex_array() != second.get_vertex_array());
+        first.get_vertex_array()->bind();
+        CHECK(get_binding(GL_ELEMENT_ARRAY_BUFFER_BINDING) == first.get_element_buffer().get_id());
+    }
+
+    TEST_CASE("mesh draw should only bind its vertex array") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_vertex_array_cache";
+        auto program = test::make_normal_color_program(directory);
+
+        const gl::Mesh<gl::experimental::Vertex> mesh(make_triangle());
+        auto &state = gl::StateCache::get_instance();
+        const auto pixel = test::draw_pixel([&] {
+            program.use();
+            mesh.draw();
+            state.end_frame();
+            mesh.draw();
+        });
+        CHECK(state.get_frame_stats().issued == 0);
+        CHECK(state.get_frame_stats().elided == 1);
+
+        // the normal attribute is read too
+        CHECK(pixel[0] == 0);
+        CHECK(pixel[1] == 255);
+        CHECK(pixel[2] == 0);
+        std::filesystem::remove_all(directory);
+    }
+
+    TEST_CASE("moved vertex array should keep its name") {
+        DK_REQUIRE_GL_CONTEXT();
+        gl::VertexArray original;
+        const auto id = original.get_id();
+        gl::VertexArray moved(std::move(original));
+        CHECK(moved.get_id() == id);
+        CHECK(original.get_id() == 0);
+
+        gl::VertexArray assigned;
+        assigned = std::move(moved);
+        CHECK(assigned.get_id() == id);
+        // the name becomes a vertex array on its first bind
+        assigned.bind();
+        CHECK(glIsVertexArray(id) == GL_TRUE);
+    }
+}
@@ -0,0 +1,231 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/mesh.hpp>
+#include <dklib/gl/program.hpp>
+#include <dklib/gl/vertex_compression.hpp>
+#include "gl_test_context.hpp"
+
+#include <GLES3/gl3.h>
+
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <random>
+#include <span>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+std::vector<gl::experimental::Vertex> make_vertices(std::size_t count) {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<gl::f32> position(-25.0f, 40.0f);
+    std::uniform_real_distribution<gl::f32> direction(-1.0f, 1.0f);
+    std::uniform_real_distribution<gl::f32> uv(0.0f, 1.0f);
+    std::vector<gl::experimental::Vertex> vertices;
+    for (std::size_t i = 0; i < count; ++i) {
+        math::Vector3D normal { direction(generator), direction(generator), direction(generator) };
+        const gl::f32 length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+        normal = { normal.x / length, normal.y / length, normal.z / length };
+        vertices.push_back({ { position(generator), position(generator), position(generator) }, normal, uv(generator),
+                             uv(generator) });
+    }
+    return vertices;
+}
+
+} // namespace
+
+TEST_SUITE("[GL] Vertex compression") {
+    TEST_CASE("compressed vertices should have half of the size and a matching layout") {
+        static_assert(sizeof(gl::CompressedVertex) * 2 == sizeof(gl::experimental::Vertex));
+        constexpr auto &layout = gl::VertexLayout<gl::CompressedVertex>::attributes;
+        CHECK(layout[0] == gl::VertexAttribute { 0, 4, GL_SHORT, true, 0 });
+        CHECK(layout[1] == gl::VertexAttribute { 1, 2, GL_SHORT, true, 8 });
+        CHECK(layout[2] == gl::VertexAttribute { 2, 2, GL_HALF_FLOAT, false, 12 });
+    }
+
+    TEST_CASE("half floats should be rounded to nearest even") {
+        CHECK(gl::float_to_half(0.0f).bits == 0x0000);
+        CHECK(gl::float_to_half(-0.0f).bits == 0x8000);
+        CHECK(gl::float_to_half(1.0f).bits == 0x3c00);
+        CHECK(gl::float_to_half(-2.0f).bits == 0xc000);
+        CHECK(gl::float_to_half(65504.0f).bits == 0x7bff);
+        // 65520 is halfway between the largest half and infinity
+        CHECK(gl::float_to_half(65519.0f).bits == 0x7bff);
+        CHECK(gl::float_to_half(65520.0f).bits == 0x7c00);
+        CHECK(gl::float_to_half(std::numeric_limits<gl::f32>::infinity()).bits == 0x7c00);
+        CHECK((gl::float_to_half(std::numeric_limits<gl::f32>::quiet_NaN()).bits & 0x7e00) == 0x7e00);
+        // 1 + 2^-11 is halfway between 1 and its successor, ties to the even 1
+        CHECK(gl::float_to_half(1.0f + std::ldexp(1.0f, -11)).bits == 0x3c00);
+        CHECK(gl::float_to_half(1.0f + 3.0f * std::ldexp(1.0f, -11)).bits == 0x3c02);
+        // subnormals
+        CHECK(gl::float_to_half(std::ldexp(1.0f, -24)).bits == 0x0001);
+        CHECK(gl::float_to_half(std::ldexp(1.0f, -25)).bits == 0x0000);
+        CHECK(gl::float_to_half(std::ldexp(1023.5f, -24)).bits == 0x0400);
+
+        for (gl::u32 bits = 0; bits < 0x7c00; ++bits) {
+            const gl::Half half { static_cast<gl::u16>(bits) };
+            REQUIRE(gl::float_to_half(gl::half_to_float(half)).bits == bits);
+        }
+    }
+
+    TEST_CASE("octahedral normals should decode to the encoded direction") {
+        const std::array<std::array<gl::f32, 3>, 6> axes { {
+            { 1.0f, 0.0f, 0.0f },
+            { -1.0f, 0.0f, 0.0f },
+            { 0.0f, 1.0f, 0.0f },
+            { 0.0f, -1.0f, 0.0f },
+            { 0.0f, 0.0f, 1.0f },
+            { 0.0f, 0.0f, -1.0f },
+        } };
+        for (const auto &axis : axes) {
+            const auto decoded = gl::decode_octahedral(gl::encode_octahedral(axis[0], axis[1], axis[2]));
+            CHECK(decoded[0] == doctest::Approx(axis[0]));
+            CHECK(decoded[1] == doctest::Approx(axis[1]));
+            CHECK(decoded[2] == doctest::Approx(axis[2]));
+        }
+        // the length of the direction does not matter
+        const auto scaled = gl::encode_octahedral(0.0f, 0.0f, -5.0f);
+        CHECK(scaled.values == gl::encode_octahedral(0.0f, 0.0f, -1.0f).values);
+    }
+
+    TEST_CASE("compression should stay within the precision of its formats") {
+        // an odd count, so that the vector kernels have a scalar tail
+        const auto vertices = make_vertices(1001);
+        const auto compressed = gl::compress(vertices);
+        REQUIRE(compressed.vertices.size() == vertices.size());
+        CHECK(compressed.quantization.offset[0] == doctest::Approx(7.5f).epsilon(0.1));
+
+        const auto error = gl::measure_error(vertices, compressed);
+        // half of a snorm16 step of each axis, the extent is below 65
+        const gl::f32 step = 65.0f / 65534.0f;
+        CHECK(error.max_position <= std::sqrt(3.0f) * step * 0.5f + 1e-5f);
+        CHECK(error.mean_position <= error.max_position);
+        CHECK(error.max_normal_degrees < 0.01f);
+        // half of the half float step below 1
+        CHECK(error.max_uv <= std::ldexp(1.0f, -12));
+
+        const auto decoded = gl::decompress(compressed.vertices, compressed.quantization);
+        CHECK(decoded[0].position.x == doctest::Approx(vertices[0].position.x).epsilon(1e-3));
+        CHECK(decoded[1000].u == doctest::Approx(vertices[1000].u).epsilon(1e-3));
+    }
+
+    TEST_CASE("the vector kernels should match the scalar conversions") {
+        const auto vertices = make_vertices(259);
+        const auto compressed = gl::compress(vertices);
+        const gl::f32 w = 32767.0f;
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            const auto &vertex = vertices[i];
+            const auto &result = compressed.vertices[i];
+            const auto normal = gl::encode_octahedral(vertex.normal.x, vertex.normal.y, vertex.normal.z);
+            REQUIRE(result.normal.values == normal.values);
+            REQUIRE(result.uv[0].bits == gl::float_to_half(vertex.u).bits);
+            REQUIRE(result.uv[1].bits == gl::float_to_half(vertex.v).bits);
+            REQUIRE(result.position.values[3] == static_cast<gl::i16>(w));
+            // a single vertex is converted by the scalar tail
+            const auto single = gl::compress(std::span { &vertex, 1 }, compressed.quantization);
+            REQUIRE(result.position.values == single[0].position.values);
+        }
+    }
+
+    TEST_CASE("NaN components should be encoded as zero by every kernel") {
+        const gl::f32 nan = std::numeric_limits<gl::f32>::quiet_NaN();
+        auto vertices = make_vertices(6);
+        vertices[1].position.x = nan;
+        vertices[1].normal = { nan, nan, nan };
+        vertices[2].normal.z = nan;
+        vertices[5].position.y = nan;
+        vertices[5].normal = { nan, nan, nan };
+        const auto compressed = gl::compress(vertices, gl::VertexQuantization {});
+        CHECK(compressed[1].position.values[0] == 0);
+        CHECK(compressed[1].normal.values == std::array<gl::i16, 2> { 0, 0 });
+        CHECK(compressed[5].position.values[1] == 0);
+        CHECK(compressed[5].normal.values == std::array<gl::i16, 2> { 0, 0 });
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            const auto &vertex = vertices[i];
+            const auto normal = gl::encode_octahedral(vertex.normal.x, vertex.normal.y, vertex.normal.z);
+            CHECK(compressed[i].normal.values == normal.values);
+            const auto single = gl::compress(std::span { &vertex, 1 }, gl::VertexQuantization {});
+            CHECK(compressed[i].position.values == single[0].position.values);
+        }
+    }
+
+    TEST_CASE("positions outside of a shared quantization should be clamped") {
+        const std::vector<gl::experimental::Vertex> vertices {
+            { { 3.0f, -3.0f, 0.5f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f },
+        };
+        const auto compressed = gl::compress(vertices, gl::VertexQuantization {});
+        CHECK(compressed[0].position.values[0] == 32767);
+        CHECK(compressed[0].position.values[1] == -32767);
+        CHECK(compressed[0].position.values[2] == 16384);
+    }
+
+    TEST_CASE("meshes should keep their indices") {
+        gl::MeshData<gl::experimental::Vertex> data {
+            {
+                { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f },
+                { { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 1.0f, 0.0f },
+                { { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 1.0f },
+            },
+            { 0, 1, 2 },
+        };
+        const auto compressed = gl::compress(std::move(data));
+        CHECK(compressed.mesh.vertices.size() == 3);
+        CHECK(compressed.mesh.indices == std::vector<gl::u32> { 0, 1, 2 });
+        CHECK(compressed.quantization.scale[0] == doctest::Approx(0.5f));
+        CHECK(compressed.quantization.scale[2] == doctest::Approx(1.0f));
+    }
+
+    TEST_CASE("compressed meshes should be decoded by the vertex shader") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_vertex_compression";
+        auto program = test::make_program(
+            directory,
+            "#version 450 core\n"
+            "layout (location = 0) in vec4 position;\n"
+            "layout (location = 1) in vec2 normal;\n"
+            "layout (location = 2) in vec2 uv;\n"
+            "uniform vec3 quantization_scale;\n"
+            "uniform vec3 quantization_offset;\n"
+            "out vec4 vertex_color;\n"
+            "void main() {\n"
+            "    vec3 n = vec3(normal, 1.0 - abs(normal.x) - abs(normal.y));\n"
+            "    if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * sign(n.xy);\n"
+            "    vertex_color = vec4(normalize(n) * 0.5 + 0.5, uv.x);\n"
+            "    gl_Position = vec4(position.xyz * quantization_scale + quantization_offset, position.w);\n"
+            "}\n",
+            "#version 450 core\n"
+            "in vec4 vertex_color;\n"
+            "out vec4 result;\n"
+            "void main() { result = vertex_color; }\n"
+        );
+
+        // a triangle covering the viewport, with the normal pointing below
+        // the horizon to exercise the folded half of the encoding
+        gl::MeshData<gl::experimental::Vertex> data {
+            {
+                { { -1.0f, -1.0f, 0.0f }, { 0.6f, 0.0f, -0.8f }, 1.0f, 0.0f },
+                { { 3.0f, -1.0f, 0.0f }, { 0.6f, 0.0f, -0.8f }, 1.0f, 0.0f },
+                { { -1.0f, 3.0f, 0.0f }, { 0.6f, 0.0f, -0.8f }, 1.0f, 0.0f },
+            },
+            { 0, 1, 2 },
+        };
+        const auto compressed = gl::compress(std::move(data));
+        const gl::Mesh<gl::CompressedVertex> mesh(gl::MeshData<gl::CompressedVertex>(compressed.mesh));
+
+        const auto &quantization = compressed.quantization;
+        const auto pixel = test::draw_pixel([&] {
+            program.use();
+            glUniform3fv(glGetUniformLocation(program.get_id(), "quantization_scale"), 1, quantization.scale.data());
+            glUniform3fv(glGetUniformLocation(program.get_id(), "quantization_offset"), 1, quantization.offset.data());
+            mesh.draw();
+        });
+        // (0.6, 0, -0.8) * 0.5 + 0.5
+        CHECK(pixel[0] == doctest::Approx(204).epsilon(0.01));
+        CHECK(pixel[1] == doctest::Approx(128).epsilon(0.01));
+        CHECK(pixel[2] == doctest::Approx(26).epsilon(0.05));
+        CHECK(pixel[3] == 255);
+        std::filesystem::remove_all(directory);
+    }
+}
@@ -0,0 +1,148 @@
+#include <doctest/doctest.h>
+#include <dklib/gl/program.hpp>
+#include <dklib/gl/vertex.hpp>
+#include <dklib/gl/vertex_array_cache.hpp>
+#include <dklib/gl/vertex_format.hpp>
+#include "gl_test_context.hpp"
+
+#include <GLES3/gl3.h>
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+using namespace dk;
+
+namespace {
+struct CompressedVertex {
+    gl::Normalized<gl::i16, 4> position;
+    gl::Packed1010102 normal;
+    gl::Half uv[2];
+    gl::u8 material;
+};
+} // namespace
+
+template <>
+struct gl::VertexLayout<CompressedVertex> {
+    static constexpr std::array attributes {
+        DK_VERTEX_ATTRIBUTE(CompressedVertex, position, 0),
+        DK_VERTEX_ATTRIBUTE(CompressedVertex, normal, 1),
+        DK_VERTEX_ATTRIBUTE(CompressedVertex, uv, 2),
+        DK_VERTEX_ATTRIBUTE(CompressedVertex, material, 3),
+    };
+};
+
+TEST_SUITE("[GL] Vertex format") {
+    TEST_CASE("layouts should be derived from the fields") {
+        constexpr auto &layout = gl::VertexLayout<gl::experimental::Vertex>::attributes;
+        static_assert(layout[0] == gl::VertexAttribute { 0, 3, GL_FLOAT, false, 0 });
+        static_assert(layout[1] == gl::VertexAttribute { 1, 3, GL_FLOAT, false, 12 });
+        static_assert(layout[2] == gl::VertexAttribute { 2, 2, GL_FLOAT, false, 24 });
+
+        constexpr auto &compressed = gl::VertexLayout<CompressedVertex>::attributes;
+        CHECK(compressed[0] == gl::VertexAttribute { 0, 4, GL_SHORT, true, 0 });
+        CHECK(compressed[1] == gl::VertexAttribute { 1, 4, GL_INT_2_10_10_10_REV, true, 8 });
+        CHECK(compressed[2] == gl::VertexAttribute { 2, 2, GL_HALF_FLOAT, false, 12 });
+        CHECK(compressed[3] == gl::VertexAttribute { 3, 1, GL_UNSIGNED_BYTE, false, 16, 0, true });
+
+        // a single field vertex is read at location 0
+        constexpr auto &single = gl::VertexLayout<std::array<gl::f32, 2>>::attributes;
+        CHECK(single.size() == 1);
+        CHECK(single[0] == gl::VertexAttribute { 0, 2, GL_FLOAT, false, 0 });
+    }
+
+    TEST_CASE("stream layouts should read each stream from its own binding") {
+        using Split = gl::StreamLayout<gl::experimental::PositionalVertex, gl::AttributeStream<1, gl::Packed1010102>,
+                                       gl::AttributeStream<2, std::array<gl::Half, 2>>>;
+        static_assert(Split::stream_count == 3);
+        static_assert(Split::strides == std::array<gl::u32, 3> { 12, 4, 4 });
+        CHECK(Split::attributes[0] == gl::VertexAttribute { 0, 3, GL_FLOAT, false, 0, 0 });
+        CHECK(Split::attributes[1] == gl::VertexAttribute { 1, 4, GL_INT_2_10_10_10_REV, true, 0, 1 });
+        CHECK(Split::attributes[2] == gl::VertexAttribute { 2, 2, GL_HALF_FLOAT, false, 0, 2 });
+    }
+
+    TEST_CASE("deprecated setters should point into the bound buffer") {
+        DK_REQUIRE_GL_CONTEXT();
+        gl::VertexArray vertex_array;
+        vertex_array.bind();
+        const gl::VertexBuffer vertices(std::vector<gl::f32>(16, 0.0f));
+        vertices.bind();
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+        gl::bind_attributes(3);
+        gl::experimental::bind_attributes_v2<gl::f32>(4);
+#pragma GCC diagnostic pop
+
+        const auto get = [](gl::u32 location, gl::enum32 name) {
+            gl::i32 value = 0;
+            glGetVertexAttribiv(location, name, &value);
+            return value;
+        };
+        CHECK(get(3, GL_VERTEX_ATTRIB_ARRAY_SIZE) == 3);
+        CHECK(get(3, GL_VERTEX_ATTRIB_ARRAY_STRIDE) == 3 * sizeof(gl::f32));
+        CHECK(get(3, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING) == static_cast<gl::i32>(vertices.get_id()));
+        // position, normal and uv of experimental::Vertex, shifted by 4
+        CHECK(get(5, GL_VERTEX_ATTRIB_ARRAY_SIZE) == 3);
+        CHECK(get(6, GL_VERTEX_ATTRIB_ARRAY_SIZE) == 2);
+        CHECK(get(6, GL_VERTEX_ATTRIB_ARRAY_STRIDE) == sizeof(gl::experimental::Vertex));
+        CHECK(glGetError() == GL_NO_ERROR);
+    }
+
+    TEST_CASE("structure of arrays in one buffer should be drawn") {
+        DK_REQUIRE_GL_CONTEXT();
+        const auto directory = std::filesystem::temp_directory_path() / "dk_test_vertex_format";
+        auto program = test::make_program(directory,
+                                          "#version 450 core\n"
+                                          "layout (location = 0) in vec3 position;\n"
+                                          "layout (location = 1) in vec4 color;\n"
+                                          "layout (location = 2) in uint channel;\n"
+                                          "out vec4 vertex_color;\n"
+                                          "void main() {\n"
+                                          "    vertex_color = color;\n"
+                                          "    vertex_color[channel] = 1.0;\n"
+                                          "    gl_Position = vec4(position, 1.0);\n"
+                                          "}\n",
+                                          "#version 450 core\n"
+                                          "in vec4 vertex_color;\n"
+                                          "out vec4 result;\n"
+                                          "void main() { result = vertex_color; }\n");
+
+        using SoA = gl::StreamLayout<gl::AttributeStream<0, math::Vector3D>, gl::AttributeStream<1, gl::Normalized<gl::u8, 4>>,
+                                     gl::AttributeStream<2, gl::u32>>;
+        const std::array<math::Vector3D, 3> positions { { { -1.0f, -1.0f, 0.0f }, { 3.0f, -1.0f, 0.0f }, { -1.0f, 3.0f, 0.0f } } };
+        const std::array<gl::Normalized<gl::u8, 4>, 3> colors { { { 0, 0, 0, 255 }, { 0, 0, 0, 255 }, { 0, 0, 0, 255 } } };
+        const std::array<gl::u32, 3> channels { 2, 2, 2 };
+
+        // the arrays follow each other in a single buffer
+        std::vector<std::byte> bytes(sizeof(positions) + sizeof(colors) + sizeof(channels));
+        std::memcpy(bytes.data(), positions.data(), sizeof(positions));
+        std::memcpy(bytes.data() + sizeof(positions), colors.data(), sizeof(colors));
+        std::memcpy(bytes.data() + sizeof(positions) + sizeof(colors), channels.data(), sizeof(channels));
+        gl::VertexBuffer buffer;
+        buffer.allocate(bytes.size(), gl::BufferUsage::STATIC_DRAW);
+        buffer.update(0, bytes);
+
+        const std::array<gl::VertexStreamBinding, 3> streams { {
+            { buffer.get_id(), SoA::strides[0], 0 },
+            { buffer.get_id(), SoA::strides[1], sizeof(positions) },
+            { buffer.get_id(), SoA::strides[2], sizeof(positions) + sizeof(colors) },
+        } };
+        gl::VertexArrayCache cache;
+        const auto vertex_array = cache.get(SoA::attributes, streams, 0);
+
+        const auto pixel = test::draw_pixel([&] {
+            program.use();
+            vertex_array->bind();
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        });
+        CHECK(pixel[0] == 0);
+        CHECK(pixel[1] == 0);
+        // the blue channel comes from the integer attribute
+        CHECK(pixel[2] == 255);
+        CHECK(pixel[3] == 255);
+        std::filesystem::remove_all(directory);
+    }
+}
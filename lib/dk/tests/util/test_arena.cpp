@@ -0,0 +1,59 @@
+#include <doctest/doctest.h>
+#include <dklib/util/arena.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+using namespace dk;
+
+TEST_SUITE("[UTIL] Arena") {
+    TEST_CASE("allocations should be aligned and stable") {
+        util::Arena arena(64);
+        const auto first = arena.allocate(3, 1);
+        const auto second = arena.allocate(16, 16);
+        CHECK(reinterpret_cast<std::uintptr_t>(second.data()) % 16 == 0);
+        CHECK(second.data() >= first.data() + 3);
+        CHECK(arena.used() == 19);
+
+        // does not fit into the block, another one is added
+        const auto big = arena.allocate(1000);
+        CHECK(big.size() == 1000);
+        CHECK(arena.capacity() >= 1064);
+    }
+
+    TEST_CASE("stored texts should be null terminated copies") {
+        util::Arena arena(16);
+        std::string text = "#version 330 core";
+        const auto stored = arena.store(text);
+        text[0] = 'x';
+        CHECK(stored == "#version 330 core");
+        CHECK(stored.data()[stored.size()] == '\0');
+
+        arena.clear();
+        CHECK(arena.used() == 0);
+        CHECK(arena.capacity() == 0);
+    }
+
+    TEST_CASE("moved arenas should not share blocks") {
+        util::Arena arena(64);
+        const auto before = arena.allocate(8, 1);
+
+        util::Arena moved(std::move(arena));
+        CHECK(moved.used() == 8);
+        CHECK(arena.used() == 0);
+        CHECK(arena.capacity() == 0);
+
+        // the moved from arena starts a block of its own
+        const auto own = arena.allocate(8, 1);
+        const auto next = moved.allocate(8, 1);
+        CHECK(next.data() == before.data() + 8);
+        CHECK((own.data() < before.data() or own.data() >= before.data() + 64));
+
+        util::Arena assigned;
+        assigned = std::move(moved);
+        CHECK(assigned.used() == 16);
+        CHECK(moved.used() == 0);
+        CHECK(moved.allocate(4, 1).data() != assigned.allocate(4, 1).data());
+    }
+}
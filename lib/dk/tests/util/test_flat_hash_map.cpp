@@ -0,0 +1,75 @@
+#include <doctest/doctest.h>
+
+#include <dklib/util/flat_hash_map.hpp>
+
+#include <cstdint>
+#include <map>
+#include <random>
+
+using namespace dk;
+
+TEST_SUITE_BEGIN("Flat Hash Map");
+
+TEST_CASE("Inserted values can be found") {
+    util::FlatHashMap<int, int> map;
+    CHECK(map.empty());
+    CHECK(map.find(1) == nullptr);
+    for (int i = 0; i < 1000; ++i) {
+        const auto [value, is_inserted] = map.try_emplace(i, i * 2);
+        CHECK(is_inserted);
+        CHECK(*value == i * 2);
+    }
+    CHECK(map.size() == 1000);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(map.find(i) != nullptr);
+        CHECK(*map.find(i) == i * 2);
+    }
+    CHECK_FALSE(map.contains(1000));
+}
+
+TEST_CASE("Existing keys are not overwritten") {
+    util::FlatHashMap<int, int> map;
+    map.try_emplace(7, 1);
+    const auto [value, is_inserted] = map.try_emplace(7, 2);
+    CHECK_FALSE(is_inserted);
+    CHECK(*value == 1);
+    CHECK(map.size() == 1);
+}
+
+TEST_CASE("Reserving avoids growth") {
+    util::FlatHashMap<std::uint64_t, int> map(500);
+    const auto capacity = map.capacity();
+    for (std::uint64_t i = 0; i < 500; ++i) {
+        map.try_emplace(i, 0);
+    }
+    CHECK(map.capacity() == capacity);
+    CHECK(map.memory_usage() >= capacity * (sizeof(std::uint64_t) + sizeof(int)));
+}
+
+TEST_CASE("Erasing keeps the other keys reachable") {
+    util::FlatHashMap<std::uint32_t, std::uint32_t> map;
+    std::map<std::uint32_t, std::uint32_t> reference;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::uint32_t> keys(0, 300);
+    for (int i = 0; i < 5000; ++i) {
+        const auto key = keys(generator);
+        if (generator() % 3 == 0) {
+            CHECK(map.erase(key) == (reference.erase(key) == 1));
+        } else {
+            map.try_emplace(key, key + 1);
+            reference.try_emplace(key, key + 1);
+        }
+    }
+    CHECK(map.size() == reference.size());
+    for (std::uint32_t key = 0; key <= 300; ++key) {
+        const auto *value = map.find(key);
+        if (reference.contains(key)) {
+            REQUIRE(value != nullptr);
+            CHECK(*value == key + 1);
+        } else {
+            CHECK(value == nullptr);
+        }
+    }
+}
+
+TEST_SUITE_END();
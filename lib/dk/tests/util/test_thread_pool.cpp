@@ -0,0 +1,71 @@
+#include <doctest/doctest.h>
+
+#include <dklib/util/thread_pool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace dk;
+
+TEST_SUITE_BEGIN("Thread Pool");
+
+TEST_CASE("Submitted tasks return their results") {
+    util::ThreadPool pool(2);
+    auto first = pool.submit([]() { return 1; });
+    auto second = pool.submit([]() { return 2; });
+    CHECK(first.get() + second.get() == 3);
+}
+
+TEST_CASE("Parallel for covers the whole range exactly once") {
+    util::ThreadPool pool(4);
+    std::vector<int> visits(1000, 0);
+    pool.parallel_for(visits.size(), [&visits](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            ++visits[i];
+        }
+    });
+    CHECK(std::accumulate(visits.begin(), visits.end(), 0) == 1000);
+    CHECK(std::all_of(visits.begin(), visits.end(), [](int v) { return v == 1; }));
+}
+
+TEST_CASE("Parallel for rethrows exceptions of the tasks") {
+    util::ThreadPool pool(2);
+    CHECK_THROWS_AS(
+        pool.parallel_for(8, [](std::size_t, std::size_t) { throw std::runtime_error("failure"); }),
+        std::runtime_error
+    );
+}
+
+TEST_CASE("Parallel for rethrows only after all of the ranges finished") {
+    util::ThreadPool pool(4);
+    std::atomic<int> finished { 0 };
+    CHECK_THROWS_AS(pool.parallel_for(4,
+                                      [&finished](std::size_t begin, std::size_t) {
+                                          if (begin == 0) {
+                                              throw std::runtime_error("failure");
+                                          }
+                                          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                                          ++finished;
+                                      }),
+                    std::runtime_error);
+    CHECK(finished == 3);
+}
+
+TEST_CASE("Parallel for called from a worker runs inline") {
+    util::ThreadPool pool(1);
+    CHECK_FALSE(pool.is_worker());
+    auto result = pool.submit([&pool]() {
+        int visits = 0;
+        pool.parallel_for(100, [&visits](std::size_t begin, std::size_t end) {
+            visits += static_cast<int>(end - begin);
+        });
+        return pool.is_worker() ? visits : -1;
+    });
+    CHECK(result.get() == 100);
+}
+
+TEST_SUITE_END();
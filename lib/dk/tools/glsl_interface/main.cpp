@@ -0,0 +1,125 @@
+/// @file main.cpp
+///
+/// Generates the typed C++ interface of a shader program from its GLSL
+/// sources, see cmake/glsl.cmake. Includes of the shaders are resolved and
+/// listed in "<stamp>.d", so the build knows when to run it again. The stamp
+/// is written on every run, the header only when its contents change.
+///
+/// Usage: dk_glsl_interface <struct name> <output header> [--stamp <file>]
+/// [--vertex|--fragment|--geometry|--tess-control|--tess-evaluation|--compute <shader>]...
+/// [--include <directory>]...
+
+#include <dklib/gl/glsl_interface.hpp>
+#include <dklib/gl/shader_preprocessor.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr std::array<std::pair<std::string_view, dk::gl::ShaderType>, 6> STAGES = { {
+    { "--vertex", dk::gl::ShaderType::VERTEX },
+    { "--fragment", dk::gl::ShaderType::FRAGMENT },
+    { "--geometry", dk::gl::ShaderType::GEOMETRY },
+    { "--tess-control", dk::gl::ShaderType::TESS_CONTROL },
+    { "--tess-evaluation", dk::gl::ShaderType::TESS_EVALUATION },
+    { "--compute", dk::gl::ShaderType::COMPUTE },
+} };
+
+std::string read_file(const std::filesystem::path &path) {
+    std::ifstream fin(path);
+    if (not fin.is_open()) {
+        spdlog::error("Shader {} could not be opened", path.string());
+        throw std::runtime_error("Shader could not be opened");
+    }
+    std::stringstream buffer;
+    buffer << fin.rdbuf();
+    return buffer.str();
+}
+
+/// Dependency file in the make syntax, understood by every CMake generator.
+std::string make_depfile(const std::filesystem::path &output, const std::vector<std::filesystem::path> &files) {
+    const auto escape = [](const std::filesystem::path &path) {
+        std::string escaped;
+        for (const char c : std::filesystem::absolute(path).lexically_normal().generic_string()) {
+            if (c == ' ' or c == '#') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    };
+    std::string depfile = escape(output) + ":";
+    for (const auto &file : files) {
+        depfile += " \\\n  " + escape(file);
+    }
+    return depfile + "\n";
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 5 or (argc - 3) % 2 != 0) {
+        spdlog::error("Usage: {} <struct name> <output header> [--vertex|--fragment|... <shader>]...", argv[0]);
+        return 1;
+    }
+    const std::string_view name = argv[1];
+    const std::filesystem::path output = argv[2];
+
+    try {
+        std::vector<std::filesystem::path> include_directories;
+        // without a stamp the header itself is the target of the build rule
+        std::filesystem::path stamp = output;
+        for (int i = 3; i < argc; i += 2) {
+            if (std::string_view { argv[i] } == "--include") {
+                include_directories.emplace_back(argv[i + 1]);
+            } else if (std::string_view { argv[i] } == "--stamp") {
+                stamp = argv[i + 1];
+            }
+        }
+        dk::gl::ShaderPreprocessor preprocessor(std::move(include_directories));
+
+        std::vector<dk::gl::glsl::ShaderFile> shaders;
+        std::vector<std::filesystem::path> dependencies;
+        dk::gl::glsl::Interface interface;
+        for (int i = 3; i < argc; i += 2) {
+            if (std::string_view { argv[i] } == "--include" or std::string_view { argv[i] } == "--stamp") {
+                continue;
+            }
+            const auto stage = std::ranges::find(STAGES, std::string_view { argv[i] }, &decltype(STAGES)::value_type::first);
+            if (stage == STAGES.end()) {
+                spdlog::error("Unknown shader stage {}", argv[i]);
+                return 1;
+            }
+            shaders.push_back({ stage->second, argv[i + 1] });
+            const auto preprocessed = preprocessor.preprocess(argv[i + 1]);
+            interface.merge(dk::gl::glsl::parse_interface(preprocessed.source.text, stage->second));
+            dependencies.insert(dependencies.end(), preprocessed.files.begin(), preprocessed.files.end());
+        }
+        std::filesystem::create_directories(output.parent_path());
+        std::ofstream(stamp.string() + ".d") << make_depfile(stamp, dependencies);
+
+        const auto header = dk::gl::glsl::generate_header(name, shaders, interface);
+        // unchanged header keeps its timestamp, so nothing is rebuilt
+        if (not std::filesystem::exists(output) or read_file(output) != header) {
+            std::ofstream(output) << header;
+        }
+        if (stamp != output) {
+            // stamp is newer than the dependencies, so the rule is satisfied
+            std::ofstream(stamp, std::ios::trunc);
+        } else {
+            std::filesystem::last_write_time(output, std::filesystem::file_time_type::clock::now());
+        }
+    } catch (const std::exception &error) {
+        spdlog::error("{}", error.what());
+        return 1;
+    }
+    return 0;
+}
@@ -15,6 +15,9 @@ public:
         static const gl::f32 white[] = { 1.0f, 1.0f, 1.0f, 1.0f };
         glClearBufferfv(GL_COLOR, 0, white);
         program.use();
+        // the vertices come from gl_VertexID, but a core profile context
+        // draws only with a vertex array bound
+        vertex_array.bind();
         // Sends Point primitive to pipeline
         glDrawArrays(GL_TRIANGLES, 0, 3);
     };
@@ -22,5 +25,6 @@ public:
 
 private:
     gl::Program program;
+    gl::VertexArray vertex_array;
 };
 } // namespace dk
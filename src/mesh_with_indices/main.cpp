@@ -3,8 +3,11 @@
 #include <dklib/file.h>
 #include <dklib/dklib.h>
 
+#include <glsl/mesh_with_indices_interface.hpp>
 #include <imgui.h>
 
+#include <array>
+#include <filesystem>
 #include <string_view>
 #include <vector>
 
@@ -14,12 +17,10 @@ public:
     MeshWithIndicesApplication()
         : Application("Mesh rendering with indices")
         , program()
+        // uniforms are typed and resolved without any string lookup, see
+        // dk_glsl_interface in CMakeLists.txt
+        , uniforms(glsl::MeshWithIndicesProgram::attach_shaders(program).link())
         , aspect_ratio(static_cast<gl::f32>(info.window_width) / static_cast<gl::f32>(info.window_height)) {
-        const std::string path_prefix = "src/mesh_with_indices/";
-        program
-            .attach_shader(path_prefix + "main.frag.glsl", gl::ShaderType::FRAGMENT)
-            .attach_shader(path_prefix + "main.vert.glsl", gl::ShaderType::VERTEX)
-            .link();
 
         // Informations about uniforms, etc.
         {
@@ -82,9 +83,17 @@ public:
         // meshes.emplace_back(dk::ObjFile::read("assets/obj_files/monkey.obj"));
         // meshes.emplace_back(dk::ObjFile::read("assets/obj_files/bunny.obj"));
 
-        mv_location = program.get_uniform("mv_matrix");
-        proj_location = program.get_uniform("proj_matrix");
-        scale_location = program.get_uniform("scale_matrix");
+        // Saved shaders and meshes are reloaded while the application runs,
+        // meshes were reserved above, so they do not move
+        auto &reloader = get_hot_reloader();
+        reloader.watch(program, [this](gl::Program &reloaded) { uniforms = glsl::MeshWithIndicesProgram(reloaded); });
+        constexpr std::array MESH_FILES { "assets/obj_files/cube.obj", "assets/obj_files/cone.obj",
+                                          "assets/obj_files/monkey.obj", "assets/obj_files/bunny_v2.obj" };
+        for (std::size_t i = 0; i < meshes.size(); ++i) {
+            reloader.watch(meshes[i], MESH_FILES[i], [](const std::filesystem::path &path) {
+                return dk::file::obj::experimental::read_data<dk::gl::experimental::Vertex>(path);
+            });
+        }
 
         program.get_uniform(true, "mv_matrix");
 
@@ -133,6 +142,9 @@ public:
         ImGui::SliderFloat("Stride factor", &STRIDE_FACTOR, 0.0f, 100.0f);
         ImGui::SliderInt("Mesh count", &mesh_cnt, 0, 255);
         ImGui::Checkbox("Enable rotation", &is_rotation_enabled);
+        const auto &reloads = get_hot_reloader().get_stats();
+        ImGui::Text("Reloads: %zu, failed: %zu, latency: %.1f ms (max %.1f ms)", reloads.reload_count,
+                    reloads.failure_count, reloads.last_latency.count(), reloads.max_latency.count());
         ImGui::End();
     }
 
@@ -142,10 +154,10 @@ public:
 
         program.use();
 
-        glUniformMatrix4fv(proj_location, 1, GL_FALSE, proj_matrix);
+        uniforms.set_proj_matrix(proj_matrix);
 
         scale_matrix = vmath::scale(SCALE_FACTOR, SCALE_FACTOR, SCALE_FACTOR);
-        glUniformMatrix4fv(scale_location, 1, GL_FALSE, scale_matrix);
+        uniforms.set_scale_matrix(scale_matrix);
 
         for (gl::i32 i = 0; i < mesh_cnt; ++i) {
             gl::f32 stride = i == 1 ? 1.0f : static_cast<gl::f32>(i) * STRIDE_FACTOR;
@@ -153,7 +165,7 @@ public:
             if (is_rotation_enabled) {
                 mv_matrix = vmath::translate(0.0f, 0.0f, -4.0f) * vmath::translate(sinf(2.1f * f) * 0.5f, cosf(1.7f * f) * 0.5f, sinf(1.3f * f) * cosf(1.5f * f) * 2.0f) * vmath::rotate(static_cast<gl::f32>(delta) * 45.0f, 0.0f, 1.0f, 0.0f) * vmath::rotate(static_cast<gl::f32>(delta) * 81.0f, 1.0f, 0.0f, 0.0f);
             }
-            glUniformMatrix4fv(mv_location, 1, GL_FALSE, mv_matrix);
+            uniforms.set_mv_matrix(mv_matrix);
 
             meshes[drawed_shape % meshes.size()].draw();
         }
@@ -163,9 +175,7 @@ private:
     gl::f32 STRIDE_FACTOR = 1.0f;
     gl::f32 SCALE_FACTOR = 1.0f;
     gl::Program program;
-    gl::i32 mv_location;
-    gl::i32 proj_location;
-    gl::i32 scale_location;
+    glsl::MeshWithIndicesProgram uniforms;
     gl::f32 aspect_ratio;
     vmath::mat4 proj_matrix;
     vmath::mat4 scale_matrix;
@@ -64,9 +64,9 @@ public:
             )
         );
 
-        mv_location = program.get_uniform("mv_matrix");
-        proj_location = program.get_uniform("proj_matrix");
-        scale_location = program.get_uniform("scale_matrix");
+        mv_uniform = program.make_uniform("mv_matrix");
+        proj_uniform = program.make_uniform("proj_matrix");
+        scale_uniform = program.make_uniform("scale_matrix");
 
         program.get_uniform(true, "mv_matrix");
 
@@ -74,10 +74,11 @@ public:
 
         // TODO indeces => indices
 
-        glEnable(GL_CULL_FACE);
+        auto &state = gl::StateCache::get_instance();
+        state.enable(GL_CULL_FACE);
         glFrontFace(GL_CCW);
 
-        glEnable(GL_DEPTH_TEST);
+        state.enable(GL_DEPTH_TEST);
         glDepthFunc(GL_LEQUAL);
 
         spdlog::info("registering callback");
@@ -120,12 +121,16 @@ public:
         ImGui::SliderFloat("Stride factor", &STRIDE_FACTOR, 0.0f, 100.0f);
         ImGui::SliderInt("Mesh count", &mesh_cnt, 0, 255);
         ImGui::Checkbox("Enable rotation", &is_rotation_enabled);
+        // every mesh after the first one binds the same buffers again
+        const auto &state = gl::StateCache::get_instance().get_last_frame_stats();
+        ImGui::Text("State changes issued: %llu, elided: %llu", static_cast<unsigned long long>(state.issued),
+                    static_cast<unsigned long long>(state.elided));
         ImGui::End();
 
-        glUniformMatrix4fv(proj_location, 1, GL_FALSE, proj_matrix);
+        proj_uniform.set_matrix4(proj_matrix);
 
         scale_matrix = vmath::scale(SCALE_FACTOR, SCALE_FACTOR, SCALE_FACTOR);
-        glUniformMatrix4fv(scale_location, 1, GL_FALSE, scale_matrix);
+        scale_uniform.set_matrix4(scale_matrix);
 
         for (gl::i32 i = 0; i < mesh_cnt; ++i) {
             gl::f32 stride = i == 1 ? 1.0f : static_cast<gl::f32>(i) * STRIDE_FACTOR;
@@ -133,7 +138,7 @@ public:
             if (is_rotation_enabled) {
                 mv_matrix = vmath::translate(0.0f, 0.0f, -4.0f) * vmath::translate(sinf(2.1f * f) * 0.5f, cosf(1.7f * f) * 0.5f, sinf(1.3f * f) * cosf(1.5f * f) * 2.0f) * vmath::rotate(static_cast<gl::f32>(delta) * 45.0f, 0.0f, 1.0f, 0.0f) * vmath::rotate(static_cast<gl::f32>(delta) * 81.0f, 1.0f, 0.0f, 0.0f);
             }
-            glUniformMatrix4fv(mv_location, 1, GL_FALSE, mv_matrix);
+            mv_uniform.set_matrix4(mv_matrix);
 
             meshes[drawed_shape % meshes.size()].draw();
         }
@@ -143,9 +148,9 @@ private:
     gl::f32 STRIDE_FACTOR = 1.0f;
     gl::f32 SCALE_FACTOR = 1.0f;
     gl::Program program;
-    gl::i32 mv_location;
-    gl::i32 proj_location;
-    gl::i32 scale_location;
+    gl::Uniform mv_uniform { -1, std::string {} };
+    gl::Uniform proj_uniform { -1, std::string {} };
+    gl::Uniform scale_uniform { -1, std::string {} };
     gl::f32 aspect_ratio;
     vmath::mat4 proj_matrix;
     vmath::mat4 scale_matrix;
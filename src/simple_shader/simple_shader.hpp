@@ -24,6 +24,8 @@ public:
 
         // Sets size of a point to 40px
         glPointSize(40.0f);
+        // a core profile context draws only with a vertex array bound
+        vertex_array.bind();
         // Sends Point primitive to pipeline
         glDrawArrays(GL_POINTS, 0, 1);
     };
@@ -31,5 +33,6 @@ public:
 
 private:
     gl::Program prog;
+    gl::VertexArray vertex_array;
 };
 } // namespace dk
@@ -57,6 +57,7 @@ public:
             0.25f, 0.25f, 0.25f, -0.25f, 0.25f, 0.25f, -0.25f, 0.25f, -0.25f
         };
 
+        vertex_array.bind();
         glGenBuffers(1, &buf);
         glBindBuffer(GL_ARRAY_BUFFER, buf);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertex_positions), vertex_positions, GL_STATIC_DRAW);
@@ -89,12 +90,14 @@ public:
         gl::f32 f = static_cast<gl::f32>(delta) * 0.3f;
         vmath::mat4 mv_matrix = vmath::translate(0.0f, 0.0f, -4.0f) * vmath::translate(sinf(2.1f * f) * 0.5f, cosf(1.7f * f) * 0.5f, sinf(1.3f * f) * cosf(1.5f * f) * 2.0f) * vmath::rotate(static_cast<gl::f32>(delta) * 45.0f, 0.0f, 1.0f, 0.0f) * vmath::rotate(static_cast<gl::f32>(delta) * 81.0f, 1.0f, 0.0f, 0.0f);
         glUniformMatrix4fv(mv_location, 1, GL_FALSE, mv_matrix);
+        vertex_array.bind();
         glDrawArrays(GL_TRIANGLES, 0, 36);
     };
     virtual void shutdown() override {};
 
 private:
     gl::Program program;
+    gl::VertexArray vertex_array;
     gl::i32 mv_location;
     gl::i32 proj_location;
     gl::u32 buf;
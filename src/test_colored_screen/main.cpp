@@ -64,6 +64,7 @@ public:
         spdlog::info("Size of alt Array: {}", 6 * triangle.size() * sizeof(f32));
         spdlog::info("size of vertices: {}", sizeof(vertices));
 
+        vertex_array.bind();
         glGenBuffers(1, &vbo);
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
         // glBufferData(GL_ARRAY_BUFFER, size, triangle.data(), GL_STATIC_DRAW);
@@ -84,11 +85,13 @@ public:
         static const gl::f32 white[] = { 1.0f, 1.0f, 1.0f, 1.0f };
         glClearBufferfv(GL_COLOR, 0, white);
         program.use();
+        vertex_array.bind();
         glDrawArrays(GL_TRIANGLES, 0, 3);
     }
 
 private:
     gl::Program program;
+    gl::VertexArray vertex_array;
     u32 vbo;
 };
 } // namespace dk
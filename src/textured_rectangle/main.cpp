@@ -11,13 +11,28 @@
 
 namespace dk {
 
+/// Rectangle of two triangles, the normals of the vertices are their colors.
+inline gl::MeshData<gl::experimental::Vertex, gl::u8> make_rectangle() {
+    return {
+        {
+            { { 0.5f, 0.5f, 0.0f }, { 1.0f, 0.0f, 0.0f }, 1.0f, 1.0f },
+            { { 0.5f, -0.5f, 0.0f }, { 0.0f, 1.0f, 0.0f }, 1.0f, 0.0f },
+            { { -0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 0.0f, 0.0f },
+            { { -0.5f, 0.5f, 0.0f }, { 1.0f, 1.0f, 0.0f }, 0.0f, 1.0f },
+        },
+        {
+            0, 1, 3,
+            1, 2, 3,
+        },
+    };
+}
+
 class TexturedTriangleApplication : public sdl::Application {
 public:
     TexturedTriangleApplication()
         : Application("Textured Rectangle")
         , program()
-        , vbo()
-        , ebo() {
+        , mesh(make_rectangle()) {
         const std::string path_prefix = "src/textured_rectangle/";
         program
             .attach_shader(path_prefix + "main.frag.glsl", gl::ShaderType::FRAGMENT)
@@ -60,39 +75,6 @@ public:
         blend_factor_location = program.get_uniform("blend_factor");
         spdlog::info("blend factor location {}", blend_factor_location);
 
-        // TODO:
-        // [ ] We need to specify some shape
-        // [ ] Triangulate that shape (and provide indices)
-        // [ ] Compute textire coordinates
-        std::vector<gl::f32> vertices = {
-            0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f,
-            0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-           -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f,
-           -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        };
-        std::vector<gl::u8> indices = {
-            0, 1, 3,
-            1, 2, 3,
-        };
-
-        vbo.setup(vertices);
-        ebo.setup(indices);
-
-        // TODO: this should be done with some vertex structure
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(gl::f32), reinterpret_cast<void *>(0));
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(gl::f32), reinterpret_cast<void *>(3 * sizeof(gl::f32)));
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(gl::f32), reinterpret_cast<void *>(6 * sizeof(gl::f32)));
-        glEnableVertexAttribArray(2);
-
-        // TODO: ^^^ Both the vertex structure and buffers should be contained
-        // in some kind of Drawable.
-        // We should be able to say whether we should provide:
-        // 1. Vertices
-        // 2. Colors
-        // 3. Texturing coordinates
-
         // TODO: it should be possible to bind some texture to this drawable
         // and throw an exception (or something similar) if the drawable does
         // not allow texturing.
@@ -209,7 +191,7 @@ public:
         glUniform1i(flag_location, is_blending_enabled);
         glUniform1i(color_location, is_color_mode_enabled);
         glUniform1f(blend_factor_location, blend_factor);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, nullptr);
+        mesh.draw();
 
         // TODO: We should probably add some method solely used for GUI rendering,
         // it can be here, but I think that it only clutters the important
@@ -235,8 +217,9 @@ private:
     bool is_blending_enabled {true};
     bool is_color_mode_enabled {true};
     gl::Program program;
-    gl::VertexBuffer vbo;
-    gl::ElementBuffer ebo;
+    // the layout of experimental::Vertex matches the shader, with the
+    // color in place of the normal
+    gl::Mesh<gl::experimental::Vertex, gl::u8> mesh;
     gl::u32 active_texture;
     std::vector<gl::u32> textures;
 };